@@ -14,16 +14,33 @@
  *                Basic I/O primitives                                  *
  ************************************************************************/
 
+/* A flushed message that the client has not acknowledged yet */
+typedef struct {
+  guint32 end_serial; /* serial of the first command after this message */
+  gsize size;
+  gint64 time;
+} BroadwayOutputFrame;
+
 struct BroadwayOutput {
   GOutputStream *out;
   GString *buf;
   int error;
   guint32 serial;
+
+  GQueue frames; /* BroadwayOutputFrame, oldest first */
+  gsize backlog;
+  gint64 round_trip_time;
+  guint64 bytes_sent;
+  guint64 bytes_uncompressed;
+
+  /* permessage-deflate, with the context kept between messages */
+  GConverter *compressor;
 };
 
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
-                          gboolean fin, BroadwayWSOpCode code,
+                          gboolean fin, gboolean compressed,
+                          BroadwayWSOpCode code,
                           const void *buf, gsize count)
 {
   gboolean mask = FALSE;
@@ -34,7 +51,7 @@ broadway_output_send_cmd (BroadwayOutput *output,
   gboolean long_header = count > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
                 (mid_header ? 126 : long_header ? 127 : count) );
   p = 2;
@@ -56,17 +73,94 @@ broadway_output_send_cmd (BroadwayOutput *output,
 
 void broadway_output_pong (BroadwayOutput *output)
 {
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
+  broadway_output_send_cmd (output, TRUE, FALSE, BROADWAY_WS_CNX_PONG, NULL, 0);
+}
+
+/* Compresses a message as described in RFC 7692: a sync flush,
+ * without the trailing empty block */
+static GBytes *
+deflate_message (BroadwayOutput *output,
+                 const char     *data,
+                 gsize           len)
+{
+  GByteArray *res;
+  GConverterResult result;
+  gsize read, written;
+  GError *error = NULL;
+
+  res = g_byte_array_new ();
+  do
+    {
+      gsize pos = res->len;
+
+      g_byte_array_set_size (res, pos + len + 64);
+      result = g_converter_convert (output->compressor,
+                                    data, len,
+                                    res->data + pos, res->len - pos,
+                                    G_CONVERTER_FLUSH,
+                                    &read, &written,
+                                    &error);
+      if (result == G_CONVERTER_ERROR)
+        {
+          g_warning ("Failed to compress message: %s", error->message);
+          g_error_free (error);
+          g_byte_array_unref (res);
+          return NULL;
+        }
+
+      g_byte_array_set_size (res, pos + written);
+      data += read;
+      len -= read;
+    }
+  while (result != G_CONVERTER_FLUSHED);
+
+  if (res->len >= 4 && memcmp (res->data + res->len - 4, "\x00\x00\xff\xff", 4) == 0)
+    g_byte_array_set_size (res, res->len - 4);
+
+  return g_byte_array_free_to_bytes (res);
 }
 
 int
 broadway_output_flush (BroadwayOutput *output)
 {
+  BroadwayOutputFrame *frame;
+  GBytes *compressed = NULL;
+  gsize size;
+
   if (output->buf->len == 0)
     return TRUE;
 
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
-                            output->buf->str, output->buf->len);
+  if (output->compressor)
+    {
+      compressed = deflate_message (output, output->buf->str, output->buf->len);
+      /* The context is gone, stop compressing */
+      if (compressed == NULL)
+        g_clear_object (&output->compressor);
+    }
+
+  if (compressed)
+    {
+      const guchar *data = g_bytes_get_data (compressed, &size);
+
+      broadway_output_send_cmd (output, TRUE, TRUE, BROADWAY_WS_BINARY, data, size);
+      g_bytes_unref (compressed);
+    }
+  else
+    {
+      size = output->buf->len;
+      broadway_output_send_cmd (output, TRUE, FALSE, BROADWAY_WS_BINARY,
+                                output->buf->str, output->buf->len);
+    }
+
+  frame = g_new (BroadwayOutputFrame, 1);
+  frame->end_serial = output->serial;
+  frame->size = size;
+  frame->time = g_get_monotonic_time ();
+  g_queue_push_tail (&output->frames, frame);
+
+  output->backlog += size;
+  output->bytes_sent += size;
+  output->bytes_uncompressed += output->buf->len;
 
   g_string_set_size (output->buf, 0);
 
@@ -75,7 +169,7 @@ broadway_output_flush (BroadwayOutput *output)
 }
 
 BroadwayOutput *
-broadway_output_new (GOutputStream *out, guint32 serial)
+broadway_output_new (GOutputStream *out, guint32 serial, gboolean deflate)
 {
   BroadwayOutput *output;
 
@@ -84,6 +178,10 @@ broadway_output_new (GOutputStream *out, guint32 serial)
   output->out = g_object_ref (out);
   output->buf = g_string_new ("");
   output->serial = serial;
+  g_queue_init (&output->frames);
+
+  if (deflate)
+    output->compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, -1));
 
   return output;
 }
@@ -91,10 +189,45 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 void
 broadway_output_free (BroadwayOutput *output)
 {
+  g_queue_clear_full (&output->frames, g_free);
+  g_clear_object (&output->compressor);
   g_object_unref (output->out);
   free (output);
 }
 
+/* The client has handled all commands up to and including @serial */
+void
+broadway_output_ack (BroadwayOutput *output,
+                     guint32         serial)
+{
+  BroadwayOutputFrame *frame;
+
+  while ((frame = g_queue_peek_head (&output->frames)) != NULL &&
+         (gint32) (frame->end_serial - serial - 1) <= 0)
+    {
+      output->round_trip_time = g_get_monotonic_time () - frame->time;
+      output->backlog -= frame->size;
+      g_free (g_queue_pop_head (&output->frames));
+    }
+}
+
+guint
+broadway_output_get_frames_in_flight (BroadwayOutput *output)
+{
+  return g_queue_get_length (&output->frames);
+}
+
+void
+broadway_output_get_stats (BroadwayOutput      *output,
+                           BroadwayOutputStats *stats)
+{
+  stats->round_trip_time = output->round_trip_time;
+  stats->frames_in_flight = g_queue_get_length (&output->frames);
+  stats->backlog = output->backlog;
+  stats->bytes_sent = output->bytes_sent;
+  stats->bytes_uncompressed = output->bytes_uncompressed;
+}
+
 guint32
 broadway_output_get_next_serial (BroadwayOutput *output)
 {
@@ -602,11 +735,13 @@ broadway_output_surface_set_nodes (BroadwayOutput *output,
 void
 broadway_output_upload_texture (BroadwayOutput *output,
                                 guint32 id,
+                                guint32 base_id,
                                 GBytes *texture)
 {
   gsize len = g_bytes_get_size (texture);
   write_header (output, BROADWAY_OP_UPLOAD_TEXTURE);
   append_uint32 (output, id);
+  append_uint32 (output, base_id);
   append_uint32 (output, (guint32)len);
   g_string_append_len (output->buf, g_bytes_get_data (texture, NULL), len);
 }
@@ -16,10 +16,24 @@ typedef enum {
   BROADWAY_WS_CNX_PONG = 0xa
 } BroadwayWSOpCode;
 
+typedef struct {
+  gint64 round_trip_time;       /* of the last acknowledged message, in µs */
+  guint frames_in_flight;       /* messages the client has not acknowledged */
+  gsize backlog;                /* bytes the client has not acknowledged */
+  guint64 bytes_sent;
+  guint64 bytes_uncompressed;
+} BroadwayOutputStats;
+
 BroadwayOutput *broadway_output_new                 (GOutputStream  *out,
-                                                     guint32         serial);
+                                                     guint32         serial,
+                                                     gboolean        deflate);
 void            broadway_output_free                (BroadwayOutput *output);
 int             broadway_output_flush               (BroadwayOutput *output);
+void            broadway_output_ack                 (BroadwayOutput *output,
+                                                     guint32         serial);
+guint           broadway_output_get_frames_in_flight (BroadwayOutput *output);
+void            broadway_output_get_stats           (BroadwayOutput      *output,
+                                                     BroadwayOutputStats *stats);
 int             broadway_output_has_error           (BroadwayOutput *output);
 void            broadway_output_set_next_serial     (BroadwayOutput *output,
                                                      guint32         serial);
@@ -62,6 +76,7 @@ void            broadway_output_surface_set_nodes   (BroadwayOutput *output,
                                                      GHashTable     *old_node_lookup);
 void            broadway_output_upload_texture      (BroadwayOutput *output,
                                                      guint32         id,
+                                                     guint32         base_id,
                                                      GBytes         *texture);
 void            broadway_output_release_texture     (BroadwayOutput *output,
                                                      guint32         id);
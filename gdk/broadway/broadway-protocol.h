@@ -65,6 +65,7 @@ typedef enum {
   BROADWAY_EVENT_SCREEN_SIZE_CHANGED = 12,
   BROADWAY_EVENT_FOCUS = 13,
   BROADWAY_EVENT_ROUNDTRIP_NOTIFY = 14,
+  BROADWAY_EVENT_FRAME_ACK = 15, /* only seen by broadwayd */
 } BroadwayEventType;
 
 typedef enum {
@@ -241,6 +242,7 @@ typedef struct {
 typedef struct {
   BroadwayRequestBase base;
   guint32 id;
+  guint32 base_id; /* 0, or the texture that the data is a patch for */
   guint32 offset;
   guint32 size;
 } BroadwayRequestUploadTexture;
@@ -88,6 +88,8 @@ struct _BroadwayServer {
   int future_mouse_in_surface;
 
   GList *outstanding_roundtrips;
+
+  guint64 frames_coalesced;
 };
 
 struct _BroadwayServerClass
@@ -112,6 +114,7 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  GConverter *decompressor; /* if permessage-deflate was negotiated */
 };
 
 struct BroadwaySurface {
@@ -127,16 +130,29 @@ struct BroadwaySurface {
   gboolean modal_hint;
   BroadwayNode *nodes;
   GHashTable *node_lookup;
+
+  /* What the client shows, may be behind nodes if the client is slow */
+  BroadwayNode *sent_nodes;
+  GHashTable *sent_node_lookup;
+  gboolean nodes_pending;
 };
 
+/* Node updates are held back while this many messages have not been
+ * acknowledged by the client. Only the last tree of a surface is sent
+ * when it catches up, so latency stays bounded on slow connections.
+ */
+#define MAX_FRAMES_IN_FLIGHT 2
+
 struct _BroadwayTexture {
   grefcount refcount;
   guint32 id;
+  guint32 base_id; /* the texture that bytes is a patch for, or 0 */
   GBytes *bytes;
 };
 
 static void broadway_server_resync_surfaces (BroadwayServer *server);
 static void send_outstanding_roundtrips (BroadwayServer *server);
+static void broadway_server_send_pending_nodes (BroadwayServer *server);
 
 static void broadway_server_ref_texture (BroadwayServer   *server,
                                          guint32           id);
@@ -308,6 +324,9 @@ broadway_surface_free (BroadwayServer *server,
   if (surface->nodes)
     broadway_node_unref (server, surface->nodes);
   g_hash_table_unref (surface->node_lookup);
+  if (surface->sent_nodes)
+    broadway_node_unref (server, surface->sent_nodes);
+  g_clear_pointer (&surface->sent_node_lookup, g_hash_table_unref);
   g_free (surface);
 }
 
@@ -337,6 +356,7 @@ broadway_input_free (BroadwayInput *input)
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
   g_source_destroy (input->source);
+  g_clear_object (&input->decompressor);
   g_free (input);
 }
 
@@ -653,6 +673,14 @@ parse_input_message (BroadwayInput *input, const unsigned char *message)
   msg.base.time = time_;
 
   switch (msg.base.type) {
+  case BROADWAY_EVENT_FRAME_ACK:
+    if (input->output == server->output)
+      {
+        broadway_output_ack (server->output, msg.base.serial);
+        broadway_server_send_pending_nodes (server);
+      }
+    return;
+
   case BROADWAY_EVENT_ENTER:
   case BROADWAY_EVENT_LEAVE:
     p = parse_pointer_data (p, &msg.pointer);
@@ -772,6 +800,73 @@ hex_dump (guchar *data, gsize len)
 #endif
 }
 
+/* Undoes permessage-deflate, see RFC 7692. Clients are asked not to
+ * keep the compression context between messages, so every message
+ * is a new stream. */
+static GBytes *
+inflate_message (BroadwayInput *input,
+                 const guchar  *data,
+                 gsize          len)
+{
+  static const guchar tail[] = { 0x00, 0x00, 0xff, 0xff };
+  GByteArray *in, *res;
+  GConverterResult result;
+  gsize read, written, pos;
+  GError *error = NULL;
+
+  if (input->decompressor == NULL)
+    {
+      g_warning ("compressed input without permessage-deflate");
+      return NULL;
+    }
+
+  in = g_byte_array_sized_new (len + sizeof (tail));
+  g_byte_array_append (in, data, len);
+  g_byte_array_append (in, tail, sizeof (tail));
+
+  g_converter_reset (input->decompressor);
+  res = g_byte_array_new ();
+  pos = 0;
+  do
+    {
+      gsize out_pos = res->len;
+
+      g_byte_array_set_size (res, out_pos + 256);
+      result = g_converter_convert (input->decompressor,
+                                    in->data + pos, in->len - pos,
+                                    res->data + out_pos, 256,
+                                    G_CONVERTER_NO_FLAGS,
+                                    &read, &written,
+                                    &error);
+      if (result == G_CONVERTER_ERROR)
+        {
+          g_byte_array_set_size (res, out_pos);
+          /* All input consumed, that's what the sync flush is for */
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT) &&
+              pos == in->len)
+            {
+              g_clear_error (&error);
+              break;
+            }
+
+          g_warning ("Failed to inflate input: %s", error->message);
+          g_error_free (error);
+          g_byte_array_unref (in);
+          g_byte_array_unref (res);
+          return NULL;
+        }
+
+      g_byte_array_set_size (res, out_pos + written);
+      pos += read;
+    }
+  while (result != G_CONVERTER_FINISHED &&
+         (pos < in->len || written == 256));
+
+  g_byte_array_unref (in);
+
+  return g_byte_array_free_to_bytes (res);
+}
+
 static void
 parse_input (BroadwayInput *input)
 {
@@ -784,7 +879,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -795,6 +890,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = buf[0] & 0x40;
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -844,6 +940,16 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed)
+          {
+            GBytes *message = inflate_message (input, data, payload_len);
+
+            if (message)
+              {
+                parse_input_message (input, g_bytes_get_data (message, NULL));
+                g_bytes_unref (message);
+              }
+          }
         else
           {
             parse_input_message (input, data);
@@ -1091,6 +1197,16 @@ generate_handshake_response_wsietf_v7 (const char *key)
   return g_base64_encode (digest, digest_len);
 }
 
+/* Compressing the websocket costs cpu time on both ends, and is only
+ * worth it on slow connections */
+static gboolean
+use_deflate (void)
+{
+  const char *s = g_getenv ("BROADWAY_WEBSOCKET_DEFLATE");
+
+  return s != NULL && atoi (s) != 0;
+}
+
 static void
 start_input (HttpRequest *request)
 {
@@ -1106,6 +1222,7 @@ start_input (HttpRequest *request)
   const char *key;
   GSocket *socket;
   int flag = 1;
+  gboolean deflate;
 
 #ifdef DEBUG_WEBSOCKETS
   g_print ("incoming request:\n%s\n", request->request->str);
@@ -1115,10 +1232,13 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  deflate = FALSE;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
         key = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        deflate = strstr (p, "permessage-deflate") != NULL && use_deflate ();
       else if ((p = parse_line (lines[i], "Origin")))
         origin = p;
       else if ((p = parse_line (lines[i], "Host")))
@@ -1142,10 +1262,12 @@ start_input (HttpRequest *request)
                              "Connection: Upgrade\r\n"
                              "Sec-WebSocket-Accept: %s\r\n"
                              "%s%s%s"
+                             "%s"
                              "Sec-WebSocket-Location: ws://%s/socket\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
+                             deflate?"Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover\r\n":"",
                              host);
       g_free (accept);
 
@@ -1177,7 +1299,9 @@ start_input (HttpRequest *request)
   g_byte_array_append (input->buffer, data_buffer, data_buffer_size);
 
   input->output =
-    broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
+    broadway_output_new (g_io_stream_get_output_stream (request->connection), 0, deflate);
+  if (deflate)
+    input->decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
 
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
@@ -1281,6 +1405,35 @@ send_data (HttpRequest *request,
 #include "clienthtml.h"
 #include "broadwayjs.h"
 
+/* Lets people watch how the connection to the client is doing */
+static void
+send_stats (HttpRequest *request)
+{
+  BroadwayServer *server = request->server;
+  BroadwayOutputStats stats = { 0, };
+  char *text;
+
+  if (server->output)
+    broadway_output_get_stats (server->output, &stats);
+
+  text = g_strdup_printf ("connected: %s\n"
+                          "round-trip-time: %" G_GINT64_FORMAT " us\n"
+                          "frames-in-flight: %u\n"
+                          "backlog: %" G_GSIZE_FORMAT " bytes\n"
+                          "frames-coalesced: %" G_GUINT64_FORMAT "\n"
+                          "bytes-sent: %" G_GUINT64_FORMAT "\n"
+                          "bytes-uncompressed: %" G_GUINT64_FORMAT "\n",
+                          server->output ? "yes" : "no",
+                          stats.round_trip_time,
+                          stats.frames_in_flight,
+                          stats.backlog,
+                          server->frames_coalesced,
+                          stats.bytes_sent,
+                          stats.bytes_uncompressed);
+  send_data (request, "text/plain", text, strlen (text));
+  g_free (text);
+}
+
 static void
 got_request (HttpRequest *request)
 {
@@ -1321,6 +1474,8 @@ got_request (HttpRequest *request)
     send_data (request, "text/javascript", broadway_js, G_N_ELEMENTS(broadway_js) - 1);
   else if (strcmp (escaped, "/socket") == 0)
     start_input (request);
+  else if (strcmp (escaped, "/stats") == 0)
+    send_stats (request);
   else
     send_error (request, 404, "File not found");
 
@@ -1898,6 +2053,52 @@ decode_nodes (BroadwayServer *server,
   return node;
 }
 
+/* Sends the difference between the tree the client has and the
+ * current one */
+static void
+broadway_server_surface_send_nodes (BroadwayServer  *server,
+                                    BroadwaySurface *surface)
+{
+  broadway_output_surface_set_nodes (server->output, surface->id,
+                                     surface->nodes,
+                                     surface->sent_nodes,
+                                     surface->sent_node_lookup);
+
+  if (surface->sent_nodes)
+    broadway_node_unref (server, surface->sent_nodes);
+  surface->sent_nodes = broadway_node_ref (surface->nodes);
+
+  g_clear_pointer (&surface->sent_node_lookup, g_hash_table_unref);
+  surface->sent_node_lookup = g_hash_table_ref (surface->node_lookup);
+
+  surface->nodes_pending = FALSE;
+}
+
+static void
+broadway_server_send_pending_nodes (BroadwayServer *server)
+{
+  gboolean sent = FALSE;
+  GList *l;
+
+  if (server->output == NULL ||
+      broadway_output_get_frames_in_flight (server->output) >= MAX_FRAMES_IN_FLIGHT)
+    return;
+
+  for (l = server->surfaces; l != NULL; l = l->next)
+    {
+      BroadwaySurface *surface = l->data;
+
+      if (surface->nodes_pending)
+        {
+          broadway_server_surface_send_nodes (server, surface);
+          sent = TRUE;
+        }
+    }
+
+  if (sent)
+    broadway_server_flush (server);
+}
+
 /* passes ownership of nodes */
 void
 broadway_server_surface_update_nodes (BroadwayServer   *server,
@@ -1916,24 +2117,36 @@ broadway_server_surface_update_nodes (BroadwayServer   *server,
 
   root = decode_nodes (server, surface, len, data, client_texture_map, &pos);
 
-  if (server->output != NULL)
-    broadway_output_surface_set_nodes (server->output, surface->id,
-                                       root,
-                                       surface->nodes,
-                                       surface->node_lookup);
-
   if (surface->nodes)
     broadway_node_unref (server, surface->nodes);
-
   surface->nodes = root;
 
-  g_hash_table_remove_all (surface->node_lookup);
+  g_hash_table_unref (surface->node_lookup);
+  surface->node_lookup = g_hash_table_new (g_direct_hash, g_direct_equal);
   broadway_node_add_to_lookup (root, surface->node_lookup);
+
+  if (server->output == NULL)
+    return;
+
+  if (broadway_output_get_frames_in_flight (server->output) >= MAX_FRAMES_IN_FLIGHT)
+    {
+      /* Replaces a tree that never made it to the client */
+      if (surface->nodes_pending)
+        server->frames_coalesced++;
+      surface->nodes_pending = TRUE;
+    }
+  else
+    broadway_server_surface_send_nodes (server, surface);
 }
 
+/* If @base_id is not 0, @bytes only contain the tiles that differ
+ * from that texture, and the base is kept alive for as long as this
+ * texture exists, so the client can still be resynced.
+ */
 guint32
 broadway_server_upload_texture (BroadwayServer   *server,
-                                GBytes           *bytes)
+                                GBytes           *bytes,
+                                guint32           base_id)
 {
   BroadwayTexture *texture;
 
@@ -1942,12 +2155,19 @@ broadway_server_upload_texture (BroadwayServer   *server,
   texture->id = ++server->next_texture_id;
   texture->bytes = g_bytes_ref (bytes);
 
+  if (base_id != 0 &&
+      g_hash_table_contains (server->textures, GINT_TO_POINTER (base_id)))
+    {
+      texture->base_id = base_id;
+      broadway_server_ref_texture (server, base_id);
+    }
+
   g_hash_table_replace (server->textures,
                         GINT_TO_POINTER (texture->id),
                         texture);
 
   if (server->output)
-    broadway_output_upload_texture (server->output, texture->id, texture->bytes);
+    broadway_output_upload_texture (server->output, texture->id, texture->base_id, texture->bytes);
 
   return texture->id;
 }
@@ -1973,10 +2193,15 @@ broadway_server_release_texture (BroadwayServer   *server,
 
   if (texture && g_ref_count_dec (&texture->refcount))
     {
+      guint32 base_id = texture->base_id;
+
       g_hash_table_remove (server->textures, GINT_TO_POINTER (id));
 
       if (server->output)
         broadway_output_release_texture (server->output, id);
+
+      if (base_id != 0)
+        broadway_server_release_texture (server, base_id);
     }
 }
 
@@ -2142,25 +2367,37 @@ broadway_server_new_surface (BroadwayServer *server,
   return surface->id;
 }
 
+static int
+compare_texture_ids (gconstpointer a,
+                     gconstpointer b)
+{
+  const BroadwayTexture *ta = a;
+  const BroadwayTexture *tb = b;
+
+  return ta->id < tb->id ? -1 : ta->id > tb->id;
+}
+
 static void
 broadway_server_resync_surfaces (BroadwayServer *server)
 {
-  GHashTableIter iter;
-  gpointer key, value;
-  GList *l;
+  GList *l, *textures;
 
   if (server->output == NULL)
     return;
 
-  /* First upload all textures */
-  g_hash_table_iter_init (&iter, server->textures);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  /* First upload all textures. Patches need their base texture,
+   * which always has a smaller id, so go in order. */
+  textures = g_hash_table_get_values (server->textures);
+  textures = g_list_sort (textures, compare_texture_ids);
+  for (l = textures; l != NULL; l = l->next)
     {
-      BroadwayTexture *texture = value;
+      BroadwayTexture *texture = l->data;
       broadway_output_upload_texture (server->output,
-                                      GPOINTER_TO_INT (key),
+                                      texture->id,
+                                      texture->base_id,
                                       texture->bytes);
     }
+  g_list_free (textures);
 
   /* Then create all surfaces */
   for (l = server->surfaces; l != NULL; l = l->next)
@@ -2191,9 +2428,15 @@ broadway_server_resync_surfaces (BroadwayServer *server)
                                            surface->transient_for);
 
       if (surface->nodes)
-        broadway_output_surface_set_nodes (server->output, surface->id,
-                                           surface->nodes,
-                                           NULL, NULL);
+        {
+          /* The new client has nothing yet */
+          if (surface->sent_nodes)
+            broadway_node_unref (server, surface->sent_nodes);
+          surface->sent_nodes = NULL;
+          g_clear_pointer (&surface->sent_node_lookup, g_hash_table_unref);
+
+          broadway_server_surface_send_nodes (server, surface);
+        }
 
       if (surface->visible)
         broadway_output_show_surface (server->output, surface->id);
@@ -54,6 +54,7 @@ const BROADWAY_EVENT_CONFIGURE_NOTIFY = 11;
 const BROADWAY_EVENT_SCREEN_SIZE_CHANGED = 12;
 const BROADWAY_EVENT_FOCUS = 13;
 const BROADWAY_EVENT_ROUNDTRIP_NOTIFY = 14;
+const BROADWAY_EVENT_FRAME_ACK = 15;
 
 const DISPLAY_OP_REPLACE_CHILD = 0;
 const DISPLAY_OP_APPEND_CHILD = 1;
@@ -89,8 +90,6 @@ const GDK_HYPER_MASK    = 1 << 27;
 const GDK_META_MASK     = 1 << 28;
 
 
-var useDataUrls = window.location.search.includes("datauri");
-
 /* check if we are on Android and using Chrome */
 var isAndroidChrome = false;
 {
@@ -116,60 +115,6 @@ try {
     passiveSupported = false;
 }
 
-/* This base64code is based on https://github.com/beatgammit/base64-js/blob/master/index.js which is MIT licensed */
-
-var b64_lookup = [];
-var base64_code = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
-for (var i = 0, len = base64_code.length; i < len; ++i) {
-    b64_lookup[i] = base64_code[i];
-}
-
-function tripletToBase64 (num) {
-    return b64_lookup[num >> 18 & 0x3F] +
-        b64_lookup[num >> 12 & 0x3F] +
-        b64_lookup[num >> 6 & 0x3F] +
-        b64_lookup[num & 0x3F];
-}
-
-function encodeBase64Chunk (uint8, start, end) {
-    var tmp;
-    var output = [];
-    for (var i = start; i < end; i += 3) {
-        tmp =
-            ((uint8[i] << 16) & 0xFF0000) +
-            ((uint8[i + 1] << 8) & 0xFF00) +
-            (uint8[i + 2] & 0xFF);
-        output.push(tripletToBase64(tmp));
-    }
-    return output.join('');
-}
-
-function bytesToDataUri(uint8) {
-    var tmp;
-    var len = uint8.length;
-    var extraBytes = len % 3; // if we have 1 byte left, pad 2 bytes
-    var parts = [];
-    var maxChunkLength = 16383; // must be multiple of 3
-
-    parts.push("data:image/png;base64,");
-
-    // go through the array every three bytes, we'll deal with trailing stuff later
-    for (var i = 0, len2 = len - extraBytes; i < len2; i += maxChunkLength) {
-        parts.push(encodeBase64Chunk(uint8, i, (i + maxChunkLength) > len2 ? len2 : (i + maxChunkLength)));
-    }
-
-    // pad the end with zeros, but make sure to not forget the extra bytes
-    if (extraBytes === 1) {
-        tmp = uint8[len - 1];
-        parts.push(b64_lookup[tmp >> 2] + b64_lookup[(tmp << 4) & 0x3F] + '==');
-    } else if (extraBytes === 2) {
-        tmp = (uint8[len - 2] << 8) + uint8[len - 1];
-        parts.push(b64_lookup[tmp >> 10] + b64_lookup[(tmp >> 4) & 0x3F] + b64_lookup[(tmp << 2) & 0x3F] + '=');
-    }
-
-    return parts.join('');
-}
-
 /* Helper functions for debugging */
 var logDiv = null;
 function log(str) {
@@ -267,6 +212,7 @@ grab.implicit = false;
 var keyDownList = [];
 var inputList = [];
 var lastSerial = 0;
+var lastAckedSerial = 0;
 var lastX = 0;
 var lastY = 0;
 var lastState;
@@ -299,23 +245,57 @@ function getButtonMask (button) {
     return 0;
 }
 
-function Texture(id, data) {
-    var url;
-    if (useDataUrls) {
-        url = bytesToDataUri(data);
-    } else {
-        var blob = new Blob([data],{type: "image/png"});
-        url = window.URL.createObjectURL(blob);
+function inflate(data) {
+    var stream = new Blob([data]).stream().pipeThrough(new DecompressionStream("deflate"));
+    return new Response(stream).arrayBuffer();
+}
+
+/* Textures are a list of zlib compressed rectangles of RGBA pixels,
+ * drawn on top of the base texture if there is one. */
+async function decodeTexture(texture, base, data) {
+    var view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+    var canvas = document.createElement("canvas");
+    canvas.width = view.getUint32(0, true);
+    canvas.height = view.getUint32(4, true);
+    var n_rects = view.getUint32(8, true);
+    var context = canvas.getContext("2d");
+
+    // Start inflating everything right away
+    var rects = [];
+    var pos = 12;
+    for (var i = 0; i < n_rects; i++) {
+        var size = view.getUint32(pos + 16, true);
+        rects.push({
+            x: view.getUint32(pos, true),
+            y: view.getUint32(pos + 4, true),
+            width: view.getUint32(pos + 8, true),
+            height: view.getUint32(pos + 12, true),
+            pixels: inflate(data.subarray(pos + 20, pos + 20 + size))
+        });
+        pos += 20 + size;
+    }
+
+    if (base) {
+        await base.decoded;
+        context.drawImage(base.bitmap, 0, 0);
+        base.unref();
+    }
+
+    for (var i = 0; i < rects.length; i++) {
+        var r = rects[i];
+        var pixels = new Uint8ClampedArray(await r.pixels);
+        context.putImageData(new ImageData(pixels, r.width, r.height), r.x, r.y);
     }
 
-    this.url = url;
+    // Keep the pixels as they are, without encoding them to an image file
+    texture.bitmap = await createImageBitmap(canvas);
+}
+
+function Texture(id, base, data) {
+    this.bitmap = null;
     this.refcount = 1;
     this.id = id;
-
-    var image = new Image();
-    image.src = this.url;
-    this.image = image;
-    this.decoded = image.decode();
+    this.decoded = decodeTexture(this, base ? base.ref() : null, data);
     textures[id] = this;
 }
 
@@ -327,13 +307,29 @@ Texture.prototype.ref = function() {
 Texture.prototype.unref = function() {
     this.refcount -= 1;
     if (this.refcount == 0) {
-        if (this.url.startsWith("blob")) {
-            window.URL.revokeObjectURL(this.url);
+        if (this.bitmap) {
+            this.bitmap.close();
         }
         delete textures[this.id];
     }
 }
 
+/* Draws the texture into canvas once it is decoded and takes over the
+ * reference to it. */
+Texture.prototype.setOnCanvas = function(canvas) {
+    var texture = this;
+    canvas.pendingTexture = texture;
+    this.decoded.then(() => {
+        if (canvas.pendingTexture === texture) {
+            // Resizing also clears the canvas
+            canvas.width = texture.bitmap.width;
+            canvas.height = texture.bitmap.height;
+            canvas.getContext("2d").drawImage(texture.bitmap, 0, 0);
+        }
+        texture.unref();
+    }, () => texture.unref());
+}
+
 function sendConfigureNotify(surface)
 {
     sendInput(BROADWAY_EVENT_CONFIGURE_NOTIFY, [surface.id, surface.x, surface.y, surface.width, surface.height]);
@@ -617,12 +613,12 @@ TransformNodes.prototype.createDiv = function(id)
     return div;
 }
 
-TransformNodes.prototype.createImage = function(id)
+TransformNodes.prototype.createCanvas = function(id)
 {
-    var image = new Image();
-    image.node_id = id;
-    this.nodes[id] = image;
-    return image;
+    var canvas = document.createElement("canvas");
+    canvas.node_id = id;
+    this.nodes[id] = canvas;
+    return canvas;
 }
 
 TransformNodes.prototype.insertNode = function(parent, previousSibling, is_toplevel)
@@ -646,16 +642,11 @@ TransformNodes.prototype.insertNode = function(parent, previousSibling, is_tople
         {
             var rect = this.decode_rect();
             var texture_id = this.decode_uint32();
-            var image = this.createImage(id);
-            image.width = rect.width;
-            image.height = rect.height;
-            image.style["position"] = "absolute";
-            set_rect_style(image, rect);
-            var texture = textures[texture_id].ref();
-            image.src = texture.url;
-            // Unref blob url when loaded
-            image.onload = function() { texture.unref(); };
-            newNode = image;
+            var canvas = this.createCanvas(id);
+            canvas.style["position"] = "absolute";
+            set_rect_style(canvas, rect);
+            textures[texture_id].ref().setOnCanvas(canvas);
+            newNode = canvas;
         }
         break;
 
@@ -1043,15 +1034,9 @@ function handleDisplayCommands(display_commands)
            delete surfaces[id];
             break;
         case DISPLAY_OP_CHANGE_TEXTURE:
-            var image = cmd[1];
+            var canvas = cmd[1];
             var texture = cmd[2];
-            // We need a new closure here to have a separate copy of "texture" for each iteration in the onload callback...
-            var block = function(t) {
-                image.src = t.url;
-                // Unref blob url when loaded
-                image.onload = function() { t.unref(); };
-            };
-            block(texture);
+            texture.setOnCanvas(canvas);
             break;
         case DISPLAY_OP_CHANGE_TRANSFORM:
             var div = cmd[1];
@@ -1072,6 +1057,7 @@ function handleCommands(cmd, display_commands, new_textures, modified_trees)
     while (res && cmd.pos < cmd.length) {
         var id, x, y, w, h, q, surface;
         var saved_pos = cmd.pos;
+        var saved_serial = lastSerial;
         var command = cmd.get_uint8();
         lastSerial = cmd.get_32();
         switch (command) {
@@ -1182,8 +1168,9 @@ function handleCommands(cmd, display_commands, new_textures, modified_trees)
 
         case BROADWAY_OP_UPLOAD_TEXTURE:
             id = cmd.get_32();
+            var base_id = cmd.get_32();
             var data = cmd.get_data();
-            var texture = new Texture (id, data); // Stores a ref in global textures array
+            var texture = new Texture (id, base_id ? textures[base_id] : null, data); // Stores a ref in global textures array
             new_textures.push(texture);
             break;
 
@@ -1197,6 +1184,7 @@ function handleCommands(cmd, display_commands, new_textures, modified_trees)
             if (id in modified_trees) {
                 // Can't modify the same dom tree in the same loop, bail out and do the first one
                 cmd.pos = saved_pos;
+                lastSerial = saved_serial;
                 res = false;
             } else {
                 modified_trees[id] = true;
@@ -1235,6 +1223,17 @@ function handleCommands(cmd, display_commands, new_textures, modified_trees)
     return res;
 }
 
+/* Tells the server that everything up to lastSerial is on screen,
+ * so it knows how far behind we are. */
+function sendFrameAck()
+{
+    if (lastSerial == lastAckedSerial)
+        return;
+
+    lastAckedSerial = lastSerial;
+    sendInput(BROADWAY_EVENT_FRAME_ACK, []);
+}
+
 function handleOutstandingDisplayCommands()
 {
     if (outstandingDisplayCommands) {
@@ -1242,11 +1241,13 @@ function handleOutstandingDisplayCommands()
             function () {
                 handleDisplayCommands(outstandingDisplayCommands);
                 outstandingDisplayCommands = null;
+                sendFrameAck();
 
                 if (outstandingCommands.length > 0)
                     setTimeout(handleOutstanding);
             });
     } else {
+        sendFrameAck();
         if (outstandingCommands.length > 0)
             handleOutstanding ();
     }
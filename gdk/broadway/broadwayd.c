@@ -329,7 +329,9 @@ client_handle_request (BroadwayClient *client,
           close (fd);
 
           texture = g_bytes_new_take (data, request->upload_texture.size);
-          global_id = broadway_server_upload_texture (server, texture);
+          global_id = broadway_server_upload_texture (server, texture,
+                                                      GPOINTER_TO_INT (g_hash_table_lookup (client->textures,
+                                                                                            GINT_TO_POINTER (request->upload_texture.base_id))));
           g_bytes_unref (texture);
 
           g_hash_table_replace (client->textures,
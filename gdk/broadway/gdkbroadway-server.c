@@ -11,7 +11,9 @@
 #include "gdkprivate-broadway.h"
 #include "gdkprivate.h"
 
+#include <gdk/gdkprofilerprivate.h>
 #include <gdk/gdktextureprivate.h>
+#include <gdk/gdktexturedownloaderprivate.h>
 
 #include <glib.h>
 #include <glib/gprintf.h>
@@ -73,12 +75,18 @@ gdk_broadway_server_finalize (GObject *object)
   G_OBJECT_CLASS (gdk_broadway_server_parent_class)->finalize (object);
 }
 
+static guint profiler_bytes_counter;
+
 static void
 gdk_broadway_server_class_init (GdkBroadwayServerClass * class)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (class);
 
   object_class->finalize = gdk_broadway_server_finalize;
+
+  if (profiler_bytes_counter == 0)
+    profiler_bytes_counter = gdk_profiler_define_int_counter ("broadway texture bytes",
+                                                              "Bytes of texture data sent to broadwayd");
 }
 
 gboolean
@@ -617,9 +625,242 @@ open_shared_memory (void)
   return ret;
 }
 
+/* Textures are sent as a list of rectangles of unpremultiplied
+ * R8G8B8A8 pixels that are compressed with zlib, all numbers are
+ * little endian:
+ *
+ *   guint32 width, height, n_rects
+ *   n_rects times:
+ *     guint32 x, y, width, height, size
+ *     size bytes of compressed data
+ *
+ * When a base texture is given, only the rectangles that differ from
+ * it are included and the client draws them on top of the base.
+ */
+#define TILE_SIZE 64
+
+static int
+get_compression_level (void)
+{
+  static int level = -1;
+
+  if (level < 0)
+    {
+      const char *s = g_getenv ("BROADWAY_COMPRESSION_LEVEL");
+
+      level = s ? CLAMP (atoi (s), 0, 9) : 1;
+    }
+
+  return level;
+}
+
+static GBytes *
+download_rgba (GdkTexture *texture,
+               gsize      *stride)
+{
+  GdkTextureDownloader downloader;
+  GBytes *bytes;
+
+  gdk_texture_downloader_init (&downloader, texture);
+  gdk_texture_downloader_set_format (&downloader, GDK_MEMORY_R8G8B8A8);
+  bytes = gdk_texture_downloader_download_bytes (&downloader, stride);
+  gdk_texture_downloader_finish (&downloader);
+
+  return bytes;
+}
+
+static gboolean
+tile_differs (const guchar                *a,
+              gsize                        a_stride,
+              const guchar                *b,
+              gsize                        b_stride,
+              const cairo_rectangle_int_t *tile)
+{
+  int y;
+
+  for (y = tile->y; y < tile->y + tile->height; y++)
+    {
+      if (memcmp (a + y * a_stride + tile->x * 4,
+                  b + y * b_stride + tile->x * 4,
+                  tile->width * 4) != 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+append_uint32_le (GByteArray *array,
+                  guint32     value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (array, (guint8 *) &value, sizeof (value));
+}
+
+static gboolean
+append_rect (GByteArray                  *array,
+             GConverter                  *compressor,
+             const guchar                *pixels,
+             gsize                        stride,
+             const cairo_rectangle_int_t *rect)
+{
+  gsize row_size = rect->width * 4;
+  GBytes *rows, *compressed;
+  guchar *data;
+  gsize size;
+  int y;
+
+  data = g_malloc (row_size * rect->height);
+  for (y = 0; y < rect->height; y++)
+    memcpy (data + y * row_size, pixels + (rect->y + y) * stride + rect->x * 4, row_size);
+  rows = g_bytes_new_take (data, row_size * rect->height);
+
+  g_converter_reset (compressor);
+  compressed = g_converter_convert_bytes (compressor, rows, NULL);
+  g_bytes_unref (rows);
+  if (compressed == NULL)
+    return FALSE;
+
+  append_uint32_le (array, rect->x);
+  append_uint32_le (array, rect->y);
+  append_uint32_le (array, rect->width);
+  append_uint32_le (array, rect->height);
+  data = (guchar *) g_bytes_get_data (compressed, &size);
+  append_uint32_le (array, size);
+  g_byte_array_append (array, data, size);
+  g_bytes_unref (compressed);
+
+  return TRUE;
+}
+
+static GBytes *
+encode_texture (GdkTexture           *texture,
+                GdkTexture           *base,
+                const cairo_region_t *diff,
+                guint32              *base_id)
+{
+  int width = gdk_texture_get_width (texture);
+  int height = gdk_texture_get_height (texture);
+  int n_cols = (width + TILE_SIZE - 1) / TILE_SIZE;
+  int n_rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+  GBytes *bytes, *base_bytes = NULL;
+  const guchar *pixels, *base_pixels = NULL;
+  gsize stride, base_stride = 0;
+  gboolean *changed;
+  int n_changed, n_rects;
+  GConverter *compressor;
+  GByteArray *array;
+  guint32 n;
+  int col, row, i;
+
+  bytes = download_rgba (texture, &stride);
+  pixels = g_bytes_get_data (bytes, NULL);
+
+  changed = g_new (gboolean, n_cols * n_rows);
+  n_changed = 0;
+
+  if (*base_id != 0 && diff == NULL)
+    {
+      base_bytes = download_rgba (base, &base_stride);
+      base_pixels = g_bytes_get_data (base_bytes, NULL);
+    }
+
+  for (row = 0; row < n_rows; row++)
+    for (col = 0; col < n_cols; col++)
+      {
+        cairo_rectangle_int_t tile = {
+          col * TILE_SIZE,
+          row * TILE_SIZE,
+          MIN (TILE_SIZE, width - col * TILE_SIZE),
+          MIN (TILE_SIZE, height - row * TILE_SIZE)
+        };
+        gboolean tile_changed;
+
+        if (*base_id == 0)
+          tile_changed = TRUE;
+        else if (diff)
+          tile_changed = cairo_region_contains_rectangle (diff, &tile) != CAIRO_REGION_OVERLAP_OUT;
+        else
+          tile_changed = tile_differs (pixels, stride, base_pixels, base_stride, &tile);
+
+        changed[row * n_cols + col] = tile_changed;
+        n_changed += tile_changed;
+      }
+
+  g_clear_pointer (&base_bytes, g_bytes_unref);
+
+  /* Not worth the overhead on the client */
+  if (*base_id != 0 && n_changed > n_cols * n_rows * 3 / 4)
+    {
+      *base_id = 0;
+      for (i = 0; i < n_cols * n_rows; i++)
+        changed[i] = TRUE;
+    }
+
+  array = g_byte_array_new ();
+  append_uint32_le (array, width);
+  append_uint32_le (array, height);
+  append_uint32_le (array, 0);
+
+  compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB,
+                                                   get_compression_level ()));
+  n_rects = 0;
+
+  for (row = 0; row < n_rows; row++)
+    for (col = 0; col < n_cols; col++)
+      {
+        cairo_rectangle_int_t rect;
+        int end;
+
+        if (!changed[row * n_cols + col])
+          continue;
+
+        /* Send runs of changed tiles in one go */
+        for (end = col + 1; end < n_cols && changed[row * n_cols + end]; end++)
+          ;
+
+        rect.x = col * TILE_SIZE;
+        rect.y = row * TILE_SIZE;
+        rect.width = MIN (end * TILE_SIZE, width) - rect.x;
+        rect.height = MIN (TILE_SIZE, height - rect.y);
+
+        if (append_rect (array, compressor, pixels, stride, &rect))
+          n_rects++;
+
+        col = end - 1;
+      }
+
+  n = GUINT32_TO_LE (n_rects);
+  memcpy (array->data + 8, &n, sizeof (n));
+
+  g_object_unref (compressor);
+  g_free (changed);
+  g_bytes_unref (bytes);
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+/*<private>
+ * gdk_broadway_server_upload_texture:
+ * @server: the server
+ * @texture: the texture to upload
+ * @base: (nullable): an uploaded texture of the same size
+ * @diff: (nullable): the area where @texture differs from @base,
+ *   or %NULL to find it by comparing pixels
+ * @base_id: (inout): the id of @base, or 0. Set to 0 if the
+ *   texture was sent in full
+ *
+ * Sends the texture to the server, as a patch on top of @base
+ * if it is given and that saves enough work.
+ *
+ * Returns: the id of the texture
+ */
 guint32
-gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
-                                    GdkTexture        *texture)
+gdk_broadway_server_upload_texture (GdkBroadwayServer    *server,
+                                    GdkTexture           *texture,
+                                    GdkTexture           *base,
+                                    const cairo_region_t *diff,
+                                    guint32              *base_id)
 {
   guint32 id;
   BroadwayRequestUploadTexture msg;
@@ -627,14 +868,18 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
   const guchar *data;
   gsize size;
   int fd;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  g_return_val_if_fail (*base_id == 0 || base != NULL, 0);
 
-  bytes = gdk_texture_save_to_png_bytes (texture);
+  bytes = encode_texture (texture, base, diff, base_id);
   fd = open_shared_memory ();
   data = g_bytes_get_data (bytes, &size);
 
   id = server->next_texture_id++;
 
   msg.id = id;
+  msg.base_id = *base_id;
   msg.offset = 0;
   msg.size = 0;
 
@@ -658,6 +903,16 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
   gdk_broadway_server_send_fd_message (server, msg,
                                        BROADWAY_REQUEST_UPLOAD_TEXTURE, fd);
 
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      gdk_profiler_set_int_counter (profiler_bytes_counter, size);
+      gdk_profiler_end_markf (before, "Upload texture", "%dx%d, %zu bytes%s",
+                              gdk_texture_get_width (texture),
+                              gdk_texture_get_height (texture),
+                              size,
+                              *base_id ? ", patch" : "");
+    }
+
   return id;
 }
 
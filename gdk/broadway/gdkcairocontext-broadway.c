@@ -29,6 +29,10 @@ G_DEFINE_TYPE (GdkBroadwayCairoContext, gdk_broadway_cairo_context, GDK_TYPE_CAI
 static void
 gdk_broadway_cairo_context_dispose (GObject *object)
 {
+  GdkBroadwayCairoContext *self = GDK_BROADWAY_CAIRO_CONTEXT (object);
+
+  g_clear_object (&self->last_texture);
+
   G_OBJECT_CLASS (gdk_broadway_cairo_context_parent_class)->dispose (object);
 }
 
@@ -94,7 +98,9 @@ gdk_broadway_cairo_context_end_frame (GdkDrawContext *draw_context,
 
   texture = gdk_texture_new_for_surface ((cairo_surface_t *)self->paint_surface);
   g_ptr_array_add (node_textures, g_object_ref (texture)); /* Transfers ownership to node_textures */
-  texture_id = gdk_broadway_display_ensure_texture (display, texture);
+  texture_id = gdk_broadway_display_ensure_texture (display, texture, self->last_texture);
+  g_clear_object (&self->last_texture);
+  self->last_texture = texture; /* takes the reference from creating it */
 
   add_uint32 (nodes, BROADWAY_NODE_TEXTURE);
   add_float (nodes, 0);
@@ -39,6 +39,7 @@ struct _GdkBroadwayCairoContext
   GdkCairoContext parent_instance;
 
   cairo_surface_t *paint_surface;
+  GdkTexture *last_texture; /* so the next frame can be sent as a patch */
 };
 
 struct _GdkBroadwayCairoContextClass
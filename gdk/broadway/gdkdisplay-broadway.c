@@ -402,8 +402,14 @@ gdk_broadway_display_get_setting (GdkDisplay *display,
   return FALSE;
 }
 
+/* Patches keep their base alive in the server and in the browser,
+ * so limit how long chains of them can get.
+ */
+#define MAX_PATCH_DEPTH 16
+
 typedef struct {
   int id;
+  guint depth; /* number of patches on top of a full upload */
   GdkDisplay *display;
   GList *textures;
 } BroadwayTextureData;
@@ -418,25 +424,88 @@ broadway_texture_data_free (BroadwayTextureData *data)
   g_free (data);
 }
 
+static BroadwayTextureData *
+get_patchable_data (GdkTexture *texture)
+{
+  BroadwayTextureData *data;
+
+  data = g_object_get_data (G_OBJECT (texture), "broadway-data");
+  if (data == NULL || data->depth >= MAX_PATCH_DEPTH)
+    return NULL;
+
+  return data;
+}
+
+static gboolean
+find_uploaded_ancestor (GdkTexture *ancestor,
+                        gpointer    user_data)
+{
+  GdkTexture **result = user_data;
+
+  if (get_patchable_data (ancestor) == NULL)
+    return FALSE;
+
+  *result = g_object_ref (ancestor);
+  return TRUE;
+}
+
+/*<private>
+ * gdk_broadway_display_ensure_texture:
+ * @display: the display
+ * @texture: the texture
+ * @previous: (nullable): a texture that was shown in the same place
+ *   last frame
+ *
+ * Makes sure @texture is uploaded and returns its id.
+ *
+ * If the texture is an update of an uploaded texture, or @previous
+ * has the same size, only the changed tiles are sent.
+ *
+ * Returns: the id of the texture
+ */
 guint32
 gdk_broadway_display_ensure_texture (GdkDisplay *display,
-                                     GdkTexture *texture)
+                                     GdkTexture *texture,
+                                     GdkTexture *previous)
 {
   GdkBroadwayDisplay *broadway_display = GDK_BROADWAY_DISPLAY (display);
-  BroadwayTextureData *data;
+  BroadwayTextureData *data, *base_data;
+  GdkTexture *base = NULL;
+  cairo_region_t *diff;
+  guint32 id, base_id;
 
   data = g_object_get_data (G_OBJECT (texture), "broadway-data");
-  if (data == NULL)
-    {
-      guint32 id = gdk_broadway_server_upload_texture (broadway_display->server, texture);
+  if (data != NULL)
+    return data->id;
 
-      data = g_new0 (BroadwayTextureData, 1);
-      data->id = id;
-      data->display = g_object_ref (display);
-     g_object_set_data_full (G_OBJECT (texture), "broadway-data", data, (GDestroyNotify)broadway_texture_data_free);
+  diff = cairo_region_create ();
+  if (!gdk_texture_find_ancestor (texture, find_uploaded_ancestor, &base, diff))
+    {
+      g_clear_pointer (&diff, cairo_region_destroy);
+
+      if (previous != NULL &&
+          previous != texture &&
+          gdk_texture_get_width (previous) == gdk_texture_get_width (texture) &&
+          gdk_texture_get_height (previous) == gdk_texture_get_height (texture) &&
+          get_patchable_data (previous) != NULL)
+        base = g_object_ref (previous);
     }
 
-  return data->id;
+  base_data = base ? g_object_get_data (G_OBJECT (base), "broadway-data") : NULL;
+  base_id = base_data ? base_data->id : 0;
+
+  id = gdk_broadway_server_upload_texture (broadway_display->server, texture, base, diff, &base_id);
+
+  data = g_new0 (BroadwayTextureData, 1);
+  data->id = id;
+  data->depth = base_id ? base_data->depth + 1 : 0;
+  data->display = g_object_ref (display);
+  g_object_set_data_full (G_OBJECT (texture), "broadway-data", data, (GDestroyNotify)broadway_texture_data_free);
+
+  g_clear_pointer (&diff, cairo_region_destroy);
+  g_clear_object (&base);
+
+  return id;
 }
 
 static gboolean
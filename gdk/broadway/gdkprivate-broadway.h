@@ -37,7 +37,8 @@
 #include "gdkbroadwaysurface.h"
 
 guint32 gdk_broadway_display_ensure_texture (GdkDisplay *display,
-                                             GdkTexture *texture);
+                                             GdkTexture *texture,
+                                             GdkTexture *previous);
 
 void gdk_broadway_display_flush_in_idle (GdkDisplay *display);
 
@@ -32,6 +32,7 @@
 #include "gdkdebugprivate.h"
 #include "gdkdisplayprivate.h"
 #include "gdkglcontextprivate.h"
+#include "gdkprofilerprivate.h"
 #include <glib/gi18n-lib.h>
 #include "gdkprivate.h"
 #include <glib/gprintf.h>
@@ -348,6 +349,8 @@ gdk_pre_parse (void)
 
   gdk_features = GDK_ALL_FEATURES & ~disabled_features;
 
+  gdk_profiler_init ();
+
 #ifndef G_HAS_CONSTRUCTORS
   stash_and_unset_environment ();
 #endif
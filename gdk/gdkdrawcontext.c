@@ -480,7 +480,6 @@ gdk_draw_context_begin_frame_full (GdkDrawContext        *context,
                                     });
 }
 
-#ifdef HAVE_SYSPROF
 static gint64
 region_get_pixels (cairo_region_t *region)
 {
@@ -497,7 +496,6 @@ region_get_pixels (cairo_region_t *region)
 
   return pixels;
 }
-#endif
 
 void
 gdk_draw_context_end_frame_full (GdkDrawContext *context,
@@ -507,7 +505,8 @@ gdk_draw_context_end_frame_full (GdkDrawContext *context,
 
   GDK_DRAW_CONTEXT_GET_CLASS (context)->end_frame (context, context_data, priv->render_region);
 
-  gdk_profiler_set_int_counter (pixels_counter, region_get_pixels (priv->render_region));
+  if (GDK_PROFILER_IS_RUNNING)
+    gdk_profiler_set_int_counter (pixels_counter, region_get_pixels (priv->render_region));
 
   priv->color_state = NULL;
   g_clear_pointer (&priv->render_region, cairo_region_destroy);
@@ -25,6 +25,7 @@
 #include "gdkglcontextprivate.h"
 #include "gdkmemoryformatprivate.h"
 #include "gdkmemorytextureprivate.h"
+#include "gdkprivate.h"
 
 #include <epoxy/gl.h>
 
@@ -92,13 +93,10 @@ typedef struct _InvokeData
   gpointer data;
 } InvokeData;
 
-static gboolean
-gdk_gl_texture_invoke_callback (gpointer data)
+static GdkGLContext *
+gdk_gl_texture_push_context (GdkGLContext *context)
 {
-  InvokeData *invoke = data;
-  GdkGLContext *context, *previous;
-
-  context = gdk_display_get_gl_context (gdk_gl_context_get_display (invoke->self->context));
+  GdkGLContext *previous;
 
   previous = gdk_gl_context_get_current ();
 
@@ -107,15 +105,12 @@ gdk_gl_texture_invoke_callback (gpointer data)
 
   gdk_gl_context_make_current (context);
 
-  if (invoke->self->sync && context != invoke->self->context)
-    glWaitSync (invoke->self->sync, 0, GL_TIMEOUT_IGNORED);
-
-  glBindTexture (GL_TEXTURE_2D, invoke->self->id);
-
-  invoke->func (invoke->self, context, invoke->data);
-
-  g_atomic_int_set (&invoke->spinlock, 1);
+  return previous;
+}
 
+static void
+gdk_gl_texture_pop_context (GdkGLContext *previous)
+{
   if (previous)
     {
       gdk_gl_context_make_current (previous);
@@ -125,6 +120,28 @@ gdk_gl_texture_invoke_callback (gpointer data)
     {
       gdk_gl_context_clear_current ();
     }
+}
+
+static gboolean
+gdk_gl_texture_invoke_callback (gpointer data)
+{
+  InvokeData *invoke = data;
+  GdkGLContext *context, *previous;
+
+  context = gdk_display_get_gl_context (gdk_gl_context_get_display (invoke->self->context));
+
+  previous = gdk_gl_texture_push_context (context);
+
+  if (invoke->self->sync && context != invoke->self->context)
+    glWaitSync (invoke->self->sync, 0, GL_TIMEOUT_IGNORED);
+
+  glBindTexture (GL_TEXTURE_2D, invoke->self->id);
+
+  invoke->func (invoke->self, context, invoke->data);
+
+  g_atomic_int_set (&invoke->spinlock, 1);
+
+  gdk_gl_texture_pop_context (previous);
 
   return FALSE;
 }
@@ -189,6 +206,306 @@ gdk_gl_texture_download (GdkTexture            *texture,
   gdk_gl_texture_run (self, gdk_gl_texture_do_download, &download);
 }
 
+/* How often to check if the GPU is done with a readback */
+#define READBACK_POLL_INTERVAL_MS 2
+
+typedef struct _Readback Readback;
+
+struct _Readback
+{
+  GdkGLContext *context;
+  GLuint buffer_id;
+  GLsync sync;
+  gboolean mapped;
+  GdkMemoryLayout layout;
+};
+
+static void
+readback_free (Readback *readback)
+{
+  GdkGLContext *previous;
+
+  previous = gdk_gl_texture_push_context (readback->context);
+
+  if (readback->sync)
+    glDeleteSync (readback->sync);
+
+  if (readback->mapped)
+    {
+      glBindBuffer (GL_PIXEL_PACK_BUFFER, readback->buffer_id);
+      glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+      glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+  glDeleteBuffers (1, &readback->buffer_id);
+
+  gdk_gl_texture_pop_context (previous);
+
+  g_object_unref (readback->context);
+  g_free (readback);
+}
+
+/* Runs @func on the thread that runs the default main context.
+ *
+ * g_main_context_invoke() isn't good enough, it runs @func right
+ * away on any thread that can acquire the context, which includes
+ * other threads while the main thread isn't iterating.
+ */
+static void
+gdk_gl_texture_invoke_on_main (GSourceFunc func,
+                               gpointer    data)
+{
+  guint id;
+
+  if (g_main_context_is_owner (NULL))
+    {
+      func (data);
+      return;
+    }
+
+  id = g_idle_add (func, data);
+  gdk_source_set_static_name_by_id (id, "[gdk] GL texture readback");
+}
+
+static gboolean
+readback_free_cb (gpointer data)
+{
+  readback_free (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+readback_release (gpointer data)
+{
+  /* The bytes can be released in any thread, but the
+   * buffer must be unmapped on the main thread */
+  gdk_gl_texture_invoke_on_main (readback_free_cb, data);
+}
+
+static gboolean
+gdk_gl_texture_poll_readback (gpointer data)
+{
+  GTask *task = data;
+  Readback *readback = g_task_get_task_data (task);
+  GdkTexture *texture = g_task_get_source_object (task);
+  GdkGLContext *previous;
+  GdkTexture *result;
+  GBytes *bytes;
+  gpointer mapped;
+  GLenum status;
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      readback_free (readback);
+      g_object_unref (task);
+      return G_SOURCE_REMOVE;
+    }
+
+  previous = gdk_gl_texture_push_context (readback->context);
+
+  status = glClientWaitSync (readback->sync, 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED)
+    {
+      gdk_gl_texture_pop_context (previous);
+      return G_SOURCE_CONTINUE;
+    }
+
+  glDeleteSync (readback->sync);
+  readback->sync = NULL;
+
+  if (status == GL_WAIT_FAILED)
+    mapped = NULL;
+  else
+    {
+      glBindBuffer (GL_PIXEL_PACK_BUFFER, readback->buffer_id);
+      mapped = glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, readback->layout.size, GL_MAP_READ_BIT);
+      glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+  gdk_gl_texture_pop_context (previous);
+
+  if (mapped == NULL)
+    {
+      readback_free (readback);
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                               "Failed to read back texture");
+      g_object_unref (task);
+      return G_SOURCE_REMOVE;
+    }
+
+  readback->mapped = TRUE;
+
+  /* The buffer stays mapped until the bytes are released */
+  bytes = g_bytes_new_with_free_func (mapped,
+                                      readback->layout.size,
+                                      readback_release,
+                                      readback);
+  result = gdk_memory_texture_new_from_layout (bytes,
+                                               &readback->layout,
+                                               gdk_texture_get_color_state (texture),
+                                               NULL, NULL);
+  g_bytes_unref (bytes);
+
+  g_task_return_pointer (task, result, g_object_unref);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static GThread *last_readback_thread;
+
+/*<private>
+ * gdk_gl_texture_get_last_readback_thread:
+ *
+ * Returns the thread that the last readback was started on,
+ * for the testsuite.
+ *
+ * Returns: (transfer none) (nullable): the thread
+ */
+GThread *
+gdk_gl_texture_get_last_readback_thread (void)
+{
+  return last_readback_thread;
+}
+
+static gboolean
+gdk_gl_texture_start_readback (gpointer data)
+{
+  GTask *task = data;
+  GdkGLTexture *self = g_task_get_source_object (task);
+  GdkTexture *texture = GDK_TEXTURE (self);
+  GdkGLContext *context, *previous;
+  GLint gl_internal_format, gl_internal_srgb_format;
+  GLenum gl_format, gl_type;
+  GdkSwizzle gl_swizzle;
+  Readback *readback;
+
+  last_readback_thread = g_thread_self ();
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return G_SOURCE_REMOVE;
+    }
+
+  if (self->saved)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               "Texture can't be read back asynchronously");
+      g_object_unref (task);
+      return G_SOURCE_REMOVE;
+    }
+
+  context = gdk_display_get_gl_context (gdk_gl_context_get_display (self->context));
+  previous = gdk_gl_texture_push_context (context);
+
+  /* Pixel buffers and fences need GL 3.2, and GLES can't read
+   * textures without fixing up the data afterwards */
+  if (!gdk_gl_context_check_version (context, "3.2", NULL) ||
+      (gdk_gl_context_get_format_flags (context, texture->format) & GDK_GL_FORMAT_USABLE) != GDK_GL_FORMAT_USABLE ||
+      !gdk_memory_format_gl_format (texture->format,
+                                    0,
+                                    FALSE,
+                                    &gl_internal_format, &gl_internal_srgb_format,
+                                    &gl_format, &gl_type, &gl_swizzle))
+    {
+      gdk_gl_texture_pop_context (previous);
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               "Texture can't be read back asynchronously");
+      g_object_unref (task);
+      return G_SOURCE_REMOVE;
+    }
+
+  if (self->sync && context != self->context)
+    glWaitSync (self->sync, 0, GL_TIMEOUT_IGNORED);
+
+  readback = g_new0 (Readback, 1);
+  readback->context = g_object_ref (context);
+  gdk_memory_layout_init (&readback->layout,
+                          texture->format,
+                          texture->width,
+                          texture->height,
+                          1);
+
+  glGenBuffers (1, &readback->buffer_id);
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, readback->buffer_id);
+  glBufferData (GL_PIXEL_PACK_BUFFER, readback->layout.size, NULL, GL_STREAM_READ);
+
+  /* With a pack buffer bound, this just queues the copy */
+  glPixelStorei (GL_PACK_ALIGNMENT, 1);
+  glBindTexture (GL_TEXTURE_2D, self->id);
+  glGetTexImage (GL_TEXTURE_2D, 0, gl_format, gl_type, NULL);
+
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+
+  readback->sync = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush ();
+
+  gdk_gl_texture_pop_context (previous);
+
+  g_task_set_task_data (task, readback, NULL);
+  g_timeout_add (READBACK_POLL_INTERVAL_MS, gdk_gl_texture_poll_readback, task);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*<private>
+ * gdk_gl_texture_download_async:
+ * @self: a `GdkGLTexture`
+ * @cancellable: (nullable): a `GCancellable`
+ * @callback: callback to call when the download is done
+ * @user_data: data for @callback
+ *
+ * Starts copying the texture into a pixel buffer without waiting for
+ * the GPU. When the copy is done, the buffer is made available as a
+ * memory texture in the format and color state of @self.
+ *
+ * The GL calls are made on the main thread, the one running the
+ * default main context, so this can be called from any thread. If it
+ * isn't called from the main loop, they are made when the main loop
+ * gets to run next.
+ *
+ * This is only supported with desktop GL 3.2 or later. If it isn't,
+ * the download fails with %G_IO_ERROR_NOT_SUPPORTED and callers should
+ * fall back to [method@Gdk.Texture.download].
+ */
+void
+gdk_gl_texture_download_async (GdkGLTexture        *self,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             user_data)
+{
+  GTask *task;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_gl_texture_download_async);
+
+  gdk_gl_texture_invoke_on_main (gdk_gl_texture_start_readback, task);
+}
+
+/*<private>
+ * gdk_gl_texture_download_finish:
+ * @self: a `GdkGLTexture`
+ * @result: the `GAsyncResult`
+ * @error: return location for an error
+ *
+ * Finishes a download started with gdk_gl_texture_download_async().
+ *
+ * Returns: (transfer full) (nullable): a memory texture with
+ *   the contents of @self
+ */
+GdkTexture *
+gdk_gl_texture_download_finish (GdkGLTexture  *self,
+                                GAsyncResult  *result,
+                                GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_gl_texture_download_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 static void
 gdk_gl_texture_class_init (GdkGLTextureClass *klass)
 {
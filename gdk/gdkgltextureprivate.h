@@ -17,5 +17,15 @@ guint                   gdk_gl_texture_get_id           (GdkGLTexture
 gboolean                gdk_gl_texture_has_mipmap       (GdkGLTexture           *self);
 gpointer                gdk_gl_texture_get_sync         (GdkGLTexture           *self);
 
+void                    gdk_gl_texture_download_async   (GdkGLTexture           *self,
+                                                         GCancellable           *cancellable,
+                                                         GAsyncReadyCallback     callback,
+                                                         gpointer                user_data);
+GdkTexture *            gdk_gl_texture_download_finish  (GdkGLTexture           *self,
+                                                         GAsyncResult           *result,
+                                                         GError                **error);
+
+GThread *               gdk_gl_texture_get_last_readback_thread (void);
+
 G_END_DECLS
 
@@ -29,6 +29,9 @@
 
 #include "gsk/gl/fp16private.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /* Don't report quick (< 0.5 msec) runs */
 #define MIN_MARK_DURATION 500000
@@ -131,6 +134,25 @@ name ## _to_float (float                (*dest)[4], \
 } \
 \
 static void \
+name ## _yuv_unpack (float                 *y_row, \
+                     float                 *cb_row, \
+                     float                 *cr_row, \
+                     const guchar          *src_data, \
+                     const GdkMemoryLayout *src_layout, \
+                     gsize                  y) \
+{ \
+  const T *y_data = (const T *) (src_data + gdk_memory_layout_offset (src_layout, 0, 0, y)); \
+  const T *uv_data = (const T *) (src_data + gdk_memory_layout_offset (src_layout, 1, 0, y - y % y_subsample)); \
+  for (gsize x = 0; x < src_layout->width; x++) \
+    y_row[x] = (float) (y_data[x] >> shift) * (1.f / scale); \
+  for (gsize x = 0; x < src_layout->width; x++) \
+    { \
+      cb_row[x] = (float) (uv_data[x / x_subsample * 2 + (uv_swapped ? 1 : 0)] >> shift) * (1.f / scale); \
+      cr_row[x] = (float) (uv_data[x / x_subsample * 2 + (uv_swapped ? 0 : 1)] >> shift) * (1.f / scale); \
+    } \
+} \
+\
+static void \
 name ## _from_float (guchar                *dest_data, \
                      const GdkMemoryLayout *dest_layout, \
                      const float          (*src)[4], \
@@ -249,6 +271,26 @@ name ## _to_float (float                (*dest)[4], \
 } \
 \
 static void \
+name ## _yuv_unpack (float                 *y_row, \
+                     float                 *cb_row, \
+                     float                 *cr_row, \
+                     const guchar          *src_data, \
+                     const GdkMemoryLayout *src_layout, \
+                     gsize                  y) \
+{ \
+  const guchar *y_data = (const guchar *) (src_data + gdk_memory_layout_offset (src_layout, 0, 0, y)); \
+  const guchar *u_data = (const guchar *) (src_data + gdk_memory_layout_offset (src_layout, uv_swapped ? 2 : 1, 0, y - y % y_subsample)); \
+  const guchar *v_data = (const guchar *) (src_data + gdk_memory_layout_offset (src_layout, uv_swapped ? 1 : 2, 0, y - y % y_subsample)); \
+  for (gsize x = 0; x < src_layout->width; x++) \
+    y_row[x] = (float) y_data[x] * (1.f / 255.f); \
+  for (gsize x = 0; x < src_layout->width; x++) \
+    { \
+      cb_row[x] = (float) u_data[x / x_subsample] * (1.f / 255.f); \
+      cr_row[x] = (float) v_data[x / x_subsample] * (1.f / 255.f); \
+    } \
+} \
+\
+static void \
 name ## _from_float (guchar                *dest_data, \
                      const GdkMemoryLayout *dest_layout, \
                      const float          (*src)[4], \
@@ -815,6 +857,286 @@ MIPMAP_FUNC(float, half_float, 4)
 #undef FROM
 #undef TO
 
+/* Straight alpha needs to be weighted by alpha, or fully transparent
+ * pixels would bleed their color into the result. Blocks that are
+ * fully transparent fall back to averaging the color. */
+#define STRAIGHT_MIPMAP_FUNC(SumType, DataType, n_units, A) \
+static void \
+gdk_mipmap_ ## DataType ## _ ## n_units ## _alpha ## A ## _linear (guchar                *dest, \
+                                                                   const guchar          *src, \
+                                                                   const GdkMemoryLayout *src_layout,\
+                                                                   gsize                  y_start,\
+                                                                   guint                  lod_level) \
+{ \
+  gsize y, x_dest, x, i; \
+  gsize n = 1 << lod_level; \
+  DataType *dest_data = (DataType *) dest; \
+\
+  for (x_dest = 0; x_dest < src_layout->width; x_dest += n) \
+    { \
+      SumType color[n_units] = { 0, }; \
+      SumType weighted[n_units] = { 0, }; \
+      SumType alpha = 0; \
+\
+      x = 0; /* silence MSVC */\
+\
+      for (y = 0; y < MIN (n, src_layout->height - y_start); y++) \
+        { \
+          const DataType *src_data = (const DataType *) (src + gdk_memory_layout_offset (src_layout, 0, 0, y + y_start)); \
+          for (x = 0; x < MIN (n, src_layout->width - x_dest); x++) \
+            { \
+              const DataType *pixel = &src_data[n_units * (x_dest + x)]; \
+              SumType a = FROM (pixel[A]); \
+\
+              for (i = 0; i < n_units; i++) \
+                { \
+                  color[i] += FROM (pixel[i]); \
+                  weighted[i] += FROM (pixel[i]) * a; \
+                } \
+              alpha += a; \
+            } \
+        } \
+\
+      for (i = 0; i < n_units; i++) \
+        { \
+          if (i == A) \
+            *dest_data++ = TO (alpha / (x * y)); \
+          else if (alpha > 0) \
+            *dest_data++ = TO (weighted[i] / alpha); \
+          else \
+            *dest_data++ = TO (color[i] / (x * y)); \
+        } \
+    } \
+}
+
+#define FROM(x) (x)
+#define TO(x) (x)
+STRAIGHT_MIPMAP_FUNC(guint64, guint8, 2, 1)
+STRAIGHT_MIPMAP_FUNC(guint64, guint8, 4, 0)
+STRAIGHT_MIPMAP_FUNC(guint64, guint8, 4, 3)
+STRAIGHT_MIPMAP_FUNC(guint64, guint16, 2, 1)
+STRAIGHT_MIPMAP_FUNC(guint64, guint16, 4, 3)
+STRAIGHT_MIPMAP_FUNC(float, float, 4, 3)
+#undef FROM
+#undef TO
+#define half_float guint16
+#define FROM half_to_float_one
+#define TO float_to_half_one
+STRAIGHT_MIPMAP_FUNC(float, half_float, 4, 3)
+#undef half_float
+#undef FROM
+#undef TO
+
+/* The box filters below are separable: They first sum up the rows
+ * of a block and then the columns of those sums. That way, every
+ * pixel only needs to be touched once and the row sums can be done
+ * for many values at once.
+ *
+ * Rows are processed in chunks, so the sums fit on the stack.
+ * The chunk size must be a multiple of the block size, which limits
+ * the lod level. It also ensures 16bit sums of 8bit values can't
+ * overflow.
+ */
+#define BOX_MAX_LOD 8
+#define BOX_CHUNK_PIXELS (1 << BOX_MAX_LOD)
+
+static inline void
+box_add_row_guint8 (guint16      *sums,
+                    const guchar *row,
+                    gsize         n_values,
+                    gboolean      first)
+{
+  gsize i = 0;
+
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128 ();
+
+  for (; i + 16 <= n_values; i += 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (row + i));
+      __m128i lo = _mm_unpacklo_epi8 (v, zero);
+      __m128i hi = _mm_unpackhi_epi8 (v, zero);
+
+      if (!first)
+        {
+          lo = _mm_add_epi16 (lo, _mm_loadu_si128 ((const __m128i *) (sums + i)));
+          hi = _mm_add_epi16 (hi, _mm_loadu_si128 ((const __m128i *) (sums + i + 8)));
+        }
+
+      _mm_storeu_si128 ((__m128i *) (sums + i), lo);
+      _mm_storeu_si128 ((__m128i *) (sums + i + 8), hi);
+    }
+#endif
+
+  if (first)
+    {
+      for (; i < n_values; i++)
+        sums[i] = row[i];
+    }
+  else
+    {
+      for (; i < n_values; i++)
+        sums[i] += row[i];
+    }
+}
+
+static inline void
+box_sum_columns_guint8 (guchar        *dest,
+                        const guint16 *sums,
+                        gsize          width,
+                        gsize          n,
+                        gsize          n_rows,
+                        gsize          n_units)
+{
+  gsize x = 0, i, u;
+
+#ifdef __SSE2__
+  if (n == 2 && n_units == 4)
+    {
+      /* 2x2 with 4 channels is the most common case, so we
+       * do 4 result pixels at a time */
+      __m128i shift = _mm_cvtsi32_si128 (n_rows == 2 ? 2 : 1);
+
+      for (; x + 8 <= width; x += 8)
+        {
+          __m128i s0 = _mm_loadu_si128 ((const __m128i *) (sums + 4 * x));
+          __m128i s1 = _mm_loadu_si128 ((const __m128i *) (sums + 4 * x + 8));
+          __m128i s2 = _mm_loadu_si128 ((const __m128i *) (sums + 4 * x + 16));
+          __m128i s3 = _mm_loadu_si128 ((const __m128i *) (sums + 4 * x + 24));
+          __m128i t0 = _mm_add_epi16 (_mm_unpacklo_epi64 (s0, s1), _mm_unpackhi_epi64 (s0, s1));
+          __m128i t1 = _mm_add_epi16 (_mm_unpacklo_epi64 (s2, s3), _mm_unpackhi_epi64 (s2, s3));
+
+          t0 = _mm_srl_epi16 (t0, shift);
+          t1 = _mm_srl_epi16 (t1, shift);
+          _mm_storeu_si128 ((__m128i *) dest, _mm_packus_epi16 (t0, t1));
+          dest += 16;
+        }
+    }
+#endif
+
+  for (; x < width; x += n)
+    {
+      gsize n_columns = MIN (n, width - x);
+
+      for (u = 0; u < n_units; u++)
+        {
+          guint32 sum = 0;
+
+          for (i = 0; i < n_columns; i++)
+            sum += sums[(x + i) * n_units + u];
+
+          *dest++ = sum / (n_columns * n_rows);
+        }
+    }
+}
+
+static void
+gdk_mipmap_guint8_box (guchar                *dest,
+                       const guchar          *src,
+                       const GdkMemoryLayout *src_layout,
+                       gsize                  y_start,
+                       guint                  lod_level,
+                       gsize                  n_units)
+{
+  guint16 sums[4 * BOX_CHUNK_PIXELS];
+  gsize n = 1 << lod_level;
+  gsize n_rows = MIN (n, src_layout->height - y_start);
+  gsize x, y, width;
+
+  g_assert (lod_level <= BOX_MAX_LOD);
+
+  for (x = 0; x < src_layout->width; x += BOX_CHUNK_PIXELS)
+    {
+      width = MIN (BOX_CHUNK_PIXELS, src_layout->width - x);
+
+      for (y = 0; y < n_rows; y++)
+        {
+          const guchar *row = src + gdk_memory_layout_offset (src_layout, 0, 0, y_start + y);
+
+          box_add_row_guint8 (sums, row + x * n_units, width * n_units, y == 0);
+        }
+
+      box_sum_columns_guint8 (dest + (x >> lod_level) * n_units, sums, width, n, n_rows, n_units);
+    }
+}
+
+static void
+gdk_mipmap_half_float_box (guchar                *dest,
+                           const guchar          *src,
+                           const GdkMemoryLayout *src_layout,
+                           gsize                  y_start,
+                           guint                  lod_level,
+                           gsize                  n_units)
+{
+  float sums[4 * BOX_CHUNK_PIXELS];
+  float values[4 * BOX_CHUNK_PIXELS];
+  gsize n = 1 << lod_level;
+  gsize n_rows = MIN (n, src_layout->height - y_start);
+  gsize x, y, i, u, width, n_values, n_dest;
+
+  g_assert (lod_level <= BOX_MAX_LOD);
+
+  for (x = 0; x < src_layout->width; x += BOX_CHUNK_PIXELS)
+    {
+      width = MIN (BOX_CHUNK_PIXELS, src_layout->width - x);
+      n_values = width * n_units;
+
+      for (y = 0; y < n_rows; y++)
+        {
+          const guint16 *row = (const guint16 *) (src + gdk_memory_layout_offset (src_layout, 0, 0, y_start + y));
+
+          /* half_to_float() uses F16C when available */
+          half_to_float (row + x * n_units, y == 0 ? sums : values, n_values);
+          if (y > 0)
+            {
+              for (i = 0; i < n_values; i++)
+                sums[i] += values[i];
+            }
+        }
+
+      n_dest = 0;
+      for (i = 0; i < width; i += n)
+        {
+          gsize n_columns = MIN (n, width - i);
+
+          for (u = 0; u < n_units; u++)
+            {
+              float sum = 0;
+              gsize j;
+
+              for (j = 0; j < n_columns; j++)
+                sum += sums[(i + j) * n_units + u];
+
+              values[n_dest++] = sum / (n_columns * n_rows);
+            }
+        }
+
+      float_to_half (values, (guint16 *) dest + (x >> lod_level) * n_units, n_dest);
+    }
+}
+
+#define BOX_FUNC(DataType, n_units) \
+static void \
+gdk_mipmap_ ## DataType ## _ ## n_units ## _box_linear (guchar                *dest, \
+                                                        const guchar          *src, \
+                                                        const GdkMemoryLayout *src_layout,\
+                                                        gsize                  y_start,\
+                                                        guint                  lod_level) \
+{ \
+  if (lod_level > BOX_MAX_LOD) \
+    gdk_mipmap_ ## DataType ## _ ## n_units ## _linear (dest, src, src_layout, y_start, lod_level); \
+  else \
+    gdk_mipmap_ ## DataType ## _box (dest, src, src_layout, y_start, lod_level, n_units); \
+}
+
+BOX_FUNC(guint8, 1)
+BOX_FUNC(guint8, 2)
+BOX_FUNC(guint8, 3)
+BOX_FUNC(guint8, 4)
+BOX_FUNC(half_float, 1)
+BOX_FUNC(half_float, 3)
+BOX_FUNC(half_float, 4)
+
 struct _GdkMemoryFormatDescription
 {
   const char *name;
@@ -871,6 +1193,8 @@ struct _GdkMemoryFormatDescription
   /* no premultiplication going on here */
   void (* to_float) (float (*)[4], const guchar *, const GdkMemoryLayout *, gsize);
   void (* from_float) (guchar *, const GdkMemoryLayout *, const float (*)[4], gsize);
+  /* for planar YCbCr formats: split a row into normalized Y, Cb and Cr rows */
+  void (* yuv_unpack) (float *, float *, float *, const guchar *, const GdkMemoryLayout *, gsize);
   GdkMemoryFormat mipmap_format; /* must be single plane continuous format with 1x1 block size */
   void (* mipmap_nearest) (guchar *, const guchar *, const GdkMemoryLayout *, gsize, guint);
   void (* mipmap_linear) (guchar *, const guchar *, const GdkMemoryLayout *, gsize, guint);
@@ -941,7 +1265,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = b8g8r8a8_premultiplied_from_float,
     .mipmap_format = GDK_MEMORY_B8G8R8A8_PREMULTIPLIED,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_A8R8G8B8_PREMULTIPLIED] = {
     .name = "ARGB8p",
@@ -999,7 +1323,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = a8r8g8b8_premultiplied_from_float,
     .mipmap_format = GDK_MEMORY_A8R8G8B8_PREMULTIPLIED,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_R8G8B8A8_PREMULTIPLIED] = {
     .name = "RGBA8p",
@@ -1056,7 +1380,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r8g8b8a8_premultiplied_from_float,
     .mipmap_format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_A8B8G8R8_PREMULTIPLIED] = {
     .name = "ABGR8p",
@@ -1114,7 +1438,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = a8b8g8r8_premultiplied_from_float,
     .mipmap_format = GDK_MEMORY_A8B8G8R8_PREMULTIPLIED,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_B8G8R8A8] = {
     .name = "BGRA8",
@@ -1172,7 +1496,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = b8g8r8a8_from_float,
     .mipmap_format = GDK_MEMORY_B8G8R8A8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_alpha3_linear,
   },
   [GDK_MEMORY_A8R8G8B8] = {
     .name = "ARGB8",
@@ -1230,7 +1554,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = a8r8g8b8_from_float,
     .mipmap_format = GDK_MEMORY_A8R8G8B8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_alpha0_linear,
   },
   [GDK_MEMORY_R8G8B8A8] = {
     .name = "RGBA8",
@@ -1287,7 +1611,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r8g8b8a8_from_float,
     .mipmap_format = GDK_MEMORY_R8G8B8A8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_alpha3_linear,
   },
   [GDK_MEMORY_A8B8G8R8] = {
     .name = "ABGR8",
@@ -1345,7 +1669,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = a8b8g8r8_from_float,
     .mipmap_format = GDK_MEMORY_A8B8G8R8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_alpha0_linear,
   },
   [GDK_MEMORY_B8G8R8X8] = {
     .name = "BGRX8",
@@ -1403,7 +1727,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = b8g8r8x8_from_float,
     .mipmap_format = GDK_MEMORY_B8G8R8X8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_X8R8G8B8] = {
     .name = "XRGB8",
@@ -1462,7 +1786,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = x8r8g8b8_from_float,
     .mipmap_format = GDK_MEMORY_X8R8G8B8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_R8G8B8X8] = {
     .name = "RGBX8",
@@ -1520,7 +1844,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r8g8b8x8_from_float,
     .mipmap_format = GDK_MEMORY_R8G8B8X8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_X8B8G8R8] = {
     .name = "XBGR8",
@@ -1579,7 +1903,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = x8b8g8r8_from_float,
     .mipmap_format = GDK_MEMORY_X8B8G8R8,
     .mipmap_nearest = gdk_mipmap_guint8_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_4_linear,
+    .mipmap_linear = gdk_mipmap_guint8_4_box_linear,
   },
   [GDK_MEMORY_R8G8B8] = {
     .name = "RGB8",
@@ -1638,7 +1962,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r8g8b8_from_float,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = gdk_mipmap_guint8_3_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_3_linear,
+    .mipmap_linear = gdk_mipmap_guint8_3_box_linear,
   },
   [GDK_MEMORY_B8G8R8] = {
     .name = "BGR8",
@@ -1696,7 +2020,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = b8g8r8_from_float,
     .mipmap_format = GDK_MEMORY_B8G8R8,
     .mipmap_nearest = gdk_mipmap_guint8_3_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_3_linear,
+    .mipmap_linear = gdk_mipmap_guint8_3_box_linear,
   },
   [GDK_MEMORY_R16G16B16] = {
     .name = "RGB16",
@@ -1877,7 +2201,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r16g16b16a16_from_float,
     .mipmap_format = GDK_MEMORY_R16G16B16A16,
     .mipmap_nearest = gdk_mipmap_guint16_4_nearest,
-    .mipmap_linear = gdk_mipmap_guint16_4_linear,
+    .mipmap_linear = gdk_mipmap_guint16_4_alpha3_linear,
   },
   [GDK_MEMORY_R16G16B16_FLOAT] = {
     .name = "RGB16f",
@@ -1937,7 +2261,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r16g16b16_float_from_float,
     .mipmap_format = GDK_MEMORY_R16G16B16_FLOAT,
     .mipmap_nearest = gdk_mipmap_half_float_3_nearest,
-    .mipmap_linear = gdk_mipmap_half_float_3_linear,
+    .mipmap_linear = gdk_mipmap_half_float_3_box_linear,
   },
   [GDK_MEMORY_R16G16B16A16_FLOAT_PREMULTIPLIED] = {
     .name = "RGBA16fp",
@@ -1996,7 +2320,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r16g16b16a16_float_from_float,
     .mipmap_format = GDK_MEMORY_R16G16B16A16_FLOAT_PREMULTIPLIED,
     .mipmap_nearest = gdk_mipmap_half_float_4_nearest,
-    .mipmap_linear = gdk_mipmap_half_float_4_linear,
+    .mipmap_linear = gdk_mipmap_half_float_4_box_linear,
   },
   [GDK_MEMORY_R16G16B16A16_FLOAT] = {
     .name = "RGBA16f",
@@ -2055,7 +2379,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r16g16b16a16_float_from_float,
     .mipmap_format = GDK_MEMORY_R16G16B16A16_FLOAT,
     .mipmap_nearest = gdk_mipmap_half_float_4_nearest,
-    .mipmap_linear = gdk_mipmap_half_float_4_linear,
+    .mipmap_linear = gdk_mipmap_half_float_4_alpha3_linear,
   },
   [GDK_MEMORY_R32G32B32_FLOAT] = {
     .name = "RGB32f",
@@ -2233,7 +2557,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = r32g32b32a32_float_from_float,
     .mipmap_format = GDK_MEMORY_R32G32B32A32_FLOAT,
     .mipmap_nearest = gdk_mipmap_float_4_nearest,
-    .mipmap_linear = gdk_mipmap_float_4_linear,
+    .mipmap_linear = gdk_mipmap_float_4_alpha3_linear,
   },
   [GDK_MEMORY_G8A8_PREMULTIPLIED] = {
     .name = "GA8p",
@@ -2291,7 +2615,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = g8a8_premultiplied_from_float,
     .mipmap_format = GDK_MEMORY_G8A8_PREMULTIPLIED,
     .mipmap_nearest = gdk_mipmap_guint8_2_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_2_linear,
+    .mipmap_linear = gdk_mipmap_guint8_2_box_linear,
   },
   [GDK_MEMORY_G8A8] = {
     .name = "GA8",
@@ -2349,7 +2673,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = g8a8_from_float,
     .mipmap_format = GDK_MEMORY_G8A8,
     .mipmap_nearest = gdk_mipmap_guint8_2_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_2_linear,
+    .mipmap_linear = gdk_mipmap_guint8_2_alpha1_linear,
   },
   [GDK_MEMORY_G8] = {
     .name = "G8",
@@ -2407,7 +2731,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = g8_from_float,
     .mipmap_format = GDK_MEMORY_G8,
     .mipmap_nearest = gdk_mipmap_guint8_1_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_1_linear,
+    .mipmap_linear = gdk_mipmap_guint8_1_box_linear,
   },
   [GDK_MEMORY_G16A16_PREMULTIPLIED] = {
     .name = "GA16p",
@@ -2529,7 +2853,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = g16a16_from_float,
     .mipmap_format = GDK_MEMORY_G16A16,
     .mipmap_nearest = gdk_mipmap_guint16_2_nearest,
-    .mipmap_linear = gdk_mipmap_guint16_2_linear,
+    .mipmap_linear = gdk_mipmap_guint16_2_alpha1_linear,
   },
   [GDK_MEMORY_G16] = {
     .name = "G16",
@@ -2648,7 +2972,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = a8_from_float,
     .mipmap_format = GDK_MEMORY_A8,
     .mipmap_nearest = gdk_mipmap_guint8_1_nearest,
-    .mipmap_linear = gdk_mipmap_guint8_1_linear,
+    .mipmap_linear = gdk_mipmap_guint8_1_box_linear,
   },
   [GDK_MEMORY_A16] = {
     .name = "A16",
@@ -2769,7 +3093,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     .from_float = a16_float_from_float,
     .mipmap_format = GDK_MEMORY_A16_FLOAT,
     .mipmap_nearest = gdk_mipmap_half_float_1_nearest,
-    .mipmap_linear = gdk_mipmap_half_float_1_linear,
+    .mipmap_linear = gdk_mipmap_half_float_1_box_linear,
   },
   [GDK_MEMORY_A32_FLOAT] = {
     .name = "A32f",
@@ -2899,6 +3223,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = nv12_to_float,
     .from_float = nv12_from_float,
+    .yuv_unpack = nv12_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = nv12_mipmap_nearest,
     .mipmap_linear = nv12_mipmap_linear,
@@ -2971,6 +3296,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = nv21_to_float,
     .from_float = nv21_from_float,
+    .yuv_unpack = nv21_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = nv21_mipmap_nearest,
     .mipmap_linear = nv21_mipmap_linear,
@@ -3043,6 +3369,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = nv16_to_float,
     .from_float = nv16_from_float,
+    .yuv_unpack = nv16_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = nv16_mipmap_nearest,
     .mipmap_linear = nv16_mipmap_linear,
@@ -3115,6 +3442,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = nv61_to_float,
     .from_float = nv61_from_float,
+    .yuv_unpack = nv61_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = nv61_mipmap_nearest,
     .mipmap_linear = nv61_mipmap_linear,
@@ -3187,6 +3515,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = nv24_to_float,
     .from_float = nv24_from_float,
+    .yuv_unpack = nv24_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = nv24_mipmap_nearest,
     .mipmap_linear = nv24_mipmap_linear,
@@ -3259,6 +3588,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = nv42_to_float,
     .from_float = nv42_from_float,
+    .yuv_unpack = nv42_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = nv42_mipmap_nearest,
     .mipmap_linear = nv42_mipmap_linear,
@@ -3332,6 +3662,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = p010_to_float,
     .from_float = p010_from_float,
+    .yuv_unpack = p010_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R16G16B16,
     .mipmap_nearest = p010_mipmap_nearest,
     .mipmap_linear = p010_mipmap_linear,
@@ -3405,6 +3736,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = p012_to_float,
     .from_float = p012_from_float,
+    .yuv_unpack = p012_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R16G16B16,
     .mipmap_nearest = p012_mipmap_nearest,
     .mipmap_linear = p012_mipmap_linear,
@@ -3478,6 +3810,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = p016_to_float,
     .from_float = p016_from_float,
+    .yuv_unpack = p016_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R16G16B16,
     .mipmap_nearest = p016_mipmap_nearest,
     .mipmap_linear = p016_mipmap_linear,
@@ -3564,6 +3897,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yuv410_to_float,
     .from_float = yuv410_from_float,
+    .yuv_unpack = yuv410_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yuv410_mipmap_nearest,
     .mipmap_linear = yuv410_mipmap_linear,
@@ -3650,6 +3984,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yvu410_to_float,
     .from_float = yvu410_from_float,
+    .yuv_unpack = yvu410_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yvu410_mipmap_nearest,
     .mipmap_linear = yvu410_mipmap_linear,
@@ -3736,6 +4071,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yuv411_to_float,
     .from_float = yuv411_from_float,
+    .yuv_unpack = yuv411_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yuv411_mipmap_nearest,
     .mipmap_linear = yuv411_mipmap_linear,
@@ -3822,6 +4158,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yvu411_to_float,
     .from_float = yvu411_from_float,
+    .yuv_unpack = yvu411_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yvu411_mipmap_nearest,
     .mipmap_linear = yvu411_mipmap_linear,
@@ -3908,6 +4245,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yuv420_to_float,
     .from_float = yuv420_from_float,
+    .yuv_unpack = yuv420_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yuv420_mipmap_nearest,
     .mipmap_linear = yuv420_mipmap_linear,
@@ -3994,6 +4332,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yvu420_to_float,
     .from_float = yvu420_from_float,
+    .yuv_unpack = yvu420_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yvu420_mipmap_nearest,
     .mipmap_linear = yvu420_mipmap_linear,
@@ -4080,6 +4419,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yuv422_to_float,
     .from_float = yuv422_from_float,
+    .yuv_unpack = yuv422_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yuv422_mipmap_nearest,
     .mipmap_linear = yuv422_mipmap_linear,
@@ -4166,6 +4506,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yvu422_to_float,
     .from_float = yvu422_from_float,
+    .yuv_unpack = yvu422_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yvu422_mipmap_nearest,
     .mipmap_linear = yvu422_mipmap_linear,
@@ -4252,6 +4593,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yuv444_to_float,
     .from_float = yuv444_from_float,
+    .yuv_unpack = yuv444_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yuv444_mipmap_nearest,
     .mipmap_linear = yuv444_mipmap_linear,
@@ -4338,6 +4680,7 @@ static const GdkMemoryFormatDescription memory_formats[] = {
     },
     .to_float = yvu444_to_float,
     .from_float = yvu444_from_float,
+    .yuv_unpack = yvu444_yuv_unpack,
     .mipmap_format = GDK_MEMORY_R8G8B8,
     .mipmap_nearest = yvu444_mipmap_nearest,
     .mipmap_linear = yvu444_mipmap_linear,
@@ -5331,6 +5674,263 @@ get_fast_conversion_func (GdkMemoryFormat dest_format,
   return NULL;
 }
 
+/* Fast YCbCr to RGB conversion
+ *
+ * This handles the common case of converting planar video frames
+ * to 8-bit RGB when the color state of the frame has the same
+ * primaries as the target color state. Then the conversion is a
+ * fixed affine transform per pixel, followed by a per-channel
+ * lookup table if the transfer functions differ, and we can skip
+ * the full float pipeline.
+ *
+ * Rows are first split into normalized Y, Cb and Cr rows by the
+ * yuv_unpack function of the source format, and then packed into
+ * the destination. Both steps are straight loops over plain float
+ * arrays, so that the compiler can vectorize them.
+ */
+
+#define YUV_LUT_SIZE 4096
+
+typedef struct _YuvConvert YuvConvert;
+
+struct _YuvConvert
+{
+  /* undo the range: v * scale + offset */
+  float y_scale, y_offset;
+  float c_scale, c_offset;
+  /* the nonzero chroma entries of the YCbCr -> RGB matrix */
+  float r_cr, g_cr, g_cb, b_cb;
+  /* maps from the source to the target transfer function */
+  gboolean use_lut;
+  guchar lut[YUV_LUT_SIZE];
+};
+
+typedef void (* YuvPackFunc) (guchar           *dest,
+                              const YuvConvert *yc,
+                              const float      *y_row,
+                              const float      *cb_row,
+                              const float      *cr_row,
+                              gsize             n);
+
+#define YUV_PACK_FUNC(name, R, G, B, A, bpp) \
+static void \
+name (guchar           *dest, \
+      const YuvConvert *yc, \
+      const float      *y_row, \
+      const float      *cb_row, \
+      const float      *cr_row, \
+      gsize             n) \
+{ \
+  if (yc->use_lut) \
+    { \
+      for (gsize i = 0; i < n; i++) \
+        { \
+          float y = CLAMP (y_row[i] * yc->y_scale + yc->y_offset, 0.f, 1.f); \
+          float cb = CLAMP (cb_row[i] * yc->c_scale + yc->c_offset, 0.f, 1.f) - 0.5f; \
+          float cr = CLAMP (cr_row[i] * yc->c_scale + yc->c_offset, 0.f, 1.f) - 0.5f; \
+          float r = y + yc->r_cr * cr; \
+          float g = y + yc->g_cr * cr + yc->g_cb * cb; \
+          float b = y + yc->b_cb * cb; \
+          dest[i * bpp + R] = yc->lut[(gsize) (CLAMP (r, 0.f, 1.f) * (YUV_LUT_SIZE - 1) + 0.5f)]; \
+          dest[i * bpp + G] = yc->lut[(gsize) (CLAMP (g, 0.f, 1.f) * (YUV_LUT_SIZE - 1) + 0.5f)]; \
+          dest[i * bpp + B] = yc->lut[(gsize) (CLAMP (b, 0.f, 1.f) * (YUV_LUT_SIZE - 1) + 0.5f)]; \
+          if (A >= 0) dest[i * bpp + A] = 255; \
+        } \
+    } \
+  else \
+    { \
+      for (gsize i = 0; i < n; i++) \
+        { \
+          float y = CLAMP (y_row[i] * yc->y_scale + yc->y_offset, 0.f, 1.f); \
+          float cb = CLAMP (cb_row[i] * yc->c_scale + yc->c_offset, 0.f, 1.f) - 0.5f; \
+          float cr = CLAMP (cr_row[i] * yc->c_scale + yc->c_offset, 0.f, 1.f) - 0.5f; \
+          float r = y + yc->r_cr * cr; \
+          float g = y + yc->g_cr * cr + yc->g_cb * cb; \
+          float b = y + yc->b_cb * cb; \
+          dest[i * bpp + R] = (guchar) (CLAMP (r, 0.f, 1.f) * 255.f + 0.5f); \
+          dest[i * bpp + G] = (guchar) (CLAMP (g, 0.f, 1.f) * 255.f + 0.5f); \
+          dest[i * bpp + B] = (guchar) (CLAMP (b, 0.f, 1.f) * 255.f + 0.5f); \
+          if (A >= 0) dest[i * bpp + A] = 255; \
+        } \
+    } \
+}
+
+YUV_PACK_FUNC (yuv_to_r8g8b8a8, 0, 1, 2, 3, 4)
+YUV_PACK_FUNC (yuv_to_b8g8r8a8, 2, 1, 0, 3, 4)
+YUV_PACK_FUNC (yuv_to_a8r8g8b8, 1, 2, 3, 0, 4)
+YUV_PACK_FUNC (yuv_to_a8b8g8r8, 3, 2, 1, 0, 4)
+YUV_PACK_FUNC (yuv_to_r8g8b8, 0, 1, 2, -1, 3)
+YUV_PACK_FUNC (yuv_to_b8g8r8, 2, 1, 0, -1, 3)
+
+static YuvPackFunc
+get_yuv_pack_func (GdkMemoryFormat dest_format)
+{
+  /* The result is opaque, so premultiplication doesn't matter
+   * and we can fill the padding of X formats with 0xff.
+   */
+  switch ((int) dest_format)
+    {
+    case GDK_MEMORY_R8G8B8A8_PREMULTIPLIED:
+    case GDK_MEMORY_R8G8B8A8:
+    case GDK_MEMORY_R8G8B8X8:
+      return yuv_to_r8g8b8a8;
+    case GDK_MEMORY_B8G8R8A8_PREMULTIPLIED:
+    case GDK_MEMORY_B8G8R8A8:
+    case GDK_MEMORY_B8G8R8X8:
+      return yuv_to_b8g8r8a8;
+    case GDK_MEMORY_A8R8G8B8_PREMULTIPLIED:
+    case GDK_MEMORY_A8R8G8B8:
+    case GDK_MEMORY_X8R8G8B8:
+      return yuv_to_a8r8g8b8;
+    case GDK_MEMORY_A8B8G8R8_PREMULTIPLIED:
+    case GDK_MEMORY_A8B8G8R8:
+    case GDK_MEMORY_X8B8G8R8:
+      return yuv_to_a8b8g8r8;
+    case GDK_MEMORY_R8G8B8:
+      return yuv_to_r8g8b8;
+    case GDK_MEMORY_B8G8R8:
+      return yuv_to_b8g8r8;
+    default:
+      return NULL;
+    }
+}
+
+static void
+yuv_convert_init_lut (YuvConvert    *yc,
+                      GdkColorState *src_cs,
+                      GdkColorState *dest_cs)
+{
+  GdkFloatColorConvert convert_func = NULL;
+  GdkFloatColorConvert convert_func2 = NULL;
+  float (*ramp)[4];
+
+  convert_func = gdk_color_state_get_convert_to (src_cs, dest_cs);
+  if (!convert_func)
+    convert_func2 = gdk_color_state_get_convert_from (dest_cs, src_cs);
+
+  if (!convert_func && !convert_func2)
+    {
+      GdkColorState *connection = GDK_COLOR_STATE_REC2100_LINEAR;
+      convert_func = gdk_color_state_get_convert_to (src_cs, connection);
+      convert_func2 = gdk_color_state_get_convert_from (dest_cs, connection);
+    }
+
+  ramp = g_malloc (sizeof (*ramp) * YUV_LUT_SIZE);
+  for (gsize i = 0; i < YUV_LUT_SIZE; i++)
+    {
+      float v = (float) i / (YUV_LUT_SIZE - 1);
+      ramp[i][0] = ramp[i][1] = ramp[i][2] = v;
+      ramp[i][3] = 1.f;
+    }
+
+  if (convert_func)
+    convert_func (src_cs, ramp, YUV_LUT_SIZE);
+  if (convert_func2)
+    convert_func2 (dest_cs, ramp, YUV_LUT_SIZE);
+
+  /* The primaries are the same, so gray stays gray */
+  for (gsize i = 0; i < YUV_LUT_SIZE; i++)
+    yc->lut[i] = CLAMP (ramp[i][1] * 255.f + 0.5f, 0, 255);
+
+  g_free (ramp);
+
+  yc->use_lut = TRUE;
+}
+
+static gboolean
+yuv_convert_init (YuvConvert      *yc,
+                  GdkMemoryFormat  dest_format,
+                  GdkColorState   *dest_cs,
+                  GdkMemoryFormat  src_format,
+                  GdkColorState   *src_cs)
+{
+  const GdkCicp *src_cicp, *dest_cicp;
+  GdkCicp rgb_cicp;
+
+  if (memory_formats[src_format].yuv_unpack == NULL ||
+      get_yuv_pack_func (dest_format) == NULL)
+    return FALSE;
+
+  src_cicp = gdk_color_state_get_cicp (src_cs);
+  dest_cicp = gdk_color_state_get_cicp (dest_cs);
+  if (src_cicp == NULL || dest_cicp == NULL)
+    return FALSE;
+
+  if (dest_cicp->matrix_coefficients != 0 ||
+      dest_cicp->range != GDK_CICP_RANGE_FULL)
+    return FALSE;
+
+  rgb_cicp = (GdkCicp) {
+    src_cicp->color_primaries,
+    dest_cicp->transfer_function,
+    0,
+    GDK_CICP_RANGE_FULL
+  };
+  if (!gdk_cicp_equivalent (&rgb_cicp, dest_cicp))
+    return FALSE;
+
+  /* Same values as in gdkcolordefs.h */
+  switch (src_cicp->matrix_coefficients)
+    {
+    case 1:
+      yc->r_cr = 1.574800f;
+      yc->g_cr = -0.468124f;
+      yc->g_cb = -0.187324f;
+      yc->b_cb = 1.855600f;
+      break;
+    case 5:
+    case 6:
+      yc->r_cr = 1.402000f;
+      yc->g_cr = -0.714136f;
+      yc->g_cb = -0.344136f;
+      yc->b_cb = 1.772000f;
+      break;
+    case 9:
+      yc->r_cr = 1.474600f;
+      yc->g_cr = -0.571353f;
+      yc->g_cb = -0.164553f;
+      yc->b_cb = 1.881400f;
+      break;
+    default:
+      return FALSE;
+    }
+
+  if (src_cicp->range == GDK_CICP_RANGE_NARROW)
+    {
+      yc->y_scale = 255.f / 219.f;
+      yc->y_offset = -16.f / 219.f;
+      yc->c_scale = 255.f / 224.f;
+      yc->c_offset = -16.f / 224.f;
+    }
+  else
+    {
+      yc->y_scale = 1.f;
+      yc->y_offset = 0.f;
+      yc->c_scale = 1.f;
+      yc->c_offset = 0.f;
+    }
+
+  rgb_cicp.transfer_function = src_cicp->transfer_function;
+  if (!gdk_cicp_equivalent (&rgb_cicp, dest_cicp))
+    {
+      GdkColorState *rgb_cs;
+
+      rgb_cs = gdk_color_state_new_for_cicp (&rgb_cicp, NULL);
+      if (rgb_cs == NULL)
+        return FALSE;
+
+      yuv_convert_init_lut (yc, rgb_cs, dest_cs);
+
+      gdk_color_state_unref (rgb_cs);
+
+      return TRUE;
+    }
+
+  yc->use_lut = FALSE;
+
+  return TRUE;
+}
+
 typedef struct _MemoryConvert MemoryConvert;
 
 struct _MemoryConvert
@@ -5342,10 +5942,47 @@ struct _MemoryConvert
   GdkMemoryLayout      src_layout;
   GdkColorState       *src_cs;
   gsize                chunk_size;
+  YuvConvert           yuv;
 
   /* atomic */ int     rows_done;
 };
 
+static void
+gdk_memory_convert_yuv (gpointer data)
+{
+  MemoryConvert *mc = data;
+  const GdkMemoryFormatDescription *src_desc = &memory_formats[mc->src_layout.format];
+  YuvPackFunc pack = get_yuv_pack_func (mc->dest_layout.format);
+  gsize width = mc->dest_layout.width;
+  float *y_row, *cb_row, *cr_row;
+  gsize y0, y;
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+  gsize rows;
+
+  y_row = g_new (float, 3 * width);
+  cb_row = y_row + width;
+  cr_row = cb_row + width;
+
+  for (y0 = g_atomic_int_add (&mc->rows_done, mc->chunk_size), rows = 0;
+       y0 < mc->dest_layout.height;
+       y0 = g_atomic_int_add (&mc->rows_done, mc->chunk_size))
+    {
+      for (y = y0; y < MIN (y0 + mc->chunk_size, mc->dest_layout.height); y++, rows++)
+        {
+          guchar *dest_data = mc->dest_data + gdk_memory_layout_offset (&mc->dest_layout, 0, 0, y);
+
+          src_desc->yuv_unpack (y_row, cb_row, cr_row, mc->src_data, &mc->src_layout, y);
+          pack (dest_data, &mc->yuv, y_row, cb_row, cr_row, width);
+        }
+    }
+
+  g_free (y_row);
+
+  ADD_MARK (before,
+            "Memory convert YUV (thread)", "size %lux%lu, %lu rows",
+            mc->dest_layout.width, mc->dest_layout.height, rows);
+}
+
 static void
 gdk_memory_convert_generic (gpointer data)
 {
@@ -5493,7 +6130,10 @@ gdk_memory_convert (guchar                *dest_data,
 
   n_tasks = (mc.dest_layout.height + mc.chunk_size - 1) / mc.chunk_size;
 
-  gdk_parallel_task_run (gdk_memory_convert_generic, &mc, n_tasks);
+  if (yuv_convert_init (&mc.yuv, dest_layout->format, dest_cs, src_layout->format, src_cs))
+    gdk_parallel_task_run (gdk_memory_convert_yuv, &mc, n_tasks);
+  else
+    gdk_parallel_task_run (gdk_memory_convert_generic, &mc, n_tasks);
 }
 
 typedef struct _MemoryConvertColorState MemoryConvertColorState;
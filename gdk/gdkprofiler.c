@@ -24,24 +24,778 @@
 
 #include <sys/types.h>
 #include <signal.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
 
+#ifdef G_OS_UNIX
+#include <glib-unix.h>
+#endif
+
 #include "version/gdkversionmacros.h"
 #include "gdkframeclockprivate.h"
 
 #define CATEGORY "GTK"
 
+/* The trace recorder is a fallback for when sysprof is not available.
+ *
+ * If GDK_TRACE is set to a filename, marks and counter values are
+ * recorded into per-thread ring buffers and written to that file
+ * when the process exits or receives SIGUSR2. Filenames ending in
+ * .pftrace or .perfetto-trace produce a Perfetto trace, anything
+ * else produces Chrome trace-event JSON.
+ *
+ * Recording is meant to be cheap enough to be left on. Each thread
+ * only writes to its own buffer, so there are no locks or atomic
+ * read-modify-write operations on the hot path. When a buffer is
+ * full, the oldest events are overwritten.
+ */
+
+#define TRACE_BUFFER_SIZE  8192  /* must be a power of 2 */
+#define TRACE_NAME_LEN     48
+#define TRACE_MESSAGE_LEN  96
+#define MAX_COUNTERS       256
+
+typedef struct
+{
+  gint64 time;
+  gint64 duration;
+  union {
+    double v_double;
+    gint64 v_int;
+  } value;
+  guint tid;
+  guint counter;  /* 0 for marks */
+  char name[TRACE_NAME_LEN];
+  char message[TRACE_MESSAGE_LEN];
+} TraceEvent;
+
+typedef struct
+{
+  guint tid;
+  /* Only written by the owning thread */
+  guint head;
+  TraceEvent events[TRACE_BUFFER_SIZE];
+} TraceBuffer;
+
+typedef struct
+{
+  char name[TRACE_NAME_LEN];
+  gboolean is_int;
+#ifdef HAVE_SYSPROF
+  guint sysprof_id;
+#endif
+} Counter;
+
+gboolean gdk_profiler_recording;
+
+static char *trace_filename;
+
+G_LOCK_DEFINE_STATIC (trace_buffers);
+static GPtrArray *trace_buffers;    /* all buffers */
+static GPtrArray *retired_buffers;  /* buffers of threads that exited */
+static guint next_tid;
+
+G_LOCK_DEFINE_STATIC (counters);
+static Counter counters[MAX_COUNTERS];
+static guint n_counters; /* ids start at 1 */
+
+static void
+trace_buffer_retire (gpointer data)
+{
+  G_LOCK (trace_buffers);
+  g_ptr_array_add (retired_buffers, data);
+  G_UNLOCK (trace_buffers);
+}
+
+static GPrivate trace_buffer_key = G_PRIVATE_INIT (trace_buffer_retire);
+
+static TraceBuffer *
+trace_buffer_get (void)
+{
+  TraceBuffer *buffer;
+
+  buffer = g_private_get (&trace_buffer_key);
+  if (G_LIKELY (buffer))
+    return buffer;
+
+  G_LOCK (trace_buffers);
+
+  /* Events in a reused buffer keep the id of the thread that wrote them */
+  if (retired_buffers->len > 0)
+    {
+      buffer = g_ptr_array_steal_index_fast (retired_buffers, retired_buffers->len - 1);
+    }
+  else
+    {
+      /* Not zeroed, so pages only get touched once they are used */
+      buffer = g_new (TraceBuffer, 1);
+      buffer->head = 0;
+      g_ptr_array_add (trace_buffers, buffer);
+    }
+
+  buffer->tid = ++next_tid;
+
+  G_UNLOCK (trace_buffers);
+
+  g_private_set (&trace_buffer_key, buffer);
+
+  return buffer;
+}
+
+static inline TraceEvent *
+trace_event_begin (TraceBuffer *buffer)
+{
+  TraceEvent *event = &buffer->events[buffer->head & (TRACE_BUFFER_SIZE - 1)];
+
+  event->tid = buffer->tid;
+
+  return event;
+}
+
+static inline void
+trace_event_end (TraceBuffer *buffer)
+{
+  /* Publishes the event to the exporter */
+  g_atomic_int_set (&buffer->head, buffer->head + 1);
+}
+
+static void
+trace_add_mark (gint64      begin_time,
+                gint64      duration,
+                const char *name,
+                const char *message)
+{
+  TraceBuffer *buffer = trace_buffer_get ();
+  TraceEvent *event = trace_event_begin (buffer);
+
+  event->time = begin_time;
+  event->duration = duration;
+  event->counter = 0;
+  g_strlcpy (event->name, name, TRACE_NAME_LEN);
+  g_strlcpy (event->message, message ? message : "", TRACE_MESSAGE_LEN);
+
+  trace_event_end (buffer);
+}
+
+static void
+trace_add_markv (gint64      begin_time,
+                 gint64      duration,
+                 const char *name,
+                 const char *message_format,
+                 va_list     args)
+{
+  TraceBuffer *buffer = trace_buffer_get ();
+  TraceEvent *event = trace_event_begin (buffer);
+
+  event->time = begin_time;
+  event->duration = duration;
+  event->counter = 0;
+  g_strlcpy (event->name, name, TRACE_NAME_LEN);
+  g_vsnprintf (event->message, TRACE_MESSAGE_LEN, message_format, args);
+
+  trace_event_end (buffer);
+}
+
+static void
+trace_set_counter (guint  id,
+                   double v_double,
+                   gint64 v_int)
+{
+  TraceBuffer *buffer = trace_buffer_get ();
+  TraceEvent *event = trace_event_begin (buffer);
+
+  event->time = GDK_PROFILER_CURRENT_TIME;
+  event->counter = id;
+  if (counters[id].is_int)
+    event->value.v_int = v_int;
+  else
+    event->value.v_double = v_double;
+
+  trace_event_end (buffer);
+}
+
+/* Copies the events of all buffers that have not been overwritten,
+ * and sorts them by time.
+ */
+static GArray *
+trace_collect_events (void)
+{
+  GArray *events;
+  guint i;
+
+  events = g_array_new (FALSE, FALSE, sizeof (TraceEvent));
+
+  G_LOCK (trace_buffers);
+
+  for (i = 0; i < trace_buffers->len; i++)
+    {
+      TraceBuffer *buffer = g_ptr_array_index (trace_buffers, i);
+      guint head, start, end, first;
+
+      head = g_atomic_int_get (&buffer->head);
+      start = head > TRACE_BUFFER_SIZE ? head - TRACE_BUFFER_SIZE : 0;
+      first = events->len;
+
+      for (guint j = start; j != head; j++)
+        g_array_append_val (events, buffer->events[j & (TRACE_BUFFER_SIZE - 1)]);
+
+      /* The owner may have kept writing while we copied. Drop everything
+       * that might have been overwritten in the meantime, including the
+       * event that is being written right now.
+       */
+      end = g_atomic_int_get (&buffer->head);
+      if (end - start >= TRACE_BUFFER_SIZE)
+        {
+          guint overwritten = MIN (end - start - TRACE_BUFFER_SIZE + 1, head - start);
+
+          g_array_remove_range (events, first, overwritten);
+        }
+    }
+
+  G_UNLOCK (trace_buffers);
+
+  return events;
+}
+
+static int
+compare_events (gconstpointer a,
+                gconstpointer b)
+{
+  const TraceEvent *ea = a;
+  const TraceEvent *eb = b;
+
+  /* Longer marks first, so marks that start together nest */
+  if (ea->time == eb->time)
+    return (ea->duration < eb->duration) - (ea->duration > eb->duration);
+
+  return (ea->time > eb->time) - (ea->time < eb->time);
+}
+
+static void
+append_json_string (GString    *string,
+                    const char *s)
+{
+  g_string_append_c (string, '"');
+
+  for (; *s; s++)
+    {
+      switch (*s)
+        {
+        case '"':
+          g_string_append (string, "\\\"");
+          break;
+        case '\\':
+          g_string_append (string, "\\\\");
+          break;
+        case '\n':
+          g_string_append (string, "\\n");
+          break;
+        default:
+          if ((guchar) *s < 0x20)
+            g_string_append_printf (string, "\\u%04x", (guchar) *s);
+          else
+            g_string_append_c (string, *s);
+          break;
+        }
+    }
+
+  g_string_append_c (string, '"');
+}
+
+/* See the "Trace Event Format" document for the Chrome tracing
+ * JSON format. Times are in microseconds.
+ */
+static GBytes *
+trace_to_json (GArray *events,
+               guint   n_threads)
+{
+  GString *string;
+  int pid;
+  guint i;
+
+#ifdef HAVE_UNISTD_H
+  pid = getpid ();
+#else
+  pid = 1;
+#endif
+
+  string = g_string_new ("{\"traceEvents\":[\n");
+
+  for (i = 1; i <= n_threads; i++)
+    g_string_append_printf (string,
+                            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,"
+                            "\"args\":{\"name\":\"%s %u\"}},\n",
+                            pid, i, i == 1 ? "main" : "thread", i);
+
+  for (i = 0; i < events->len; i++)
+    {
+      const TraceEvent *event = &g_array_index (events, TraceEvent, i);
+
+      if (event->counter == 0)
+        {
+          g_string_append (string, "{\"name\":");
+          append_json_string (string, event->name);
+          g_string_append_printf (string,
+                                  ",\"cat\":\"" CATEGORY "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                                  "\"pid\":%d,\"tid\":%u",
+                                  event->time / 1000.0,
+                                  MAX (event->duration, 0) / 1000.0,
+                                  pid, event->tid);
+          if (event->message[0])
+            {
+              g_string_append (string, ",\"args\":{\"message\":");
+              append_json_string (string, event->message);
+              g_string_append_c (string, '}');
+            }
+          g_string_append (string, "},\n");
+        }
+      else
+        {
+          const Counter *counter = &counters[event->counter];
+          char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+          g_string_append (string, "{\"name\":");
+          append_json_string (string, counter->name);
+          g_string_append_printf (string,
+                                  ",\"cat\":\"" CATEGORY "\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,"
+                                  "\"args\":{\"value\":",
+                                  event->time / 1000.0, pid);
+          if (counter->is_int)
+            g_string_append_printf (string, "%" G_GINT64_FORMAT, event->value.v_int);
+          else
+            g_string_append (string, g_ascii_dtostr (buf, sizeof (buf), event->value.v_double));
+          g_string_append (string, "}},\n");
+        }
+    }
+
+  /* Trailing commas are not allowed */
+  if (string->str[string->len - 2] == ',')
+    g_string_truncate (string, string->len - 2);
+
+  g_string_append (string, "\n]}\n");
+
+  return g_string_free_to_bytes (string);
+}
+
+/* A minimal protobuf writer for the parts of the Perfetto trace
+ * format (perfetto/trace/trace_packet.proto and friends) we need.
+ */
+enum {
+  WIRE_VARINT = 0,
+  WIRE_FIXED64 = 1,
+  WIRE_BYTES = 2,
+};
+
+static void
+pb_varint (GByteArray *pb,
+           guint64     value)
+{
+  do
+    {
+      guint8 byte = value & 0x7f;
+
+      value >>= 7;
+      if (value)
+        byte |= 0x80;
+      g_byte_array_append (pb, &byte, 1);
+    }
+  while (value);
+}
+
+static void
+pb_uint (GByteArray *pb,
+         guint       field,
+         guint64     value)
+{
+  pb_varint (pb, (field << 3) | WIRE_VARINT);
+  pb_varint (pb, value);
+}
+
+static void
+pb_double (GByteArray *pb,
+           guint       field,
+           double      value)
+{
+  guint64 bits;
+
+  memcpy (&bits, &value, sizeof (bits));
+  bits = GUINT64_TO_LE (bits);
+
+  pb_varint (pb, (field << 3) | WIRE_FIXED64);
+  g_byte_array_append (pb, (guint8 *) &bits, sizeof (bits));
+}
+
+static void
+pb_bytes (GByteArray   *pb,
+          guint         field,
+          const guint8 *data,
+          gsize         size)
+{
+  pb_varint (pb, (field << 3) | WIRE_BYTES);
+  pb_varint (pb, size);
+  g_byte_array_append (pb, data, size);
+}
+
+static void
+pb_string (GByteArray *pb,
+           guint       field,
+           const char *string)
+{
+  pb_bytes (pb, field, (const guint8 *) string, strlen (string));
+}
+
+static void
+pb_message (GByteArray *pb,
+            guint       field,
+            GByteArray *message)
+{
+  pb_bytes (pb, field, message->data, message->len);
+  g_byte_array_set_size (message, 0);
+}
+
+/* Field numbers */
+#define TRACE_PACKET                         1
+#define PACKET_TIMESTAMP                     8
+#define PACKET_TRUSTED_PACKET_SEQUENCE_ID   10
+#define PACKET_TRACK_EVENT                  11
+#define PACKET_TIMESTAMP_CLOCK_ID           58
+#define PACKET_TRACK_DESCRIPTOR             60
+#define TRACK_DESCRIPTOR_UUID                1
+#define TRACK_DESCRIPTOR_NAME                2
+#define TRACK_DESCRIPTOR_PARENT_UUID         5
+#define TRACK_DESCRIPTOR_THREAD              4
+#define TRACK_DESCRIPTOR_COUNTER             8
+#define THREAD_DESCRIPTOR_PID                1
+#define THREAD_DESCRIPTOR_TID                2
+#define THREAD_DESCRIPTOR_THREAD_NAME        5
+#define TRACK_EVENT_DEBUG_ANNOTATIONS        4
+#define TRACK_EVENT_TYPE                     9
+#define TRACK_EVENT_TRACK_UUID              11
+#define TRACK_EVENT_CATEGORIES              22
+#define TRACK_EVENT_NAME                    23
+#define TRACK_EVENT_COUNTER_VALUE           30
+#define TRACK_EVENT_DOUBLE_COUNTER_VALUE    44
+#define DEBUG_ANNOTATION_STRING_VALUE        6
+#define DEBUG_ANNOTATION_NAME               10
+
+#define TYPE_SLICE_BEGIN 1
+#define TYPE_SLICE_END   2
+#define TYPE_COUNTER     4
+
+#define CLOCK_MONOTONIC_ID 3
+#define SEQUENCE_ID 1
+#define COUNTER_TRACK_BASE 0x10000
+#define LANE_TRACK_BASE    G_GUINT64_CONSTANT (0x100000000)
+
+/* Slices on a Perfetto track must nest, but marks on one thread can
+ * overlap in any way. So each mark goes on the first lane of its
+ * thread where it nests with the marks that are still open. Lane 0
+ * is the thread's own track, the others are child tracks of it.
+ *
+ * The lanes of a thread are a GPtrArray of GArrays holding the end
+ * times of the open marks, innermost last.
+ */
+static guint
+assign_lane (GPtrArray        *lanes,
+             const TraceEvent *event)
+{
+  gint64 end = event->time + MAX (event->duration, 0);
+  guint i;
+
+  for (i = 0; i < lanes->len; i++)
+    {
+      GArray *open = g_ptr_array_index (lanes, i);
+
+      while (open->len > 0 &&
+             g_array_index (open, gint64, open->len - 1) <= event->time)
+        g_array_set_size (open, open->len - 1);
+
+      /* The enclosing mark must end strictly later, or the
+       * two end events could be reordered */
+      if (open->len == 0 ||
+          g_array_index (open, gint64, open->len - 1) > end)
+        {
+          g_array_append_val (open, end);
+          return i;
+        }
+    }
+
+  g_ptr_array_add (lanes, g_array_new (FALSE, FALSE, sizeof (gint64)));
+  g_array_append_val (g_ptr_array_index (lanes, i), end);
+
+  return i;
+}
+
+static guint64
+lane_track_uuid (guint tid,
+                 guint lane)
+{
+  if (lane == 0)
+    return tid;
+
+  return LANE_TRACK_BASE + ((guint64) tid << 16) + lane;
+}
+
+static void
+pb_track_event_packet (GByteArray *trace,
+                       GByteArray *packet,
+                       GByteArray *track_event,
+                       gint64      time)
+{
+  pb_uint (packet, PACKET_TIMESTAMP, time);
+  pb_uint (packet, PACKET_TIMESTAMP_CLOCK_ID, CLOCK_MONOTONIC_ID);
+  pb_uint (packet, PACKET_TRUSTED_PACKET_SEQUENCE_ID, SEQUENCE_ID);
+  pb_message (packet, PACKET_TRACK_EVENT, track_event);
+  pb_message (trace, TRACE_PACKET, packet);
+}
+
+static GBytes *
+trace_to_perfetto (GArray *events,
+                   guint   n_threads)
+{
+  GByteArray *trace, *packet, *track, *message, *annotation;
+  GPtrArray **lanes;
+  guint *event_lanes;
+  int pid;
+  guint i;
+
+#ifdef HAVE_UNISTD_H
+  pid = getpid ();
+#else
+  pid = 1;
+#endif
+
+  trace = g_byte_array_new ();
+  packet = g_byte_array_new ();
+  track = g_byte_array_new ();
+  message = g_byte_array_new ();
+  annotation = g_byte_array_new ();
+
+  for (i = 1; i <= n_threads; i++)
+    {
+      char *name = g_strdup_printf ("%s %u", i == 1 ? "main" : "thread", i);
+
+      pb_uint (message, THREAD_DESCRIPTOR_PID, pid);
+      pb_uint (message, THREAD_DESCRIPTOR_TID, i);
+      pb_string (message, THREAD_DESCRIPTOR_THREAD_NAME, name);
+      pb_uint (track, TRACK_DESCRIPTOR_UUID, i);
+      pb_message (track, TRACK_DESCRIPTOR_THREAD, message);
+      pb_uint (packet, PACKET_TRUSTED_PACKET_SEQUENCE_ID, SEQUENCE_ID);
+      pb_message (packet, PACKET_TRACK_DESCRIPTOR, track);
+      pb_message (trace, TRACE_PACKET, packet);
+
+      g_free (name);
+    }
+
+  lanes = g_new (GPtrArray *, n_threads + 1);
+  for (i = 1; i <= n_threads; i++)
+    lanes[i] = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+
+  event_lanes = g_new0 (guint, events->len);
+  for (i = 0; i < events->len; i++)
+    {
+      const TraceEvent *event = &g_array_index (events, TraceEvent, i);
+
+      if (event->counter == 0)
+        event_lanes[i] = assign_lane (lanes[event->tid], event);
+    }
+
+  for (i = 1; i <= n_threads; i++)
+    {
+      for (guint lane = 1; lane < lanes[i]->len; lane++)
+        {
+          char *name = g_strdup_printf ("%s %u (%u)", i == 1 ? "main" : "thread", i, lane);
+
+          pb_uint (track, TRACK_DESCRIPTOR_UUID, lane_track_uuid (i, lane));
+          pb_uint (track, TRACK_DESCRIPTOR_PARENT_UUID, i);
+          pb_string (track, TRACK_DESCRIPTOR_NAME, name);
+          pb_uint (packet, PACKET_TRUSTED_PACKET_SEQUENCE_ID, SEQUENCE_ID);
+          pb_message (packet, PACKET_TRACK_DESCRIPTOR, track);
+          pb_message (trace, TRACE_PACKET, packet);
+
+          g_free (name);
+        }
+
+      g_ptr_array_unref (lanes[i]);
+    }
+  g_free (lanes);
+
+  for (i = 1; i <= n_counters; i++)
+    {
+      pb_uint (track, TRACK_DESCRIPTOR_UUID, COUNTER_TRACK_BASE + i);
+      pb_string (track, TRACK_DESCRIPTOR_NAME, counters[i].name);
+      pb_message (track, TRACK_DESCRIPTOR_COUNTER, message);
+      pb_uint (packet, PACKET_TRUSTED_PACKET_SEQUENCE_ID, SEQUENCE_ID);
+      pb_message (packet, PACKET_TRACK_DESCRIPTOR, track);
+      pb_message (trace, TRACE_PACKET, packet);
+    }
+
+  for (i = 0; i < events->len; i++)
+    {
+      const TraceEvent *event = &g_array_index (events, TraceEvent, i);
+
+      if (event->counter == 0)
+        {
+          guint64 uuid = lane_track_uuid (event->tid, event_lanes[i]);
+
+          pb_uint (track, TRACK_EVENT_TYPE, TYPE_SLICE_BEGIN);
+          pb_uint (track, TRACK_EVENT_TRACK_UUID, uuid);
+          pb_string (track, TRACK_EVENT_CATEGORIES, CATEGORY);
+          pb_string (track, TRACK_EVENT_NAME, event->name);
+          if (event->message[0])
+            {
+              pb_string (annotation, DEBUG_ANNOTATION_NAME, "message");
+              pb_string (annotation, DEBUG_ANNOTATION_STRING_VALUE, event->message);
+              pb_message (track, TRACK_EVENT_DEBUG_ANNOTATIONS, annotation);
+            }
+          pb_track_event_packet (trace, packet, track, event->time);
+
+          pb_uint (track, TRACK_EVENT_TYPE, TYPE_SLICE_END);
+          pb_uint (track, TRACK_EVENT_TRACK_UUID, uuid);
+          pb_track_event_packet (trace, packet, track, event->time + MAX (event->duration, 0));
+        }
+      else
+        {
+          pb_uint (track, TRACK_EVENT_TYPE, TYPE_COUNTER);
+          pb_uint (track, TRACK_EVENT_TRACK_UUID, COUNTER_TRACK_BASE + event->counter);
+          if (counters[event->counter].is_int)
+            pb_uint (track, TRACK_EVENT_COUNTER_VALUE, event->value.v_int);
+          else
+            pb_double (track, TRACK_EVENT_DOUBLE_COUNTER_VALUE, event->value.v_double);
+          pb_track_event_packet (trace, packet, track, event->time);
+        }
+    }
+
+  g_free (event_lanes);
+  g_byte_array_unref (annotation);
+  g_byte_array_unref (message);
+  g_byte_array_unref (track);
+  g_byte_array_unref (packet);
+
+  return g_byte_array_free_to_bytes (trace);
+}
+
+/*< private >
+ * gdk_profiler_save_trace:
+ * @filename: the file to write to
+ * @error: return location for an error
+ *
+ * Writes the events that the trace recorder currently holds to
+ * @filename. The format is determined by the file extension.
+ *
+ * This can be called at any time while the recorder is running,
+ * from any thread.
+ *
+ * Returns: %TRUE if the trace was written
+ */
+gboolean
+gdk_profiler_save_trace (const char  *filename,
+                         GError     **error)
+{
+  GArray *events;
+  GBytes *bytes;
+  guint n_threads;
+  gboolean result;
+
+  if (!gdk_profiler_recording)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_INITIALIZED,
+                           "The trace recorder is not running");
+      return FALSE;
+    }
+
+  events = trace_collect_events ();
+  g_array_sort (events, compare_events);
+
+  G_LOCK (trace_buffers);
+  n_threads = next_tid;
+  G_UNLOCK (trace_buffers);
+
+  if (g_str_has_suffix (filename, ".pftrace") ||
+      g_str_has_suffix (filename, ".perfetto-trace"))
+    bytes = trace_to_perfetto (events, n_threads);
+  else
+    bytes = trace_to_json (events, n_threads);
+
+  result = g_file_set_contents (filename,
+                                g_bytes_get_data (bytes, NULL),
+                                g_bytes_get_size (bytes),
+                                error);
+
+  g_bytes_unref (bytes);
+  g_array_unref (events);
+
+  return result;
+}
+
+static void
+save_trace (void)
+{
+  GError *error = NULL;
+
+  if (!gdk_profiler_save_trace (trace_filename, &error))
+    {
+      g_warning ("Failed to write trace to %s: %s", trace_filename, error->message);
+      g_error_free (error);
+    }
+}
+
+#ifdef G_OS_UNIX
+static gboolean
+save_trace_on_signal (gpointer data)
+{
+  save_trace ();
+
+  return G_SOURCE_CONTINUE;
+}
+#endif
+
+/*< private >
+ * gdk_profiler_init:
+ *
+ * Starts the trace recorder if the `GDK_TRACE` environment
+ * variable is set.
+ */
+void
+gdk_profiler_init (void)
+{
+  const char *filename;
+
+  if (gdk_profiler_recording)
+    return;
+
+  filename = g_getenv ("GDK_TRACE");
+  if (filename == NULL || filename[0] == '\0')
+    return;
+
+  trace_filename = g_strdup (filename);
+  trace_buffers = g_ptr_array_new ();
+  retired_buffers = g_ptr_array_new ();
+
+  /* Make the calling thread get the first id */
+  trace_buffer_get ();
+
+  gdk_profiler_recording = TRUE;
+
+  atexit (save_trace);
+#ifdef G_OS_UNIX
+  g_unix_signal_add (SIGUSR2, save_trace_on_signal, NULL);
+#endif
+}
+
 gboolean
 gdk_profiler_is_running (void)
 {
 #ifdef HAVE_SYSPROF
-  return sysprof_collector_is_active ();
-#else
-  return FALSE;
+  if (sysprof_collector_is_active ())
+    return TRUE;
 #endif
+
+  return gdk_profiler_recording;
 }
 
 void
@@ -53,6 +807,9 @@ void
 #ifdef HAVE_SYSPROF
   sysprof_collector_mark (begin_time, duration, CATEGORY, name, message);
 #endif
+
+  if (G_UNLIKELY (gdk_profiler_recording))
+    trace_add_mark (begin_time, duration, name, message);
 }
 
 void
@@ -60,9 +817,7 @@ void
                          const char *name,
                          const char *message)
 {
-#ifdef HAVE_SYSPROF
-  sysprof_collector_mark (begin_time, GDK_PROFILER_CURRENT_TIME - begin_time, CATEGORY, name, message);
-#endif
+  gdk_profiler_add_mark (begin_time, GDK_PROFILER_CURRENT_TIME - begin_time, name, message);
 }
 
 void
@@ -72,12 +827,20 @@ void
                           const gchar *message_format,
                           ...)
 {
-#ifdef HAVE_SYSPROF
   va_list args;
+
+#ifdef HAVE_SYSPROF
   va_start (args, message_format);
   sysprof_collector_mark_vprintf (begin_time, duration, CATEGORY, name, message_format, args);
   va_end (args);
 #endif  /* HAVE_SYSPROF */
+
+  if (G_UNLIKELY (gdk_profiler_recording))
+    {
+      va_start (args, message_format);
+      trace_add_markv (begin_time, duration, name, message_format, args);
+      va_end (args);
+    }
 }
 
 void
@@ -86,78 +849,118 @@ void
                           const gchar *message_format,
                           ...)
 {
-#ifdef HAVE_SYSPROF
+  gint64 duration = GDK_PROFILER_CURRENT_TIME - begin_time;
   va_list args;
+
+#ifdef HAVE_SYSPROF
   va_start (args, message_format);
-  sysprof_collector_mark_vprintf (begin_time, GDK_PROFILER_CURRENT_TIME - begin_time, CATEGORY, name, message_format, args);
+  sysprof_collector_mark_vprintf (begin_time, duration, CATEGORY, name, message_format, args);
   va_end (args);
 #endif  /* HAVE_SYSPROF */
+
+  if (G_UNLIKELY (gdk_profiler_recording))
+    {
+      va_start (args, message_format);
+      trace_add_markv (begin_time, duration, name, message_format, args);
+      va_end (args);
+    }
 }
 
-guint
-(gdk_profiler_define_counter) (const char *name,
-                               const char *description)
+static guint
+define_counter (const char *name,
+                const char *description,
+                gboolean    is_int)
 {
+  guint id;
+
+  G_LOCK (counters);
+
+  if (n_counters + 1 >= MAX_COUNTERS)
+    {
+      G_UNLOCK (counters);
+      g_warning ("Too many profiler counters, ignoring %s", name);
+      return 0;
+    }
+
+  id = ++n_counters;
+  g_strlcpy (counters[id].name, name, TRACE_NAME_LEN);
+  counters[id].is_int = is_int;
+
 #ifdef HAVE_SYSPROF
-  SysprofCaptureCounter counter;
+  {
+    SysprofCaptureCounter counter;
 
-  counter.id = sysprof_collector_request_counters (1);
-  counter.type = SYSPROF_CAPTURE_COUNTER_DOUBLE;
-  counter.value.vdbl = 0.0;
-  g_strlcpy (counter.category, CATEGORY, sizeof counter.category);
-  g_strlcpy (counter.name, name, sizeof counter.name);
-  g_strlcpy (counter.description, description, sizeof counter.name);
+    counter.id = sysprof_collector_request_counters (1);
+    counter.type = is_int ? SYSPROF_CAPTURE_COUNTER_INT64 : SYSPROF_CAPTURE_COUNTER_DOUBLE;
+    if (is_int)
+      counter.value.v64 = 0;
+    else
+      counter.value.vdbl = 0.0;
+    g_strlcpy (counter.category, CATEGORY, sizeof counter.category);
+    g_strlcpy (counter.name, name, sizeof counter.name);
+    g_strlcpy (counter.description, description, sizeof counter.name);
 
-  sysprof_collector_define_counters (&counter, 1);
+    sysprof_collector_define_counters (&counter, 1);
 
-  return counter.id;
-#else
-  return 0;
+    counters[id].sysprof_id = counter.id;
+  }
 #endif
+
+  G_UNLOCK (counters);
+
+  return id;
+}
+
+guint
+(gdk_profiler_define_counter) (const char *name,
+                               const char *description)
+{
+  return define_counter (name, description, FALSE);
 }
 
 guint
 (gdk_profiler_define_int_counter) (const char *name,
                                    const char *description)
 {
-#ifdef HAVE_SYSPROF
-  SysprofCaptureCounter counter;
-
-  counter.id = sysprof_collector_request_counters (1);
-  counter.type = SYSPROF_CAPTURE_COUNTER_INT64;
-  counter.value.v64 = 0;
-  g_strlcpy (counter.category, CATEGORY, sizeof counter.category);
-  g_strlcpy (counter.name, name, sizeof counter.name);
-  g_strlcpy (counter.description, description, sizeof counter.name);
-
-  sysprof_collector_define_counters (&counter, 1);
-
-  return counter.id;
-#else
-  return 0;
-#endif
+  return define_counter (name, description, TRUE);
 }
 
 void
 (gdk_profiler_set_counter) (guint  id,
                             double val)
 {
+  if (id == 0)
+    return;
+
 #ifdef HAVE_SYSPROF
-  SysprofCaptureCounterValue value;
+  {
+    SysprofCaptureCounterValue value;
 
-  value.vdbl = val;
-  sysprof_collector_set_counters (&id, &value, 1);
+    value.vdbl = val;
+    sysprof_collector_set_counters (&counters[id].sysprof_id, &value, 1);
+  }
 #endif
+
+  if (G_UNLIKELY (gdk_profiler_recording))
+    trace_set_counter (id, val, 0);
 }
 
 void
 (gdk_profiler_set_int_counter) (guint  id,
                                 gint64 val)
 {
+  if (id == 0)
+    return;
+
 #ifdef HAVE_SYSPROF
-  SysprofCaptureCounterValue value;
+  {
+    SysprofCaptureCounterValue value;
 
-  value.v64 = val;
-  sysprof_collector_set_counters (&id, &value, 1);
+    value.v64 = val;
+    sysprof_collector_set_counters (&counters[id].sysprof_id, &value, 1);
+  }
 #endif
+
+  if (G_UNLIKELY (gdk_profiler_recording))
+    trace_set_counter (id, 0, val);
 }
@@ -2889,7 +2889,6 @@ add_event_mark (GdkEvent *event,
                 gint64    time,
                 gint64    end_time)
 {
-#ifdef HAVE_SYSPROF
   char *message = NULL;
   const char *kind;
   GEnumClass *class;
@@ -2974,7 +2973,6 @@ add_event_mark (GdkEvent *event,
   gdk_profiler_add_mark (time, end_time - time, "Event", message ? message : kind);
 
   g_free (message);
-#endif
 }
 
 gboolean
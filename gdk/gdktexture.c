@@ -57,6 +57,7 @@
 #include "gdkpaintable.h"
 #include "gdksnapshot.h"
 #include "gdktexturedownloaderprivate.h"
+#include "gdktiledtextureprivate.h"
 
 #include <glib/gi18n-lib.h>
 #include <graphene.h>
@@ -656,20 +657,50 @@ gdk_texture_can_load (GBytes *bytes)
          gdk_is_tiff (bytes);
 }
 
+/* The tiled loaders only look at the header, make sure that
+ * broken files still fail to load */
+static GdkTexture *
+gdk_texture_validate_tiled (GdkTexture  *texture,
+                            GError     **error)
+{
+  if (!gdk_tiled_texture_validate (GDK_TILED_TEXTURE (texture), error))
+    {
+      g_object_unref (texture);
+      return NULL;
+    }
+
+  return texture;
+}
+
 static GdkTexture *
 gdk_texture_new_from_bytes_internal (GBytes  *bytes,
                                      GError **error)
 {
+  GdkTexture *texture;
+
+  /* Huge images get decoded on demand, see GdkTiledTexture */
   if (gdk_is_png (bytes))
     {
+      texture = gdk_load_png_tiled (bytes);
+      if (texture)
+        return gdk_texture_validate_tiled (texture, error);
+
       return gdk_load_png (bytes, NULL, error);
     }
   else if (gdk_is_jpeg (bytes))
     {
+      texture = gdk_load_jpeg_tiled (bytes);
+      if (texture)
+        return gdk_texture_validate_tiled (texture, error);
+
       return gdk_load_jpeg (bytes, error);
     }
   else if (gdk_is_tiff (bytes))
     {
+      texture = gdk_load_tiff_tiled (bytes);
+      if (texture)
+        return gdk_texture_validate_tiled (texture, error);
+
       return gdk_load_tiff (bytes, error);
     }
   else
@@ -977,6 +1008,59 @@ gdk_texture_set_diff (GdkTexture     *self,
   g_mutex_unlock (&self->chain->lock);
 }
 
+#define MAX_ANCESTORS 16
+
+/*< private >
+ * gdk_texture_find_ancestor:
+ * @self: a texture
+ * @func: the function to call for each ancestor
+ * @user_data: data to pass to @func
+ * @diff: the region to add the difference to
+ *
+ * Calls @func for the known ancestors of @self, most recent first,
+ * until it returns %TRUE. The difference between @self and that
+ * ancestor is then added to @diff.
+ *
+ * @func is called with the lock of the texture chain held, so it
+ * must not call any of the texture diff functions. The ancestor
+ * is guaranteed to stay alive while @func runs.
+ *
+ * Returns: %TRUE if @func returned %TRUE for an ancestor
+ */
+gboolean
+gdk_texture_find_ancestor (GdkTexture             *self,
+                           GdkTextureAncestorFunc  func,
+                           gpointer                user_data,
+                           cairo_region_t         *diff)
+{
+  GdkTextureChain *chain;
+  GdkTexture *texture;
+  gboolean found = FALSE;
+  guint i;
+
+  chain = g_atomic_pointer_get (&self->chain);
+  if (chain == NULL)
+    return FALSE;
+
+  g_mutex_lock (&chain->lock);
+
+  for (texture = self->previous_texture, i = 0;
+       texture != NULL && i < MAX_ANCESTORS;
+       texture = texture->previous_texture, i++)
+    {
+      if (func (texture, user_data))
+        {
+          gdk_texture_diff_from_known_ancestor (self, texture, diff);
+          found = TRUE;
+          break;
+        }
+    }
+
+  g_mutex_unlock (&chain->lock);
+
+  return found;
+}
+
 cairo_surface_t *
 gdk_texture_download_surface (GdkTexture    *texture,
                               GdkColorState *color_state)
@@ -36,6 +36,7 @@
 #include "gdktexturedownloaderprivate.h"
 
 #include "gdkcolorstateprivate.h"
+#include "gdkgltextureprivate.h"
 #include "gdkmemoryformatprivate.h"
 #include "gdkmemorytextureprivate.h"
 #include "gdktextureprivate.h"
@@ -310,6 +311,24 @@ gdk_texture_downloader_download_bytes_layout (const GdkTextureDownloader *self,
     }
 }
 
+static GBytes *
+gdk_texture_downloader_strip_offset (GBytes                *bytes,
+                                     const GdkMemoryLayout *layout,
+                                     gsize                 *out_stride)
+{
+  if (layout->planes[0].offset)
+    {
+      GBytes *tmp = g_bytes_new_from_bytes (bytes,
+                                            layout->planes[0].offset,
+                                            g_bytes_get_size (bytes) - layout->planes[0].offset);
+      g_bytes_unref (bytes);
+      bytes = tmp;
+    }
+
+  *out_stride = layout->planes[0].stride;
+  return bytes;
+}
+
 /**
  * gdk_texture_downloader_download_bytes:
  * @self: the downloader
@@ -343,17 +362,7 @@ gdk_texture_downloader_download_bytes (const GdkTextureDownloader *self,
 
   bytes = gdk_texture_downloader_download_bytes_layout (self, &layout);
 
-  if (layout.planes[0].offset)
-    {
-      GBytes *tmp = g_bytes_new_from_bytes (bytes,
-                                            layout.planes[0].offset,
-                                            g_bytes_get_size (bytes) - layout.planes[0].offset);
-      g_bytes_unref (bytes);
-      bytes = tmp;
-    }
-
-  *out_stride = layout.planes[0].stride;
-  return bytes;
+  return gdk_texture_downloader_strip_offset (bytes, &layout, out_stride);
 }
 
 /**
@@ -403,3 +412,184 @@ gdk_texture_downloader_download_bytes_with_planes (const GdkTextureDownloader *s
   return bytes;
 }
 
+
+typedef struct _DownloadBytes DownloadBytes;
+
+struct _DownloadBytes
+{
+  GdkTextureDownloader downloader;
+  GdkMemoryLayout layout;
+  /* TRUE if the texture's bytes must not be handed out */
+  gboolean copy;
+};
+
+static void
+download_bytes_free (gpointer data)
+{
+  DownloadBytes *download = data;
+
+  gdk_texture_downloader_finish (&download->downloader);
+  g_free (download);
+}
+
+static void
+download_bytes_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+  DownloadBytes *download = task_data;
+  GdkTexture *texture = download->downloader.texture;
+  GBytes *bytes;
+
+  if (download->copy)
+    {
+      guchar *data;
+
+      gdk_memory_layout_init (&download->layout,
+                              download->downloader.format,
+                              texture->width,
+                              texture->height,
+                              1);
+      data = g_malloc (download->layout.size);
+      gdk_texture_downloader_download_into_layout (&download->downloader, data, &download->layout);
+      bytes = g_bytes_new_take (data, download->layout.size);
+    }
+  else
+    {
+      bytes = gdk_texture_downloader_download_bytes_layout (&download->downloader, &download->layout);
+    }
+
+  g_task_return_pointer (task, bytes, (GDestroyNotify) g_bytes_unref);
+}
+
+static void
+gl_texture_downloaded (GObject      *source,
+                       GAsyncResult *result,
+                       gpointer      data)
+{
+  GTask *task = data;
+  DownloadBytes *download = g_task_get_task_data (task);
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = gdk_gl_texture_download_finish (GDK_GL_TEXTURE (source), result, &error);
+  if (texture)
+    {
+      /* The texture's bytes are a mapped GL buffer, so they are
+       * converted or copied in the thread */
+      gdk_texture_downloader_set_texture (&download->downloader, texture);
+      download->copy = TRUE;
+      g_object_unref (texture);
+    }
+  else if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+  else
+    {
+      /* fall back to a regular download in the thread */
+      g_clear_error (&error);
+    }
+
+  g_task_run_in_thread (task, download_bytes_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gdk_texture_downloader_download_bytes_async:
+ * @self: the downloader
+ * @cancellable: (nullable): a `GCancellable`
+ * @callback: (scope async): callback to call when the download is done
+ * @user_data: data for @callback
+ *
+ * Downloads the given texture pixels into a `GBytes` without
+ * blocking the calling thread.
+ *
+ * GL textures are copied into a buffer on the GPU and only read
+ * once the GPU is done with them. Converting the pixels to the
+ * requested format and color state happens in a thread.
+ *
+ * The settings of @self are used at the time of the call, so
+ * @self can be changed while the download is running. It must
+ * not be freed before the download was finished with
+ * [method@Gdk.TextureDownloader.download_bytes_finish], which
+ * needs it.
+ *
+ * This function cannot be used with a multiplanar format.
+ *
+ * Since: 4.20
+ **/
+void
+gdk_texture_downloader_download_bytes_async (const GdkTextureDownloader *self,
+                                             GCancellable               *cancellable,
+                                             GAsyncReadyCallback         callback,
+                                             gpointer                    user_data)
+{
+  DownloadBytes *download;
+  GTask *task;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (gdk_memory_format_get_n_planes (self->format) == 1);
+
+  download = g_new0 (DownloadBytes, 1);
+  gdk_texture_downloader_init (&download->downloader, self->texture);
+  gdk_texture_downloader_set_format (&download->downloader, self->format);
+  gdk_texture_downloader_set_color_state (&download->downloader, self->color_state);
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_texture_downloader_download_bytes_async);
+  g_task_set_task_data (task, download, download_bytes_free);
+
+  if (GDK_IS_GL_TEXTURE (self->texture))
+    {
+      gdk_gl_texture_download_async (GDK_GL_TEXTURE (self->texture),
+                                     cancellable,
+                                     gl_texture_downloaded,
+                                     task);
+      return;
+    }
+
+  g_task_run_in_thread (task, download_bytes_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gdk_texture_downloader_download_bytes_finish:
+ * @self: the downloader that the download was started with
+ * @result: the `GAsyncResult`
+ * @out_stride: (out): The stride of the resulting data in bytes
+ * @error: return location for an error
+ *
+ * Finishes a download started with
+ * [method@Gdk.TextureDownloader.download_bytes_async].
+ *
+ * Returns: (transfer full) (nullable): The downloaded pixels
+ *
+ * Since: 4.20
+ **/
+GBytes *
+gdk_texture_downloader_download_bytes_finish (const GdkTextureDownloader  *self,
+                                              GAsyncResult                *result,
+                                              gsize                       *out_stride,
+                                              GError                     **error)
+{
+  DownloadBytes *download;
+  GBytes *bytes;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_texture_downloader_download_bytes_async, NULL);
+  g_return_val_if_fail (out_stride != NULL, NULL);
+
+  bytes = g_task_propagate_pointer (G_TASK (result), error);
+  if (bytes == NULL)
+    return NULL;
+
+  download = g_task_get_task_data (G_TASK (result));
+
+  return gdk_texture_downloader_strip_offset (bytes, &download->layout, out_stride);
+}
@@ -74,6 +74,14 @@ void                    gdk_texture_set_diff            (GdkTexture
                                                          GdkTexture             *previous,
                                                          cairo_region_t         *diff);
 
+typedef gboolean     (* GdkTextureAncestorFunc)         (GdkTexture             *ancestor,
+                                                         gpointer                user_data);
+
+gboolean                gdk_texture_find_ancestor       (GdkTexture             *self,
+                                                         GdkTextureAncestorFunc  func,
+                                                         gpointer                user_data,
+                                                         cairo_region_t         *diff);
+
 gboolean                gdk_texture_set_render_data     (GdkTexture             *self,
                                                          gpointer                key,
                                                          gpointer                data,
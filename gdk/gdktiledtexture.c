@@ -0,0 +1,456 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdktiledtextureprivate.h"
+
+#include "gdkmemoryformatprivate.h"
+#include "gdkmemorytextureprivate.h"
+#include "gdkprofilerprivate.h"
+
+#include <string.h>
+
+/* GdkTiledTexture:
+ *
+ * A texture for huge images that keeps the encoded file around and
+ * decodes it on demand.
+ *
+ * Renderers that know about it (the GPU renderers, via their tile
+ * cache) ask for the visible tiles at the level of detail they need
+ * with gdk_tiled_texture_decode(), so the full image never needs to
+ * exist in memory. Everybody else goes through the download vfunc,
+ * which decodes the whole image. That result is kept, as those users,
+ * like the Cairo renderer, tend to download the texture repeatedly.
+ *
+ * Loaders call gdk_tiled_texture_validate() before handing out the
+ * texture, so broken files still fail to load. Should decoding fail
+ * later anyway, the failed areas are remembered, so a renderer that
+ * asks for them every frame doesn't decode them again, and the
+ * failure is only reported once.
+ */
+
+struct _GdkTiledTexture
+{
+  GdkTexture parent_instance;
+
+  GMutex lock;
+  const GdkTileDecoder *decoder;
+  gpointer data;
+  GdkTexture *full; /* the whole image, once it was downloaded */
+  GArray *failed; /* FailedArea, for the decodes that failed */
+  GError *error; /* the error of the first one */
+};
+
+typedef struct
+{
+  cairo_rectangle_int_t area;
+  guint lod_level;
+} FailedArea;
+
+struct _GdkTiledTextureClass
+{
+  GdkTextureClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkTiledTexture, gdk_tiled_texture, GDK_TYPE_TEXTURE)
+
+static void
+gdk_tiled_texture_finalize (GObject *object)
+{
+  GdkTiledTexture *self = GDK_TILED_TEXTURE (object);
+
+  self->decoder->free (self->data);
+  g_clear_object (&self->full);
+  g_clear_pointer (&self->failed, g_array_unref);
+  g_clear_error (&self->error);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gdk_tiled_texture_parent_class)->finalize (object);
+}
+
+static void
+gdk_tiled_texture_download (GdkTexture            *texture,
+                            guchar                *data,
+                            const GdkMemoryLayout *layout,
+                            GdkColorState         *color_state)
+{
+  GdkTiledTexture *self = GDK_TILED_TEXTURE (texture);
+  GdkTexture *decoded;
+  GError *error = NULL;
+
+  g_mutex_lock (&self->lock);
+  decoded = self->full ? g_object_ref (self->full) : NULL;
+  g_mutex_unlock (&self->lock);
+
+  if (decoded == NULL)
+    {
+      decoded = gdk_tiled_texture_decode (self,
+                                          &(cairo_rectangle_int_t) { 0, 0, texture->width, texture->height },
+                                          0,
+                                          FALSE,
+                                          &error);
+      if (decoded == NULL)
+        {
+          /* gdk_tiled_texture_decode() warned already */
+          g_error_free (error);
+          memset (data, 0, layout->size);
+          return;
+        }
+
+      g_mutex_lock (&self->lock);
+      if (self->full == NULL)
+        self->full = g_object_ref (decoded);
+      g_mutex_unlock (&self->lock);
+    }
+
+  gdk_texture_do_download (decoded, data, layout, color_state);
+  g_object_unref (decoded);
+}
+
+static void
+gdk_tiled_texture_class_init (GdkTiledTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gdk_tiled_texture_download;
+
+  gobject_class->finalize = gdk_tiled_texture_finalize;
+}
+
+static void
+gdk_tiled_texture_init (GdkTiledTexture *self)
+{
+  g_mutex_init (&self->lock);
+}
+
+gboolean
+gdk_tiled_texture_should_tile (gsize width,
+                               gsize height)
+{
+  return width * height >= GDK_TILED_TEXTURE_MIN_PIXELS;
+}
+
+/*<private>
+ * gdk_tiled_texture_new:
+ * @width: width of the image
+ * @height: height of the image
+ * @format: format of the image at full resolution
+ * @color_state: color state of the image
+ * @decoder: the functions to decode the image with
+ * @data: (transfer full): data passed to @decoder
+ *
+ * Creates a texture that calls @decoder whenever pixel data
+ * is needed.
+ *
+ * Returns: (transfer full): a new texture
+ */
+GdkTexture *
+gdk_tiled_texture_new (int                   width,
+                       int                   height,
+                       GdkMemoryFormat       format,
+                       GdkColorState        *color_state,
+                       const GdkTileDecoder *decoder,
+                       gpointer              data)
+{
+  GdkTiledTexture *self;
+
+  self = g_object_new (GDK_TYPE_TILED_TEXTURE,
+                       "width", width,
+                       "height", height,
+                       "color-state", color_state,
+                       NULL);
+
+  GDK_TEXTURE (self)->format = format;
+  self->decoder = decoder;
+  self->data = data;
+
+  return GDK_TEXTURE (self);
+}
+
+/*<private>
+ * gdk_tiled_texture_validate:
+ * @self: a tiled texture
+ * @error: return location for an error
+ *
+ * Checks that the whole image can be decoded, so that loading a
+ * broken file fails like it does for images that are not tiled.
+ *
+ * This decodes the image at 1/8 of its size, which costs about as
+ * much as skimming through the file, but doesn't need the memory
+ * for the full image.
+ *
+ * Returns: %TRUE if the image can be decoded
+ */
+gboolean
+gdk_tiled_texture_validate (GdkTiledTexture  *self,
+                            GError          **error)
+{
+  GdkTexture *texture = GDK_TEXTURE (self);
+  GdkTexture *decoded;
+
+  /* Not using gdk_tiled_texture_decode(), the error is reported
+   * to the caller and doesn't need a warning */
+  g_mutex_lock (&self->lock);
+  decoded = self->decoder->decode (self->data,
+                                   &(cairo_rectangle_int_t) { 0, 0, texture->width, texture->height },
+                                   3,
+                                   FALSE,
+                                   error);
+  g_mutex_unlock (&self->lock);
+
+  if (decoded == NULL)
+    return FALSE;
+
+  g_object_unref (decoded);
+
+  return TRUE;
+}
+
+static gboolean
+gdk_tiled_texture_has_failed (GdkTiledTexture             *self,
+                              const cairo_rectangle_int_t *area,
+                              guint                        lod_level)
+{
+  guint i;
+
+  if (self->failed == NULL)
+    return FALSE;
+
+  for (i = 0; i < self->failed->len; i++)
+    {
+      const FailedArea *failed = &g_array_index (self->failed, FailedArea, i);
+
+      if (failed->lod_level == lod_level &&
+          failed->area.x == area->x &&
+          failed->area.y == area->y &&
+          failed->area.width == area->width &&
+          failed->area.height == area->height)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*<private>
+ * gdk_tiled_texture_decode:
+ * @self: a tiled texture
+ * @area: the area to decode, in image coordinates
+ * @lod_level: how often to halve the size of the result
+ * @linear: %TRUE to average pixels when scaling down, %FALSE to
+ *   pick one
+ * @error: return location for an error
+ *
+ * Decodes a part of the image. The result is @area scaled down by
+ * 2^@lod_level, rounding up.
+ *
+ * If decoding fails, a warning is printed the first time, and asking
+ * for the same area again fails right away.
+ *
+ * This function is threadsafe.
+ *
+ * Returns: (transfer full) (nullable): a texture with the pixels
+ *   or %NULL if the image could not be decoded
+ */
+GdkTexture *
+gdk_tiled_texture_decode (GdkTiledTexture             *self,
+                          const cairo_rectangle_int_t *area,
+                          guint                        lod_level,
+                          gboolean                     linear,
+                          GError                     **error)
+{
+  GdkTexture *result;
+  GError *local_error = NULL;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  g_return_val_if_fail (area->x >= 0 && area->y >= 0, NULL);
+  g_return_val_if_fail (area->x + area->width <= GDK_TEXTURE (self)->width, NULL);
+  g_return_val_if_fail (area->y + area->height <= GDK_TEXTURE (self)->height, NULL);
+
+  g_mutex_lock (&self->lock);
+
+  if (gdk_tiled_texture_has_failed (self, area, lod_level))
+    {
+      g_propagate_error (error, g_error_copy (self->error));
+      g_mutex_unlock (&self->lock);
+      return NULL;
+    }
+
+  result = self->decoder->decode (self->data, area, lod_level, linear, &local_error);
+  if (result == NULL)
+    {
+      if (self->failed == NULL)
+        self->failed = g_array_new (FALSE, FALSE, sizeof (FailedArea));
+      g_array_append_val (self->failed, ((FailedArea) { *area, lod_level }));
+
+      if (self->error == NULL)
+        {
+          g_warning ("Failed to decode %dx%d image: %s",
+                     GDK_TEXTURE (self)->width, GDK_TEXTURE (self)->height,
+                     local_error->message);
+          self->error = g_error_copy (local_error);
+        }
+
+      g_propagate_error (error, local_error);
+    }
+
+  g_mutex_unlock (&self->lock);
+
+  g_assert (result == NULL ||
+            gdk_texture_get_width (result) == (area->width + (1 << lod_level) - 1) >> lod_level);
+  g_assert (result == NULL ||
+            gdk_texture_get_height (result) == (area->height + (1 << lod_level) - 1) >> lod_level);
+
+  gdk_profiler_end_markf (before, "Decode tile", "%dx%d at %d,%d, lod %u",
+                          area->width, area->height, area->x, area->y, lod_level);
+
+  return result;
+}
+
+/* {{{ GdkTileBuilder */
+
+/* Collects rows at full resolution and scales them down as soon as
+ * enough rows for one row of the result have been pushed, so that
+ * decoders never need memory for more than 2^lod_level source rows.
+ */
+struct _GdkTileBuilder
+{
+  GdkMemoryLayout layout;
+  guchar *data;
+
+  GdkMemoryLayout band_layout;
+  guchar *band;
+
+  guint lod_level;
+  gboolean linear;
+  gsize src_height;
+  gsize row;
+};
+
+GdkTileBuilder *
+gdk_tile_builder_new (GdkMemoryFormat format,
+                      gsize           width,
+                      gsize           height,
+                      guint           lod_level,
+                      gboolean        linear)
+{
+  GdkTileBuilder *self;
+  GdkMemoryFormat result_format;
+  gsize n = 1 << lod_level;
+
+  self = g_new0 (GdkTileBuilder, 1);
+
+  self->lod_level = lod_level;
+  self->linear = linear;
+  self->src_height = height;
+
+  result_format = lod_level == 0 ? format : gdk_memory_format_get_mipmap_format (format);
+  gdk_memory_layout_init (&self->layout,
+                          result_format,
+                          (width + n - 1) >> lod_level,
+                          (height + n - 1) >> lod_level,
+                          gdk_memory_format_alignment (result_format));
+  self->data = g_malloc (self->layout.size);
+
+  if (lod_level > 0)
+    {
+      gdk_memory_layout_init (&self->band_layout,
+                              format,
+                              width,
+                              n,
+                              gdk_memory_format_alignment (format));
+      self->band = g_malloc (self->band_layout.size);
+    }
+
+  return self;
+}
+
+void
+gdk_tile_builder_free (GdkTileBuilder *self)
+{
+  g_free (self->band);
+  g_free (self->data);
+  g_free (self);
+}
+
+/* Returns the memory for the next row, in the format and width
+ * that the builder was created with.
+ */
+guchar *
+gdk_tile_builder_get_row (GdkTileBuilder *self)
+{
+  g_assert (self->row < self->src_height);
+
+  if (self->lod_level == 0)
+    return self->data + gdk_memory_layout_offset (&self->layout, 0, 0, self->row);
+  else
+    return self->band + gdk_memory_layout_offset (&self->band_layout, 0, 0, self->row & ((1 << self->lod_level) - 1));
+}
+
+void
+gdk_tile_builder_push_row (GdkTileBuilder *self)
+{
+  GdkMemoryLayout src_layout, dest_layout;
+  gsize n_rows;
+
+  self->row++;
+
+  if (self->lod_level == 0)
+    return;
+
+  if ((self->row & ((1 << self->lod_level) - 1)) != 0 &&
+      self->row != self->src_height)
+    return;
+
+  n_rows = ((self->row - 1) & ((1 << self->lod_level) - 1)) + 1;
+  gdk_memory_layout_init_sublayout (&src_layout,
+                                    &self->band_layout,
+                                    &(cairo_rectangle_int_t) { 0, 0, self->band_layout.width, n_rows });
+  gdk_memory_layout_init_sublayout (&dest_layout,
+                                    &self->layout,
+                                    &(cairo_rectangle_int_t) { 0, (self->row - 1) >> self->lod_level, self->layout.width, 1 });
+
+  gdk_memory_mipmap (self->data,
+                     &dest_layout,
+                     self->band,
+                     &src_layout,
+                     self->lod_level,
+                     self->linear);
+}
+
+GdkTexture *
+gdk_tile_builder_free_to_texture (GdkTileBuilder *self,
+                                  GdkColorState  *color_state)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+
+  g_assert (self->row == self->src_height);
+
+  bytes = g_bytes_new_take (g_steal_pointer (&self->data), self->layout.size);
+  texture = gdk_memory_texture_new_from_layout (bytes, &self->layout, color_state, NULL, NULL);
+  g_bytes_unref (bytes);
+
+  gdk_tile_builder_free (self);
+
+  return texture;
+}
+
+/* }}} */
+
+/* vim:set foldmethod=marker: */
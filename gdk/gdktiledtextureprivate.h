@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gdktextureprivate.h"
+
+G_BEGIN_DECLS
+
+#define GDK_TYPE_TILED_TEXTURE              (gdk_tiled_texture_get_type ())
+#define GDK_TILED_TEXTURE(object)           (G_TYPE_CHECK_INSTANCE_CAST ((object), GDK_TYPE_TILED_TEXTURE, GdkTiledTexture))
+#define GDK_IS_TILED_TEXTURE(object)        (G_TYPE_CHECK_INSTANCE_TYPE ((object), GDK_TYPE_TILED_TEXTURE))
+
+typedef struct _GdkTiledTexture GdkTiledTexture;
+typedef struct _GdkTiledTextureClass GdkTiledTextureClass;
+typedef struct _GdkTileDecoder GdkTileDecoder;
+typedef struct _GdkTileBuilder GdkTileBuilder;
+
+/* Images with at least this many pixels are not decoded at load time,
+ * but on demand, in the parts and at the level of detail that the
+ * renderer asks for.
+ */
+#define GDK_TILED_TEXTURE_MIN_PIXELS (32 * 1024 * 1024)
+
+struct _GdkTileDecoder
+{
+  /* Decode @area (in image coordinates) scaled down by 2^@lod_level.
+   * The result must be (@area->width + 2^@lod_level - 1) >> @lod_level
+   * pixels wide and the same for the height.
+   * Called with the texture's decoder lock held.
+   */
+  GdkTexture *          (* decode)                      (gpointer                        data,
+                                                         const cairo_rectangle_int_t    *area,
+                                                         guint                           lod_level,
+                                                         gboolean                        linear,
+                                                         GError                        **error);
+  void                  (* free)                        (gpointer                        data);
+};
+
+GType                   gdk_tiled_texture_get_type      (void) G_GNUC_CONST;
+
+gboolean                gdk_tiled_texture_should_tile   (gsize                           width,
+                                                         gsize                           height);
+
+GdkTexture *            gdk_tiled_texture_new           (int                             width,
+                                                         int                             height,
+                                                         GdkMemoryFormat                 format,
+                                                         GdkColorState                  *color_state,
+                                                         const GdkTileDecoder           *decoder,
+                                                         gpointer                        data);
+
+gboolean                gdk_tiled_texture_validate      (GdkTiledTexture                *self,
+                                                         GError                        **error);
+
+GdkTexture *            gdk_tiled_texture_decode        (GdkTiledTexture                *self,
+                                                         const cairo_rectangle_int_t    *area,
+                                                         guint                           lod_level,
+                                                         gboolean                        linear,
+                                                         GError                        **error);
+
+/* Helper for decoders that produce rows from top to bottom */
+GdkTileBuilder *        gdk_tile_builder_new            (GdkMemoryFormat                 format,
+                                                         gsize                           width,
+                                                         gsize                           height,
+                                                         guint                           lod_level,
+                                                         gboolean                        linear);
+void                    gdk_tile_builder_free           (GdkTileBuilder                 *self);
+guchar *                gdk_tile_builder_get_row        (GdkTileBuilder                 *self);
+void                    gdk_tile_builder_push_row       (GdkTileBuilder                 *self);
+GdkTexture *            gdk_tile_builder_free_to_texture (GdkTileBuilder                *self,
+                                                          GdkColorState                 *color_state);
+
+G_END_DECLS
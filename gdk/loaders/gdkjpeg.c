@@ -26,6 +26,7 @@
 #include "gdktexturedownloaderprivate.h"
 #include "gdkmemorytexturebuilder.h"
 #include "gdkcolorstateprivate.h"
+#include "gdktiledtextureprivate.h"
 
 #include "gdkprofilerprivate.h"
 
@@ -114,9 +115,208 @@ convert_cmyk_to_rgba (guchar *data,
     }
 }
 
+/* }}} */
+/* {{{ Tiled loading */
+
+typedef struct
+{
+  GBytes *bytes;
+} JpegTileData;
+
+static void
+jpeg_tile_data_free (gpointer data)
+{
+  JpegTileData *tile_data = data;
+
+  g_bytes_unref (tile_data->bytes);
+  g_free (tile_data);
+}
+
+static gboolean
+jpeg_get_format (J_COLOR_SPACE    color_space,
+                 GdkMemoryFormat *format,
+                 gsize           *bpp)
+{
+  switch ((int) color_space)
+    {
+    case JCS_GRAYSCALE:
+      *format = GDK_MEMORY_G8;
+      *bpp = 1;
+      return TRUE;
+    case JCS_RGB:
+      *format = GDK_MEMORY_R8G8B8;
+      *bpp = 3;
+      return TRUE;
+    case JCS_CMYK:
+      *format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      *bpp = 4;
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+/* The IDCT can scale by 1/2, 1/4 and 1/8 for free, and libjpeg-turbo
+ * can skip rows and columns outside of the area. Whatever scaling is
+ * left is done by the tile builder.
+ */
+static GdkTexture *
+jpeg_decode_tile (gpointer                      data,
+                  const cairo_rectangle_int_t  *area,
+                  guint                         lod_level,
+                  gboolean                      linear,
+                  GError                      **error)
+{
+  JpegTileData *tile_data = data;
+  struct jpeg_decompress_struct info;
+  struct error_handler_data jerr;
+  GdkTileBuilder *builder = NULL;
+  unsigned char *row[1] = { NULL, };
+  JDIMENSION x0, y0, x1, y1, crop_x, crop_width, y;
+  GdkMemoryFormat format;
+  guint scale_level;
+  gsize bpp;
+
+  info.err = jpeg_std_error (&jerr.pub);
+  jerr.pub.error_exit = fatal_error_handler;
+  jerr.pub.output_message = output_message_handler;
+  jerr.error = error;
+
+  if (sigsetjmp (jerr.setjmp_buffer, 1))
+    {
+      g_free (row[0]);
+      g_clear_pointer (&builder, gdk_tile_builder_free);
+      jpeg_destroy_decompress (&info);
+      return NULL;
+    }
+
+  jpeg_create_decompress (&info);
+  info.mem->max_memory_to_use = 1024 * 1024 * 1024;
+  jpeg_mem_src (&info,
+                g_bytes_get_data (tile_data->bytes, NULL),
+                g_bytes_get_size (tile_data->bytes));
+  jpeg_read_header (&info, TRUE);
+
+  if (!jpeg_get_format (info.out_color_space, &format, &bpp))
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                   _("Unsupported JPEG colorspace (%d)"), info.out_color_space);
+      jpeg_destroy_decompress (&info);
+      return NULL;
+    }
+
+  /* Only scale in the decoder when the area is aligned, otherwise
+   * rounding would give us a result of the wrong size */
+  if (area->x % (1 << lod_level) == 0 && area->y % (1 << lod_level) == 0)
+    scale_level = MIN (lod_level, 3);
+  else
+    scale_level = 0;
+
+  info.scale_num = 1;
+  info.scale_denom = 1 << scale_level;
+  jpeg_start_decompress (&info);
+
+  x0 = area->x >> scale_level;
+  y0 = area->y >> scale_level;
+  x1 = MIN ((area->x + area->width + (1 << scale_level) - 1) >> scale_level, info.output_width);
+  y1 = MIN ((area->y + area->height + (1 << scale_level) - 1) >> scale_level, info.output_height);
+
+#if LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+  crop_x = x0;
+  crop_width = x1 - x0;
+  jpeg_crop_scanline (&info, &crop_x, &crop_width);
+  if (y0 > 0)
+    jpeg_skip_scanlines (&info, y0);
+#else
+  crop_x = 0;
+  crop_width = info.output_width;
+#endif
+
+  row[0] = g_malloc (crop_width * bpp);
+  while (info.output_scanline < y0)
+    jpeg_read_scanlines (&info, row, 1);
+
+  builder = gdk_tile_builder_new (format, x1 - x0, y1 - y0, lod_level - scale_level, linear);
+
+  for (y = y0; y < y1; y++)
+    {
+      guchar *dest = gdk_tile_builder_get_row (builder);
+
+      jpeg_read_scanlines (&info, row, 1);
+      memcpy (dest, row[0] + (x0 - crop_x) * bpp, (x1 - x0) * bpp);
+      if (info.out_color_space == JCS_CMYK)
+        convert_cmyk_to_rgba (dest, x1 - x0, 1, 0);
+
+      gdk_tile_builder_push_row (builder);
+    }
+
+  g_free (row[0]);
+  jpeg_destroy_decompress (&info);
+
+  return gdk_tile_builder_free_to_texture (builder, GDK_COLOR_STATE_SRGB);
+}
+
+static const GdkTileDecoder jpeg_tile_decoder = {
+  jpeg_decode_tile,
+  jpeg_tile_data_free,
+};
+
 /* }}} */
 /* {{{ Public API */
 
+/* Returns a texture that decodes the image on demand if the image
+ * is big enough to make that worthwhile, %NULL otherwise.
+ */
+GdkTexture *
+gdk_load_jpeg_tiled (GBytes *input_bytes)
+{
+  struct jpeg_decompress_struct info;
+  struct error_handler_data jerr;
+  JpegTileData *tile_data;
+  GdkMemoryFormat format;
+  guint width, height;
+  gsize bpp;
+
+  info.err = jpeg_std_error (&jerr.pub);
+  jerr.pub.error_exit = fatal_error_handler;
+  jerr.pub.output_message = output_message_handler;
+  jerr.error = NULL;
+
+  if (sigsetjmp (jerr.setjmp_buffer, 1))
+    {
+      jpeg_destroy_decompress (&info);
+      return NULL;
+    }
+
+  jpeg_create_decompress (&info);
+  jpeg_mem_src (&info,
+                g_bytes_get_data (input_bytes, NULL),
+                g_bytes_get_size (input_bytes));
+  jpeg_read_header (&info, TRUE);
+
+  width = info.image_width;
+  height = info.image_height;
+
+  if (!gdk_tiled_texture_should_tile (width, height) ||
+      !jpeg_get_format (info.out_color_space, &format, &bpp))
+    {
+      jpeg_destroy_decompress (&info);
+      return NULL;
+    }
+
+  jpeg_destroy_decompress (&info);
+
+  tile_data = g_new (JpegTileData, 1);
+  tile_data->bytes = g_bytes_ref (input_bytes);
+
+  return gdk_tiled_texture_new (width, height,
+                                format,
+                                GDK_COLOR_STATE_SRGB,
+                                &jpeg_tile_decoder,
+                                tile_data);
+}
+
 GdkTexture *
 gdk_load_jpeg (GBytes  *input_bytes,
                GError **error)
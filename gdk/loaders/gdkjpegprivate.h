@@ -24,6 +24,7 @@
 
 GdkTexture *gdk_load_jpeg         (GBytes           *bytes,
                                    GError          **error);
+GdkTexture *gdk_load_jpeg_tiled   (GBytes           *bytes);
 
 GBytes     *gdk_save_jpeg         (GdkTexture     *texture);
 
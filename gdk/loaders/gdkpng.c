@@ -23,8 +23,10 @@
 #include "gdkcolorstateprivate.h"
 #include "gdkmemoryformatprivate.h"
 #include "gdkmemorytextureprivate.h"
+#include "gdkparalleltaskprivate.h"
 #include "gdkprofilerprivate.h"
 #include "gdktexturedownloaderprivate.h"
+#include "gdktiledtextureprivate.h"
 
 #include <png.h>
 #include <stdio.h>
@@ -294,64 +296,23 @@ gdk_png_set_color_state (png_struct    *png,
 }
 
 /* }}} */
-/* {{{ Public API */
+/* {{{ Reading */
 
-GdkTexture *
-gdk_load_png (GBytes      *bytes,
-              GHashTable  *options,
-              GError     **error)
+/* Reads the header and sets up the transformations to get the image
+ * data in a GdkMemoryFormat. Must be called with the png's jmpbuf set.
+ */
+static gboolean
+gdk_png_setup_read (png_struct       *png,
+                    png_info         *info,
+                    guint            *out_width,
+                    guint            *out_height,
+                    GdkMemoryFormat  *out_format,
+                    GError          **error)
 {
-  png_io io;
-  png_struct *png = NULL;
-  png_info *info;
-  png_textp text;
-  int num_texts;
   guint width, height;
-  gsize i;
   int depth, color_type;
   int interlace;
   GdkMemoryFormat format;
-  GdkMemoryLayout layout;
-  guchar *buffer = NULL;
-  guchar **row_pointers = NULL;
-  GBytes *out_bytes;
-  GdkColorState *color_state;
-  GdkTexture *texture;
-#if PNG_LIBPNG_VER < 10645
-  CICPData cicp = { FALSE, };
-#endif
-
-  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
-
-  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
-  io.position = 0;
-
-  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
-                                  error,
-                                  png_simple_error_callback,
-                                  png_simple_warning_callback,
-                                  NULL,
-                                  png_malloc_callback,
-                                  png_free_callback);
-  if (png == NULL)
-    g_error ("Out of memory");
-
-  info = png_create_info_struct (png);
-  if (info == NULL)
-    g_error ("Out of memory");
-
-  png_set_read_fn (png, &io, png_read_func);
-#if PNG_LIBPNG_VER < 10645
-  png_set_read_user_chunk_fn (png, &cicp, png_read_chunk_func);
-#endif
-
-  if (sigsetjmp (png_jmpbuf (png), 1))
-    {
-      g_free (buffer);
-      g_free (row_pointers);
-      png_destroy_read_struct (&png, &info, NULL);
-      return NULL;
-    }
 
   png_read_info (png, info);
 
@@ -384,11 +345,10 @@ gdk_load_png (GBytes      *bytes,
                 &color_type, &interlace, NULL, NULL);
   if (depth != 8 && depth != 16)
     {
-      png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
                    _("Unsupported depth %u in png image"), depth);
-      return NULL;
+      return FALSE;
     }
 
   switch (color_type)
@@ -434,10 +394,860 @@ gdk_load_png (GBytes      *bytes,
         }
       break;
     default:
-      png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
                    _("Unsupported color type %u in png image"), color_type);
+      return FALSE;
+    }
+
+  *out_width = width;
+  *out_height = height;
+  *out_format = format;
+
+  return TRUE;
+}
+
+/* }}} */
+/* {{{ Tiled loading */
+
+/* Png data can only be decoded from the start, so to make decoding
+ * tiles top to bottom cheap, the reader is kept open between calls
+ * and only restarted when going back up. And because the tiles in a
+ * row all need the same rows of the image, the last band of rows is
+ * kept around at full width.
+ */
+typedef struct
+{
+  GBytes *bytes;
+  GdkColorState *color_state;
+  GdkMemoryFormat format;
+  guint width;
+  guint height;
+
+  png_io io;
+  png_struct *png;
+  png_info *info;
+  int next_row;
+
+  GdkTexture *band;
+  int band_y;
+  int band_height;
+  guint band_lod_level;
+  gboolean band_linear;
+} PngTileData;
+
+static void
+png_tile_data_close (PngTileData *tile_data)
+{
+  if (tile_data->png)
+    png_destroy_read_struct (&tile_data->png, &tile_data->info, NULL);
+  tile_data->png = NULL;
+  tile_data->info = NULL;
+}
+
+static void
+png_tile_data_free (gpointer data)
+{
+  PngTileData *tile_data = data;
+
+  png_tile_data_close (tile_data);
+  g_clear_object (&tile_data->band);
+  gdk_color_state_unref (tile_data->color_state);
+  g_bytes_unref (tile_data->bytes);
+  g_free (tile_data);
+}
+
+static gboolean
+png_tile_data_open (PngTileData  *tile_data,
+                    GError      **error)
+{
+  guint width, height;
+  GdkMemoryFormat format;
+
+  tile_data->io.data = (guchar *) g_bytes_get_data (tile_data->bytes, &tile_data->io.size);
+  tile_data->io.position = 0;
+  tile_data->next_row = 0;
+
+  tile_data->png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                             error,
+                                             png_simple_error_callback,
+                                             png_simple_warning_callback,
+                                             NULL,
+                                             png_malloc_callback,
+                                             png_free_callback);
+  if (tile_data->png == NULL)
+    g_error ("Out of memory");
+
+  tile_data->info = png_create_info_struct (tile_data->png);
+  if (tile_data->info == NULL)
+    g_error ("Out of memory");
+
+  png_set_read_fn (tile_data->png, &tile_data->io, png_read_func);
+
+  if (sigsetjmp (png_jmpbuf (tile_data->png), 1))
+    {
+      png_tile_data_close (tile_data);
+      return FALSE;
+    }
+
+  if (!gdk_png_setup_read (tile_data->png, tile_data->info, &width, &height, &format, error))
+    {
+      png_tile_data_close (tile_data);
+      return FALSE;
+    }
+
+  g_assert (width == tile_data->width);
+  g_assert (height == tile_data->height);
+  g_assert (format == tile_data->format);
+
+  return TRUE;
+}
+
+static GdkTexture *
+png_decode_tile (gpointer                      data,
+                 const cairo_rectangle_int_t  *area,
+                 guint                         lod_level,
+                 gboolean                      linear,
+                 GError                      **error)
+{
+  PngTileData *tile_data = data;
+  GdkTileBuilder *builder = NULL;
+  guchar *row = NULL;
+  GdkTexture *result;
+  gboolean use_band;
+  gsize bpp;
+  int y;
+
+  /* The band can only be shared by tiles that start on a pixel
+   * boundary of the scaled down image */
+  use_band = area->x % (1 << lod_level) == 0;
+
+  if (use_band &&
+      tile_data->band != NULL &&
+      tile_data->band_y == area->y &&
+      tile_data->band_height == area->height &&
+      tile_data->band_lod_level == lod_level &&
+      tile_data->band_linear == linear)
+    goto out;
+
+  g_clear_object (&tile_data->band);
+
+  if (tile_data->png && tile_data->next_row > area->y)
+    png_tile_data_close (tile_data);
+
+  if (tile_data->png == NULL &&
+      !png_tile_data_open (tile_data, error))
+    return NULL;
+
+  png_set_error_fn (tile_data->png, error, png_simple_error_callback, png_simple_warning_callback);
+
+  if (sigsetjmp (png_jmpbuf (tile_data->png), 1))
+    {
+      g_free (row);
+      g_clear_pointer (&builder, gdk_tile_builder_free);
+      png_tile_data_close (tile_data);
+      return NULL;
+    }
+
+  bpp = gdk_memory_format_get_plane_block_bytes (tile_data->format, 0);
+  row = g_malloc (png_get_rowbytes (tile_data->png, tile_data->info));
+
+  while (tile_data->next_row < area->y)
+    {
+      png_read_row (tile_data->png, row, NULL);
+      tile_data->next_row++;
+    }
+
+  builder = gdk_tile_builder_new (tile_data->format,
+                                  use_band ? tile_data->width : area->width,
+                                  area->height,
+                                  lod_level,
+                                  linear);
+  for (y = 0; y < area->height; y++)
+    {
+      if (use_band)
+        {
+          png_read_row (tile_data->png, gdk_tile_builder_get_row (builder), NULL);
+        }
+      else
+        {
+          png_read_row (tile_data->png, row, NULL);
+          memcpy (gdk_tile_builder_get_row (builder), row + area->x * bpp, area->width * bpp);
+        }
+      tile_data->next_row++;
+      gdk_tile_builder_push_row (builder);
+    }
+
+  g_free (row);
+
+  if (tile_data->next_row == (int) tile_data->height)
+    png_tile_data_close (tile_data);
+
+  result = gdk_tile_builder_free_to_texture (builder, tile_data->color_state);
+
+  if (!use_band ||
+      (area->x == 0 && area->width == (int) tile_data->width))
+    return result;
+
+  tile_data->band = result;
+  tile_data->band_y = area->y;
+  tile_data->band_height = area->height;
+  tile_data->band_lod_level = lod_level;
+  tile_data->band_linear = linear;
+
+out:
+  return gdk_memory_texture_new_subtexture (GDK_MEMORY_TEXTURE (tile_data->band),
+                                            area->x >> lod_level,
+                                            0,
+                                            (area->width + (1 << lod_level) - 1) >> lod_level,
+                                            gdk_texture_get_height (tile_data->band));
+}
+
+static const GdkTileDecoder png_tile_decoder = {
+  png_decode_tile,
+  png_tile_data_free,
+};
+
+/* }}} */
+/* {{{ Parallel encoding */
+
+/* libpng filters and deflates the image one row at a time on a
+ * single thread, which makes saving large images slow.
+ *
+ * Instead, we split the image into bands of rows and filter and
+ * deflate every band on its own thread. Every band is compressed
+ * as an independent raw deflate stream that ends with a sync flush,
+ * so the streams can simply be concatenated. The Adler-32 checksums
+ * of the bands are combined into the checksum for the zlib stream.
+ *
+ * libpng is still used to write all the other chunks.
+ */
+
+/* Bands must be large compared to the 32kB deflate window,
+ * or the compression ratio suffers */
+#define PNG_BAND_SIZE (256 * 1024)
+#define PNG_IDAT_SIZE (1024 * 1024)
+/* How often to check if a filter is already worse than the best one */
+#define PNG_FILTER_CHUNK 512
+
+#define ADLER_BASE 65521u
+/* largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits */
+#define ADLER_NMAX 5552
+
+typedef struct
+{
+  guchar *data;
+  gsize size;
+  guint32 adler;
+} PngBand;
+
+typedef struct
+{
+  const guchar *data;
+  gsize stride;
+  gsize row_size;
+  gsize bpp;
+  gsize height;
+  gboolean swap;
+  GdkPngCompression compression;
+  gsize rows_per_band;
+  gsize n_bands;
+  PngBand *bands;
+  int bands_done;
+} PngEncoder;
+
+static guint32
+png_adler32 (guint32       adler,
+             const guchar *data,
+             gsize         size)
+{
+  guint32 a = adler & 0xffff;
+  guint32 b = adler >> 16;
+
+  while (size > 0)
+    {
+      gsize i, n = MIN (size, ADLER_NMAX);
+
+      for (i = 0; i < n; i++)
+        {
+          a += data[i];
+          b += a;
+        }
+
+      a %= ADLER_BASE;
+      b %= ADLER_BASE;
+      data += n;
+      size -= n;
+    }
+
+  return (b << 16) | a;
+}
+
+/* Returns the checksum of the concatenation of two blocks of data,
+ * given the checksums of both and the size of the second one.
+ * This is adler32_combine() from zlib. */
+static guint32
+png_adler32_combine (guint32 adler1,
+                     guint32 adler2,
+                     gsize   size2)
+{
+  guint32 rem, sum1, sum2;
+
+  rem = size2 % ADLER_BASE;
+  sum1 = adler1 & 0xffff;
+  sum2 = (rem * sum1) % ADLER_BASE;
+  sum1 += (adler2 & 0xffff) + ADLER_BASE - 1;
+  sum2 += (adler1 >> 16) + (adler2 >> 16) + ADLER_BASE - rem;
+
+  if (sum1 >= ADLER_BASE)
+    sum1 -= ADLER_BASE;
+  if (sum1 >= ADLER_BASE)
+    sum1 -= ADLER_BASE;
+  if (sum2 >= 2 * ADLER_BASE)
+    sum2 -= 2 * ADLER_BASE;
+  if (sum2 >= ADLER_BASE)
+    sum2 -= ADLER_BASE;
+
+  return (sum2 << 16) | sum1;
+}
+
+static inline guint
+png_filter_cost (guchar value)
+{
+  /* The filtered bytes are treated as signed, so
+   * values close to 0 and 255 are both cheap */
+  return value < 128 ? value : 256 - value;
+}
+
+static inline guchar
+png_paeth_predictor (int a,
+                     int b,
+                     int c)
+{
+  int pa = ABS (b - c);
+  int pb = ABS (a - c);
+  int pc = ABS (a + b - 2 * c);
+
+  if (pa <= pb && pa <= pc)
+    return a;
+  else if (pb <= pc)
+    return b;
+  else
+    return c;
+}
+
+#define FILTER_ROW(predict) G_STMT_START { \
+  for (i = 0; i < MIN (bpp, row_size); i++) \
+    { \
+      int a = 0, b = prev[i], c = 0; \
+      (void) a; (void) b; (void) c; \
+      out[i] = row[i] - (guchar) (predict); \
+      cost += png_filter_cost (out[i]); \
+    } \
+  while (i < row_size) \
+    { \
+      gsize end = MIN (i + PNG_FILTER_CHUNK, row_size); \
+      for (; i < end; i++) \
+        { \
+          int a = row[i - bpp], b = prev[i], c = prev[i - bpp]; \
+          (void) a; (void) b; (void) c; \
+          out[i] = row[i] - (guchar) (predict); \
+          cost += png_filter_cost (out[i]); \
+        } \
+      if (cost >= limit) \
+        return cost; \
+    } \
+} G_STMT_END
+
+static gsize
+png_filter_row (guchar        filter,
+                guchar       *out,
+                const guchar *row,
+                const guchar *prev,
+                gsize         row_size,
+                gsize         bpp,
+                gsize         limit)
+{
+  gsize i, cost = 0;
+
+  switch (filter)
+    {
+    case PNG_FILTER_VALUE_NONE:
+      FILTER_ROW (0);
+      break;
+    case PNG_FILTER_VALUE_SUB:
+      FILTER_ROW (a);
+      break;
+    case PNG_FILTER_VALUE_UP:
+      FILTER_ROW (b);
+      break;
+    case PNG_FILTER_VALUE_AVG:
+      FILTER_ROW ((a + b) / 2);
+      break;
+    case PNG_FILTER_VALUE_PAETH:
+      FILTER_ROW (png_paeth_predictor (a, b, c));
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  return cost;
+}
+
+#undef FILTER_ROW
+
+/* Picks the filter for a row with the usual heuristic of
+ * minimizing the sum of the absolute filtered values.
+ *
+ * Filters give up as soon as they are worse than the best
+ * one so far, which is cheap for the common case of one
+ * filter clearly winning.
+ *
+ * Writes the filter type byte, followed by the filtered row,
+ * to @out. @scratch must have room for 2 rows.
+ */
+static void
+png_filter_row_adaptive (PngEncoder   *encoder,
+                         guchar       *out,
+                         const guchar *row,
+                         const guchar *prev,
+                         guchar       *scratch)
+{
+  static const guchar filters[] = {
+    PNG_FILTER_VALUE_NONE, PNG_FILTER_VALUE_SUB, PNG_FILTER_VALUE_UP,
+    PNG_FILTER_VALUE_AVG, PNG_FILTER_VALUE_PAETH
+  };
+  gsize i;
+  gsize best_cost = G_MAXSIZE;
+  guchar *best = scratch;
+  guchar *candidate = scratch + encoder->row_size;
+
+  for (i = 0; i < G_N_ELEMENTS (filters); i++)
+    {
+      gsize cost = png_filter_row (filters[i],
+                                   candidate, row, prev,
+                                   encoder->row_size, encoder->bpp,
+                                   best_cost);
+
+      if (cost < best_cost)
+        {
+          guchar *tmp = best;
+          best = candidate;
+          candidate = tmp;
+          best_cost = cost;
+          out[0] = filters[i];
+        }
+    }
+
+  memcpy (out + 1, best, encoder->row_size);
+}
+
+/* Copies a row into @row, converting 16-bit values to big endian */
+static void
+png_encoder_load_row (PngEncoder *encoder,
+                      guchar     *row,
+                      gsize       y)
+{
+  const guchar *src = encoder->data + y * encoder->stride;
+  gsize i;
+
+  if (encoder->swap)
+    {
+      for (i = 0; i + 1 < encoder->row_size; i += 2)
+        {
+          row[i] = src[i + 1];
+          row[i + 1] = src[i];
+        }
+    }
+  else
+    {
+      memcpy (row, src, encoder->row_size);
+    }
+}
+
+static int
+png_compression_get_level (GdkPngCompression compression)
+{
+  switch (compression)
+    {
+    case GDK_PNG_COMPRESSION_FAST:
+      return 3;
+    case GDK_PNG_COMPRESSION_DEFAULT:
+      return 6;
+    case GDK_PNG_COMPRESSION_BEST:
+      return 9;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gboolean
+png_deflate_band (PngBand      *band,
+                  const guchar *data,
+                  gsize         size,
+                  int           level,
+                  gboolean      last)
+{
+  GConverter *converter;
+  GConverterFlags flags;
+  GConverterResult result;
+  gsize n_read, n_written, allocated, available;
+  GError *error = NULL;
+
+  converter = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, level));
+  flags = last ? G_CONVERTER_INPUT_AT_END : G_CONVERTER_FLUSH;
+
+  allocated = size / 2 + 1024;
+  band->data = g_malloc (allocated);
+  band->size = 0;
+
+  while (TRUE)
+    {
+      if (allocated - band->size < 1024)
+        {
+          allocated *= 2;
+          band->data = g_realloc (band->data, allocated);
+        }
+
+      available = allocated - band->size;
+      result = g_converter_convert (converter,
+                                    data, size,
+                                    band->data + band->size, available,
+                                    flags,
+                                    &n_read, &n_written,
+                                    &error);
+
+      if (result == G_CONVERTER_ERROR)
+        {
+          /* zlib reports that it cannot make progress
+           * once everything has been flushed */
+          if (!last && size == 0 &&
+              g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+            {
+              g_clear_error (&error);
+              break;
+            }
+
+          g_clear_error (&error);
+          g_clear_pointer (&band->data, g_free);
+          g_object_unref (converter);
+          return FALSE;
+        }
+
+      data += n_read;
+      size -= n_read;
+      band->size += n_written;
+
+      if (result == G_CONVERTER_FINISHED || result == G_CONVERTER_FLUSHED)
+        break;
+
+      /* zlib has flushed everything if it did not fill the buffer */
+      if (!last && size == 0 && n_written < available)
+        break;
+    }
+
+  g_object_unref (converter);
+
+  return TRUE;
+}
+
+static void
+png_encoder_encode_band (PngEncoder *encoder,
+                         gsize       n,
+                         guchar     *prev,
+                         guchar     *row,
+                         guchar     *scratch)
+{
+  PngBand *band = &encoder->bands[n];
+  gsize y, start, end, filtered_stride, filtered_size;
+  guchar *filtered;
+
+  start = n * encoder->rows_per_band;
+  end = MIN (start + encoder->rows_per_band, encoder->height);
+  filtered_stride = encoder->row_size + 1;
+  filtered_size = (end - start) * filtered_stride;
+  filtered = g_malloc (filtered_size);
+
+  /* Filters look at the previous row, even across bands */
+  if (start > 0)
+    png_encoder_load_row (encoder, prev, start - 1);
+  else
+    memset (prev, 0, encoder->row_size);
+
+  for (y = start; y < end; y++)
+    {
+      guchar *tmp;
+
+      png_encoder_load_row (encoder, row, y);
+      png_filter_row_adaptive (encoder,
+                               filtered + (y - start) * filtered_stride,
+                               row, prev,
+                               scratch);
+
+      tmp = prev;
+      prev = row;
+      row = tmp;
+    }
+
+  band->adler = png_adler32 (1, filtered, filtered_size);
+
+  /* leaves band->data as NULL on failure */
+  png_deflate_band (band,
+                    filtered, filtered_size,
+                    png_compression_get_level (encoder->compression),
+                    n + 1 == encoder->n_bands);
+
+  g_free (filtered);
+}
+
+static void
+png_encoder_run (gpointer data)
+{
+  PngEncoder *encoder = data;
+  guchar *prev, *row, *scratch;
+  gsize n;
+
+  prev = g_malloc (encoder->row_size);
+  row = g_malloc (encoder->row_size);
+  scratch = g_malloc (2 * encoder->row_size);
+
+  for (n = g_atomic_int_add (&encoder->bands_done, 1);
+       n < encoder->n_bands;
+       n = g_atomic_int_add (&encoder->bands_done, 1))
+    {
+      png_encoder_encode_band (encoder, n, prev, row, scratch);
+    }
+
+  g_free (scratch);
+  g_free (row);
+  g_free (prev);
+}
+
+/* Writes the IDAT chunks for the image in @data.
+ * Returns FALSE if compression failed. */
+static gboolean
+png_write_image_data (png_struct        *png,
+                      const guchar      *data,
+                      gsize              stride,
+                      gsize              width,
+                      gsize              height,
+                      gsize              bpp,
+                      gboolean           swap,
+                      GdkPngCompression  compression)
+{
+  PngEncoder encoder = {
+    .data = data,
+    .stride = stride,
+    .row_size = width * bpp,
+    .bpp = bpp,
+    .height = height,
+    .swap = swap,
+    .compression = compression,
+    .bands_done = 0,
+  };
+  GByteArray *idat;
+  guint32 adler;
+  guchar header[2];
+  gsize i;
+  gboolean success = TRUE;
+
+  encoder.rows_per_band = MAX (1, PNG_BAND_SIZE / (encoder.row_size + 1));
+  encoder.n_bands = (height + encoder.rows_per_band - 1) / encoder.rows_per_band;
+  encoder.bands = g_new0 (PngBand, encoder.n_bands);
+
+  gdk_parallel_task_run (png_encoder_run, &encoder, encoder.n_bands);
+
+  /* The zlib header: deflate with a 32kB window, and the level as a hint */
+  header[0] = 0x78;
+  switch (compression)
+    {
+    case GDK_PNG_COMPRESSION_FAST:
+      header[1] = 0x5e;
+      break;
+    case GDK_PNG_COMPRESSION_DEFAULT:
+      header[1] = 0x9c;
+      break;
+    case GDK_PNG_COMPRESSION_BEST:
+      header[1] = 0xda;
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  idat = g_byte_array_new ();
+  g_byte_array_append (idat, header, sizeof (header));
+
+  adler = 1;
+  for (i = 0; i < encoder.n_bands; i++)
+    {
+      PngBand *band = &encoder.bands[i];
+      gsize band_rows;
+
+      if (band->data == NULL)
+        {
+          success = FALSE;
+          continue;
+        }
+
+      band_rows = MIN (encoder.rows_per_band, height - i * encoder.rows_per_band);
+      adler = png_adler32_combine (adler, band->adler, band_rows * (encoder.row_size + 1));
+      g_byte_array_append (idat, band->data, band->size);
+      g_free (band->data);
+    }
+  g_free (encoder.bands);
+
+  if (success)
+    {
+      guchar trailer[4];
+
+      trailer[0] = adler >> 24;
+      trailer[1] = adler >> 16;
+      trailer[2] = adler >> 8;
+      trailer[3] = adler;
+      g_byte_array_append (idat, trailer, sizeof (trailer));
+
+      for (i = 0; i < idat->len; i += PNG_IDAT_SIZE)
+        png_write_chunk (png, (png_const_bytep) "IDAT", idat->data + i, MIN (PNG_IDAT_SIZE, idat->len - i));
+    }
+
+  g_byte_array_unref (idat);
+
+  return success;
+}
+
+/* }}} */
+/* {{{ Public API */
+
+/* Returns a texture that decodes the image on demand if the image
+ * is big enough to make that worthwhile, %NULL otherwise.
+ */
+GdkTexture *
+gdk_load_png_tiled (GBytes *bytes)
+{
+  png_io io;
+  png_struct *png = NULL;
+  png_info *info;
+  guint width, height;
+  GdkMemoryFormat format;
+  GdkColorState *color_state;
+  PngTileData *tile_data;
+#if PNG_LIBPNG_VER < 10645
+  CICPData cicp = { FALSE, };
+#endif
+
+  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
+  io.position = 0;
+
+  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                  NULL,
+                                  png_simple_error_callback,
+                                  png_simple_warning_callback,
+                                  NULL,
+                                  png_malloc_callback,
+                                  png_free_callback);
+  if (png == NULL)
+    g_error ("Out of memory");
+
+  info = png_create_info_struct (png);
+  if (info == NULL)
+    g_error ("Out of memory");
+
+  png_set_read_fn (png, &io, png_read_func);
+#if PNG_LIBPNG_VER < 10645
+  png_set_read_user_chunk_fn (png, &cicp, png_read_chunk_func);
+#endif
+
+  if (sigsetjmp (png_jmpbuf (png), 1))
+    {
+      png_destroy_read_struct (&png, &info, NULL);
+      return NULL;
+    }
+
+  if (!gdk_png_setup_read (png, info, &width, &height, &format, NULL) ||
+      !gdk_tiled_texture_should_tile (width, height) ||
+      png_get_interlace_type (png, info) != PNG_INTERLACE_NONE)
+    {
+      png_destroy_read_struct (&png, &info, NULL);
+      return NULL;
+    }
+
+  color_state = gdk_png_get_color_state (png, info, NULL);
+  png_destroy_read_struct (&png, &info, NULL);
+  if (color_state == NULL)
+    return NULL;
+
+  tile_data = g_new0 (PngTileData, 1);
+  tile_data->bytes = g_bytes_ref (bytes);
+  tile_data->color_state = color_state;
+  tile_data->format = format;
+  tile_data->width = width;
+  tile_data->height = height;
+
+  return gdk_tiled_texture_new (width, height,
+                                format,
+                                color_state,
+                                &png_tile_decoder,
+                                tile_data);
+}
+
+GdkTexture *
+gdk_load_png (GBytes      *bytes,
+              GHashTable  *options,
+              GError     **error)
+{
+  png_io io;
+  png_struct *png = NULL;
+  png_info *info;
+  png_textp text;
+  int num_texts;
+  guint width, height;
+  gsize i;
+  GdkMemoryFormat format;
+  GdkMemoryLayout layout;
+  guchar *buffer = NULL;
+  guchar **row_pointers = NULL;
+  GBytes *out_bytes;
+  GdkColorState *color_state;
+  GdkTexture *texture;
+#if PNG_LIBPNG_VER < 10645
+  CICPData cicp = { FALSE, };
+#endif
+
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
+  io.position = 0;
+
+  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                  error,
+                                  png_simple_error_callback,
+                                  png_simple_warning_callback,
+                                  NULL,
+                                  png_malloc_callback,
+                                  png_free_callback);
+  if (png == NULL)
+    g_error ("Out of memory");
+
+  info = png_create_info_struct (png);
+  if (info == NULL)
+    g_error ("Out of memory");
+
+  png_set_read_fn (png, &io, png_read_func);
+#if PNG_LIBPNG_VER < 10645
+  png_set_read_user_chunk_fn (png, &cicp, png_read_chunk_func);
+#endif
+
+  if (sigsetjmp (png_jmpbuf (png), 1))
+    {
+      g_free (buffer);
+      g_free (row_pointers);
+      png_destroy_read_struct (&png, &info, NULL);
+      return NULL;
+    }
+
+  if (!gdk_png_setup_read (png, info, &width, &height, &format, error))
+    {
+      png_destroy_read_struct (&png, &info, NULL);
       return NULL;
     }
 
@@ -506,12 +1316,19 @@ gdk_load_png (GBytes      *bytes,
 GBytes *
 gdk_save_png (GdkTexture *texture,
               GHashTable *options)
+{
+  return gdk_save_png_full (texture, options, GDK_PNG_COMPRESSION_DEFAULT);
+}
+
+GBytes *
+gdk_save_png_full (GdkTexture        *texture,
+                   GHashTable        *options,
+                   GdkPngCompression  compression)
 {
   png_struct *png = NULL;
   png_info *info;
   png_io io = { NULL, 0, 0 };
   int width, height;
-  int y;
   GdkMemoryFormat format;
   GdkTextureDownloader downloader;
   GBytes *bytes;
@@ -522,6 +1339,7 @@ gdk_save_png (GdkTexture *texture,
   int depth;
   png_byte chunk_data[4];
   png_textp text_ptr = NULL;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
 
   width = gdk_texture_get_width (texture);
   height = gdk_texture_get_height (texture);
@@ -674,8 +1492,6 @@ gdk_save_png (GdkTexture *texture,
 
   color_state = gdk_png_set_color_state (png, info, color_state, chunk_data);
 
-  png_write_info (png, info);
-
   if (options)
     {
       GHashTableIter iter;
@@ -711,9 +1527,7 @@ gdk_save_png (GdkTexture *texture,
       png_set_text (png, info, text_ptr, n_keys);
     }
 
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-  png_set_swap (png);
-#endif
+  png_write_info (png, info);
 
   gdk_texture_downloader_init (&downloader, texture);
   gdk_texture_downloader_set_format (&downloader, format);
@@ -722,10 +1536,15 @@ gdk_save_png (GdkTexture *texture,
   gdk_texture_downloader_finish (&downloader);
   data = g_bytes_get_data (bytes, NULL);
 
-  for (y = 0; y < height; y++)
-    png_write_row (png, data + y * stride);
+  if (!png_write_image_data (png, data, stride, width, height,
+                             png_get_channels (png, info) * depth / 8,
+                             depth == 16 && G_BYTE_ORDER == G_LITTLE_ENDIAN,
+                             compression))
+    png_error (png, "Failed to compress image data");
 
-  png_write_end (png, info);
+  /* libpng did not write the image data itself, so
+   * png_write_end() would complain */
+  png_write_chunk (png, (png_const_bytep) "IEND", NULL, 0);
 
   png_destroy_write_struct (&png, &info);
 
@@ -734,6 +1553,13 @@ gdk_save_png (GdkTexture *texture,
 
   g_free (text_ptr);
 
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      gint64 end = GDK_PROFILER_CURRENT_TIME;
+      if (end - before > 500000)
+        gdk_profiler_add_mark (before, end - before, "Save png", NULL);
+    }
+
   return g_bytes_new_take (io.data, io.size);
 }
 
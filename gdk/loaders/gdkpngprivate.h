@@ -22,12 +22,22 @@
 
 #define PNG_SIGNATURE "\x89PNG"
 
+typedef enum {
+  GDK_PNG_COMPRESSION_FAST,
+  GDK_PNG_COMPRESSION_DEFAULT,
+  GDK_PNG_COMPRESSION_BEST,
+} GdkPngCompression;
+
 GdkTexture *gdk_load_png        (GBytes         *bytes,
                                  GHashTable     *options,
                                  GError        **error);
+GdkTexture *gdk_load_png_tiled  (GBytes         *bytes);
 
-GBytes     *gdk_save_png        (GdkTexture     *texture,
-                                 GHashTable     *options);
+GBytes     *gdk_save_png        (GdkTexture        *texture,
+                                 GHashTable        *options);
+GBytes     *gdk_save_png_full   (GdkTexture        *texture,
+                                 GHashTable        *options,
+                                 GdkPngCompression  compression);
 
 static inline gboolean
 gdk_is_png (GBytes *bytes)
@@ -24,6 +24,7 @@
 #include "gdkmemorytextureprivate.h"
 #include "gdkprofilerprivate.h"
 #include "gdktexturedownloaderprivate.h"
+#include "gdktiledtextureprivate.h"
 
 #include <glib/gi18n-lib.h>
 #include <tiffio.h>
@@ -396,36 +397,19 @@ load_fallback (TIFF    *tif,
   return texture;
 }
 
-GdkTexture *
-gdk_load_tiff (GBytes  *input_bytes,
-               GError **error)
+/* Checks if the image data can be read as-is, in one of our formats */
+static gboolean
+tiff_get_native_format (TIFF            *tif,
+                        GdkMemoryFormat *out_format)
 {
-  TIFF *tif;
   guint16 samples_per_pixel;
   guint16 bits_per_sample;
   guint16 photometric;
   guint16 planarconfig;
   guint16 sample_format;
   guint16 orientation;
-  guint32 width, height;
   gint16 alpha_samples;
   GdkMemoryFormat format;
-  GdkMemoryLayout layout;
-  guchar *data, *line;
-  GBytes *bytes;
-  GdkTexture *texture;
-  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
-
-  tif = tiff_open_read (input_bytes);
-  if (!tif)
-    {
-      g_set_error_literal (error,
-                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
-                           _("Could not load TIFF data"));
-      return NULL;
-    }
-
-  TIFFSetDirectory (tif, 0);
 
   TIFFGetFieldDefaulted (tif, TIFFTAG_SAMPLESPERPIXEL, &samples_per_pixel);
   TIFFGetFieldDefaulted (tif, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
@@ -433,8 +417,6 @@ gdk_load_tiff (GBytes  *input_bytes,
   TIFFGetFieldDefaulted (tif, TIFFTAG_PHOTOMETRIC, &photometric);
   TIFFGetFieldDefaulted (tif, TIFFTAG_PLANARCONFIG, &planarconfig);
   TIFFGetFieldDefaulted (tif, TIFFTAG_ORIENTATION, &orientation);
-  TIFFGetFieldDefaulted (tif, TIFFTAG_IMAGEWIDTH, &width);
-  TIFFGetFieldDefaulted (tif, TIFFTAG_IMAGELENGTH, &height);
 
   if (samples_per_pixel == 2 || samples_per_pixel == 4)
     {
@@ -447,11 +429,7 @@ gdk_load_tiff (GBytes  *input_bytes,
         alpha_samples = -1;
 
       if (alpha_samples >= 0 && alpha_samples != EXTRASAMPLE_ASSOCALPHA && alpha_samples != EXTRASAMPLE_UNASSALPHA && alpha_samples != 0)
-        {
-          texture = load_fallback (tif, error);
-          TIFFClose (tif);
-          return texture;
-        }
+        return FALSE;
     }
   else
     alpha_samples = -1;
@@ -475,14 +453,237 @@ gdk_load_tiff (GBytes  *input_bytes,
   if (format == G_N_ELEMENTS(format_data) ||
       (photometric != PHOTOMETRIC_RGB && photometric != PHOTOMETRIC_MINISBLACK) ||
       planarconfig != PLANARCONFIG_CONTIG ||
-      TIFFIsTiled (tif) ||
       orientation != ORIENTATION_TOPLEFT)
+    return FALSE;
+
+  *out_format = format;
+
+  return TRUE;
+}
+
+/* {{{ Tiled loading */
+
+/* For tiled files, only the tiles that overlap the area are read.
+ * For files organized in strips, libtiff takes care of only decoding
+ * the strips that contain the rows we ask for.
+ */
+typedef struct
+{
+  GBytes *bytes;
+  TIFF *tif;
+  GdkMemoryFormat format;
+} TiffTileData;
+
+static void
+tiff_tile_data_free (gpointer data)
+{
+  TiffTileData *tile_data = data;
+
+  TIFFClose (tile_data->tif);
+  g_bytes_unref (tile_data->bytes);
+  g_free (tile_data);
+}
+
+static gboolean
+tiff_decode_tiled_rows (TiffTileData                *tile_data,
+                        const cairo_rectangle_int_t *area,
+                        GdkTileBuilder              *builder,
+                        gsize                        bpp)
+{
+  TIFF *tif = tile_data->tif;
+  guint32 tile_width, tile_height;
+  guint32 tx0, tx1, tx, ty, y;
+  tmsize_t tile_size;
+  guchar *tiles;
+  gboolean result = TRUE;
+
+  TIFFGetField (tif, TIFFTAG_TILEWIDTH, &tile_width);
+  TIFFGetField (tif, TIFFTAG_TILELENGTH, &tile_height);
+  tile_size = TIFFTileSize (tif);
+
+  tx0 = area->x / tile_width;
+  tx1 = (area->x + area->width - 1) / tile_width + 1;
+  tiles = g_malloc_n (tx1 - tx0, tile_size);
+
+  ty = G_MAXUINT32;
+  for (y = area->y; y < area->y + area->height; y++)
+    {
+      guchar *dest = gdk_tile_builder_get_row (builder);
+
+      if (ty != y / tile_height)
+        {
+          ty = y / tile_height;
+          for (tx = tx0; tx < tx1; tx++)
+            {
+              if (TIFFReadTile (tif, tiles + (tx - tx0) * tile_size, tx * tile_width, ty * tile_height, 0, 0) == -1)
+                {
+                  result = FALSE;
+                  goto out;
+                }
+            }
+        }
+
+      for (tx = tx0; tx < tx1; tx++)
+        {
+          guint32 x0 = MAX (tx * tile_width, area->x);
+          guint32 x1 = MIN ((tx + 1) * tile_width, area->x + area->width);
+
+          memcpy (dest + (x0 - area->x) * bpp,
+                  tiles + (tx - tx0) * tile_size + ((y - ty * tile_height) * tile_width + (x0 - tx * tile_width)) * bpp,
+                  (x1 - x0) * bpp);
+        }
+
+      gdk_tile_builder_push_row (builder);
+    }
+
+out:
+  g_free (tiles);
+
+  return result;
+}
+
+static gboolean
+tiff_decode_stripped_rows (TiffTileData                *tile_data,
+                           const cairo_rectangle_int_t *area,
+                           GdkTileBuilder              *builder,
+                           gsize                        bpp)
+{
+  TIFF *tif = tile_data->tif;
+  guchar *line;
+  int y;
+
+  line = g_malloc (TIFFScanlineSize (tif));
+
+  for (y = area->y; y < area->y + area->height; y++)
+    {
+      if (TIFFReadScanline (tif, line, y, 0) == -1)
+        {
+          g_free (line);
+          return FALSE;
+        }
+
+      memcpy (gdk_tile_builder_get_row (builder), line + area->x * bpp, area->width * bpp);
+      gdk_tile_builder_push_row (builder);
+    }
+
+  g_free (line);
+
+  return TRUE;
+}
+
+static GdkTexture *
+tiff_decode_tile (gpointer                      data,
+                  const cairo_rectangle_int_t  *area,
+                  guint                         lod_level,
+                  gboolean                      linear,
+                  GError                      **error)
+{
+  TiffTileData *tile_data = data;
+  GdkTileBuilder *builder;
+  gboolean success;
+  gsize bpp;
+
+  bpp = gdk_memory_format_get_plane_block_bytes (tile_data->format, 0);
+  builder = gdk_tile_builder_new (tile_data->format, area->width, area->height, lod_level, linear);
+
+  if (TIFFIsTiled (tile_data->tif))
+    success = tiff_decode_tiled_rows (tile_data, area, builder, bpp);
+  else
+    success = tiff_decode_stripped_rows (tile_data, area, builder, bpp);
+
+  if (!success)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("Could not load TIFF data"));
+      gdk_tile_builder_free (builder);
+      return NULL;
+    }
+
+  return gdk_tile_builder_free_to_texture (builder, gdk_color_state_get_srgb ());
+}
+
+static const GdkTileDecoder tiff_tile_decoder = {
+  tiff_decode_tile,
+  tiff_tile_data_free,
+};
+
+/* }}} */
+
+/* Returns a texture that decodes the image on demand if the image
+ * is big enough to make that worthwhile, %NULL otherwise.
+ */
+GdkTexture *
+gdk_load_tiff_tiled (GBytes *input_bytes)
+{
+  TiffTileData *tile_data;
+  GdkMemoryFormat format;
+  guint32 width, height;
+  TIFF *tif;
+
+  tif = tiff_open_read (input_bytes);
+  if (!tif)
+    return NULL;
+
+  TIFFSetDirectory (tif, 0);
+
+  TIFFGetFieldDefaulted (tif, TIFFTAG_IMAGEWIDTH, &width);
+  TIFFGetFieldDefaulted (tif, TIFFTAG_IMAGELENGTH, &height);
+
+  if (!gdk_tiled_texture_should_tile (width, height) ||
+      !tiff_get_native_format (tif, &format))
+    {
+      TIFFClose (tif);
+      return NULL;
+    }
+
+  tile_data = g_new (TiffTileData, 1);
+  tile_data->bytes = g_bytes_ref (input_bytes);
+  tile_data->tif = tif;
+  tile_data->format = format;
+
+  return gdk_tiled_texture_new (width, height,
+                                format,
+                                gdk_color_state_get_srgb (),
+                                &tiff_tile_decoder,
+                                tile_data);
+}
+
+GdkTexture *
+gdk_load_tiff (GBytes  *input_bytes,
+               GError **error)
+{
+  TIFF *tif;
+  guint32 width, height;
+  GdkMemoryFormat format;
+  GdkMemoryLayout layout;
+  guchar *data, *line;
+  GBytes *bytes;
+  GdkTexture *texture;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  tif = tiff_open_read (input_bytes);
+  if (!tif)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("Could not load TIFF data"));
+      return NULL;
+    }
+
+  TIFFSetDirectory (tif, 0);
+
+  if (!tiff_get_native_format (tif, &format) ||
+      TIFFIsTiled (tif))
     {
       texture = load_fallback (tif, error);
       TIFFClose (tif);
       return texture;
     }
 
+  TIFFGetFieldDefaulted (tif, TIFFTAG_IMAGEWIDTH, &width);
+  TIFFGetFieldDefaulted (tif, TIFFTAG_IMAGELENGTH, &height);
+
   if (!gdk_memory_layout_try_init (&layout, format, width, height, 1) ||
       !(data = g_try_malloc (layout.size)))
     {
@@ -25,6 +25,7 @@
 
 GdkTexture *gdk_load_tiff         (GBytes           *bytes,
                                    GError          **error);
+GdkTexture *gdk_load_tiff_tiled   (GBytes           *bytes);
 
 GBytes *    gdk_save_tiff         (GdkTexture       *texture);
 
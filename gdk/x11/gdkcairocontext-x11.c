@@ -22,6 +22,7 @@
 
 #include "gdkcairocontext-x11.h"
 
+#include "gdkdisplay-x11.h"
 #include "gdkprivate-x11.h"
 
 #include "gdkcairoprivate.h"
@@ -29,10 +30,261 @@
 
 #include <X11/Xlib.h>
 
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
 G_DEFINE_TYPE (GdkX11CairoContext, gdk_x11_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
 
+#ifdef HAVE_XSHM
+
+/* When the X server supports MIT-SHM, we paint into window-sized
+ * image surfaces in shared memory and send the painted region to
+ * the window with XShmPutImage(), instead of creating new surfaces
+ * every frame and sending the pixels over the X connection.
+ *
+ * A buffer can be reused once the server has processed the last
+ * XShmPutImage() request from it. We keep a couple of buffers around
+ * so that we don't have to wait for that.
+ */
+struct _GdkX11ShmBuffer
+{
+  XShmSegmentInfo info;
+  XImage *image;
+  cairo_surface_t *surface;
+  int width;
+  int height;
+  /* Serial of the last request reading from the buffer */
+  unsigned long serial;
+};
+
+static void
+gdk_x11_shm_buffer_free (Display         *xdisplay,
+                         GdkX11ShmBuffer *buffer)
+{
+  g_clear_pointer (&buffer->surface, cairo_surface_destroy);
+
+  if (buffer->info.shmaddr != NULL)
+    {
+      XShmDetach (xdisplay, &buffer->info);
+      shmdt (buffer->info.shmaddr);
+    }
+
+  if (buffer->image)
+    {
+      /* The data is the shared memory segment, which we just detached */
+      buffer->image->data = NULL;
+      XDestroyImage (buffer->image);
+    }
+
+  g_free (buffer);
+}
+
+static GdkX11ShmBuffer *
+gdk_x11_shm_buffer_new (GdkDisplay *display,
+                        int         width,
+                        int         height)
+{
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
+  Display *xdisplay = display_x11->xdisplay;
+  Visual *visual;
+  int depth;
+  cairo_format_t format;
+  GdkX11ShmBuffer *buffer;
+  gboolean attached;
+  char *shmaddr;
+
+  visual = gdk_x11_display_get_window_visual (display_x11);
+  depth = gdk_x11_display_get_window_depth (display_x11);
+
+  if (depth == 32)
+    format = CAIRO_FORMAT_ARGB32;
+  else if (depth == 24)
+    format = CAIRO_FORMAT_RGB24;
+  else
+    return NULL;
+
+  if (visual->red_mask != 0xff0000 ||
+      visual->green_mask != 0xff00 ||
+      visual->blue_mask != 0xff)
+    return NULL;
+
+  buffer = g_new0 (GdkX11ShmBuffer, 1);
+  buffer->width = width;
+  buffer->height = height;
+
+  buffer->image = XShmCreateImage (xdisplay, visual, depth, ZPixmap, NULL,
+                                   &buffer->info, width, height);
+  if (buffer->image == NULL ||
+      buffer->image->bits_per_pixel != 32 ||
+      buffer->image->byte_order != (G_BYTE_ORDER == G_LITTLE_ENDIAN ? LSBFirst : MSBFirst))
+    goto fail;
+
+  buffer->info.shmid = shmget (IPC_PRIVATE,
+                               buffer->image->bytes_per_line * buffer->image->height,
+                               IPC_CREAT | 0600);
+  if (buffer->info.shmid < 0)
+    goto fail;
+
+  shmaddr = shmat (buffer->info.shmid, NULL, 0);
+  if (shmaddr == (char *) -1)
+    {
+      shmctl (buffer->info.shmid, IPC_RMID, NULL);
+      goto fail;
+    }
+
+  buffer->info.readOnly = False;
+
+  gdk_x11_display_error_trap_push (display);
+  XShmAttach (xdisplay, &buffer->info);
+  XSync (xdisplay, False);
+  attached = gdk_x11_display_error_trap_pop (display) == 0;
+
+  /* The segment goes away once both sides have detached */
+  shmctl (buffer->info.shmid, IPC_RMID, NULL);
+
+  if (!attached)
+    {
+      /* Typically, the server is not on this machine. Don't try again. */
+      GDK_DISPLAY_DEBUG (display, MISC, "Could not attach MIT-SHM segment, not using MIT-SHM");
+      display_x11->have_shm = FALSE;
+      shmdt (shmaddr);
+      goto fail;
+    }
+
+  buffer->info.shmaddr = buffer->image->data = shmaddr;
+  buffer->surface = cairo_image_surface_create_for_data ((guchar *) shmaddr,
+                                                         format,
+                                                         width, height,
+                                                         buffer->image->bytes_per_line);
+
+  return buffer;
+
+fail:
+  gdk_x11_shm_buffer_free (xdisplay, buffer);
+  return NULL;
+}
+
+static void
+gdk_x11_cairo_context_clear_shm_buffers (GdkX11CairoContext *self)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  Display *xdisplay;
+
+  if (display == NULL)
+    return;
+
+  xdisplay = gdk_x11_display_get_xdisplay (display);
+
+  for (guint i = 0; i < GDK_X11_N_SHM_BUFFERS; i++)
+    {
+      if (self->shm_buffers[i])
+        {
+          gdk_x11_shm_buffer_free (xdisplay, self->shm_buffers[i]);
+          self->shm_buffers[i] = NULL;
+        }
+    }
+
+  if (self->shm_gc)
+    {
+      XFreeGC (xdisplay, self->shm_gc);
+      self->shm_gc = NULL;
+    }
+}
+
+static GdkX11ShmBuffer *
+gdk_x11_cairo_context_get_shm_buffer (GdkX11CairoContext *self,
+                                      int                 width,
+                                      int                 height)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  guint i;
+
+  if (!GDK_X11_DISPLAY (display)->have_shm)
+    return NULL;
+
+  /* Reuse a buffer that the server is done with */
+  for (i = 0; i < GDK_X11_N_SHM_BUFFERS; i++)
+    {
+      GdkX11ShmBuffer *buffer = self->shm_buffers[i];
+
+      if (buffer == NULL)
+        continue;
+
+      if (buffer->width != width || buffer->height != height)
+        {
+          gdk_x11_shm_buffer_free (xdisplay, buffer);
+          self->shm_buffers[i] = NULL;
+          continue;
+        }
+
+      if (LastKnownRequestProcessed (xdisplay) >= buffer->serial)
+        return buffer;
+    }
+
+  for (i = 0; i < GDK_X11_N_SHM_BUFFERS; i++)
+    {
+      if (self->shm_buffers[i] == NULL)
+        {
+          self->shm_buffers[i] = gdk_x11_shm_buffer_new (display, width, height);
+          return self->shm_buffers[i];
+        }
+    }
+
+  /* All buffers are still being read, wait for the server */
+  XSync (xdisplay, False);
+
+  return self->shm_buffers[0];
+}
+
+static void
+gdk_x11_cairo_context_put_shm_buffer (GdkX11CairoContext *self,
+                                      GdkX11ShmBuffer    *buffer,
+                                      cairo_region_t     *painted)
+{
+  GdkDrawContext *draw_context = GDK_DRAW_CONTEXT (self);
+  GdkSurface *surface = gdk_draw_context_get_surface (draw_context);
+  Display *xdisplay = gdk_x11_display_get_xdisplay (gdk_draw_context_get_display (draw_context));
+  cairo_rectangle_int_t bounds = { 0, 0, buffer->width, buffer->height };
+  cairo_region_t *region;
+  int i, n;
+
+  cairo_surface_flush (buffer->surface);
+
+  if (self->shm_gc == NULL)
+    self->shm_gc = XCreateGC (xdisplay, GDK_SURFACE_XID (surface), 0, NULL);
+
+  region = cairo_region_copy (painted);
+  cairo_region_intersect_rectangle (region, &bounds);
+
+  n = cairo_region_num_rectangles (region);
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (region, i, &rect);
+      XShmPutImage (xdisplay,
+                    GDK_SURFACE_XID (surface),
+                    self->shm_gc,
+                    buffer->image,
+                    rect.x, rect.y,
+                    rect.x, rect.y,
+                    rect.width, rect.height,
+                    False);
+    }
+
+  buffer->serial = NextRequest (xdisplay) - 1;
+
+  cairo_region_destroy (region);
+}
+
+#endif /* HAVE_XSHM */
+
 static cairo_surface_t *
 create_cairo_surface_for_surface (GdkSurface *surface)
 {
@@ -70,6 +322,35 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext  *draw_context,
   surface = gdk_draw_context_get_surface (draw_context);
   cairo_region_get_extents (region, &clip_box);
 
+  *out_color_state = GDK_COLOR_STATE_SRGB;
+  *out_depth = gdk_color_state_get_depth (GDK_COLOR_STATE_SRGB);
+
+#ifdef HAVE_XSHM
+  {
+    int scale = gdk_surface_get_scale_factor (surface);
+
+    self->paint_buffer = gdk_x11_cairo_context_get_shm_buffer (self,
+                                                               gdk_surface_get_width (surface) * scale,
+                                                               gdk_surface_get_height (surface) * scale);
+    if (self->paint_buffer)
+      {
+        cairo_t *cr;
+
+        self->paint_surface = cairo_surface_reference (self->paint_buffer->surface);
+
+        /* The buffer contains an old frame, clear what we are going to paint */
+        cr = cairo_create (self->paint_surface);
+        gdk_cairo_region (cr, region);
+        cairo_clip (cr);
+        cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint (cr);
+        cairo_destroy (cr);
+
+        return;
+      }
+  }
+#endif
+
   self->window_surface = create_cairo_surface_for_surface (surface);
 
   format = gdk_cairo_format_for_content (cairo_surface_get_content (self->window_surface)),
@@ -79,9 +360,6 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext  *draw_context,
 
   cairo_surface_set_device_scale (self->paint_surface, 1.0, 1.0);
   cairo_surface_set_device_offset (self->paint_surface, -clip_box.x, -clip_box.y);
-
-  *out_color_state = GDK_COLOR_STATE_SRGB;
-  *out_depth = gdk_color_state_get_depth (GDK_COLOR_STATE_SRGB);
 }
 
 static void
@@ -92,6 +370,16 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
   cairo_t *cr;
 
+#ifdef HAVE_XSHM
+  if (self->paint_buffer)
+    {
+      gdk_x11_cairo_context_put_shm_buffer (self, self->paint_buffer, painted);
+      self->paint_buffer = NULL;
+      g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+      return;
+    }
+#endif
+
   cr = cairo_create (self->window_surface);
 
   cairo_set_source_surface (cr, self->paint_surface, 0, 0);
@@ -117,12 +405,25 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+#ifdef HAVE_XSHM
+  gdk_x11_cairo_context_clear_shm_buffers (GDK_X11_CAIRO_CONTEXT (object));
+#endif
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  object_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
 
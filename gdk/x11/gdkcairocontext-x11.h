@@ -24,6 +24,8 @@
 
 #include "gdkcairocontextprivate.h"
 
+#include <X11/Xlib.h>
+
 G_BEGIN_DECLS
 
 #define GDK_TYPE_X11_CAIRO_CONTEXT		(gdk_x11_cairo_context_get_type ())
@@ -35,6 +37,9 @@ G_BEGIN_DECLS
 
 typedef struct _GdkX11CairoContext GdkX11CairoContext;
 typedef struct _GdkX11CairoContextClass GdkX11CairoContextClass;
+typedef struct _GdkX11ShmBuffer GdkX11ShmBuffer;
+
+#define GDK_X11_N_SHM_BUFFERS 2
 
 struct _GdkX11CairoContext
 {
@@ -42,6 +47,11 @@ struct _GdkX11CairoContext
 
   cairo_surface_t *window_surface;
   cairo_surface_t *paint_surface;
+
+  /* MIT-SHM back buffers, reused across frames */
+  GdkX11ShmBuffer *shm_buffers[GDK_X11_N_SHM_BUFFERS];
+  GdkX11ShmBuffer *paint_buffer;
+  GC shm_gc;
 };
 
 struct _GdkX11CairoContextClass
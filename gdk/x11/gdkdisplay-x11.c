@@ -75,6 +75,10 @@
 #include <X11/extensions/Xrandr.h>
 #endif
 
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
 enum {
@@ -1639,6 +1643,10 @@ gdk_x11_display_open (const char *display_name)
     display_x11->have_damage = TRUE;
 #endif
 
+#ifdef HAVE_XSHM
+  display_x11->have_shm = XShmQueryExtension (display_x11->xdisplay);
+#endif
+
   display->clipboard = gdk_x11_clipboard_new (display, "CLIPBOARD");
   display->primary_clipboard = gdk_x11_clipboard_new (display, "PRIMARY");
 
@@ -127,6 +127,10 @@ struct _GdkX11Display
   guint have_damage;
 #endif
 
+#ifdef HAVE_XSHM
+  guint have_shm : 1;
+#endif
+
   /* If GL is not supported, store the error here */
   GError *gl_error;
 
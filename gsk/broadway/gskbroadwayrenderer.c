@@ -29,9 +29,12 @@ struct _GskBroadwayRenderer
   GPtrArray *node_textures;   /* Owned by draw_contex */
   GHashTable *node_lookup;
 
+  GHashTable *textures;       /* cairo_rectangle_int_t -> GdkTexture, generated this frame */
+
   /* Kept from last frame */
   GHashTable *last_node_lookup;
   GskRenderNode *last_root; /* Owning refs to the things in last_node_lookup */
+  GHashTable *last_textures;
 };
 
 struct _GskBroadwayRendererClass
@@ -75,6 +78,7 @@ gsk_broadway_renderer_unrealize (GskRenderer *renderer)
   gdk_draw_context_detach (GDK_DRAW_CONTEXT (self->draw_context));
 
   g_clear_object (&self->draw_context);
+  g_clear_pointer (&self->last_textures, g_hash_table_unref);
 }
 
 static GdkTexture *
@@ -101,6 +105,47 @@ gsk_broadway_renderer_render_texture (GskRenderer           *renderer,
   return texture;
 }
 
+static guint
+area_hash (gconstpointer data)
+{
+  const cairo_rectangle_int_t *area = data;
+
+  return (((guint) area->x * 31 + (guint) area->y) * 31 + (guint) area->width) * 31 + (guint) area->height;
+}
+
+static gboolean
+area_equal (gconstpointer a,
+            gconstpointer b)
+{
+  const cairo_rectangle_int_t *area_a = a;
+  const cairo_rectangle_int_t *area_b = b;
+
+  return area_a->x == area_b->x &&
+         area_a->y == area_b->y &&
+         area_a->width == area_b->width &&
+         area_a->height == area_b->height;
+}
+
+/* Remembers @texture as generated for @area this frame and returns
+ * the texture that was generated for the same area last frame, if
+ * any. Redrawn widgets often only change a bit, so the display can
+ * then upload the texture as a patch on top of the old one.
+ */
+static GdkTexture *
+gsk_broadway_renderer_swap_texture (GskBroadwayRenderer         *self,
+                                    const cairo_rectangle_int_t *area,
+                                    GdkTexture                  *texture)
+{
+  g_hash_table_replace (self->textures,
+                        g_memdup2 (area, sizeof (cairo_rectangle_int_t)),
+                        g_object_ref (texture));
+
+  if (self->last_textures == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (self->last_textures, area);
+}
+
 /* uint32 is sent in native endianness, and then converted to little endian in broadwayd when sending to browser */
 static void
 add_uint32 (GArray *nodes, guint32 v)
@@ -600,7 +645,7 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
 
           /* No need to add to self->node_textures here, the node will keep it alive until end of frame. */
 
-          texture_id = gdk_broadway_display_ensure_texture (display, texture);
+          texture_id = gdk_broadway_display_ensure_texture (display, texture, NULL);
 
           add_rect (nodes, &node->bounds, offset_x, offset_y);
           add_uint32 (nodes, texture_id);
@@ -612,7 +657,7 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
         {
           cairo_surface_t *surface = gsk_cairo_node_get_surface (node);
           cairo_surface_t *image_surface = NULL;
-          GdkTexture *texture;
+          GdkTexture *texture, *previous;
           guint32 texture_id;
 
           if (surface == NULL)
@@ -634,7 +679,15 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
 
           texture = gdk_texture_new_for_surface (image_surface);
           g_ptr_array_add (self->node_textures, texture); /* Transfers ownership to node_textures */
-          texture_id = gdk_broadway_display_ensure_texture (display, texture);
+          previous = gsk_broadway_renderer_swap_texture (self,
+                                                         &(cairo_rectangle_int_t) {
+                                                           floorf (node->bounds.origin.x),
+                                                           floorf (node->bounds.origin.y),
+                                                           gdk_texture_get_width (texture),
+                                                           gdk_texture_get_height (texture)
+                                                         },
+                                                         texture);
+          texture_id = gdk_broadway_display_ensure_texture (display, texture, previous);
 
           add_rect (nodes, &node->bounds, offset_x, offset_y);
           add_uint32 (nodes, texture_id);
@@ -866,7 +919,7 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
             GdkTexture *colorized_texture = get_colorized_texture (texture, color_matrix, color_offset);
             if (add_new_node (renderer, node, BROADWAY_NODE_TEXTURE, clip_bounds))
               {
-                guint32 texture_id = gdk_broadway_display_ensure_texture (display, colorized_texture);
+                guint32 texture_id = gdk_broadway_display_ensure_texture (display, colorized_texture, NULL);
                 add_rect (nodes, &child->bounds, offset_x, offset_y);
                 add_uint32 (nodes, texture_id);
               }
@@ -896,7 +949,7 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
 
   if (add_new_node (renderer, node, BROADWAY_NODE_TEXTURE, clip_bounds))
     {
-      GdkTexture *texture;
+      GdkTexture *texture, *previous;
       cairo_surface_t *surface;
       cairo_t *cr;
       guint32 texture_id;
@@ -923,7 +976,10 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
       texture = gdk_texture_new_for_surface (surface);
       g_ptr_array_add (self->node_textures, texture); /* Transfers ownership to node_textures */
 
-      texture_id = gdk_broadway_display_ensure_texture (display, texture);
+      previous = gsk_broadway_renderer_swap_texture (self,
+                                                     &(cairo_rectangle_int_t) { x, y, width, height },
+                                                     texture);
+      texture_id = gdk_broadway_display_ensure_texture (display, texture, previous);
       add_float (nodes, x - offset_x);
       add_float (nodes, y - offset_y);
       add_float (nodes, width);
@@ -942,6 +998,7 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
   GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
 
   self->node_lookup = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->textures = g_hash_table_new_full (area_hash, area_equal, g_free, g_object_unref);
 
   gdk_draw_context_begin_frame_full (GDK_DRAW_CONTEXT (self->draw_context), NULL, GDK_MEMORY_U8, update_area, NULL);
 
@@ -966,6 +1023,11 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
     gsk_render_node_unref (self->last_root);
   self->last_root = gsk_render_node_ref (root);
 
+  if (self->last_textures)
+    g_hash_table_unref (self->last_textures);
+  self->last_textures = self->textures;
+  self->textures = NULL;
+
   if (self->next_node_id > G_MAXUINT32 / 2)
     {
       /* We're "near" a wrap of the ids, lets avoid reusing any of
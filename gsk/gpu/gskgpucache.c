@@ -54,6 +54,9 @@ struct _GskGpuCache
 
   /* atomic */ gsize dead_textures;
   /* atomic */ gsize dead_texture_pixels;
+
+  /* number of images taken over from ancestors, for the testsuite */
+  gsize n_stolen_images;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GskGpuCache, gsk_gpu_cache, G_TYPE_OBJECT)
@@ -361,6 +364,9 @@ struct _GskGpuCachedTexture
   GdkTexture *texture;
   GskGpuImage *image;
   GdkColorState *color_state;  /* no ref because global. May be NULL */
+  /* image was uploaded from the texture's data, so it can be updated
+   * for a descendant of the texture */
+  gboolean updatable;
 };
 
 static GHashTable *
@@ -685,7 +691,7 @@ gsk_gpu_cache_lookup_tile (GskGpuCache      *self,
     return NULL;
 
   tile = g_hash_table_lookup (self->tile_cache, &lookup);
-  if (tile == NULL)
+  if (tile == NULL || tile->image == NULL)
     return NULL;
 
   gsk_gpu_cached_use ((GskGpuCached *) tile);
@@ -717,6 +723,124 @@ gsk_gpu_cache_cache_tile (GskGpuCache      *self,
   gsk_gpu_cached_use ((GskGpuCached *) tile);
 }
 
+typedef struct
+{
+  GskGpuCache *cache;
+  GdkTexture *texture;
+  guint lod_level;
+  gboolean lod_linear;
+  gsize tile_id;
+  GskGpuImage *image;
+  GdkColorState *color_state;
+} StealData;
+
+/* Images that have been used in the current frame can't be modified,
+ * because uploads happen before any drawing.
+ */
+static inline gboolean
+gsk_gpu_cached_can_steal (GskGpuCached *cached)
+{
+  return cached->timestamp != cached->cache->timestamp;
+}
+
+/* The image of @ancestor can only be updated to @texture if the
+ * pixels don't need to change anywhere outside the diff.
+ */
+static gboolean
+texture_can_steal_from (GdkTexture *texture,
+                        GdkTexture *ancestor)
+{
+  return gdk_texture_get_width (ancestor) == gdk_texture_get_width (texture) &&
+         gdk_texture_get_height (ancestor) == gdk_texture_get_height (texture) &&
+         gdk_texture_get_format (ancestor) == gdk_texture_get_format (texture) &&
+         gdk_color_state_equal (gdk_texture_get_color_state (ancestor),
+                                gdk_texture_get_color_state (texture));
+}
+
+static gboolean
+steal_tile (GdkTexture *ancestor,
+            gpointer    user_data)
+{
+  StealData *data = user_data;
+  GskGpuCachedTile *tile;
+  GskGpuCachedTile lookup = {
+    .texture = ancestor,
+    .lod_level = data->lod_level,
+    .lod_linear = data->lod_linear,
+    .tile_id = data->tile_id
+  };
+
+  if (!texture_can_steal_from (data->texture, ancestor))
+    return FALSE;
+
+  tile = g_hash_table_lookup (data->cache->tile_cache, &lookup);
+  if (tile == NULL ||
+      tile->image == NULL ||
+      gsk_gpu_cached_tile_is_invalid (tile) ||
+      !gsk_gpu_cached_can_steal ((GskGpuCached *) tile))
+    return FALSE;
+
+  data->image = g_steal_pointer (&tile->image);
+  data->color_state = tile->color_state;
+  ((GskGpuCached *) tile)->pixels = 0;
+  data->cache->n_stolen_images++;
+
+  return TRUE;
+}
+
+/*
+ * gsk_gpu_cache_steal_ancestor_tile:
+ * @self: the cache
+ * @texture: the texture to find a tile for
+ * @lod_level: the lod level of the tile
+ * @lod_filter: the lod filter of the tile
+ * @tile_id: the id of the tile
+ * @out_color_state: (out) (transfer none): the color state of the tile
+ * @diff: the region to add the changes to
+ *
+ * Takes the tile at the same position from an ancestor of @texture,
+ * if one is cached and not in use in the current frame.
+ *
+ * The returned tile contains the ancestor's data. The caller must
+ * update the parts of the tile that intersect @diff and then cache
+ * it for @texture. The ancestor will have to upload its tile again
+ * if it is drawn again.
+ *
+ * Only tiles that were uploaded directly from the texture's data
+ * can be taken this way, ie tiles for lod level 0 without mipmaps.
+ *
+ * Returns: (nullable) (transfer full): the tile or %NULL
+ */
+GskGpuImage *
+gsk_gpu_cache_steal_ancestor_tile (GskGpuCache       *self,
+                                   GdkTexture        *texture,
+                                   guint              lod_level,
+                                   GskScalingFilter   lod_filter,
+                                   gsize              tile_id,
+                                   GdkColorState    **out_color_state,
+                                   cairo_region_t    *diff)
+{
+  StealData data = {
+    .cache = self,
+    .texture = texture,
+    .lod_level = lod_level,
+    .lod_linear = lod_filter == GSK_SCALING_FILTER_TRILINEAR,
+    .tile_id = tile_id,
+  };
+
+  if (self->tile_cache == NULL ||
+      lod_level != 0 ||
+      lod_filter == GSK_SCALING_FILTER_TRILINEAR)
+    return NULL;
+
+  if (!gdk_texture_find_ancestor (texture, steal_tile, &data, diff))
+    return NULL;
+
+  *out_color_state = data.color_state;
+
+  return data.image;
+}
+
 /* }}} */
 /* {{{ GskGpuCache */
 
@@ -969,6 +1093,113 @@ gsk_gpu_cache_cache_texture_image (GskGpuCache   *self,
   gsk_gpu_cached_use ((GskGpuCached *) cache);
 }
 
+/*
+ * gsk_gpu_cache_cache_uploaded_texture_image:
+ * @self: the cache
+ * @texture: the texture
+ * @image: the image that the texture's data was uploaded to
+ *
+ * Like gsk_gpu_cache_cache_texture_image() for images in the
+ * texture's color state, but marks the image as containing a plain
+ * copy of the texture's data, so that it can be updated for
+ * descendants of @texture.
+ */
+void
+gsk_gpu_cache_cache_uploaded_texture_image (GskGpuCache *self,
+                                            GdkTexture  *texture,
+                                            GskGpuImage *image)
+{
+  GskGpuCachedTexture *cache;
+
+  cache = gsk_gpu_cached_texture_new (self, texture, image, NULL);
+  if (cache == NULL)
+    return;
+
+  cache->updatable = TRUE;
+
+  gsk_gpu_cached_use ((GskGpuCached *) cache);
+}
+
+static gboolean
+steal_texture_image (GdkTexture *ancestor,
+                     gpointer    user_data)
+{
+  StealData *data = user_data;
+  GskGpuCachedTexture *cached;
+
+  if (!texture_can_steal_from (data->texture, ancestor))
+    return FALSE;
+
+  cached = gdk_texture_get_render_data (ancestor, data->cache);
+  if (cached == NULL || cached->color_state != NULL)
+    cached = g_hash_table_lookup (data->cache->texture_cache, ancestor);
+
+  if (cached == NULL ||
+      cached->image == NULL ||
+      !cached->updatable ||
+      gsk_gpu_cached_texture_is_invalid (cached) ||
+      !gsk_gpu_cached_can_steal ((GskGpuCached *) cached))
+    return FALSE;
+
+  if (gsk_gpu_image_get_width (cached->image) != gdk_texture_get_width (data->texture) ||
+      gsk_gpu_image_get_height (cached->image) != gdk_texture_get_height (data->texture))
+    return FALSE;
+
+  data->image = g_steal_pointer (&cached->image);
+  ((GskGpuCached *) cached)->pixels = 0;
+  data->cache->n_stolen_images++;
+
+  return TRUE;
+}
+
+/*
+ * gsk_gpu_cache_steal_ancestor_texture_image:
+ * @self: the cache
+ * @texture: the texture to find an image for
+ * @diff: the region to add the changes to
+ *
+ * Looks for an uploaded image of an ancestor of @texture (see
+ * gdk_texture_set_diff()) that is not in use in the current frame,
+ * and takes it away from the ancestor.
+ *
+ * This is the copy-on-write step for updated textures: the caller
+ * must upload the parts of @texture in @diff into the image and
+ * cache it for @texture. The ancestor will upload itself again if
+ * it is drawn again.
+ *
+ * Returns: (nullable) (transfer full): the image or %NULL
+ */
+GskGpuImage *
+gsk_gpu_cache_steal_ancestor_texture_image (GskGpuCache    *self,
+                                            GdkTexture     *texture,
+                                            cairo_region_t *diff)
+{
+  StealData data = {
+    .cache = self,
+    .texture = texture,
+  };
+
+  if (!gdk_texture_find_ancestor (texture, steal_texture_image, &data, diff))
+    return NULL;
+
+  return data.image;
+}
+
+/*
+ * gsk_gpu_cache_get_n_stolen_images:
+ * @self: the cache
+ *
+ * Returns how often an image or tile was taken over from an ancestor
+ * texture to upload only the changes, for use in tests.
+ *
+ * Returns: the number of stolen images
+ */
+gsize
+gsk_gpu_cache_get_n_stolen_images (GskGpuCache *self)
+{
+  return self->n_stolen_images;
+}
+
 GskGpuCache *
 gsk_gpu_cache_new (GskGpuDevice *device)
 {
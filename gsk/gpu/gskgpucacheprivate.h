@@ -48,6 +48,12 @@ void                    gsk_gpu_cache_cache_texture_image               (GskGpuC
                                                                          GdkTexture             *texture,
                                                                          GskGpuImage            *image,
                                                                          GdkColorState          *color_state);
+void                    gsk_gpu_cache_cache_uploaded_texture_image      (GskGpuCache            *self,
+                                                                         GdkTexture             *texture,
+                                                                         GskGpuImage            *image);
+GskGpuImage *           gsk_gpu_cache_steal_ancestor_texture_image      (GskGpuCache            *self,
+                                                                         GdkTexture             *texture,
+                                                                         cairo_region_t         *diff);
 GskGpuImage *           gsk_gpu_cache_lookup_tile                       (GskGpuCache            *self,
                                                                          GdkTexture             *texture,
                                                                          guint                   lod_level,
@@ -61,6 +67,14 @@ void                    gsk_gpu_cache_cache_tile                        (GskGpuC
                                                                          gsize                   tile_id,
                                                                          GskGpuImage            *image,
                                                                          GdkColorState          *color_state);
+GskGpuImage *           gsk_gpu_cache_steal_ancestor_tile               (GskGpuCache            *self,
+                                                                         GdkTexture             *texture,
+                                                                         guint                   lod_level,
+                                                                         GskScalingFilter        lod_filter,
+                                                                         gsize                   tile_id,
+                                                                         GdkColorState         **out_color_state,
+                                                                         cairo_region_t         *diff);
+gsize                   gsk_gpu_cache_get_n_stolen_images               (GskGpuCache            *self);
 
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GskGpuCache, g_object_unref)
@@ -21,6 +21,7 @@
 #include "gdk/gdkdmabuftextureprivate.h"
 #include "gdk/gdkdrawcontextprivate.h"
 #include "gdk/gdktexturedownloaderprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
 
 #define DEFAULT_VERTEX_BUFFER_SIZE 128 * 1024
 
@@ -506,6 +507,74 @@ gsk_gpu_frame_get_last_op (GskGpuFrame *self)
   return priv->last_op;
 }
 
+/* If the texture was created as an update of another texture
+ * (see GdkMemoryTextureBuilder:update-texture) that we uploaded
+ * before, take over that image and only upload what changed.
+ */
+static GskGpuImage *
+gsk_gpu_frame_update_texture (GskGpuFrame *self,
+                              GdkTexture  *texture)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  GskGpuImage *image;
+  cairo_region_t *diff;
+
+  diff = cairo_region_create ();
+
+  image = gsk_gpu_cache_steal_ancestor_texture_image (gsk_gpu_device_get_cache (priv->device),
+                                                      texture,
+                                                      diff);
+  if (image &&
+      !gsk_gpu_upload_texture_region_op (self, image, texture, 0, 0, diff))
+    g_clear_object (&image);
+
+  cairo_region_destroy (diff);
+
+  return image;
+}
+
+/* Decodes the full image just for the upload, so it doesn't stay
+ * in memory. Images that are too large get drawn as tiles instead,
+ * decoded on demand.
+ */
+static GskGpuImage *
+gsk_gpu_frame_upload_tiled_texture (GskGpuFrame  *self,
+                                    gboolean      with_mipmap,
+                                    GdkTexture   *texture)
+{
+  GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  gsize max_size = gsk_gpu_device_get_max_image_size (priv->device);
+  GskGpuImage *image;
+  GdkTexture *decoded;
+  GError *error = NULL;
+  int width, height;
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  if ((gsize) width > max_size || (gsize) height > max_size)
+    return NULL;
+
+  decoded = gdk_tiled_texture_decode (GDK_TILED_TEXTURE (texture),
+                                      &(cairo_rectangle_int_t) { 0, 0, width, height },
+                                      0,
+                                      FALSE,
+                                      &error);
+  if (decoded == NULL)
+    {
+      /* The texture already warned about it */
+      g_error_free (error);
+      return NULL;
+    }
+
+  image = gsk_gpu_upload_texture_op_try (self, with_mipmap, 0, GSK_SCALING_FILTER_NEAREST, decoded);
+  g_object_unref (decoded);
+
+  if (image)
+    gsk_gpu_cache_cache_uploaded_texture_image (gsk_gpu_device_get_cache (priv->device), texture, image);
+
+  return image;
+}
+
 static GskGpuImage *
 gsk_gpu_frame_do_upload_texture (GskGpuFrame  *self,
                                  gboolean      dmabuf_import,
@@ -513,15 +582,28 @@ gsk_gpu_frame_do_upload_texture (GskGpuFrame  *self,
                                  GdkTexture   *texture)
 {
   GskGpuFramePrivate *priv = gsk_gpu_frame_get_instance_private (self);
+  GskGpuCache *cache = gsk_gpu_device_get_cache (priv->device);
   GskGpuImage *image;
 
+  if (GDK_IS_TILED_TEXTURE (texture))
+    return gsk_gpu_frame_upload_tiled_texture (self, with_mipmap, texture);
+
   image = GSK_GPU_FRAME_GET_CLASS (self)->upload_texture (self, with_mipmap, texture);
+  if (image)
+    {
+      gsk_gpu_cache_cache_texture_image (cache, texture, image, NULL);
+      return image;
+    }
 
-  if (image == NULL && !dmabuf_import)
+  if (dmabuf_import)
+    return NULL;
+
+  image = gsk_gpu_frame_update_texture (self, texture);
+  if (image == NULL)
     image = gsk_gpu_upload_texture_op_try (self, with_mipmap, 0, GSK_SCALING_FILTER_NEAREST, texture);
 
   if (image)
-    gsk_gpu_cache_cache_texture_image (gsk_gpu_device_get_cache (priv->device), texture, image, NULL);
+    gsk_gpu_cache_cache_uploaded_texture_image (cache, texture, image);
 
   return image;
 }
@@ -46,6 +46,8 @@ gsize                   gsk_gpu_image_get_height                        (GskGpuI
 GskGpuImageFlags        gsk_gpu_image_get_flags                         (GskGpuImage            *self);
 void                    gsk_gpu_image_set_flags                         (GskGpuImage            *self,
                                                                          GskGpuImageFlags        flags);
+void                    gsk_gpu_image_unset_flags                       (GskGpuImage            *self,
+                                                                         GskGpuImageFlags        flags);
 GskGpuConversion        gsk_gpu_image_get_conversion                    (GskGpuImage            *self);
 GdkShaderOp             gsk_gpu_image_get_shader_op                     (GskGpuImage            *self);
 
@@ -29,6 +29,7 @@
 #include "gskgpulineargradientopprivate.h"
 #include "gskgpumaskopprivate.h"
 #include "gskgpumipmapopprivate.h"
+#include "gskgpupathopprivate.h"
 #include "gskgpuradialgradientopprivate.h"
 #include "gskgpurenderpassopprivate.h"
 #include "gskgpuroundedcoloropprivate.h"
@@ -52,6 +53,7 @@
 #include "gdk/gdkrgbaprivate.h"
 #include "gdk/gdksubsurfaceprivate.h"
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
 
 /* the epsilon we allow pixels to be off due to rounding errors.
  * Chosen rather randomly.
@@ -2050,14 +2052,59 @@ gsk_gpu_node_processor_draw_texture_tiles (GskGpuNodeProcessor    *self,
 
           if (tile == NULL)
             {
-              if (memtex == NULL)
-                memtex = gdk_memory_texture_from_texture (texture);
-              subtex = gdk_memory_texture_new_subtexture (memtex,
-                                                          x * tile_size,
-                                                          y * tile_size,
-                                                          MIN (tile_size, width - x * tile_size),
-                                                          MIN (tile_size, height - y * tile_size));
-              tile = gsk_gpu_upload_texture_op_try (self->frame, need_mipmap, lod_level, scaling_filter, subtex);
+              cairo_region_t *diff = cairo_region_create ();
+
+              /* Reuse the tile of an older version of the texture */
+              tile = gsk_gpu_cache_steal_ancestor_tile (cache, texture, lod_level, scaling_filter, y * n_width + x, &tile_cs, diff);
+              if (tile)
+                {
+                  if (memtex == NULL)
+                    memtex = gdk_memory_texture_from_texture (texture);
+
+                  if (gsk_gpu_upload_texture_region_op (self->frame, tile, GDK_TEXTURE (memtex), x * tile_size, y * tile_size, diff))
+                    gsk_gpu_cache_cache_tile (cache, texture, lod_level, scaling_filter, y * n_width + x, tile, tile_cs);
+                  else
+                    g_clear_object (&tile);
+                }
+              cairo_region_destroy (diff);
+            }
+
+          if (tile == NULL)
+            {
+              if (GDK_IS_TILED_TEXTURE (texture))
+                {
+                  GError *error = NULL;
+
+                  /* Only decode this tile, and already at the right size */
+                  subtex = gdk_tiled_texture_decode (GDK_TILED_TEXTURE (texture),
+                                                     &(cairo_rectangle_int_t) {
+                                                         x * tile_size,
+                                                         y * tile_size,
+                                                         MIN (tile_size, width - x * tile_size),
+                                                         MIN (tile_size, height - y * tile_size)
+                                                     },
+                                                     lod_level,
+                                                     scaling_filter == GSK_SCALING_FILTER_TRILINEAR,
+                                                     &error);
+                  if (subtex == NULL)
+                    {
+                      /* The texture already warned about it */
+                      g_error_free (error);
+                      continue;
+                    }
+                  tile = gsk_gpu_upload_texture_op_try (self->frame, need_mipmap, 0, scaling_filter, subtex);
+                }
+              else
+                {
+                  if (memtex == NULL)
+                    memtex = gdk_memory_texture_from_texture (texture);
+                  subtex = gdk_memory_texture_new_subtexture (memtex,
+                                                              x * tile_size,
+                                                              y * tile_size,
+                                                              MIN (tile_size, width - x * tile_size),
+                                                              MIN (tile_size, height - y * tile_size));
+                  tile = gsk_gpu_upload_texture_op_try (self->frame, need_mipmap, lod_level, scaling_filter, subtex);
+                }
               g_object_unref (subtex);
               if (tile == NULL)
                 {
@@ -3479,6 +3526,20 @@ gsk_gpu_node_processor_add_fill_node (GskGpuNodeProcessor *self,
 
   child = gsk_fill_node_get_child (node);
 
+  if (GSK_RENDER_NODE_TYPE (child) == GSK_COLOR_NODE &&
+      gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_PATHS) &&
+      gsk_gpu_fill_op_try (self->frame,
+                           gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, &clip_bounds),
+                           self->ccs,
+                           self->opacity,
+                           &self->offset,
+                           &self->scale,
+                           &clip_bounds,
+                           gsk_fill_node_get_path (node),
+                           gsk_fill_node_get_fill_rule (node),
+                           gsk_color_node_get_gdk_color (child)))
+    return;
+
   cache = gsk_gpu_device_get_cache (gsk_gpu_frame_get_device (self->frame));
 
   mask_image = gsk_gpu_cached_fill_lookup (cache,
@@ -3560,6 +3621,20 @@ gsk_gpu_node_processor_add_stroke_node (GskGpuNodeProcessor *self,
 
   child = gsk_stroke_node_get_child (node);
 
+  if (GSK_RENDER_NODE_TYPE (child) == GSK_COLOR_NODE &&
+      gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_PATHS) &&
+      gsk_gpu_stroke_op_try (self->frame,
+                             gsk_gpu_clip_get_shader_clip (&self->clip, &self->offset, &clip_bounds),
+                             self->ccs,
+                             self->opacity,
+                             &self->offset,
+                             &self->scale,
+                             &clip_bounds,
+                             gsk_stroke_node_get_path (node),
+                             gsk_stroke_node_get_stroke (node),
+                             gsk_color_node_get_gdk_color (child)))
+    return;
+
   cache = gsk_gpu_device_get_cache (gsk_gpu_frame_get_device (self->frame));
 
   mask_image = gsk_gpu_cached_stroke_lookup (cache,
@@ -0,0 +1,781 @@
+#include "config.h"
+
+#include "gskgpupathopprivate.h"
+
+#include "gskgpudeviceprivate.h"
+#include "gskgpuframeprivate.h"
+#include "gskgpuimageprivate.h"
+#include "gskgpuprintprivate.h"
+#include "gskgpuuploadopprivate.h"
+#include "gskpathprivate.h"
+#include "gskrectprivate.h"
+#include "gskstrokeprivate.h"
+
+#include "gdk/gdkmemorytextureprivate.h"
+
+#include "gpu/shaders/gskgpupathinstance.h"
+
+#include <math.h>
+
+#define VARIATION_EVEN_ODD 1
+
+/* Maximum distance in device pixels between the path and the lines
+ * that it is flattened into */
+#define TOLERANCE 0.25
+
+/* The shader loops over all lines in a band for every pixel, so
+ * the path is split into bands with about this many lines each */
+#define LINES_PER_BAND 32
+#define MAX_BANDS 64
+
+#define LINES_PER_ROW 1024
+
+typedef struct _GskGpuPathOp GskGpuPathOp;
+
+struct _GskGpuPathOp
+{
+  GskGpuShaderOp op;
+};
+
+static void
+gsk_gpu_path_op_print_instance (GskGpuShaderOp *shader,
+                                gpointer        instance_,
+                                GString        *string)
+{
+  GskGpuPathInstance *instance = (GskGpuPathInstance *) instance_;
+
+  gsk_gpu_print_rect (string, instance->rect);
+  gsk_gpu_print_image (string, shader->images[0]);
+  gsk_gpu_print_rgba (string, instance->color);
+  g_string_append_printf (string, "%u lines ", instance->segments[1]);
+}
+
+static const GskGpuShaderOpClass GSK_GPU_PATH_OP_CLASS = {
+  {
+    GSK_GPU_OP_SIZE (GskGpuPathOp),
+    GSK_GPU_STAGE_SHADER,
+    gsk_gpu_shader_op_finish,
+    gsk_gpu_shader_op_print,
+#ifdef GDK_RENDERING_VULKAN
+    gsk_gpu_shader_op_vk_command,
+#endif
+    gsk_gpu_shader_op_gl_command
+  },
+  "gskgpupath",
+  gsk_gpu_path_n_textures,
+  sizeof (GskGpuPathInstance),
+#ifdef GDK_RENDERING_VULKAN
+  &gsk_gpu_path_info,
+#endif
+  gsk_gpu_path_op_print_instance,
+  gsk_gpu_path_setup_attrib_locations,
+  gsk_gpu_path_setup_vao
+};
+
+/* {{{ Lines */
+
+/* One line of the flattened path, in device pixels.
+ * This is the texel format of the image the shader reads.
+ */
+typedef struct _Line Line;
+struct _Line
+{
+  float x0, y0, x1, y1;
+};
+
+typedef struct _Lines Lines;
+struct _Lines
+{
+  GArray *lines;
+  graphene_point_t offset;
+  float sx, sy;
+};
+
+static void
+lines_init (Lines                  *self,
+            const graphene_point_t *offset,
+            const graphene_vec2_t  *scale)
+{
+  self->lines = g_array_new (FALSE, FALSE, sizeof (Line));
+  self->offset = *offset;
+  self->sx = graphene_vec2_get_x (scale);
+  self->sy = graphene_vec2_get_y (scale);
+}
+
+static void
+lines_clear (Lines *self)
+{
+  g_array_unref (self->lines);
+}
+
+static void
+lines_add (Lines                  *self,
+           const graphene_point_t *from,
+           const graphene_point_t *to)
+{
+  Line line = {
+    (from->x + self->offset.x) * self->sx,
+    (from->y + self->offset.y) * self->sy,
+    (to->x + self->offset.x) * self->sx,
+    (to->y + self->offset.y) * self->sy,
+  };
+
+  /* Horizontal lines never change the winding */
+  if (line.y0 == line.y1)
+    return;
+
+  g_array_append_val (self->lines, line);
+}
+
+/* Adds the outline of a polygon. All polygons are added with the
+ * same orientation, so that overlapping ones add up instead of
+ * cancelling each other.
+ */
+static void
+lines_add_polygon (Lines                  *self,
+                   const graphene_point_t *points,
+                   gsize                   n_points)
+{
+  float area = 0;
+  gsize i;
+
+  for (i = 0; i < n_points; i++)
+    {
+      const graphene_point_t *p = &points[i];
+      const graphene_point_t *q = &points[(i + 1) % n_points];
+
+      area += p->x * q->y - q->x * p->y;
+    }
+
+  if (area * self->sx * self->sy >= 0)
+    {
+      for (i = 0; i < n_points; i++)
+        lines_add (self, &points[i], &points[(i + 1) % n_points]);
+    }
+  else
+    {
+      for (i = 0; i < n_points; i++)
+        lines_add (self, &points[(i + 1) % n_points], &points[i]);
+    }
+}
+
+/* Uploads the lines and draws them in bands covering @rect */
+static gboolean
+lines_draw (Lines                  *self,
+            GskGpuFrame            *frame,
+            GskGpuShaderClip        clip,
+            GskGpuColorStates       color_states,
+            float                   opacity,
+            const graphene_rect_t  *rect,
+            GskFillRule             fill_rule,
+            const GdkColor         *color)
+{
+  GArray *band_lines;
+  GskGpuImage *image;
+  GdkTexture *texture;
+  GBytes *bytes;
+  gsize width, height, n_bands, i, j;
+  int top, bottom;
+  float right;
+  struct {
+    int top, bottom;
+    guint first, n_lines;
+  } bands[MAX_BANDS];
+
+  top = floor ((rect->origin.y + self->offset.y) * self->sy);
+  bottom = ceil ((rect->origin.y + rect->size.height + self->offset.y) * self->sy);
+  right = (rect->origin.x + rect->size.width + self->offset.x) * self->sx;
+  if (top >= bottom)
+    return TRUE;
+
+  n_bands = CLAMP (self->lines->len / LINES_PER_BAND, 1, MAX_BANDS);
+  n_bands = MIN (n_bands, bottom - top);
+
+  band_lines = g_array_new (FALSE, FALSE, sizeof (Line));
+  for (i = 0; i < n_bands; i++)
+    {
+      bands[i].top = top + (int) ((bottom - top) * i / n_bands);
+      bands[i].bottom = top + (int) ((bottom - top) * (i + 1) / n_bands);
+      bands[i].first = band_lines->len;
+
+      for (j = 0; j < self->lines->len; j++)
+        {
+          const Line *line = &g_array_index (self->lines, Line, j);
+
+          /* Lines to the right of the band don't change its winding */
+          if (MAX (line->y0, line->y1) <= bands[i].top ||
+              MIN (line->y0, line->y1) >= bands[i].bottom ||
+              MIN (line->x0, line->x1) >= right)
+            continue;
+
+          g_array_append_val (band_lines, *line);
+        }
+
+      bands[i].n_lines = band_lines->len - bands[i].first;
+    }
+
+  if (band_lines->len == 0)
+    {
+      g_array_unref (band_lines);
+      return TRUE;
+    }
+
+  width = MIN (band_lines->len, LINES_PER_ROW);
+  height = (band_lines->len + width - 1) / width;
+  if (height > gsk_gpu_device_get_max_image_size (gsk_gpu_frame_get_device (frame)))
+    {
+      g_array_unref (band_lines);
+      return FALSE;
+    }
+
+  g_array_set_size (band_lines, width * height);
+  bytes = g_bytes_new_take (g_array_steal (band_lines, NULL), width * height * sizeof (Line));
+  texture = gdk_memory_texture_new (width,
+                                    height,
+                                    GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED,
+                                    bytes,
+                                    width * sizeof (Line));
+  g_bytes_unref (bytes);
+  g_array_unref (band_lines);
+
+  image = gsk_gpu_upload_texture_op_try (frame, FALSE, 0, GSK_SCALING_FILTER_NEAREST, texture);
+  g_object_unref (texture);
+  if (image == NULL)
+    return FALSE;
+
+  /* The lines must not lose precision */
+  if (gsk_gpu_image_get_format (image) != GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED)
+    {
+      g_object_unref (image);
+      return FALSE;
+    }
+
+  for (i = 0; i < n_bands; i++)
+    {
+      GskGpuPathInstance *instance;
+      graphene_rect_t band;
+
+      if (bands[i].n_lines == 0)
+        continue;
+
+      graphene_rect_init (&band,
+                          rect->origin.x,
+                          bands[i].top / self->sy - self->offset.y,
+                          rect->size.width,
+                          (bands[i].bottom - bands[i].top) / self->sy);
+      if (!gsk_rect_intersection (&band, rect, &band))
+        continue;
+
+      gsk_gpu_shader_op_alloc (frame,
+                               &GSK_GPU_PATH_OP_CLASS,
+                               color_states,
+                               fill_rule == GSK_FILL_RULE_EVEN_ODD ? VARIATION_EVEN_ODD : 0,
+                               clip,
+                               (GskGpuImage *[1]) { image },
+                               (GskGpuSampler[1]) { GSK_GPU_SAMPLER_NEAREST },
+                               &instance);
+
+      gsk_gpu_rect_to_float (&band, &self->offset, instance->rect);
+      gsk_gpu_color_to_float (color, gsk_gpu_color_states_get_alt (color_states), opacity, instance->color);
+      instance->segments[0] = bands[i].first;
+      instance->segments[1] = bands[i].n_lines;
+    }
+
+  g_object_unref (image);
+
+  return TRUE;
+}
+
+/* }}} */
+/* {{{ Fill */
+
+typedef struct _Fill Fill;
+struct _Fill
+{
+  Lines lines;
+  graphene_point_t start;
+  graphene_point_t current;
+};
+
+static void
+fill_close (Fill *self)
+{
+  lines_add (&self->lines, &self->current, &self->start);
+  self->current = self->start;
+}
+
+static gboolean
+fill_add_op (GskPathOperation        op,
+             const graphene_point_t *pts,
+             gsize                   n_pts,
+             float                   weight,
+             gpointer                user_data)
+{
+  Fill *self = user_data;
+
+  switch (op)
+    {
+    case GSK_PATH_MOVE:
+      /* Fills close contours implicitly */
+      fill_close (self);
+      self->start = pts[0];
+      self->current = pts[0];
+      break;
+
+    case GSK_PATH_CLOSE:
+      fill_close (self);
+      break;
+
+    case GSK_PATH_LINE:
+      lines_add (&self->lines, &self->current, &pts[1]);
+      self->current = pts[1];
+      break;
+
+    case GSK_PATH_QUAD:
+    case GSK_PATH_CUBIC:
+    case GSK_PATH_CONIC:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  return TRUE;
+}
+
+/* }}} */
+/* {{{ Stroke */
+
+typedef struct _Stroke Stroke;
+struct _Stroke
+{
+  Lines lines;
+  const GskStroke *stroke;
+  float tolerance;
+  GArray *points;
+  GArray *arc_points; /* scratch space for stroke_add_arc() */
+};
+
+static inline void
+normal (const graphene_point_t *from,
+        const graphene_point_t *to,
+        float                   length,
+        graphene_point_t       *result)
+{
+  float dx = to->x - from->x;
+  float dy = to->y - from->y;
+  float scale = length / sqrtf (dx * dx + dy * dy);
+
+  *result = GRAPHENE_POINT_INIT (- dy * scale, dx * scale);
+}
+
+/* Adds the pie slice of a circle, approximated so that it stays
+ * within the tolerance */
+static void
+stroke_add_arc (Stroke                 *self,
+                const graphene_point_t *center,
+                float                   radius,
+                float                   start_angle,
+                float                   sweep)
+{
+  graphene_point_t *points;
+  float step;
+  gsize i, n;
+
+  if (self->tolerance >= radius)
+    step = G_PI / 2;
+  else
+    step = 2 * acosf (1 - self->tolerance / radius);
+
+  /* n grows with the radius, so this can get large */
+  n = MAX (ceilf (fabsf (sweep) / step), 1);
+  g_array_set_size (self->arc_points, n + 2);
+  points = (graphene_point_t *) self->arc_points->data;
+
+  points[0] = *center;
+  for (i = 0; i <= n; i++)
+    {
+      float angle = start_angle + sweep * i / n;
+
+      points[i + 1] = GRAPHENE_POINT_INIT (center->x + radius * cosf (angle),
+                                           center->y + radius * sinf (angle));
+    }
+
+  lines_add_polygon (&self->lines, points, n + 2);
+}
+
+static void
+stroke_add_cap (Stroke                 *self,
+                const graphene_point_t *point,
+                const graphene_point_t *from)
+{
+  float half_width = self->stroke->line_width / 2;
+  graphene_point_t n;
+
+  normal (from, point, half_width, &n);
+
+  switch (self->stroke->line_cap)
+    {
+    case GSK_LINE_CAP_BUTT:
+      break;
+
+    case GSK_LINE_CAP_ROUND:
+      stroke_add_arc (self, point, half_width, atan2f (n.y, n.x), - G_PI);
+      break;
+
+    case GSK_LINE_CAP_SQUARE:
+      lines_add_polygon (&self->lines,
+                         (graphene_point_t[4]) {
+                           GRAPHENE_POINT_INIT (point->x + n.x, point->y + n.y),
+                           GRAPHENE_POINT_INIT (point->x + n.x + n.y, point->y + n.y - n.x),
+                           GRAPHENE_POINT_INIT (point->x - n.x + n.y, point->y - n.y - n.x),
+                           GRAPHENE_POINT_INIT (point->x - n.x, point->y - n.y),
+                         },
+                         4);
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static void
+stroke_add_join (Stroke                 *self,
+                 const graphene_point_t *prev,
+                 const graphene_point_t *point,
+                 const graphene_point_t *next)
+{
+  float half_width = self->stroke->line_width / 2;
+  graphene_point_t n0, n1, o0, o1;
+  float cross, dot, side;
+
+  normal (prev, point, half_width, &n0);
+  normal (point, next, half_width, &n1);
+  cross = n0.x * n1.y - n0.y * n1.x;
+  dot = (n0.x * n1.x + n0.y * n1.y) / (half_width * half_width);
+
+  /* Straight continuation, nothing to fill */
+  if (fabsf (cross) < 1e-6 * half_width * half_width && dot > 0)
+    return;
+
+  /* The join is on the outside of the turn */
+  side = cross > 0 ? -1 : 1;
+  o0 = GRAPHENE_POINT_INIT (point->x + side * n0.x, point->y + side * n0.y);
+  o1 = GRAPHENE_POINT_INIT (point->x + side * n1.x, point->y + side * n1.y);
+
+  switch (self->stroke->line_join)
+    {
+    case GSK_LINE_JOIN_MITER:
+      if (dot > -1 + 1e-6 && 2 / (1 + dot) <= self->stroke->miter_limit * self->stroke->miter_limit)
+        {
+          graphene_point_t m;
+
+          m = GRAPHENE_POINT_INIT (point->x + side * (n0.x + n1.x) / (1 + dot),
+                                   point->y + side * (n0.y + n1.y) / (1 + dot));
+          lines_add_polygon (&self->lines, (graphene_point_t[4]) { *point, o0, m, o1 }, 4);
+          break;
+        }
+      G_GNUC_FALLTHROUGH;
+
+    case GSK_LINE_JOIN_BEVEL:
+      lines_add_polygon (&self->lines, (graphene_point_t[3]) { *point, o0, o1 }, 3);
+      break;
+
+    case GSK_LINE_JOIN_ROUND:
+      {
+        float start = atan2f (o0.y - point->y, o0.x - point->x);
+        float sweep = atan2f (o1.y - point->y, o1.x - point->x) - start;
+
+        if (sweep > G_PI)
+          sweep -= 2 * G_PI;
+        else if (sweep < - G_PI)
+          sweep += 2 * G_PI;
+
+        stroke_add_arc (self, point, half_width, start, sweep);
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+/* Turns a flattened contour into polygons: one rectangle per line,
+ * plus joins and caps. Their union is the stroke, and the winding
+ * fill rule takes care of the overlaps.
+ */
+static void
+stroke_finish_contour (Stroke   *self,
+                       gboolean  closed)
+{
+  const graphene_point_t *points;
+  float half_width = self->stroke->line_width / 2;
+  gsize i, n;
+
+  points = (const graphene_point_t *) self->points->data;
+  n = self->points->len;
+
+  if (closed && n > 1 && graphene_point_equal (&points[0], &points[n - 1]))
+    n--;
+
+  if (n == 0)
+    return;
+
+  if (n == 1)
+    {
+      /* Degenerate contours are drawn like cairo does */
+      switch (self->stroke->line_cap)
+        {
+        case GSK_LINE_CAP_ROUND:
+          stroke_add_arc (self, &points[0], half_width, 0, 2 * G_PI);
+          break;
+
+        case GSK_LINE_CAP_SQUARE:
+          lines_add_polygon (&self->lines,
+                             (graphene_point_t[4]) {
+                               GRAPHENE_POINT_INIT (points[0].x - half_width, points[0].y - half_width),
+                               GRAPHENE_POINT_INIT (points[0].x + half_width, points[0].y - half_width),
+                               GRAPHENE_POINT_INIT (points[0].x + half_width, points[0].y + half_width),
+                               GRAPHENE_POINT_INIT (points[0].x - half_width, points[0].y + half_width),
+                             },
+                             4);
+          break;
+
+        case GSK_LINE_CAP_BUTT:
+        default:
+          break;
+        }
+
+      g_array_set_size (self->points, 0);
+      return;
+    }
+
+  for (i = 0; i < (closed ? n : n - 1); i++)
+    {
+      const graphene_point_t *a = &points[i];
+      const graphene_point_t *b = &points[(i + 1) % n];
+      graphene_point_t normal_ab;
+
+      normal (a, b, half_width, &normal_ab);
+      lines_add_polygon (&self->lines,
+                         (graphene_point_t[4]) {
+                           GRAPHENE_POINT_INIT (a->x + normal_ab.x, a->y + normal_ab.y),
+                           GRAPHENE_POINT_INIT (b->x + normal_ab.x, b->y + normal_ab.y),
+                           GRAPHENE_POINT_INIT (b->x - normal_ab.x, b->y - normal_ab.y),
+                           GRAPHENE_POINT_INIT (a->x - normal_ab.x, a->y - normal_ab.y),
+                         },
+                         4);
+    }
+
+  if (closed)
+    {
+      for (i = 0; i < n; i++)
+        stroke_add_join (self, &points[(i + n - 1) % n], &points[i], &points[(i + 1) % n]);
+    }
+  else
+    {
+      for (i = 1; i + 1 < n; i++)
+        stroke_add_join (self, &points[i - 1], &points[i], &points[i + 1]);
+
+      stroke_add_cap (self, &points[0], &points[1]);
+      stroke_add_cap (self, &points[n - 1], &points[n - 2]);
+    }
+
+  g_array_set_size (self->points, 0);
+}
+
+static void
+stroke_add_point (Stroke                 *self,
+                  const graphene_point_t *point)
+{
+  /* Zero-length lines have no direction, skip them */
+  if (self->points->len > 0 &&
+      graphene_point_equal (point, &g_array_index (self->points, graphene_point_t, self->points->len - 1)))
+    return;
+
+  g_array_append_val (self->points, *point);
+}
+
+static gboolean
+stroke_add_op (GskPathOperation        op,
+               const graphene_point_t *pts,
+               gsize                   n_pts,
+               float                   weight,
+               gpointer                user_data)
+{
+  Stroke *self = user_data;
+
+  switch (op)
+    {
+    case GSK_PATH_MOVE:
+      stroke_finish_contour (self, FALSE);
+      stroke_add_point (self, &pts[0]);
+      break;
+
+    case GSK_PATH_CLOSE:
+      stroke_add_point (self, &pts[1]);
+      stroke_finish_contour (self, TRUE);
+      break;
+
+    case GSK_PATH_LINE:
+      stroke_add_point (self, &pts[1]);
+      break;
+
+    case GSK_PATH_QUAD:
+    case GSK_PATH_CUBIC:
+    case GSK_PATH_CONIC:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  return TRUE;
+}
+
+/* }}} */
+
+static float
+get_tolerance (const graphene_vec2_t *scale)
+{
+  return TOLERANCE / MAX (fabsf (graphene_vec2_get_x (scale)), fabsf (graphene_vec2_get_y (scale)));
+}
+
+static GskGpuColorStates
+prepare_color (GdkColorState  *ccs,
+               const GdkColor *color,
+               GdkColor       *result)
+{
+  GdkColorState *alt;
+
+  alt = gsk_gpu_color_states_find (ccs, color);
+  gdk_color_convert (result, alt, color);
+
+  return gsk_gpu_color_states_create (ccs, TRUE, alt, FALSE);
+}
+
+/*<private>
+ * gsk_gpu_fill_op_try:
+ * @frame: the frame
+ * @clip: the shader clip to use
+ * @ccs: the compositing color state
+ * @opacity: opacity to apply to @color
+ * @offset: offset applied to @rect and @path
+ * @scale: scale from @path coordinates to device pixels
+ * @rect: the area to draw
+ * @path: the path to fill
+ * @fill_rule: the fill rule
+ * @color: the color to fill with
+ *
+ * Fills a path by computing its coverage in a shader instead of
+ * rasterizing it into a mask on the CPU.
+ *
+ * Returns: %FALSE if the path could not be drawn this way and the
+ *   caller needs to draw it in a different way
+ */
+gboolean
+gsk_gpu_fill_op_try (GskGpuFrame            *frame,
+                     GskGpuShaderClip        clip,
+                     GdkColorState          *ccs,
+                     float                   opacity,
+                     const graphene_point_t *offset,
+                     const graphene_vec2_t  *scale,
+                     const graphene_rect_t  *rect,
+                     GskPath                *path,
+                     GskFillRule             fill_rule,
+                     const GdkColor         *color)
+{
+  GskGpuColorStates color_states;
+  GdkColor color2;
+  Fill fill;
+  gboolean result;
+
+  lines_init (&fill.lines, offset, scale);
+  fill.start = GRAPHENE_POINT_INIT (0, 0);
+  fill.current = GRAPHENE_POINT_INIT (0, 0);
+
+  gsk_path_foreach_with_tolerance (path,
+                                   GSK_PATH_FOREACH_ALLOW_ONLY_LINES,
+                                   get_tolerance (scale),
+                                   fill_add_op,
+                                   &fill);
+  fill_close (&fill);
+
+  color_states = prepare_color (ccs, color, &color2);
+  result = lines_draw (&fill.lines, frame, clip, color_states, opacity, rect, fill_rule, &color2);
+
+  gdk_color_finish (&color2);
+  lines_clear (&fill.lines);
+
+  return result;
+}
+
+/*<private>
+ * gsk_gpu_stroke_op_try:
+ * @frame: the frame
+ * @clip: the shader clip to use
+ * @ccs: the compositing color state
+ * @opacity: opacity to apply to @color
+ * @offset: offset applied to @rect and @path
+ * @scale: scale from @path coordinates to device pixels
+ * @rect: the area to draw
+ * @path: the path to stroke
+ * @stroke: the stroke parameters
+ * @color: the color to stroke with
+ *
+ * Strokes a path by computing its coverage in a shader instead of
+ * rasterizing it into a mask on the CPU.
+ *
+ * Dashed strokes are not supported.
+ *
+ * Returns: %FALSE if the path could not be drawn this way and the
+ *   caller needs to draw it in a different way
+ */
+gboolean
+gsk_gpu_stroke_op_try (GskGpuFrame            *frame,
+                       GskGpuShaderClip        clip,
+                       GdkColorState          *ccs,
+                       float                   opacity,
+                       const graphene_point_t *offset,
+                       const graphene_vec2_t  *scale,
+                       const graphene_rect_t  *rect,
+                       GskPath                *path,
+                       const GskStroke        *stroke,
+                       const GdkColor         *color)
+{
+  GskGpuColorStates color_states;
+  GdkColor color2;
+  Stroke self;
+  gboolean result;
+
+  if (stroke->n_dash > 0)
+    return FALSE;
+
+  if (stroke->line_width <= 0)
+    return TRUE;
+
+  lines_init (&self.lines, offset, scale);
+  self.stroke = stroke;
+  self.tolerance = get_tolerance (scale);
+  self.points = g_array_new (FALSE, FALSE, sizeof (graphene_point_t));
+  self.arc_points = g_array_new (FALSE, FALSE, sizeof (graphene_point_t));
+
+  gsk_path_foreach_with_tolerance (path,
+                                   GSK_PATH_FOREACH_ALLOW_ONLY_LINES,
+                                   self.tolerance,
+                                   stroke_add_op,
+                                   &self);
+  stroke_finish_contour (&self, FALSE);
+
+  color_states = prepare_color (ccs, color, &color2);
+  result = lines_draw (&self.lines, frame, clip, color_states, opacity, rect, GSK_FILL_RULE_WINDING, &color2);
+
+  gdk_color_finish (&color2);
+  g_array_unref (self.arc_points);
+  g_array_unref (self.points);
+  lines_clear (&self.lines);
+
+  return result;
+}
+
+/* vim:set foldmethod=marker: */
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "gskgpushaderopprivate.h"
+
+#include "gsk/gskpath.h"
+#include "gsk/gskstroke.h"
+
+#include <graphene.h>
+
+G_BEGIN_DECLS
+
+gboolean                gsk_gpu_fill_op_try                             (GskGpuFrame                    *frame,
+                                                                         GskGpuShaderClip                clip,
+                                                                         GdkColorState                  *ccs,
+                                                                         float                           opacity,
+                                                                         const graphene_point_t         *offset,
+                                                                         const graphene_vec2_t          *scale,
+                                                                         const graphene_rect_t          *rect,
+                                                                         GskPath                        *path,
+                                                                         GskFillRule                     fill_rule,
+                                                                         const GdkColor                 *color);
+
+gboolean                gsk_gpu_stroke_op_try                           (GskGpuFrame                    *frame,
+                                                                         GskGpuShaderClip                clip,
+                                                                         GdkColorState                  *ccs,
+                                                                         float                           opacity,
+                                                                         const graphene_point_t         *offset,
+                                                                         const graphene_vec2_t          *scale,
+                                                                         const graphene_rect_t          *rect,
+                                                                         GskPath                        *path,
+                                                                         const GskStroke                *stroke,
+                                                                         const GdkColor                 *color);
+
+
+G_END_DECLS
+
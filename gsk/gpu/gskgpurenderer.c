@@ -33,6 +33,7 @@ static const GdkDebugKey gsk_gpu_optimization_keys[] = {
   { "to-image",  GSK_GPU_OPTIMIZE_TO_IMAGE,          "Don't fast-path creation of images for nodes" },
   { "occlusion", GSK_GPU_OPTIMIZE_OCCLUSION_CULLING, "Disable occlusion culling via opaque node tracking" },
   { "repeat",    GSK_GPU_OPTIMIZE_REPEAT,            "Repeat drawing operations instead of using offscreen and GL_REPEAT" },
+  { "paths",     GSK_GPU_OPTIMIZE_PATHS,             "Rasterize fills and strokes with cairo instead of a shader" },
 };
 
 typedef struct _GskGpuRendererPrivate GskGpuRendererPrivate;
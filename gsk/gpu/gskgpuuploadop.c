@@ -16,6 +16,7 @@
 #include "gdk/gdkcolorstateprivate.h"
 #include "gdk/gdkdmabuftextureprivate.h"
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gsk/gskdebugprivate.h"
 
@@ -263,6 +264,7 @@ struct _GskGpuUploadTextureOp
   GdkTexture *texture;
   guint lod_level;
   GskScalingFilter lod_filter;
+  cairo_rectangle_int_t area; /* only for region uploads */
 };
 
 static void
@@ -428,6 +430,156 @@ gsk_gpu_upload_texture_op_try (GskGpuFrame      *frame,
   return g_object_ref (self->image);
 }
 
+static void
+gsk_gpu_upload_texture_area_op_print (GskGpuOp    *op,
+                                      GskGpuFrame *frame,
+                                      GString     *string,
+                                      guint        indent)
+{
+  GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
+
+  gsk_gpu_print_op (string, indent, "upload-texture-area");
+  gsk_gpu_print_int_rect (string, &self->area);
+  gsk_gpu_print_image (string, self->image);
+  gsk_gpu_print_newline (string);
+}
+
+#ifdef GDK_RENDERING_VULKAN
+static GskGpuOp *
+gsk_gpu_upload_texture_area_op_vk_command (GskGpuOp              *op,
+                                           GskGpuFrame           *frame,
+                                           GskVulkanCommandState *state)
+{
+  GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
+
+  /* Always go via a buffer, the image may still be in use by
+   * previous frames, so we can't write to it from the CPU.
+   */
+  return gsk_gpu_upload_op_vk_command_with_area (op,
+                                                 frame,
+                                                 state,
+                                                 GSK_VULKAN_IMAGE (self->image),
+                                                 &self->area,
+                                                 gsk_gpu_upload_texture_op_draw,
+                                                 &self->buffer);
+}
+#endif
+
+static GskGpuOp *
+gsk_gpu_upload_texture_area_op_gl_command (GskGpuOp          *op,
+                                           GskGpuFrame       *frame,
+                                           GskGLCommandState *state)
+{
+  GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
+
+  return gsk_gpu_upload_op_gl_command_with_area (op,
+                                                 frame,
+                                                 self->image,
+                                                 &self->area,
+                                                 gsk_gpu_upload_texture_op_draw);
+}
+
+static const GskGpuOpClass GSK_GPU_UPLOAD_TEXTURE_AREA_OP_CLASS = {
+  GSK_GPU_OP_SIZE (GskGpuUploadTextureOp),
+  GSK_GPU_STAGE_UPLOAD,
+  gsk_gpu_upload_texture_op_finish,
+  gsk_gpu_upload_texture_area_op_print,
+#ifdef GDK_RENDERING_VULKAN
+  gsk_gpu_upload_texture_area_op_vk_command,
+#endif
+  gsk_gpu_upload_texture_area_op_gl_command
+};
+
+/* Uploading lots of small rectangles is slower than uploading
+ * their bounding box.
+ */
+#define MAX_UPLOAD_RECTANGLES 16
+
+/*
+ * gsk_gpu_upload_texture_region_op:
+ * @frame: the frame
+ * @image: the image to upload into
+ * @texture: the texture to upload from
+ * @x: x coordinate of the image origin in the texture
+ * @y: y coordinate of the image origin in the texture
+ * @region: the region of the texture to upload
+ *
+ * Uploads the parts of @texture covered by @region into an existing
+ * image. This is used to update images of textures that have only
+ * changed in a small area.
+ *
+ * Returns: %FALSE if the image can't be updated partially and
+ *   needs to be uploaded in full
+ */
+gboolean
+gsk_gpu_upload_texture_region_op (GskGpuFrame          *frame,
+                                  GskGpuImage          *image,
+                                  GdkTexture           *texture,
+                                  int                   x,
+                                  int                   y,
+                                  const cairo_region_t *region)
+{
+  GdkMemoryFormat format;
+  GdkMemoryTexture *memtex;
+  cairo_region_t *clipped;
+  int i, n;
+
+  format = gsk_gpu_image_get_format (image);
+  if (gdk_memory_format_get_n_planes (format) != 1 ||
+      gdk_memory_format_get_plane_block_width (format, 0) != 1 ||
+      gdk_memory_format_get_plane_block_height (format, 0) != 1)
+    return FALSE;
+
+  clipped = cairo_region_copy (region);
+  cairo_region_intersect_rectangle (clipped,
+                                    &(cairo_rectangle_int_t) {
+                                        x, y,
+                                        gsk_gpu_image_get_width (image),
+                                        gsk_gpu_image_get_height (image)
+                                    });
+
+  if (cairo_region_num_rectangles (clipped) > MAX_UPLOAD_RECTANGLES)
+    {
+      cairo_rectangle_int_t extents;
+
+      cairo_region_get_extents (clipped, &extents);
+      cairo_region_destroy (clipped);
+      clipped = cairo_region_create_rectangle (&extents);
+    }
+
+  memtex = NULL;
+  n = cairo_region_num_rectangles (clipped);
+  for (i = 0; i < n; i++)
+    {
+      GskGpuUploadTextureOp *self;
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (clipped, i, &rect);
+
+      if (memtex == NULL)
+        memtex = gdk_memory_texture_from_texture (texture);
+
+      self = (GskGpuUploadTextureOp *) gsk_gpu_op_alloc (frame, &GSK_GPU_UPLOAD_TEXTURE_AREA_OP_CLASS);
+
+      self->texture = gdk_memory_texture_new_subtexture (memtex,
+                                                         rect.x, rect.y,
+                                                         rect.width, rect.height);
+      self->lod_level = 0;
+      self->lod_filter = GSK_SCALING_FILTER_NEAREST;
+      self->image = g_object_ref (image);
+      self->area = (cairo_rectangle_int_t) { rect.x - x, rect.y - y, rect.width, rect.height };
+    }
+
+  g_clear_object (&memtex);
+  cairo_region_destroy (clipped);
+
+  /* The mipmaps are outdated now */
+  if (n > 0)
+    gsk_gpu_image_unset_flags (image, GSK_GPU_IMAGE_MIPMAP);
+
+  return TRUE;
+}
+
 typedef struct _GskGpuUploadCairoOp GskGpuUploadCairoOp;
 
 struct _GskGpuUploadCairoOp
@@ -16,6 +16,12 @@ GskGpuImage *           gsk_gpu_upload_texture_op_try                   (GskGpuF
                                                                          guint                           lod_level,
                                                                          GskScalingFilter                lod_filter,
                                                                          GdkTexture                     *texture);
+gboolean                gsk_gpu_upload_texture_region_op                (GskGpuFrame                    *frame,
+                                                                         GskGpuImage                    *image,
+                                                                         GdkTexture                     *texture,
+                                                                         int                             x,
+                                                                         int                             y,
+                                                                         const cairo_region_t           *region);
 
 GskGpuImage *           gsk_gpu_upload_cairo_op                         (GskGpuFrame                    *frame,
                                                                          const graphene_vec2_t          *scale,
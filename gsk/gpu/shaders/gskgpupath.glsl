@@ -0,0 +1,90 @@
+#define GSK_N_TEXTURES 1
+
+#include "common.glsl"
+
+#define VARIATION_EVEN_ODD ((GSK_VARIATION & 1u) == 1u)
+
+PASS(0) vec2 _pos;
+PASS_FLAT(1) Rect _rect;
+PASS_FLAT(2) vec4 _color;
+PASS_FLAT(3) uvec2 _segments;
+
+
+#ifdef GSK_VERTEX_SHADER
+
+IN(0) vec4 in_rect;
+IN(1) vec4 in_color;
+IN(2) uvec2 in_segments;
+
+void
+run (out vec2 pos)
+{
+  Rect r = rect_from_gsk (in_rect);
+
+  pos = rect_get_position (r);
+
+  _pos = pos;
+  _rect = r;
+  _color = output_color_from_alt (in_color);
+  _segments = in_segments;
+}
+
+#endif
+
+
+
+#ifdef GSK_FRAGMENT_SHADER
+
+/* The texture contains one line per texel, in device pixels */
+vec4
+get_segment (uint i)
+{
+  int width = textureSize (GSK_TEXTURE0, 0).x;
+
+  return texelFetch (GSK_TEXTURE0, ivec2 (int (i) % width, int (i) / width), 0);
+}
+
+/* Computes the winding number of the pixel, with each line only
+ * counting for the part of the pixel that is to its right.
+ * That makes the result fractional at the edges of the path.
+ */
+float
+get_winding (vec2 pos)
+{
+  float winding = 0.0;
+  uint i;
+
+  for (i = 0u; i < _segments.y; i++)
+    {
+      vec4 line = get_segment (_segments.x + i);
+      vec2 y = clamp (line.yw, pos.y - 0.5, pos.y + 0.5);
+      float dy = y.y - y.x;
+
+      if (dy == 0.0)
+        continue;
+
+      vec2 x = mix (line.xx, line.zz, (y - line.yy) / (line.w - line.y));
+      winding += dy * clamp (pos.x + 0.5 - 0.5 * (x.x + x.y), 0.0, 1.0);
+    }
+
+  return winding;
+}
+
+void
+run (out vec4 color,
+     out vec2 position)
+{
+  float winding = abs (get_winding (_pos));
+  float alpha;
+
+  if (VARIATION_EVEN_ODD)
+    alpha = 1.0 - abs (1.0 - mod (winding, 2.0));
+  else
+    alpha = min (winding, 1.0);
+
+  alpha *= rect_coverage (_rect, _pos);
+  color = output_color_alpha (_color, alpha);
+  position = _pos;
+}
+
+#endif
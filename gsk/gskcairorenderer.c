@@ -25,10 +25,17 @@
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
 #include "gskrendernodeprivate.h"
+#include "gdk/gdkcairoprivate.h"
 #include "gdk/gdkcolorstateprivate.h"
 #include "gdk/gdkdrawcontextprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <string.h>
+
+/* How long to keep the copy of the last frame around after
+ * scrolling stopped */
+#define RETAINED_FRAMES 120
+
 typedef struct {
   GQuark cpu_time;
   GQuark gpu_time;
@@ -40,6 +47,13 @@ struct _GskCairoRenderer
 
   GdkCairoContext *cairo_context;
 
+  /* A copy of the last frame that we can move pixels around in
+   * when scrolling. The buffers of the context can't be used for
+   * that, because they don't have to contain the last frame. */
+  cairo_surface_t *retained;
+  GdkColorState *retained_color_state;
+  guint frames_since_scroll;
+
   ProfileTimers profile_timers;
 };
 
@@ -69,6 +83,9 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       return FALSE;
     }
 
+  /* Don't keep a copy of the frame until we actually scroll */
+  self->frames_since_scroll = RETAINED_FRAMES;
+
   return TRUE;
 }
 
@@ -83,6 +100,9 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
 
       g_clear_object (&self->cairo_context);
     }
+
+  g_clear_pointer (&self->retained, cairo_surface_destroy);
+  g_clear_pointer (&self->retained_color_state, gdk_color_state_unref);
 }
 
 static GdkTexture *
@@ -145,6 +165,151 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
   return texture;
 }
 
+/* Moves the pixels of the scrolled area inside the retained surface,
+ * and adds what couldn't be moved to the redraw region. Everything
+ * here is in device pixels. */
+static void
+gsk_cairo_renderer_scroll (GskCairoRenderer    *self,
+                           const GskDiffScroll *scroll,
+                           double               scale,
+                           cairo_region_t      *redraw)
+{
+  cairo_rectangle_int_t bounds, area, rect, source;
+  guchar *data;
+  gsize stride;
+  int dx, dy, y;
+
+  bounds.x = 0;
+  bounds.y = 0;
+  bounds.width = cairo_image_surface_get_width (self->retained);
+  bounds.height = cairo_image_surface_get_height (self->retained);
+
+  /* All pixels touched by the scroll */
+  area.x = floor (scroll->rect.x * scale);
+  area.y = floor (scroll->rect.y * scale);
+  area.width = ceil ((scroll->rect.x + scroll->rect.width) * scale) - area.x;
+  area.height = ceil ((scroll->rect.y + scroll->rect.height) * scale) - area.y;
+
+  if (scroll->dx * scale != floor (scroll->dx * scale) ||
+      scroll->dy * scale != floor (scroll->dy * scale))
+    {
+      cairo_region_union_rectangle (redraw, &area);
+      return;
+    }
+  dx = scroll->dx * scale;
+  dy = scroll->dy * scale;
+
+  /* The pixels we can move, they must not be partially covered */
+  rect.x = ceil (scroll->rect.x * scale);
+  rect.y = ceil (scroll->rect.y * scale);
+  rect.width = floor ((scroll->rect.x + scroll->rect.width) * scale) - rect.x;
+  rect.height = floor ((scroll->rect.y + scroll->rect.height) * scale) - rect.y;
+  source = bounds;
+  source.x += dx;
+  source.y += dy;
+  if (!gdk_rectangle_intersect (&rect, &bounds, &rect) ||
+      !gdk_rectangle_intersect (&rect, &source, &rect))
+    {
+      cairo_region_union_rectangle (redraw, &area);
+      return;
+    }
+
+  if (!gdk_rectangle_equal (&area, &rect))
+    {
+      cairo_region_t *unmoved = cairo_region_create_rectangle (&area);
+
+      cairo_region_subtract_rectangle (unmoved, &rect);
+      cairo_region_union (redraw, unmoved);
+      cairo_region_destroy (unmoved);
+    }
+
+  cairo_surface_flush (self->retained);
+  data = cairo_image_surface_get_data (self->retained);
+  stride = cairo_image_surface_get_stride (self->retained);
+
+  /* Go in the direction that doesn't overwrite rows we still need */
+  for (y = 0; y < rect.height; y++)
+    {
+      int dest_y = dy > 0 ? rect.y + rect.height - 1 - y : rect.y + y;
+
+      memmove (data + (gsize) dest_y * stride + rect.x * 4,
+               data + (gsize) (dest_y - dy) * stride + (rect.x - dx) * 4,
+               rect.width * 4);
+    }
+
+  cairo_surface_mark_dirty (self->retained);
+}
+
+/* Brings the retained surface up to date with @root.
+ *
+ * Returns: %FALSE if there is no retained surface, because we
+ *   haven't scrolled in a while
+ */
+static gboolean
+gsk_cairo_renderer_update_retained (GskCairoRenderer     *self,
+                                    GskRenderNode        *root,
+                                    const cairo_region_t *region,
+                                    GdkColorState        *color_state)
+{
+  GdkDrawContext *context = GDK_DRAW_CONTEXT (self->cairo_context);
+  const GskDiffScroll *scrolls;
+  cairo_region_t *redraw;
+  guint width, height;
+  double scale;
+  gsize i, n_scrolls;
+  cairo_t *cr;
+
+  scrolls = gsk_renderer_get_scrolls (GSK_RENDERER (self), &n_scrolls);
+  if (n_scrolls > 0)
+    self->frames_since_scroll = 0;
+  else if (self->frames_since_scroll < RETAINED_FRAMES)
+    self->frames_since_scroll++;
+
+  if (self->frames_since_scroll >= RETAINED_FRAMES)
+    {
+      g_clear_pointer (&self->retained, cairo_surface_destroy);
+      g_clear_pointer (&self->retained_color_state, gdk_color_state_unref);
+      return FALSE;
+    }
+
+  scale = gdk_surface_get_scale (gdk_draw_context_get_surface (context));
+  gdk_draw_context_get_buffer_size (context, &width, &height);
+
+  if (self->retained &&
+      cairo_image_surface_get_width (self->retained) == width &&
+      cairo_image_surface_get_height (self->retained) == height &&
+      gdk_color_state_equal (self->retained_color_state, color_state))
+    {
+      redraw = gdk_cairo_region_scale_grow (region, scale, scale);
+      for (i = 0; i < n_scrolls; i++)
+        gsk_cairo_renderer_scroll (self, &scrolls[i], scale, redraw);
+    }
+  else
+    {
+      /* Start over with a full redraw */
+      g_clear_pointer (&self->retained, cairo_surface_destroy);
+      g_clear_pointer (&self->retained_color_state, gdk_color_state_unref);
+      self->retained = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+      self->retained_color_state = gdk_color_state_ref (color_state);
+      redraw = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, width, height });
+    }
+
+  cr = cairo_create (self->retained);
+  gdk_cairo_region (cr, redraw);
+  cairo_clip (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  cairo_scale (cr, scale, scale);
+
+  gsk_render_node_draw_with_color_state (root, cr, color_state);
+
+  cairo_destroy (cr);
+  cairo_region_destroy (redraw);
+
+  return TRUE;
+}
+
 static void
 gsk_cairo_renderer_render (GskRenderer          *renderer,
                            GskRenderNode        *root,
@@ -153,23 +318,50 @@ gsk_cairo_renderer_render (GskRenderer          *renderer,
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
   graphene_rect_t opaque_tmp;
   const graphene_rect_t *opaque;
+  const GskDiffScroll *scrolls;
+  cairo_region_t *damage;
+  GdkColorState *color_state;
+  gsize i, n_scrolls;
+  gboolean retained;
   cairo_t *cr;
 
   if (gsk_render_node_get_opaque_rect (root, &opaque_tmp))
     opaque = &opaque_tmp;
   else
     opaque = NULL;
+
+  /* Scrolled areas change on screen, even if we don't redraw them */
+  damage = cairo_region_copy (region);
+  scrolls = gsk_renderer_get_scrolls (renderer, &n_scrolls);
+  for (i = 0; i < n_scrolls; i++)
+    cairo_region_union_rectangle (damage, &scrolls[i].rect);
+
   gdk_draw_context_begin_frame_full (GDK_DRAW_CONTEXT (self->cairo_context),
                                      NULL,
                                      GDK_MEMORY_U8,
-                                     region,
+                                     damage,
                                      opaque);
+  cairo_region_destroy (damage);
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
   cr = gdk_cairo_context_cairo_create (self->cairo_context);
 G_GNUC_END_IGNORE_DEPRECATIONS
 
   g_return_if_fail (cr != NULL);
 
+  color_state = gdk_draw_context_get_color_state (GDK_DRAW_CONTEXT (self->cairo_context));
+
+  retained = gsk_cairo_renderer_update_retained (self, root, region, color_state);
+  if (retained)
+    {
+      cairo_save (cr);
+      cairo_identity_matrix (cr);
+      cairo_set_source_surface (cr, self->retained, 0, 0);
+      cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+      cairo_paint (cr);
+      cairo_restore (cr);
+    }
+
   if (GSK_RENDERER_DEBUG_CHECK (renderer, GEOMETRY))
     {
       GdkSurface *surface = gsk_renderer_get_surface (renderer);
@@ -184,7 +376,8 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       cairo_restore (cr);
     }
 
-  gsk_render_node_draw_with_color_state (root, cr, gdk_draw_context_get_color_state (GDK_DRAW_CONTEXT (self->cairo_context)));
+  if (!retained)
+    gsk_render_node_draw_with_color_state (root, cr, color_state);
 
   cairo_destroy (cr);
 
@@ -196,6 +389,8 @@ gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 {
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
 
+  renderer_class->supports_scrolls = TRUE;
+
   renderer_class->realize = gsk_cairo_renderer_realize;
   renderer_class->unrealize = gsk_cairo_renderer_unrealize;
   renderer_class->render = gsk_cairo_renderer_render;
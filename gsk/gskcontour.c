@@ -1347,6 +1347,49 @@ gsk_standard_contour_new (GskPathFlags            flags,
   return contour;
 }
 
+/*<private>
+ * gsk_contour_get_curve:
+ * @self: a contour
+ * @idx: the index of the operation
+ * @curve: (out caller-allocates): return location for the curve
+ *
+ * Gets the curve for the operation at @idx.
+ *
+ * For contours that are not closed, @idx may be the number of
+ * operations to get the line that implicitly closes the contour
+ * when filling it.
+ *
+ * Only standard contours are made up of curves, for all other
+ * contours this function returns %FALSE.
+ *
+ * Returns: %TRUE if @curve was set
+ */
+gboolean
+gsk_contour_get_curve (const GskContour *self,
+                       gsize             idx,
+                       GskCurve         *curve)
+{
+  const GskStandardContour *contour = (const GskStandardContour *) self;
+
+  if (self->klass != &GSK_STANDARD_CONTOUR_CLASS)
+    return FALSE;
+
+  if (idx == contour->n_ops && (contour->flags & GSK_PATH_CLOSED) == 0)
+    {
+      gsk_curve_init (curve, gsk_pathop_encode (GSK_PATH_CLOSE,
+                                                (const GskAlignedPoint[]) { contour->points[contour->n_points - 1],
+                                                                            contour->points[0] }));
+      return TRUE;
+    }
+
+  if (idx >= contour->n_ops || gsk_pathop_op (contour->ops[idx]) == GSK_PATH_MOVE)
+    return FALSE;
+
+  gsk_curve_init (curve, contour->ops[idx]);
+
+  return TRUE;
+}
+
 /* }}} */
 /* {{{ Circle */
 
@@ -24,6 +24,7 @@
 #include "gskpathpoint.h"
 #include "gskpathopprivate.h"
 #include "gskboundingboxprivate.h"
+#include "gskcurveprivate.h"
 
 G_BEGIN_DECLS
 
@@ -60,6 +61,9 @@ gboolean                gsk_contour_foreach                     (const GskContou
 int                     gsk_contour_get_winding                 (const GskContour       *self,
                                                                  const graphene_point_t *point);
 gsize                   gsk_contour_get_n_ops                   (const GskContour       *self);
+gboolean                gsk_contour_get_curve                   (const GskContour       *self,
+                                                                 gsize                   idx,
+                                                                 GskCurve               *curve);
 gboolean                gsk_contour_get_closest_point           (const GskContour       *self,
                                                                  const graphene_point_t *point,
                                                                  float                   threshold,
@@ -15,6 +15,7 @@ static const GdkDebugKey gsk_debug_keys[] = {
   { "staging", GSK_DEBUG_STAGING, "Use a staging image for texture upload (Vulkan only)" },
   { "cairo", GSK_DEBUG_CAIRO, "Overlay error pattern over Cairo drawing (finds fallbacks)" },
   { "occlusion", GSK_DEBUG_OCCLUSION, "Overlay highlight over areas optimized via occlusion culling" },
+  { "no-pool", GSK_DEBUG_NO_POOL, "Allocate render nodes and transforms with malloc() instead of a pool" },
 };
 
 static guint gsk_debug_flags;
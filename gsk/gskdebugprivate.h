@@ -18,9 +18,10 @@ typedef enum {
   GSK_DEBUG_STAGING               = 1 <<  8,
   GSK_DEBUG_CAIRO                 = 1 <<  9,
   GSK_DEBUG_OCCLUSION             = 1 << 10,
+  GSK_DEBUG_NO_POOL               = 1 << 11,
 } GskDebugFlags;
 
-#define GSK_DEBUG_ANY ((1 << 11) - 1)
+#define GSK_DEBUG_ANY ((1 << 12) - 1)
 
 GskDebugFlags gsk_get_debug_flags (void);
 void          gsk_set_debug_flags (GskDebugFlags flags);
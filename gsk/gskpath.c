@@ -23,6 +23,7 @@
 
 #include "gskcurveprivate.h"
 #include "gskpathbuilder.h"
+#include "gskpathindexprivate.h"
 #include "gskpathpoint.h"
 #include "gskcontourprivate.h"
 
@@ -58,6 +59,10 @@ struct _GskPath
 
   GskPathFlags flags;
 
+  /* created on demand for paths with many operations, atomic */
+  GskPathIndex *index;
+  gsize n_ops;
+
   gsize n_contours;
   GskContour *contours[];
   /* followed by the contours data */
@@ -74,12 +79,14 @@ gsk_path_new_from_contours (const GSList *contours)
   const GSList *l;
   gsize size;
   gsize n_contours;
+  gsize n_ops;
   guint8 *contour_data;
   GskPathFlags flags;
 
   flags = GSK_PATH_CLOSED | GSK_PATH_FLAT;
   size = 0;
   n_contours = 0;
+  n_ops = 0;
   for (l = contours; l; l = l->next)
     {
       GskContour *contour = l->data;
@@ -88,11 +95,13 @@ gsk_path_new_from_contours (const GSList *contours)
       size += sizeof (GskContour *);
       size += gsk_contour_get_size (contour);
       flags &= gsk_contour_get_flags (contour);
+      n_ops += gsk_contour_get_n_ops (contour);
     }
 
   path = g_malloc0 (sizeof (GskPath) + size);
   path->ref_count = 1;
   path->flags = flags;
+  path->n_ops = n_ops;
   path->n_contours = n_contours;
   contour_data = (guint8 *) &path->contours[n_contours];
   n_contours = 0;
@@ -121,6 +130,31 @@ gsk_path_get_contour (const GskPath *self,
     return NULL;
 }
 
+static const GskPathIndex *
+gsk_path_get_index (GskPath *self)
+{
+  GskPathIndex *index;
+
+  if (self->n_ops < GSK_PATH_INDEX_MIN_OPS)
+    return NULL;
+
+  index = g_atomic_pointer_get (&self->index);
+  if (index != NULL)
+    return index;
+
+  /* Paths are immutable and may be used from multiple threads,
+   * so if another thread was faster, use its index.
+   */
+  index = gsk_path_index_new (self);
+  if (!g_atomic_pointer_compare_and_exchange (&self->index, NULL, index))
+    {
+      gsk_path_index_free (index);
+      index = g_atomic_pointer_get (&self->index);
+    }
+
+  return index;
+}
+
 GskPathFlags
 gsk_path_get_flags (const GskPath *self)
 {
@@ -176,6 +210,7 @@ gsk_path_unref (GskPath *self)
   if (self->ref_count > 0)
     return;
 
+  g_clear_pointer (&self->index, gsk_path_index_free);
   g_free (self);
 }
 
@@ -468,10 +503,19 @@ gsk_path_in_fill (GskPath                *self,
                   const graphene_point_t *point,
                   GskFillRule             fill_rule)
 {
+  const GskPathIndex *index;
   int winding = 0;
 
-  for (int i = 0; i < self->n_contours; i++)
-    winding += gsk_contour_get_winding (self->contours[i], point);
+  index = gsk_path_get_index (self);
+  if (index)
+    {
+      winding = gsk_path_index_get_winding (index, point);
+    }
+  else
+    {
+      for (int i = 0; i < self->n_contours; i++)
+        winding += gsk_contour_get_winding (self->contours[i], point);
+    }
 
   switch (fill_rule)
     {
@@ -575,6 +619,7 @@ gsk_path_get_closest_point (GskPath                *self,
                             GskPathPoint           *result,
                             float                  *distance)
 {
+  const GskPathIndex *index;
   gboolean found;
 
   g_return_val_if_fail (self != NULL, FALSE);
@@ -582,6 +627,18 @@ gsk_path_get_closest_point (GskPath                *self,
   g_return_val_if_fail (threshold >= 0, FALSE);
   g_return_val_if_fail (result != NULL, FALSE);
 
+  index = gsk_path_get_index (self);
+  if (index)
+    {
+      float dist;
+
+      found = gsk_path_index_get_closest_point (index, point, threshold, result, &dist);
+      if (found && distance)
+        *distance = dist;
+
+      return found;
+    }
+
   found = FALSE;
 
   for (int i = 0; i < self->n_contours; i++)
@@ -0,0 +1,478 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gskpathindexprivate.h"
+
+#include "gskcontourprivate.h"
+#include "gskcurveprivate.h"
+
+#include <math.h>
+
+/* GskPathIndex is a bounding volume hierarchy over the curves of
+ * a path. Hit testing and closest point queries use it to only look
+ * at the curves that are near the point in question, instead of
+ * looking at every curve of the path.
+ *
+ * The items of the hierarchy are the curves of standard contours,
+ * with their bounds cached. All other contours are cheap to query
+ * and are treated as a single item.
+ */
+
+#define MAX_ITEMS_PER_LEAF 4
+
+/* Leaves are split in half, so this is plenty */
+#define MAX_DEPTH 64
+
+typedef enum {
+  /* A curve of a standard contour */
+  ITEM_CURVE,
+  /* The line closing an open standard contour when filling */
+  ITEM_CLOSE,
+  /* A complete contour */
+  ITEM_CONTOUR
+} ItemType;
+
+typedef struct _Item Item;
+struct _Item
+{
+  GskBoundingBox bounds;
+  ItemType type;
+  guint contour;
+  gsize idx;
+};
+
+typedef struct _Node Node;
+struct _Node
+{
+  GskBoundingBox bounds;
+  /* the first item for leaves, the first of the two children otherwise */
+  guint start;
+  /* 0 for inner nodes */
+  guint n_items;
+};
+
+struct _GskPathIndex
+{
+  const GskPath *path;
+
+  GArray *items;
+  GArray *nodes;
+};
+
+/* {{{ Building */
+
+static void
+add_item (GskPathIndex         *self,
+          const GskBoundingBox *bounds,
+          ItemType              type,
+          gsize                 contour,
+          gsize                 idx)
+{
+  Item item = { *bounds, type, contour, idx };
+
+  g_array_append_val (self->items, item);
+}
+
+static void
+add_contour (GskPathIndex     *self,
+             gsize             i,
+             const GskContour *contour)
+{
+  GskBoundingBox bounds;
+  GskCurve curve;
+  gsize idx, n_ops, n_curves;
+
+  n_ops = gsk_contour_get_n_ops (contour);
+  n_curves = 0;
+
+  for (idx = 0; idx < n_ops; idx++)
+    {
+      if (!gsk_contour_get_curve (contour, idx, &curve))
+        continue;
+
+      gsk_curve_get_bounds (&curve, &bounds);
+      add_item (self, &bounds, ITEM_CURVE, i, idx);
+      n_curves++;
+    }
+
+  if (n_curves > 0)
+    {
+      if (gsk_contour_get_curve (contour, n_ops, &curve))
+        {
+          gsk_curve_get_bounds (&curve, &bounds);
+          add_item (self, &bounds, ITEM_CLOSE, i, n_ops);
+        }
+    }
+  else
+    {
+      gsk_contour_get_bounds (contour, &bounds);
+      add_item (self, &bounds, ITEM_CONTOUR, i, 0);
+    }
+}
+
+static int
+compare_items (gconstpointer a,
+               gconstpointer b,
+               gpointer      data)
+{
+  const Item *item_a = a;
+  const Item *item_b = b;
+  float center_a, center_b;
+
+  if (GPOINTER_TO_INT (data))
+    {
+      center_a = item_a->bounds.min.y + item_a->bounds.max.y;
+      center_b = item_b->bounds.min.y + item_b->bounds.max.y;
+    }
+  else
+    {
+      center_a = item_a->bounds.min.x + item_a->bounds.max.x;
+      center_b = item_b->bounds.min.x + item_b->bounds.max.x;
+    }
+
+  return (center_a > center_b) - (center_a < center_b);
+}
+
+static void
+build_node (GskPathIndex *self,
+            guint         node_idx,
+            guint         start,
+            guint         n_items)
+{
+  Item *items = &g_array_index (self->items, Item, start);
+  GskBoundingBox bounds, centers;
+  graphene_point_t center;
+  Node *node;
+  guint i, children;
+
+  bounds = items[0].bounds;
+  graphene_point_interpolate (&items[0].bounds.min, &items[0].bounds.max, 0.5, &center);
+  gsk_bounding_box_init (&centers, &center, &center);
+  for (i = 1; i < n_items; i++)
+    {
+      gsk_bounding_box_union (&bounds, &items[i].bounds, &bounds);
+      graphene_point_interpolate (&items[i].bounds.min, &items[i].bounds.max, 0.5, &center);
+      gsk_bounding_box_expand (&centers, &center);
+    }
+
+  if (n_items <= MAX_ITEMS_PER_LEAF)
+    {
+      node = &g_array_index (self->nodes, Node, node_idx);
+      node->bounds = bounds;
+      node->start = start;
+      node->n_items = n_items;
+      return;
+    }
+
+  /* Split at the median along the longer axis */
+  g_sort_array (items,
+                n_items,
+                sizeof (Item),
+                compare_items,
+                GINT_TO_POINTER (centers.max.y - centers.min.y > centers.max.x - centers.min.x));
+
+  children = self->nodes->len;
+  g_array_set_size (self->nodes, children + 2);
+
+  node = &g_array_index (self->nodes, Node, node_idx);
+  node->bounds = bounds;
+  node->start = children;
+  node->n_items = 0;
+
+  build_node (self, children, start, n_items / 2);
+  build_node (self, children + 1, start + n_items / 2, n_items - n_items / 2);
+}
+
+/*<private>
+ * gsk_path_index_new:
+ * @path: the path to index
+ *
+ * Creates an index for the curves of @path.
+ *
+ * The index does not keep a reference on @path, it is meant
+ * to be owned by it.
+ *
+ * Returns: (transfer full): a new index
+ */
+GskPathIndex *
+gsk_path_index_new (const GskPath *path)
+{
+  GskPathIndex *self;
+  gsize i;
+
+  self = g_new0 (GskPathIndex, 1);
+  self->path = path;
+  self->items = g_array_new (FALSE, FALSE, sizeof (Item));
+  self->nodes = g_array_new (FALSE, FALSE, sizeof (Node));
+
+  for (i = 0; i < gsk_path_get_n_contours (path); i++)
+    add_contour (self, i, gsk_path_get_contour (path, i));
+
+  if (self->items->len > 0)
+    {
+      g_array_set_size (self->nodes, 1);
+      build_node (self, 0, 0, self->items->len);
+    }
+
+  return self;
+}
+
+void
+gsk_path_index_free (GskPathIndex *self)
+{
+  g_array_unref (self->items);
+  g_array_unref (self->nodes);
+  g_free (self);
+}
+
+/* }}} */
+/* {{{ Queries */
+
+/* The same test that gsk_curve_get_crossing() does: only curves
+ * that cross the horizontal ray to the right of @point count */
+static inline gboolean
+may_cross (const GskBoundingBox   *bounds,
+           const graphene_point_t *point)
+{
+  return bounds->min.y <= point->y &&
+         bounds->max.y >= point->y &&
+         bounds->max.x >= point->x;
+}
+
+static int
+get_item_winding (const GskPathIndex     *self,
+                  const Item             *item,
+                  const graphene_point_t *point)
+{
+  const GskContour *contour = gsk_path_get_contour (self->path, item->contour);
+  GskCurve curve;
+
+  switch (item->type)
+    {
+    case ITEM_CURVE:
+    case ITEM_CLOSE:
+      gsk_contour_get_curve (contour, item->idx, &curve);
+      return gsk_curve_get_crossing (&curve, point);
+
+    case ITEM_CONTOUR:
+      return gsk_contour_get_winding (contour, point);
+
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+}
+
+/*<private>
+ * gsk_path_index_get_winding:
+ * @self: an index
+ * @point: the point to test
+ *
+ * Computes the winding number of the indexed path around @point.
+ *
+ * This gives the same result as adding up the winding numbers
+ * of all contours of the path.
+ *
+ * Returns: the winding number
+ */
+int
+gsk_path_index_get_winding (const GskPathIndex     *self,
+                            const graphene_point_t *point)
+{
+  guint stack[MAX_DEPTH];
+  guint n_stack;
+  int winding = 0;
+
+  if (self->nodes->len == 0)
+    return 0;
+
+  stack[0] = 0;
+  n_stack = 1;
+
+  while (n_stack > 0)
+    {
+      const Node *node = &g_array_index (self->nodes, Node, stack[--n_stack]);
+      guint i;
+
+      if (!may_cross (&node->bounds, point))
+        continue;
+
+      if (node->n_items == 0)
+        {
+          g_assert (n_stack + 2 <= MAX_DEPTH);
+          stack[n_stack++] = node->start;
+          stack[n_stack++] = node->start + 1;
+          continue;
+        }
+
+      for (i = node->start; i < node->start + node->n_items; i++)
+        {
+          const Item *item = &g_array_index (self->items, Item, i);
+
+          if (may_cross (&item->bounds, point))
+            winding += get_item_winding (self, item, point);
+        }
+    }
+
+  return winding;
+}
+
+static inline float
+get_distance (const GskBoundingBox   *bounds,
+              const graphene_point_t *point)
+{
+  float dx, dy;
+
+  dx = MAX (0, MAX (bounds->min.x - point->x, point->x - bounds->max.x));
+  dy = MAX (0, MAX (bounds->min.y - point->y, point->y - bounds->max.y));
+
+  return sqrtf (dx * dx + dy * dy);
+}
+
+/* Ties go to the point that comes first in the path, like they
+ * do when walking the contours in order */
+static inline gboolean
+is_before (const GskPathPoint *a,
+           const GskPathPoint *b)
+{
+  if (a->contour != b->contour)
+    return a->contour < b->contour;
+
+  if (a->idx != b->idx)
+    return a->idx < b->idx;
+
+  return a->t < b->t;
+}
+
+/*<private>
+ * gsk_path_index_get_closest_point:
+ * @self: an index
+ * @point: the point
+ * @threshold: maximum allowed distance
+ * @result: (out caller-allocates): return location for the closest point
+ * @out_dist: (out): return location for the distance
+ *
+ * Computes the closest point on the indexed path to @point.
+ *
+ * This gives the same result as asking all contours of
+ * the path in order.
+ *
+ * Returns: %TRUE if a point closer than @threshold was found
+ */
+gboolean
+gsk_path_index_get_closest_point (const GskPathIndex     *self,
+                                  const graphene_point_t *point,
+                                  float                   threshold,
+                                  GskPathPoint           *result,
+                                  float                  *out_dist)
+{
+  guint stack[MAX_DEPTH];
+  guint n_stack;
+  gboolean found = FALSE;
+
+  if (self->nodes->len == 0)
+    return FALSE;
+
+  stack[0] = 0;
+  n_stack = 1;
+
+  while (n_stack > 0)
+    {
+      const Node *node = &g_array_index (self->nodes, Node, stack[--n_stack]);
+      guint i;
+
+      if (get_distance (&node->bounds, point) > threshold)
+        continue;
+
+      if (node->n_items == 0)
+        {
+          const Node *first = &g_array_index (self->nodes, Node, node->start);
+          const Node *second = &g_array_index (self->nodes, Node, node->start + 1);
+
+          /* Look at the closer child first, so the threshold
+           * shrinks quickly and prunes more of the other one */
+          g_assert (n_stack + 2 <= MAX_DEPTH);
+          if (get_distance (&first->bounds, point) <= get_distance (&second->bounds, point))
+            {
+              stack[n_stack++] = node->start + 1;
+              stack[n_stack++] = node->start;
+            }
+          else
+            {
+              stack[n_stack++] = node->start;
+              stack[n_stack++] = node->start + 1;
+            }
+          continue;
+        }
+
+      for (i = node->start; i < node->start + node->n_items; i++)
+        {
+          const Item *item = &g_array_index (self->items, Item, i);
+          const GskContour *contour;
+          GskPathPoint candidate;
+          GskCurve curve;
+          float dist, t;
+
+          if (item->type == ITEM_CLOSE ||
+              get_distance (&item->bounds, point) > threshold)
+            continue;
+
+          contour = gsk_path_get_contour (self->path, item->contour);
+
+          if (item->type == ITEM_CURVE)
+            {
+              gsk_contour_get_curve (contour, item->idx, &curve);
+              if (!gsk_curve_get_closest_point (&curve, point, threshold, &dist, &t))
+                continue;
+
+              /* Curves need to be strictly closer than the threshold */
+              if (dist == threshold && !found)
+                continue;
+
+              candidate.contour = item->contour;
+              candidate.idx = item->idx;
+              candidate.t = t;
+            }
+          else
+            {
+              if (!gsk_contour_get_closest_point (contour, point, threshold, &candidate, &dist))
+                continue;
+
+              candidate.contour = item->contour;
+            }
+
+          if (dist > threshold ||
+              (found && dist == threshold && !is_before (&candidate, result)))
+            continue;
+
+          *result = candidate;
+          threshold = dist;
+          found = TRUE;
+        }
+    }
+
+  if (found)
+    *out_dist = threshold;
+
+  return found;
+}
+
+/* }}} */
+
+/* vim:set foldmethod=marker: */
@@ -0,0 +1,43 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gskpathprivate.h"
+#include "gskpathpoint.h"
+
+G_BEGIN_DECLS
+
+/* Paths with fewer operations than this are fast enough
+ * to query without an index */
+#define GSK_PATH_INDEX_MIN_OPS 64
+
+typedef struct _GskPathIndex GskPathIndex;
+
+GskPathIndex *          gsk_path_index_new                      (const GskPath          *path);
+void                    gsk_path_index_free                     (GskPathIndex           *self);
+
+int                     gsk_path_index_get_winding              (const GskPathIndex     *self,
+                                                                 const graphene_point_t *point);
+gboolean                gsk_path_index_get_closest_point        (const GskPathIndex     *self,
+                                                                 const graphene_point_t *point,
+                                                                 float                   threshold,
+                                                                 GskPathPoint           *result,
+                                                                 float                  *out_dist);
+
+G_END_DECLS
+
@@ -46,6 +46,8 @@ typedef struct _GskContourMeasure GskContourMeasure;
 
 struct _GskContourMeasure
 {
+  /* distance from the start of the path */
+  float offset;
   float length;
   gpointer contour_data;
 };
@@ -119,6 +121,7 @@ gsk_path_measure_new_with_tolerance (GskPath *path,
       self->measures[i].contour_data = gsk_contour_init_measure (gsk_path_get_contour (path, i),
                                                                  self->tolerance,
                                                                  &self->measures[i].length);
+      self->measures[i].offset = self->length;
       self->length += self->measures[i].length;
     }
 
@@ -258,7 +261,7 @@ gsk_path_measure_get_point (GskPathMeasure *self,
                             float           distance,
                             GskPathPoint   *result)
 {
-  gsize i;
+  gsize i, lo, hi;
   const GskContour *contour;
 
   g_return_val_if_fail (self != NULL, FALSE);
@@ -269,17 +272,23 @@ gsk_path_measure_get_point (GskPathMeasure *self,
 
   distance = gsk_path_measure_clamp_distance (self, distance);
 
-  for (i = 0; i < self->n_contours - 1; i++)
+  /* Find the first contour that ends after distance */
+  lo = 0;
+  hi = self->n_contours - 1;
+  while (lo < hi)
     {
-      if (distance < self->measures[i].length)
-        break;
+      i = (lo + hi) / 2;
 
-      distance -= self->measures[i].length;
+      if (distance < self->measures[i].offset + self->measures[i].length)
+        hi = i;
+      else
+        lo = i + 1;
     }
+  i = lo;
 
   g_assert (0 <= i && i < self->n_contours);
 
-  distance = CLAMP (distance, 0, self->measures[i].length);
+  distance = CLAMP (distance - self->measures[i].offset, 0, self->measures[i].length);
 
   contour = gsk_path_get_contour (self->path, i);
 
@@ -308,20 +317,14 @@ float
 gsk_path_point_get_distance (const GskPathPoint *point,
                              GskPathMeasure     *measure)
 {
-  float contour_offset = 0;
+  const GskContourMeasure *contour_measure;
 
   g_return_val_if_fail (measure != NULL, 0);
   g_return_val_if_fail (gsk_path_point_valid (point, measure->path), 0);
 
-  for (gsize i = 0; i < measure->n_contours; i++)
-    {
-      if (i == point->contour)
-        return contour_offset + gsk_contour_get_distance (gsk_path_get_contour (measure->path, i),
-                                                          point,
-                                                          measure->measures[i].contour_data);
-
-      contour_offset += measure->measures[i].length;
-    }
+  contour_measure = &measure->measures[point->contour];
 
-  g_return_val_if_reached (0);
+  return contour_measure->offset + gsk_contour_get_distance (gsk_path_get_contour (measure->path, point->contour),
+                                                             point,
+                                                             contour_measure->contour_data);
 }
@@ -0,0 +1,187 @@
+#include "config.h"
+
+#include "gskpoolprivate.h"
+
+#include "gskdebugprivate.h"
+
+#include "gdk/gdkprofilerprivate.h"
+
+#include <string.h>
+
+/* A simple allocator for the many small, short-lived objects that
+ * are created for every frame, like render nodes and transforms.
+ *
+ * Memory is split into size classes. Every size class keeps a list
+ * of free blocks that is refilled a whole slab at a time, so after
+ * the first few frames, allocating a node just takes a block off
+ * the list and freeing it puts the block back.
+ *
+ * Slabs are never returned to the system, so the pool keeps the
+ * memory of the largest frame around.
+ */
+
+#define SIZE_CLASS_STEP 16
+#define MAX_POOLED_SIZE 512
+#define N_SIZE_CLASSES (MAX_POOLED_SIZE / SIZE_CLASS_STEP)
+#define SLAB_SIZE 16384
+
+typedef struct _FreeBlock FreeBlock;
+struct _FreeBlock
+{
+  FreeBlock *next;
+};
+
+typedef struct _SizeClass SizeClass;
+struct _SizeClass
+{
+  GMutex lock;
+  FreeBlock *free_list;
+};
+
+static SizeClass size_classes[N_SIZE_CLASSES];
+
+/* reset by gsk_pool_report_counters() */
+static int n_allocs;
+static int n_slabs;
+
+static gboolean
+gsk_pool_is_enabled (void)
+{
+  static gsize enabled__volatile;
+
+  /* This must not change while objects are alive, so
+   * only look at the debug flags once */
+  if (g_once_init_enter (&enabled__volatile))
+    g_once_init_leave (&enabled__volatile, GSK_DEBUG_CHECK (NO_POOL) ? 1 : 2);
+
+  return enabled__volatile == 2;
+}
+
+static inline gsize
+get_size_class (gsize size)
+{
+  return (size + SIZE_CLASS_STEP - 1) / SIZE_CLASS_STEP - 1;
+}
+
+static void
+size_class_add_slab (SizeClass *size_class,
+                     gsize      block_size)
+{
+  guint8 *slab;
+  gsize i, n_blocks;
+
+  /* g_malloc() aligns for all types, and so does every
+   * block because the block size is a multiple of 16 */
+  n_blocks = SLAB_SIZE / block_size;
+  slab = g_malloc (n_blocks * block_size);
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      FreeBlock *block = (FreeBlock *) (slab + i * block_size);
+
+      block->next = size_class->free_list;
+      size_class->free_list = block;
+    }
+
+  g_atomic_int_inc (&n_slabs);
+}
+
+/*<private>
+ * gsk_pool_alloc0:
+ * @size: the size of the memory to allocate
+ *
+ * Allocates zeroed memory from the pool.
+ *
+ * The memory must be freed with gsk_pool_free(), with the same @size.
+ *
+ * Returns: the allocated memory
+ */
+gpointer
+gsk_pool_alloc0 (gsize size)
+{
+  SizeClass *size_class;
+  FreeBlock *block;
+
+  g_assert (size > 0);
+
+  if (size > MAX_POOLED_SIZE || !gsk_pool_is_enabled ())
+    return g_malloc0 (size);
+
+  g_atomic_int_inc (&n_allocs);
+
+  size_class = &size_classes[get_size_class (size)];
+
+  g_mutex_lock (&size_class->lock);
+
+  if (size_class->free_list == NULL)
+    size_class_add_slab (size_class, (get_size_class (size) + 1) * SIZE_CLASS_STEP);
+
+  block = size_class->free_list;
+  size_class->free_list = block->next;
+
+  g_mutex_unlock (&size_class->lock);
+
+  return memset (block, 0, size);
+}
+
+/*<private>
+ * gsk_pool_free:
+ * @mem: memory allocated with gsk_pool_alloc0()
+ * @size: the size that @mem was allocated with
+ *
+ * Returns memory to the pool.
+ *
+ * This is safe to call from any thread.
+ */
+void
+gsk_pool_free (gpointer mem,
+               gsize    size)
+{
+  SizeClass *size_class;
+  FreeBlock *block = mem;
+
+  if (size > MAX_POOLED_SIZE || !gsk_pool_is_enabled ())
+    {
+      g_free (mem);
+      return;
+    }
+
+  size_class = &size_classes[get_size_class (size)];
+
+  g_mutex_lock (&size_class->lock);
+
+  block->next = size_class->free_list;
+  size_class->free_list = block;
+
+  g_mutex_unlock (&size_class->lock);
+}
+
+/*<private>
+ * gsk_pool_report_counters:
+ *
+ * Reports the number of allocations and the number of slabs
+ * allocated since the last call to the profiler.
+ *
+ * This is meant to be called once per frame.
+ */
+void
+gsk_pool_report_counters (void)
+{
+  static guint allocs_counter, slabs_counter;
+  int allocs, slabs;
+
+  if (!GDK_PROFILER_IS_RUNNING)
+    return;
+
+  if (allocs_counter == 0)
+    {
+      allocs_counter = gdk_profiler_define_int_counter ("pool allocations", "Number of pooled allocations per frame");
+      slabs_counter = gdk_profiler_define_int_counter ("pool slabs", "Number of slabs allocated per frame");
+    }
+
+  allocs = g_atomic_int_exchange (&n_allocs, 0);
+  slabs = g_atomic_int_exchange (&n_slabs, 0);
+
+  gdk_profiler_set_int_counter (allocs_counter, allocs);
+  gdk_profiler_set_int_counter (slabs_counter, slabs);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gpointer                gsk_pool_alloc0                         (gsize                   size);
+void                    gsk_pool_free                           (gpointer                mem,
+                                                                 gsize                   size);
+
+void                    gsk_pool_report_counters                (void);
+
+G_END_DECLS
+
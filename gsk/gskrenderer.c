@@ -38,6 +38,7 @@
 #include "gskdebugprivate.h"
 #include "gskrendernodeprivate.h"
 #include "gskoffloadprivate.h"
+#include "gskpoolprivate.h"
 
 #include "gskenumtypes.h"
 
@@ -64,6 +65,7 @@ typedef struct
 
   GdkSurface *surface;
   GskRenderNode *prev_node;
+  GArray *scrolls; /* only valid during render() */
 
   GskDebugFlags debug_flags;
 
@@ -365,6 +367,7 @@ gsk_renderer_unrealize (GskRenderer *renderer)
 
   g_clear_object (&priv->surface);
   g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->scrolls, g_array_unref);
 
   priv->is_realized = FALSE;
 
@@ -473,15 +476,54 @@ gsk_renderer_render (GskRenderer          *renderer,
     }
   else
     {
-      gsk_render_node_diff (priv->prev_node, root, &(GskDiffData) { clip, priv->surface });
+      if (renderer_class->supports_scrolls && priv->scrolls == NULL)
+        priv->scrolls = g_array_new (FALSE, FALSE, sizeof (GskDiffScroll));
+
+      gsk_render_node_diff (priv->prev_node, root, &(GskDiffData) { clip, priv->surface, priv->scrolls });
     }
 
   renderer_class->render (renderer, root, clip);
 
+  if (priv->scrolls)
+    g_array_set_size (priv->scrolls, 0);
   g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
   cairo_region_destroy (clip);
   g_clear_pointer (&offload, gsk_offload_free);
   priv->prev_node = gsk_render_node_ref (root);
+
+  gsk_pool_report_counters ();
+}
+
+/*<private>
+ * gsk_renderer_get_scrolls:
+ * @renderer: a renderer
+ * @n_scrolls: (out): return location for the number of scrolls
+ *
+ * Returns the content that moved since the previous frame, for
+ * renderers that set `supports_scrolls`.
+ *
+ * The pixels of these areas are not part of the region passed to
+ * the render() vfunc, so the renderer must move them from the
+ * previous frame.
+ *
+ * This can only be called from the render() vfunc.
+ *
+ * Returns: (transfer none) (array length=n_scrolls): the scrolls
+ */
+const GskDiffScroll *
+gsk_renderer_get_scrolls (GskRenderer *renderer,
+                          gsize       *n_scrolls)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  if (priv->scrolls == NULL)
+    {
+      *n_scrolls = 0;
+      return NULL;
+    }
+
+  *n_scrolls = priv->scrolls->len;
+  return (const GskDiffScroll *) priv->scrolls->data;
 }
 
 static GType
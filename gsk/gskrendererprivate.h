@@ -21,6 +21,7 @@
 #include "gskrenderer.h"
 #include "gskdebugprivate.h"
 #include "gskoffloadprivate.h"
+#include "gskrendernodeprivate.h"
 
 G_BEGIN_DECLS
 
@@ -38,6 +39,7 @@ struct _GskRendererClass
   GObjectClass parent_class;
 
   gboolean supports_offload;
+  gboolean supports_scrolls;
 
   gboolean             (* realize)                              (GskRenderer            *renderer,
                                                                  GdkDisplay             *display,
@@ -61,5 +63,8 @@ GskDebugFlags           gsk_renderer_get_debug_flags            (GskRenderer
 void                    gsk_renderer_set_debug_flags            (GskRenderer    *renderer,
                                                                  GskDebugFlags   flags);
 
+const GskDiffScroll *   gsk_renderer_get_scrolls                (GskRenderer    *renderer,
+                                                                 gsize          *n_scrolls);
+
 G_END_DECLS
 
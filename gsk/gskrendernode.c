@@ -38,6 +38,7 @@
 #include "gskrendernodeprivate.h"
 
 #include "gskdebugprivate.h"
+#include "gskpoolprivate.h"
 #include "gskrendererprivate.h"
 #include "gskrendernodeparserprivate.h"
 
@@ -139,10 +140,47 @@ value_render_node_lcopy_value (const GValue *value,
   return NULL;
 }
 
+typedef struct
+{
+  GskRenderNodeClass *klass;
+  gsize instance_size;
+} GskRenderNodeAllocInfo;
+
+static GskRenderNodeAllocInfo gsk_render_node_alloc_info[GSK_RENDER_NODE_TYPE_N_TYPES];
+
+static const GskRenderNodeAllocInfo *
+gsk_render_node_get_alloc_info (GskRenderNodeType node_type)
+{
+  static gsize alloc_info__volatile;
+
+  if (g_once_init_enter (&alloc_info__volatile))
+    {
+      gsk_render_node_init_types ();
+
+      for (gsize i = 0; i < GSK_RENDER_NODE_TYPE_N_TYPES; i++)
+        {
+          GTypeQuery query;
+
+          if (gsk_render_node_types[i] == G_TYPE_INVALID)
+            continue;
+
+          g_type_query (gsk_render_node_types[i], &query);
+          gsk_render_node_alloc_info[i].klass = g_type_class_ref (gsk_render_node_types[i]);
+          gsk_render_node_alloc_info[i].instance_size = query.instance_size;
+        }
+
+      g_once_init_leave (&alloc_info__volatile, 1);
+    }
+
+  return &gsk_render_node_alloc_info[node_type];
+}
+
 static void
 gsk_render_node_finalize (GskRenderNode *self)
 {
-  g_type_free_instance ((GTypeInstance *) self);
+  const GskRenderNodeAllocInfo *info = gsk_render_node_get_alloc_info (GSK_RENDER_NODE_TYPE (self));
+
+  gsk_pool_free (self, info->instance_size);
 }
 
 static gboolean
@@ -280,11 +318,26 @@ gsk_render_node_type_register_static (const char     *node_name,
 gpointer
 gsk_render_node_alloc (GskRenderNodeType node_type)
 {
+  const GskRenderNodeAllocInfo *info;
+  GskRenderNode *self;
+
   g_return_val_if_fail (node_type > GSK_NOT_A_RENDER_NODE, NULL);
   g_return_val_if_fail (node_type < GSK_RENDER_NODE_TYPE_N_TYPES, NULL);
 
-  g_assert (gsk_render_node_types[node_type] != G_TYPE_INVALID);
-  return g_type_create_instance (gsk_render_node_types[node_type]);
+  info = gsk_render_node_get_alloc_info (node_type);
+  g_assert (info->klass != NULL);
+
+  /* Snapshots create lots of nodes, so instead of going through
+   * g_type_create_instance(), which does a separate allocation
+   * for every node, they are taken from a pool.
+   * Node types have no instance_init, so only the base type's
+   * needs to be run.
+   */
+  self = gsk_pool_alloc0 (info->instance_size);
+  self->parent_instance.g_class = (GTypeClass *) info->klass;
+  gsk_render_node_init (self);
+
+  return self;
 }
 
 /**
@@ -557,6 +610,57 @@ gsk_render_node_diff_impossible (GskRenderNode  *node1,
   cairo_region_union_rectangle (data->region, &rect);
 }
 
+/*<private>
+ * gsk_diff_data_drop_scrolls:
+ * @data: diff data
+ * @first: index of the first scroll to drop
+ *
+ * Removes the scrolls starting at @first, and adds their area
+ * to the diff region instead.
+ *
+ * This is used when scrolled content ends up somewhere that
+ * can't be moved pixel by pixel.
+ */
+void
+gsk_diff_data_drop_scrolls (GskDiffData *data,
+                            guint        first)
+{
+  guint i;
+
+  if (data->scrolls == NULL)
+    return;
+
+  for (i = first; i < data->scrolls->len; i++)
+    {
+      const GskDiffScroll *scroll = &g_array_index (data->scrolls, GskDiffScroll, i);
+
+      cairo_region_union_rectangle (data->region, &scroll->rect);
+    }
+
+  if (first < data->scrolls->len)
+    g_array_set_size (data->scrolls, first);
+}
+
+/*<private>
+ * gsk_render_node_diff_without_scrolls:
+ * @node1: a `GskRenderNode`
+ * @node2: the `GskRenderNode` to compare with
+ * @data: the diff data
+ *
+ * Like gsk_render_node_diff(), but doesn't look for scrolls.
+ *
+ * This is used for children whose pixels are not drawn as-is,
+ * like the child of an opacity node, so scrolling them would
+ * move the wrong pixels.
+ */
+void
+gsk_render_node_diff_without_scrolls (GskRenderNode *node1,
+                                      GskRenderNode *node2,
+                                      GskDiffData   *data)
+{
+  gsk_render_node_diff (node1, node2, &(GskDiffData) { data->region, data->surface, NULL });
+}
+
 /**
  * gsk_render_node_diff:
  * @node1: a render node
@@ -4514,7 +4514,22 @@ static GskDiffResult
 gsk_container_node_keep_func (gconstpointer elem1, gconstpointer elem2, gpointer user_data)
 {
   GskDiffData *data = user_data;
+  guint i, first_scroll;
+
+  first_scroll = data->scrolls ? data->scrolls->len : 0;
+
   gsk_render_node_diff ((GskRenderNode *) elem1, (GskRenderNode *) elem2, data);
+
+  /* Remember where the scrolls came from, so we can look for
+   * siblings that are drawn on top of them */
+  for (i = first_scroll; data->scrolls && i < data->scrolls->len; i++)
+    {
+      GskDiffScroll *scroll = &g_array_index (data->scrolls, GskDiffScroll, i);
+
+      scroll->node1 = elem1;
+      scroll->node2 = elem2;
+    }
+
   if (cairo_region_num_rectangles (data->region) > MAX_RECTS_IN_DIFF)
     return GSK_DIFF_ABORTED;
 
@@ -4572,15 +4587,76 @@ gsk_container_node_diff_with (GskRenderNode *container,
                               GskDiffData   *data)
 {
   GskContainerNode *self = (GskContainerNode *) container;
+  guint first_scroll;
 
-  if (gsk_render_node_diff_multiple (self->children,
-                                     self->n_children,
-                                     &other,
-                                     1,
-                                     data))
-    return;
+  first_scroll = data->scrolls ? data->scrolls->len : 0;
+
+  if (!gsk_render_node_diff_multiple (self->children,
+                                      self->n_children,
+                                      &other,
+                                      1,
+                                      data))
+    gsk_render_node_diff_impossible (container, other, data);
+
+  /* This is rare enough that we don't bother keeping scrolls */
+  gsk_diff_data_drop_scrolls (data, first_scroll);
+}
+
+static void
+region_union_rect_grow (cairo_region_t        *region,
+                        const graphene_rect_t *rect,
+                        int                    dx,
+                        int                    dy)
+{
+  cairo_rectangle_int_t int_rect;
+
+  gsk_rect_to_cairo_grow (rect, &int_rect);
+  int_rect.x += dx;
+  int_rect.y += dy;
+  cairo_region_union_rectangle (region, &int_rect);
+}
+
+/* Moving pixels around also moves everything that was drawn on top
+ * of the scrolled content, so redraw what ends up in the wrong place.
+ */
+static void
+gsk_container_node_diff_scrolls (GskContainerNode *self1,
+                                 GskContainerNode *self2,
+                                 guint             first_scroll,
+                                 GskDiffData      *data)
+{
+  guint i, j, k;
+
+  for (i = first_scroll; i < data->scrolls->len; i++)
+    {
+      const GskDiffScroll *scroll = &g_array_index (data->scrolls, GskDiffScroll, i);
+      graphene_rect_t rect = GRAPHENE_RECT_INIT (scroll->rect.x, scroll->rect.y,
+                                                 scroll->rect.width, scroll->rect.height);
+      graphene_rect_t source = GRAPHENE_RECT_INIT (scroll->rect.x - scroll->dx,
+                                                   scroll->rect.y - scroll->dy,
+                                                   scroll->rect.width, scroll->rect.height);
+
+      /* Old nodes on top got moved along with the content */
+      for (j = 0; j < self1->n_children && self1->children[j] != scroll->node1; j++)
+        ;
+      for (k = j + 1; k < self1->n_children; k++)
+        {
+          const graphene_rect_t *bounds = &self1->children[k]->bounds;
+
+          if (gsk_rect_intersects (&source, bounds))
+            region_union_rect_grow (data->region, bounds, scroll->dx, scroll->dy);
+        }
 
-  gsk_render_node_diff_impossible (container, other, data);
+      for (j = 0; j < self2->n_children && self2->children[j] != scroll->node2; j++)
+        ;
+      for (k = j + 1; k < self2->n_children; k++)
+        {
+          const graphene_rect_t *bounds = &self2->children[k]->bounds;
+
+          if (gsk_rect_intersects (&rect, bounds))
+            region_union_rect_grow (data->region, bounds, 0, 0);
+        }
+    }
 }
 
 static void
@@ -4590,14 +4666,22 @@ gsk_container_node_diff (GskRenderNode *node1,
 {
   GskContainerNode *self1 = (GskContainerNode *) node1;
   GskContainerNode *self2 = (GskContainerNode *) node2;
+  guint first_scroll;
+
+  first_scroll = data->scrolls ? data->scrolls->len : 0;
 
   if (gsk_render_node_diff_multiple (self1->children,
                                      self1->n_children,
                                      self2->children,
                                      self2->n_children,
                                      data))
-    return;
+    {
+      if (data->scrolls)
+        gsk_container_node_diff_scrolls (self1, self2, first_scroll, data);
+      return;
+    }
 
+  gsk_diff_data_drop_scrolls (data, first_scroll);
   gsk_render_node_diff_impossible (node1, node2, data);
 }
 
@@ -4844,6 +4928,53 @@ gsk_transform_node_can_diff (const GskRenderNode *node1,
   return gsk_render_node_can_diff (self1->child, self2->child);
 }
 
+static void
+gsk_render_node_diff_translated (GskRenderNode *node1,
+                                 GskRenderNode *node2,
+                                 float          dx,
+                                 float          dy,
+                                 GskDiffData   *data)
+{
+  cairo_region_t *sub;
+  GArray *scrolls;
+  guint i, first_scroll;
+
+  /* Scrolls must stay on whole pixels */
+  if (floorf (dx) == dx && floorf (dy) == dy)
+    scrolls = data->scrolls;
+  else
+    scrolls = NULL;
+  first_scroll = scrolls ? scrolls->len : 0;
+
+  sub = cairo_region_create ();
+  gsk_render_node_diff (node1, node2, &(GskDiffData) { sub, data->surface, scrolls });
+  cairo_region_translate (sub, floorf (dx), floorf (dy));
+  if (floorf (dx) != dx)
+    {
+      cairo_region_t *tmp = cairo_region_copy (sub);
+      cairo_region_translate (tmp, 1, 0);
+      cairo_region_union (sub, tmp);
+      cairo_region_destroy (tmp);
+    }
+  if (floorf (dy) != dy)
+    {
+      cairo_region_t *tmp = cairo_region_copy (sub);
+      cairo_region_translate (tmp, 0, 1);
+      cairo_region_union (sub, tmp);
+      cairo_region_destroy (tmp);
+    }
+  cairo_region_union (data->region, sub);
+  cairo_region_destroy (sub);
+
+  for (i = first_scroll; scrolls && i < scrolls->len; i++)
+    {
+      GskDiffScroll *scroll = &g_array_index (scrolls, GskDiffScroll, i);
+
+      scroll->rect.x += dx;
+      scroll->rect.y += dy;
+    }
+}
+
 static void
 gsk_transform_node_diff (GskRenderNode *node1,
                          GskRenderNode *node2,
@@ -4868,30 +4999,7 @@ gsk_transform_node_diff (GskRenderNode *node1,
       break;
 
     case GSK_TRANSFORM_CATEGORY_2D_TRANSLATE:
-      {
-        cairo_region_t *sub;
-        float dx, dy;
-        gsk_transform_to_translate (self1->transform, &dx, &dy);
-        sub = cairo_region_create ();
-        gsk_render_node_diff (self1->child, self2->child, &(GskDiffData) { sub, data->surface });
-        cairo_region_translate (sub, floorf (dx), floorf (dy));
-        if (floorf (dx) != dx)
-          {
-            cairo_region_t *tmp = cairo_region_copy (sub);
-            cairo_region_translate (tmp, 1, 0);
-            cairo_region_union (sub, tmp);
-            cairo_region_destroy (tmp);
-          }
-        if (floorf (dy) != dy)
-          {
-            cairo_region_t *tmp = cairo_region_copy (sub);
-            cairo_region_translate (tmp, 0, 1);
-            cairo_region_union (sub, tmp);
-            cairo_region_destroy (tmp);
-          }
-        cairo_region_union (data->region, sub);
-        cairo_region_destroy (sub);
-      }
+      gsk_render_node_diff_translated (self1->child, self2->child, self1->dx, self1->dy, data);
       break;
 
     case GSK_TRANSFORM_CATEGORY_2D_AFFINE:
@@ -5097,7 +5205,7 @@ gsk_opacity_node_diff (GskRenderNode *node1,
   GskOpacityNode *self2 = (GskOpacityNode *) node2;
 
   if (self1->opacity == self2->opacity)
-    gsk_render_node_diff (self1->child, self2->child, data);
+    gsk_render_node_diff_without_scrolls (self1->child, self2->child, data);
   else
     gsk_render_node_diff_impossible (node1, node2, data);
 }
@@ -5318,7 +5426,7 @@ gsk_color_matrix_node_diff (GskRenderNode *node1,
   if (!graphene_matrix_equal_fast (&self1->color_matrix, &self2->color_matrix))
     goto nope;
 
-  gsk_render_node_diff (self1->child, self2->child, data);
+  gsk_render_node_diff_without_scrolls (self1->child, self2->child, data);
   return;
 
 nope:
@@ -5770,6 +5878,78 @@ gsk_clip_node_draw (GskRenderNode *node,
   cairo_restore (cr);
 }
 
+/* Scrolling a viewport moves its content by a whole number of
+ * pixels inside a clip. Instead of redrawing all of the clip, we
+ * let the renderer move the pixels from the previous frame and
+ * only redraw what scrolled into view and what changed.
+ *
+ * This only works if the content covers all of what we move,
+ * or we would move what's drawn below it, too.
+ */
+static gboolean
+gsk_clip_node_diff_scroll (GskClipNode *self1,
+                           GskClipNode *self2,
+                           GskDiffData *data)
+{
+  GskTransformNode *transform1, *transform2;
+  graphene_rect_t opaque1, opaque2;
+  cairo_rectangle_int_t clip_rect, rect, source;
+  cairo_region_t *sub, *unmoved;
+  float dx, dy;
+
+  if (data->scrolls == NULL ||
+      gsk_render_node_get_node_type (self1->child) != GSK_TRANSFORM_NODE ||
+      gsk_render_node_get_node_type (self2->child) != GSK_TRANSFORM_NODE)
+    return FALSE;
+
+  transform1 = (GskTransformNode *) self1->child;
+  transform2 = (GskTransformNode *) self2->child;
+
+  if (gsk_transform_get_category (transform1->transform) < GSK_TRANSFORM_CATEGORY_2D_TRANSLATE ||
+      gsk_transform_get_category (transform2->transform) < GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
+    return FALSE;
+
+  dx = transform2->dx - transform1->dx;
+  dy = transform2->dy - transform1->dy;
+  if ((dx == 0 && dy == 0) ||
+      floorf (dx) != dx || floorf (dy) != dy ||
+      !gsk_render_node_can_diff (transform1->child, transform2->child))
+    return FALSE;
+
+  /* The pixels we move must be inside the clip and covered by
+   * the content, both where they come from and where they go */
+  if (!gsk_render_node_get_opaque_rect (self1->child, &opaque1) ||
+      !gsk_render_node_get_opaque_rect (self2->child, &opaque2) ||
+      !gsk_rect_intersection (&opaque1, &self1->clip, &opaque1) ||
+      !gsk_rect_intersection (&opaque2, &self2->clip, &opaque2))
+    return FALSE;
+
+  gsk_rect_to_cairo_shrink (&opaque1, &source);
+  gsk_rect_to_cairo_shrink (&opaque2, &rect);
+  source.x += dx;
+  source.y += dy;
+  if (!gdk_rectangle_intersect (&rect, &source, &rect))
+    return FALSE;
+
+  /* Redraw what changed and what we can't move */
+  sub = cairo_region_create ();
+  gsk_render_node_diff_translated (transform1->child, transform2->child,
+                                   transform2->dx, transform2->dy,
+                                   &(GskDiffData) { sub, data->surface, NULL });
+  gsk_rect_to_cairo_grow (&self2->clip, &clip_rect);
+  unmoved = cairo_region_create_rectangle (&clip_rect);
+  cairo_region_subtract_rectangle (unmoved, &rect);
+  cairo_region_union (sub, unmoved);
+  cairo_region_intersect_rectangle (sub, &clip_rect);
+  cairo_region_union (data->region, sub);
+  cairo_region_destroy (unmoved);
+  cairo_region_destroy (sub);
+
+  g_array_append_val (data->scrolls, ((GskDiffScroll) { rect, (int) dx, (int) dy, NULL, NULL }));
+
+  return TRUE;
+}
+
 static void
 gsk_clip_node_diff (GskRenderNode *node1,
                     GskRenderNode *node2,
@@ -5782,10 +5962,34 @@ gsk_clip_node_diff (GskRenderNode *node1,
     {
       cairo_region_t *sub;
       cairo_rectangle_int_t clip_rect;
+      guint i, first_scroll;
+
+      if (gsk_clip_node_diff_scroll (self1, self2, data))
+        return;
+
+      first_scroll = data->scrolls ? data->scrolls->len : 0;
 
       sub = cairo_region_create();
-      gsk_render_node_diff (self1->child, self2->child, &(GskDiffData) { sub, data->surface });
+      gsk_render_node_diff (self1->child, self2->child, &(GskDiffData) { sub, data->surface, data->scrolls });
       gsk_rect_to_cairo_grow (&self1->clip, &clip_rect);
+
+      /* Scrolls inside the clip must stay inside */
+      for (i = first_scroll; data->scrolls && i < data->scrolls->len; i++)
+        {
+          GskDiffScroll *scroll = &g_array_index (data->scrolls, GskDiffScroll, i);
+          cairo_rectangle_int_t inside;
+
+          cairo_region_t *outside;
+
+          gsk_rect_to_cairo_shrink (&self1->clip, &inside);
+          outside = cairo_region_create_rectangle (&scroll->rect);
+          if (!gdk_rectangle_intersect (&scroll->rect, &inside, &scroll->rect))
+            scroll->rect = (cairo_rectangle_int_t) { 0, 0, 0, 0 };
+          cairo_region_subtract_rectangle (outside, &scroll->rect);
+          cairo_region_union (sub, outside);
+          cairo_region_destroy (outside);
+        }
+
       cairo_region_intersect_rectangle (sub, &clip_rect);
       cairo_region_union (data->region, sub);
       cairo_region_destroy (sub);
@@ -6958,8 +7162,8 @@ gsk_blend_node_diff (GskRenderNode *node1,
 
   if (self1->blend_mode == self2->blend_mode)
     {
-      gsk_render_node_diff (self1->top, self2->top, data);
-      gsk_render_node_diff (self1->bottom, self2->bottom, data);
+      gsk_render_node_diff_without_scrolls (self1->top, self2->top, data);
+      gsk_render_node_diff_without_scrolls (self1->bottom, self2->bottom, data);
     }
   else
     {
@@ -7131,8 +7335,8 @@ gsk_cross_fade_node_diff (GskRenderNode *node1,
 
   if (self1->progress == self2->progress)
     {
-      gsk_render_node_diff (self1->start, self2->start, data);
-      gsk_render_node_diff (self1->end, self2->end, data);
+      gsk_render_node_diff_without_scrolls (self1->start, self2->start, data);
+      gsk_render_node_diff_without_scrolls (self1->end, self2->end, data);
       return;
     }
 
@@ -8100,8 +8304,8 @@ gsk_mask_node_diff (GskRenderNode *node1,
       return;
     }
 
-  gsk_render_node_diff (self1->source, self2->source, data);
-  gsk_render_node_diff (self1->mask, self2->mask, data);
+  gsk_render_node_diff_without_scrolls (self1->source, self2->source, data);
+  gsk_render_node_diff_without_scrolls (self1->mask, self2->mask, data);
 }
 
 static void
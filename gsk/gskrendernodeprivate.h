@@ -39,10 +39,26 @@ struct _GskRenderNode
   guint is_hdr : 1;
 };
 
+/* Content that moved by a whole number of pixels.
+ *
+ * Every pixel in @rect is the pixel at (x - dx, y - dy) in the
+ * previous frame, unless it is part of the diff region.
+ */
+typedef struct
+{
+  cairo_rectangle_int_t rect;
+  int dx;
+  int dy;
+  /* the children of the container that is being diffed */
+  const GskRenderNode *node1;
+  const GskRenderNode *node2;
+} GskDiffScroll;
+
 typedef struct
 {
   cairo_region_t *region;
   GdkSurface *surface;
+  GArray *scrolls; /* (nullable): GskDiffScroll, NULL to not look for scrolls */
 } GskDiffData;
 
 struct _GskRenderNodeClass
@@ -82,6 +98,11 @@ void            gsk_render_node_diff                    (GskRenderNode
 void            gsk_render_node_diff_impossible         (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          GskDiffData                 *data);
+void            gsk_render_node_diff_without_scrolls    (GskRenderNode               *node1,
+                                                         GskRenderNode               *node2,
+                                                         GskDiffData                 *data);
+void            gsk_diff_data_drop_scrolls              (GskDiffData                 *data,
+                                                         guint                        first);
 void            gsk_container_node_diff_with            (GskRenderNode               *container,
                                                          GskRenderNode               *other,
                                                          GskDiffData                 *data);
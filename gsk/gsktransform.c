@@ -36,6 +36,7 @@
 
 #include "gsktransformprivate.h"
 
+#include "gskpoolprivate.h"
 #include "gskrectprivate.h"
 
 /* {{{ Boilerplate */
@@ -116,9 +117,10 @@ gsk_transform_alloc (const GskTransformClass   *transform_class,
 
   g_return_val_if_fail (transform_class != NULL, NULL);
 
-  self = g_atomic_rc_box_alloc0 (transform_class->struct_size);
+  self = gsk_pool_alloc0 (transform_class->struct_size);
 
   self->transform_class = transform_class;
+  g_atomic_ref_count_init (&self->ref_count);
   self->category = next ? MIN (category, next->category) : category;
   if (gsk_transform_is_identity (next))
     gsk_transform_unref (next);
@@ -131,9 +133,12 @@ gsk_transform_alloc (const GskTransformClass   *transform_class,
 static void
 gsk_transform_finalize (GskTransform *self)
 {
+  GskTransform *next = self->next;
+
   self->transform_class->finalize (self);
+  gsk_pool_free (self, self->transform_class->struct_size);
 
-  gsk_transform_unref (self->next);
+  gsk_transform_unref (next);
 }
 
 /* }}} */
@@ -1741,7 +1746,9 @@ gsk_transform_ref (GskTransform *self)
   if (self == NULL)
     return NULL;
 
-  return g_atomic_rc_box_acquire (self);
+  g_atomic_ref_count_inc (&self->ref_count);
+
+  return self;
 }
 
 /**
@@ -1759,7 +1766,8 @@ gsk_transform_unref (GskTransform *self)
   if (self == NULL)
     return;
 
-  g_atomic_rc_box_release_full (self, (GDestroyNotify) gsk_transform_finalize);
+  if (g_atomic_ref_count_dec (&self->ref_count))
+    gsk_transform_finalize (self);
 }
 
 /**
@@ -83,6 +83,8 @@ struct _GskTransform
 {
   const GskTransformClass *transform_class;
 
+  gatomicrefcount ref_count;
+
   GskFineTransformCategory category;
   GskTransform *next;
 };
@@ -460,3 +460,32 @@ gtk_at_spi_cache_remove_context (GtkAtSpiCache   *self,
 
   GTK_DEBUG (A11Y, "Removing context '%s' from cache", path);
 }
+
+/*< private >
+ * gtk_at_spi_cache_update_path:
+ * @self: a `GtkAtSpiCache`
+ * @path: the object path of a context
+ *
+ * Re-emits the cached data for the context at @path, if it
+ * is in the cache.
+ *
+ * This is used instead of a long series of ChildrenChanged
+ * events, when a context gains or loses many children at once.
+ */
+void
+gtk_at_spi_cache_update_path (GtkAtSpiCache *self,
+                              const char    *path)
+{
+  GtkAtSpiContext *context;
+
+  g_return_if_fail (GTK_IS_AT_SPI_CACHE (self));
+
+  context = g_hash_table_lookup (self->contexts_by_path, path);
+  if (context == NULL)
+    return;
+
+  GTK_DEBUG (A11Y, "Updating context '%s' in cache", path);
+
+  if (!self->in_get_items)
+    emit_add_accessible (self, context);
+}
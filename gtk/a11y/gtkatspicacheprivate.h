@@ -42,4 +42,8 @@ void
 gtk_at_spi_cache_remove_context (GtkAtSpiCache *self,
                                  GtkAtSpiContext *context);
 
+void
+gtk_at_spi_cache_update_path (GtkAtSpiCache *self,
+                              const char    *path);
+
 G_END_DECLS
@@ -797,6 +797,28 @@ static const GDBusInterfaceVTable accessible_vtable = {
 };
 /* }}} */
 /* {{{ Change notification */
+
+/* Events are queued on the root and flushed at the end of the
+ * frame; see gtk_at_spi_root_queue_event(). If @detail is not
+ * %NULL, the event replaces a queued event with the same member
+ * and detail for this context.
+ */
+static void
+queue_event (GtkAtSpiContext *self,
+             const char      *interface,
+             const char      *member,
+             const char      *detail,
+             GVariant        *args)
+{
+  gtk_at_spi_root_queue_event (self->root,
+                               gtk_at_context_get_accessible (GTK_AT_CONTEXT (self)),
+                               self->context_path,
+                               interface,
+                               member,
+                               detail,
+                               args);
+}
+
 static void
 emit_text_changed (GtkAtSpiContext *self,
                    const char      *kind,
@@ -807,16 +829,14 @@ emit_text_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "TextChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                kind, start, end,
-                                                g_variant_new_string (text),
-                                                NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "TextChanged",
+               NULL,
+               g_variant_new ("(siiva{sv})",
+                              kind, start, end,
+                              g_variant_new_string (text),
+                              NULL));
 }
 
 static void
@@ -828,23 +848,19 @@ emit_text_selection_changed (GtkAtSpiContext *self,
     return;
 
   if (strcmp (kind, "text-caret-moved") == 0)
-    g_dbus_connection_emit_signal (self->connection,
-                                   NULL,
-                                   self->context_path,
-                                   "org.a11y.atspi.Event.Object",
-                                   "TextCaretMoved",
-                                   g_variant_new ("(siiva{sv})",
-                                                  "", cursor_position, 0, g_variant_new_int32 (0), NULL),
-                                 NULL);
+    queue_event (self,
+                 "org.a11y.atspi.Event.Object",
+                 "TextCaretMoved",
+                 "",
+                 g_variant_new ("(siiva{sv})",
+                                "", cursor_position, 0, g_variant_new_int32 (0), NULL));
   else
-    g_dbus_connection_emit_signal (self->connection,
-                                   NULL,
-                                   self->context_path,
-                                   "org.a11y.atspi.Event.Object",
-                                   "TextSelectionChanged",
-                                   g_variant_new ("(siiva{sv})",
-                                                  "", 0, 0, g_variant_new_string (""), NULL),
-                                   NULL);
+    queue_event (self,
+                 "org.a11y.atspi.Event.Object",
+                 "TextSelectionChanged",
+                 "",
+                 g_variant_new ("(siiva{sv})",
+                                "", 0, 0, g_variant_new_string (""), NULL));
 }
 
 static void
@@ -854,14 +870,12 @@ emit_selection_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "SelectionChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                "", 0, 0, g_variant_new_string (""), NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "SelectionChanged",
+               "",
+               g_variant_new ("(siiva{sv})",
+                              "", 0, 0, g_variant_new_string (""), NULL));
 }
 
 static void
@@ -872,14 +886,12 @@ emit_state_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "StateChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                name, enabled, 0, g_variant_new_string ("0"), NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "StateChanged",
+               name,
+               g_variant_new ("(siiva{sv})",
+                              name, enabled, 0, g_variant_new_string ("0"), NULL));
 }
 
 static void
@@ -888,13 +900,14 @@ emit_defunct (GtkAtSpiContext *self)
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "StateChanged",
-                                 g_variant_new ("(siiva{sv})", "defunct", TRUE, 0, g_variant_new_string ("0"), NULL),
-                                 NULL);
+  /* Nothing queued for this object matters anymore */
+  gtk_at_spi_root_drop_events (self->root, self->context_path);
+
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "StateChanged",
+               NULL,
+               g_variant_new ("(siiva{sv})", "defunct", TRUE, 0, g_variant_new_string ("0"), NULL));
 }
 
 static void
@@ -905,14 +918,12 @@ emit_property_changed (GtkAtSpiContext *self,
   GVariant *value_owned = g_variant_ref_sink (value);
 
   if (self->connection != NULL && gtk_at_spi_root_has_event_listeners (self->root))
-    g_dbus_connection_emit_signal (self->connection,
-                                   NULL,
-                                   self->context_path,
-                                   "org.a11y.atspi.Event.Object",
-                                   "PropertyChange",
-                                   g_variant_new ("(siiva{sv})",
-                                                  name, 0, 0, value_owned, NULL),
-                                   NULL);
+    queue_event (self,
+                 "org.a11y.atspi.Event.Object",
+                 "PropertyChange",
+                 name,
+                 g_variant_new ("(siiva{sv})",
+                                name, 0, 0, value_owned, NULL));
 
   g_variant_unref (value_owned);
 }
@@ -927,14 +938,12 @@ emit_bounds_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "BoundsChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                "", 0, 0, g_variant_new ("(iiii)", x, y, width, height), NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "BoundsChanged",
+               "",
+               g_variant_new ("(siiva{sv})",
+                              "", 0, 0, g_variant_new ("(iiii)", x, y, width, height), NULL));
 }
 
 static void
@@ -951,11 +960,12 @@ emit_children_changed (GtkAtSpiContext         *self,
 
   GVariant *child_ref = gtk_at_spi_context_to_ref (child_context);
 
-  gtk_at_spi_emit_children_changed (self->connection,
-                                    self->context_path,
-                                    state,
-                                    idx,
-                                    child_ref);
+  gtk_at_spi_root_queue_children_changed (self->root,
+                                          gtk_at_context_get_accessible (GTK_AT_CONTEXT (self)),
+                                          self->context_path,
+                                          state,
+                                          idx,
+                                          child_ref);
 }
 
 static void
@@ -965,16 +975,14 @@ emit_window_event (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Window",
-                                 event_type,
-                                 g_variant_new ("(siiva{sv})",
-                                                "", 0, 0,
-                                                g_variant_new_string("0"),
-                                                NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Window",
+               event_type,
+               NULL,
+               g_variant_new ("(siiva{sv})",
+                              "", 0, 0,
+                              g_variant_new_string("0"),
+                              NULL));
 }
 
 static void
@@ -1606,16 +1614,14 @@ gtk_at_spi_context_announce (GtkATContext                      *context,
       g_assert_not_reached ();
     }
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "Announcement",
-                                 g_variant_new ("(siiva{sv})",
-                                                "", live, 0,
-                                                g_variant_new_string (message),
-                                                NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "Announcement",
+               NULL,
+               g_variant_new ("(siiva{sv})",
+                              "", live, 0,
+                              g_variant_new_string (message),
+                              NULL));
 }
 
 static void
@@ -1631,18 +1637,16 @@ gtk_at_spi_context_update_caret_position (GtkATContext *context)
 
   offset = gtk_accessible_text_get_caret_position (accessible_text);
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "TextCaretMoved",
-                                 g_variant_new ("(siiva{sv})",
-                                                "",
-                                                (int) offset,
-                                                0,
-                                                g_variant_new_int32 (0),
-                                                NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "TextCaretMoved",
+               "",
+               g_variant_new ("(siiva{sv})",
+                              "",
+                              (int) offset,
+                              0,
+                              g_variant_new_int32 (0),
+                              NULL));
 }
 
 static void
@@ -1653,18 +1657,16 @@ gtk_at_spi_context_update_selection_bound (GtkATContext *context)
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "TextSelectionChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                "",
-                                                0,
-                                                0,
-                                                g_variant_new_string (""),
-                                                NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "TextSelectionChanged",
+               "",
+               g_variant_new ("(siiva{sv})",
+                              "",
+                              0,
+                              0,
+                              g_variant_new_string (""),
+                              NULL));
 }
 
 static void
@@ -1712,18 +1714,16 @@ gtk_at_spi_context_update_text_contents (GtkATContext *context,
   if (end == G_MAXUINT)
     end = g_utf8_strlen (text, -1);
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "TextChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                kind,
-                                                start,
-                                                end - start,
-                                                g_variant_new_string (text),
-                                                NULL),
-                                 NULL);
+  queue_event (self,
+               "org.a11y.atspi.Event.Object",
+               "TextChanged",
+               NULL,
+               g_variant_new ("(siiva{sv})",
+                              kind,
+                              start,
+                              end - start,
+                              g_variant_new_string (text),
+                              NULL));
 
 out:
   g_clear_pointer (&contents, g_bytes_unref);
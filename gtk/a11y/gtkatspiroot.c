@@ -32,11 +32,13 @@
 #include "gtkwindow.h"
 #include "gtkprivate.h"
 #include "gdkprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 
 #include "a11y/atspi/atspi-accessible.h"
 #include "a11y/atspi/atspi-application.h"
 
 #include <locale.h>
+#include <string.h>
 
 #include <glib/gi18n-lib.h>
 #include <gio/gio.h>
@@ -77,6 +79,19 @@ struct _GtkAtSpiRoot
   /* HashTable<str, uint> */
   GHashTable *event_listeners;
   bool can_use_event_listeners;
+
+  /* Events waiting for the next flush */
+  GPtrArray *queued_events;
+  /* HashTable<str, uint>, coalescing key -> index in queued_events */
+  GHashTable *queued_event_keys;
+  /* HashTable<str, uint>, path -> index of the last event in queued_events */
+  GHashTable *last_queued_events;
+  /* HashTable<str, ChildrenChanges> */
+  GHashTable *children_changed;
+
+  GdkFrameClock *flush_clock;
+  gulong flush_handler;
+  guint flush_id;
 };
 
 enum
@@ -90,6 +105,7 @@ static GParamSpec *obj_props[N_PROPS];
 
 G_DEFINE_TYPE (GtkAtSpiRoot, gtk_at_spi_root, G_TYPE_OBJECT)
 
+
 static void
 gtk_at_spi_root_finalize (GObject *gobject)
 {
@@ -97,6 +113,10 @@ gtk_at_spi_root_finalize (GObject *gobject)
 
   g_clear_handle_id (&self->register_id, g_source_remove);
   g_clear_pointer (&self->event_listeners, g_hash_table_unref);
+  g_clear_pointer (&self->queued_events, g_ptr_array_unref);
+  g_clear_pointer (&self->queued_event_keys, g_hash_table_unref);
+  g_clear_pointer (&self->last_queued_events, g_hash_table_unref);
+  g_clear_pointer (&self->children_changed, g_hash_table_unref);
 
   g_free (self->bus_address);
   g_free (self->base_path);
@@ -111,6 +131,9 @@ gtk_at_spi_root_dispose (GObject *gobject)
 {
   GtkAtSpiRoot *self = GTK_AT_SPI_ROOT (gobject);
 
+  /* Send what is still queued while we have a connection */
+  gtk_at_spi_root_flush_events (self);
+
   g_clear_object (&self->cache);
   g_clear_object (&self->connection);
   g_clear_pointer (&self->queued_contexts, g_list_free);
@@ -913,6 +936,7 @@ gtk_at_spi_root_queue_register (GtkAtSpiRoot             *self,
       if (func != NULL)
         func (self, context);
 
+      gtk_at_spi_root_flush_events (self);
       gtk_at_spi_cache_add_context (self->cache, context);
       return;
     }
@@ -942,7 +966,10 @@ gtk_at_spi_root_unregister (GtkAtSpiRoot    *self,
     self->queued_contexts = g_list_remove (self->queued_contexts, context);
 
   if (self->cache != NULL)
-    gtk_at_spi_cache_remove_context (self->cache, context);
+    {
+      gtk_at_spi_root_flush_events (self);
+      gtk_at_spi_cache_remove_context (self->cache, context);
+    }
 }
 
 static void
@@ -1117,3 +1144,411 @@ gtk_at_spi_root_has_event_listeners (GtkAtSpiRoot *self)
   return self->event_listeners != NULL &&
     g_hash_table_size (self->event_listeners) != 0;
 }
+
+/* {{{ Event queue */
+
+/* Events are not emitted on the bus right away. We collect them
+ * until the next frame of the toplevel that caused them (or an idle,
+ * for accessibles without a frame clock) and flush them in one go.
+ *
+ * While queued, events that only describe a current value (states,
+ * properties, bounds, caret position) replace an older event for the
+ * same object and detail, so that only the last value is sent. This
+ * only happens if no other event for the object was queued since, so
+ * the events for each object are always emitted in order.
+ *
+ * If a single object receives more than MAX_CHILDREN_CHANGED children
+ * changes in one frame, we replace them all with a single update of
+ * the object in the cache, emitted where the last of the changes was
+ * queued, so it comes after everything that happened before it. It
+ * is followed by one ChildrenChanged event with an index of -1 for
+ * each kind of change, which tells ATs to re-read the children.
+ *
+ * The cache's AddAccessible and RemoveAccessible signals are not
+ * queued, so the queue is flushed before they are emitted.
+ */
+
+#define MAX_CHILDREN_CHANGED 32
+
+typedef struct
+{
+  char *path;
+  const char *interface;
+  const char *member;
+  char *key;
+  GVariant *args;
+} QueuedEvent;
+
+typedef struct
+{
+  guint n_added;
+  guint n_removed;
+  gboolean added_first;
+  guint last; /* index of the last change in queued_events */
+} ChildrenChanges;
+
+static guint queued_events_counter;
+static guint emitted_events_counter;
+
+static void
+queued_event_free (gpointer data)
+{
+  QueuedEvent *event = data;
+
+  if (event == NULL)
+    return;
+
+  g_free (event->path);
+  g_free (event->key);
+  g_variant_unref (event->args);
+  g_free (event);
+}
+
+static void
+gtk_at_spi_root_ensure_event_queue (GtkAtSpiRoot *self)
+{
+  if (self->queued_events != NULL)
+    return;
+
+  self->queued_events = g_ptr_array_new_with_free_func (queued_event_free);
+  self->queued_event_keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->last_queued_events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->children_changed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  if (queued_events_counter == 0)
+    {
+      queued_events_counter = gdk_profiler_define_int_counter ("atspi-queued", "AT-SPI events queued per flush");
+      emitted_events_counter = gdk_profiler_define_int_counter ("atspi-emitted", "AT-SPI events emitted per flush");
+    }
+}
+
+static void
+gtk_at_spi_root_clear_flush (GtkAtSpiRoot *self)
+{
+  if (self->flush_clock != NULL)
+    {
+      g_clear_signal_handler (&self->flush_handler, self->flush_clock);
+      g_clear_object (&self->flush_clock);
+    }
+
+  g_clear_handle_id (&self->flush_id, g_source_remove);
+}
+
+static void
+emit_collapsed_children_changed_detail (GtkAtSpiRoot *self,
+                                        const char   *path,
+                                        const char   *detail)
+{
+  g_dbus_connection_emit_signal (self->connection,
+                                 NULL,
+                                 path,
+                                 "org.a11y.atspi.Event.Object",
+                                 "ChildrenChanged",
+                                 g_variant_new ("(siiva{sv})",
+                                                detail, -1, 0,
+                                                gtk_at_spi_null_ref (),
+                                                NULL),
+                                 NULL);
+}
+
+static guint
+emit_collapsed_children_changed (GtkAtSpiRoot          *self,
+                                 const char            *path,
+                                 const ChildrenChanges *changes)
+{
+  guint n_emitted = 0;
+
+  if (self->cache != NULL)
+    gtk_at_spi_cache_update_path (self->cache, path);
+
+  if (changes->n_added > 0 && changes->added_first)
+    {
+      emit_collapsed_children_changed_detail (self, path, "add");
+      n_emitted++;
+    }
+
+  if (changes->n_removed > 0)
+    {
+      emit_collapsed_children_changed_detail (self, path, "remove");
+      n_emitted++;
+    }
+
+  if (changes->n_added > 0 && !changes->added_first)
+    {
+      emit_collapsed_children_changed_detail (self, path, "add");
+      n_emitted++;
+    }
+
+  return n_emitted;
+}
+
+void
+gtk_at_spi_root_flush_events (GtkAtSpiRoot *self)
+{
+  GPtrArray *events;
+  GHashTable *children_changed;
+  gint64 before G_GNUC_UNUSED;
+  guint n_emitted = 0;
+
+  g_return_if_fail (GTK_IS_AT_SPI_ROOT (self));
+
+  gtk_at_spi_root_clear_flush (self);
+
+  if (self->queued_events == NULL || self->queued_events->len == 0)
+    return;
+
+  before = GDK_PROFILER_CURRENT_TIME;
+
+  /* Take the queue, so that anything queued while flushing
+   * ends up in the next batch
+   */
+  events = g_steal_pointer (&self->queued_events);
+  children_changed = g_steal_pointer (&self->children_changed);
+  g_clear_pointer (&self->queued_event_keys, g_hash_table_unref);
+  g_clear_pointer (&self->last_queued_events, g_hash_table_unref);
+
+  for (guint i = 0; i < events->len; i++)
+    {
+      QueuedEvent *event = g_ptr_array_index (events, i);
+      const ChildrenChanges *changes;
+
+      /* Replaced by a later event */
+      if (event == NULL)
+        continue;
+
+      if (self->connection == NULL)
+        break;
+
+      if (strcmp (event->member, "ChildrenChanged") == 0 &&
+          (changes = g_hash_table_lookup (children_changed, event->path)) != NULL &&
+          changes->n_added + changes->n_removed > MAX_CHILDREN_CHANGED)
+        {
+          if (i == changes->last)
+            n_emitted += emit_collapsed_children_changed (self, event->path, changes);
+
+          continue;
+        }
+
+      g_dbus_connection_emit_signal (self->connection,
+                                     NULL,
+                                     event->path,
+                                     event->interface,
+                                     event->member,
+                                     event->args,
+                                     NULL);
+      n_emitted++;
+    }
+
+  gdk_profiler_set_int_counter (queued_events_counter, events->len);
+  gdk_profiler_set_int_counter (emitted_events_counter, n_emitted);
+  gdk_profiler_end_markf (before, "AT-SPI flush", "%u events, %u emitted", events->len, n_emitted);
+
+  GTK_DEBUG (A11Y, "Flushed %u queued events, %u emitted", events->len, n_emitted);
+
+  g_hash_table_unref (children_changed);
+  g_ptr_array_unref (events);
+}
+
+static void
+flush_after_paint (GdkFrameClock *clock,
+                   GtkAtSpiRoot  *self)
+{
+  gtk_at_spi_root_flush_events (self);
+}
+
+static gboolean
+flush_timeout (gpointer data)
+{
+  GtkAtSpiRoot *self = data;
+
+  self->flush_id = 0;
+  gtk_at_spi_root_flush_events (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* If the frame clock stops ticking (e.g. because the window
+ * was hidden), we don't want to hold on to events forever
+ */
+#define FLUSH_TIMEOUT_MS 100
+
+static void
+gtk_at_spi_root_schedule_flush (GtkAtSpiRoot  *self,
+                                GtkAccessible *accessible)
+{
+  GdkFrameClock *clock = NULL;
+
+  if (self->flush_id != 0)
+    return;
+
+  if (GTK_IS_WIDGET (accessible))
+    clock = gtk_widget_get_frame_clock (GTK_WIDGET (accessible));
+
+  if (clock != NULL)
+    {
+      self->flush_clock = g_object_ref (clock);
+      self->flush_handler = g_signal_connect (clock, "after-paint",
+                                              G_CALLBACK (flush_after_paint), self);
+      gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_AFTER_PAINT);
+
+      self->flush_id = g_timeout_add (FLUSH_TIMEOUT_MS, flush_timeout, self);
+    }
+  else
+    {
+      self->flush_id = g_idle_add_full (GDK_PRIORITY_REDRAW + 10, flush_timeout, self, NULL);
+    }
+
+  gdk_source_set_static_name_by_id (self->flush_id, "[gtk] AT-SPI event flush");
+}
+
+static void
+gtk_at_spi_root_take_event (GtkAtSpiRoot  *self,
+                            GtkAccessible *accessible,
+                            QueuedEvent   *event)
+{
+  gpointer last;
+
+  gtk_at_spi_root_ensure_event_queue (self);
+
+  if (!g_hash_table_lookup_extended (self->last_queued_events, event->path, NULL, &last))
+    last = GUINT_TO_POINTER (G_MAXUINT);
+
+  if (event->key != NULL)
+    {
+      gpointer index;
+
+      /* Drop the older event, the new one goes to the end of the queue.
+       * If other events for the object came in between, we keep it,
+       * so that they are not reordered.
+       */
+      if (g_hash_table_lookup_extended (self->queued_event_keys, event->key, NULL, &index) &&
+          index == last)
+        {
+          queued_event_free (g_ptr_array_index (self->queued_events, GPOINTER_TO_UINT (index)));
+          g_ptr_array_index (self->queued_events, GPOINTER_TO_UINT (index)) = NULL;
+        }
+
+      g_hash_table_insert (self->queued_event_keys,
+                           g_strdup (event->key),
+                           GUINT_TO_POINTER (self->queued_events->len));
+    }
+
+  g_hash_table_insert (self->last_queued_events,
+                       g_strdup (event->path),
+                       GUINT_TO_POINTER (self->queued_events->len));
+
+  g_ptr_array_add (self->queued_events, event);
+
+  gtk_at_spi_root_schedule_flush (self, accessible);
+}
+
+/*< private >
+ * gtk_at_spi_root_queue_event:
+ * @self: a `GtkAtSpiRoot`
+ * @accessible: (nullable): the accessible the event is about
+ * @path: the object path to emit the event on
+ * @interface: the D-Bus interface of the event, a static string
+ * @member: the name of the event, a static string
+ * @detail: (nullable): if not %NULL, the event replaces queued
+ *   events with the same @path, @member and @detail
+ * @args: (transfer floating): the arguments of the event
+ *
+ * Queues an event for emission at the end of the next frame.
+ */
+void
+gtk_at_spi_root_queue_event (GtkAtSpiRoot  *self,
+                             GtkAccessible *accessible,
+                             const char    *path,
+                             const char    *interface,
+                             const char    *member,
+                             const char    *detail,
+                             GVariant      *args)
+{
+  QueuedEvent *event;
+
+  g_return_if_fail (GTK_IS_AT_SPI_ROOT (self));
+  g_return_if_fail (path != NULL);
+
+  event = g_new (QueuedEvent, 1);
+  event->path = g_strdup (path);
+  event->interface = interface;
+  event->member = member;
+  event->key = detail ? g_strconcat (path, " ", member, " ", detail, NULL) : NULL;
+  event->args = g_variant_ref_sink (args);
+
+  gtk_at_spi_root_take_event (self, accessible, event);
+}
+
+void
+gtk_at_spi_root_queue_children_changed (GtkAtSpiRoot            *self,
+                                        GtkAccessible           *accessible,
+                                        const char              *path,
+                                        GtkAccessibleChildState  state,
+                                        int                      idx,
+                                        GVariant                *child_ref)
+{
+  ChildrenChanges *changes;
+
+  g_return_if_fail (GTK_IS_AT_SPI_ROOT (self));
+
+  gtk_at_spi_root_queue_event (self, accessible, path,
+                               "org.a11y.atspi.Event.Object",
+                               "ChildrenChanged",
+                               NULL,
+                               g_variant_new ("(siiva{sv})",
+                                              state == GTK_ACCESSIBLE_CHILD_STATE_ADDED ? "add" : "remove",
+                                              idx, 0, child_ref, NULL));
+
+  changes = g_hash_table_lookup (self->children_changed, path);
+  if (changes == NULL)
+    {
+      changes = g_new0 (ChildrenChanges, 1);
+      changes->added_first = state == GTK_ACCESSIBLE_CHILD_STATE_ADDED;
+      g_hash_table_insert (self->children_changed, g_strdup (path), changes);
+    }
+
+  if (state == GTK_ACCESSIBLE_CHILD_STATE_ADDED)
+    changes->n_added++;
+  else
+    changes->n_removed++;
+  changes->last = self->queued_events->len - 1;
+}
+
+/*< private >
+ * gtk_at_spi_root_drop_events:
+ * @self: a `GtkAtSpiRoot`
+ * @path: an object path
+ *
+ * Drops queued events for an object that is going away.
+ */
+void
+gtk_at_spi_root_drop_events (GtkAtSpiRoot *self,
+                             const char   *path)
+{
+  g_return_if_fail (GTK_IS_AT_SPI_ROOT (self));
+
+  if (self->queued_events == NULL || path == NULL)
+    return;
+
+  for (guint i = 0; i < self->queued_events->len; i++)
+    {
+      QueuedEvent *event = g_ptr_array_index (self->queued_events, i);
+
+      if (event == NULL || strcmp (event->path, path) != 0)
+        continue;
+
+      /* ChildrenChanged events are about the children, and
+       * still matter to ATs tracking the parent
+       */
+      if (strcmp (event->member, "ChildrenChanged") == 0)
+        continue;
+
+      if (event->key)
+        g_hash_table_remove (self->queued_event_keys, event->key);
+
+      queued_event_free (event);
+      g_ptr_array_index (self->queued_events, i) = NULL;
+    }
+}
+
+/* }}} */
@@ -66,4 +66,28 @@ gtk_at_spi_root_child_changed (GtkAtSpiRoot             *self,
 gboolean
 gtk_at_spi_root_has_event_listeners (GtkAtSpiRoot *self);
 
+void
+gtk_at_spi_root_queue_event (GtkAtSpiRoot  *self,
+                             GtkAccessible *accessible,
+                             const char    *path,
+                             const char    *interface,
+                             const char    *member,
+                             const char    *detail,
+                             GVariant      *args);
+
+void
+gtk_at_spi_root_queue_children_changed (GtkAtSpiRoot            *self,
+                                        GtkAccessible           *accessible,
+                                        const char              *path,
+                                        GtkAccessibleChildState  state,
+                                        int                      idx,
+                                        GVariant                *child_ref);
+
+void
+gtk_at_spi_root_drop_events (GtkAtSpiRoot *self,
+                             const char   *path);
+
+void
+gtk_at_spi_root_flush_events (GtkAtSpiRoot *self);
+
 G_END_DECLS
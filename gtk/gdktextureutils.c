@@ -16,6 +16,9 @@
 
 #include "config.h"
 
+#include <string.h>
+#include <glib/gstdio.h>
+
 #include <gdk/gdk.h>
 #include "gdktextureutilsprivate.h"
 #include "gtkscalerprivate.h"
@@ -925,14 +928,118 @@ gdk_paintable_new_from_file_scaled (GFile  *file,
 /* }}} */
 /* {{{ Render node API */
 
+typedef struct
+{
+  GskPath *path;
+  float opacity;
+  gboolean do_fill;
+  GskFillRule fill_rule;
+  GdkRGBA fill_color;
+  GskStroke *stroke;
+  GdkRGBA stroke_color;
+} SymbolicPath;
+
+/* The result of parsing a symbolic svg. This is what
+ * gets turned into a render node, and what the symbolic
+ * icon cache stores on disk.
+ */
 typedef struct
 {
   double width, height;
-  GtkSnapshot *snapshot;
   gboolean only_fg;
   gboolean has_clip;
   guint n_paths;
-} ParserData;
+  GArray *paths;
+} SymbolicIcon;
+
+static void
+symbolic_path_clear (gpointer data)
+{
+  SymbolicPath *sp = data;
+
+  g_clear_pointer (&sp->path, gsk_path_unref);
+  g_clear_pointer (&sp->stroke, gsk_stroke_free);
+}
+
+static void
+symbolic_icon_init (SymbolicIcon *icon)
+{
+  icon->width = icon->height = 0;
+  icon->only_fg = TRUE;
+  icon->has_clip = FALSE;
+  icon->n_paths = 0;
+  icon->paths = g_array_new (FALSE, TRUE, sizeof (SymbolicPath));
+  g_array_set_clear_func (icon->paths, symbolic_path_clear);
+}
+
+static void
+symbolic_icon_clear (SymbolicIcon *icon)
+{
+  g_clear_pointer (&icon->paths, g_array_unref);
+}
+
+static void
+symbolic_icon_add_path (SymbolicIcon   *icon,
+                        GskPath        *path,
+                        float           opacity,
+                        GskFillRule     fill_rule,
+                        const GdkRGBA  *fill_color,
+                        GskStroke      *stroke,
+                        const GdkRGBA  *stroke_color)
+{
+  SymbolicPath sp = { 0, };
+
+  sp.path = gsk_path_ref (path);
+  sp.opacity = opacity;
+  sp.fill_rule = fill_rule;
+  if (fill_color)
+    {
+      sp.do_fill = TRUE;
+      sp.fill_color = *fill_color;
+      icon->n_paths++;
+    }
+  if (stroke)
+    {
+      sp.stroke = gsk_stroke_copy (stroke);
+      sp.stroke_color = *stroke_color;
+      icon->n_paths++;
+    }
+
+  g_array_append_val (icon->paths, sp);
+}
+
+static GskRenderNode *
+symbolic_icon_to_node (const SymbolicIcon *icon)
+{
+  GtkSnapshot *snapshot;
+
+  snapshot = gtk_snapshot_new ();
+
+  if (icon->has_clip)
+    gtk_snapshot_push_clip (snapshot, &GRAPHENE_RECT_INIT (0, 0, icon->width, icon->height));
+
+  for (guint i = 0; i < icon->paths->len; i++)
+    {
+      const SymbolicPath *sp = &g_array_index (icon->paths, SymbolicPath, i);
+
+      if (sp->opacity != 1)
+        gtk_snapshot_push_opacity (snapshot, sp->opacity);
+
+      if (sp->do_fill)
+        gtk_snapshot_append_fill (snapshot, sp->path, sp->fill_rule, &sp->fill_color);
+
+      if (sp->stroke)
+        gtk_snapshot_append_stroke (snapshot, sp->path, sp->stroke, &sp->stroke_color);
+
+      if (sp->opacity != 1)
+        gtk_snapshot_pop (snapshot);
+    }
+
+  if (icon->has_clip)
+    gtk_snapshot_pop (snapshot);
+
+  return gtk_snapshot_free_to_node (snapshot);
+}
 
 static void
 set_attribute_error (GError     **error,
@@ -951,7 +1058,7 @@ start_element_cb (GMarkupParseContext  *context,
                   gpointer              user_data,
                   GError              **error)
 {
-  ParserData *data = user_data;
+  SymbolicIcon *data = user_data;
 
   if (strcmp (element_name, "svg") == 0)
     {
@@ -994,7 +1101,6 @@ start_element_cb (GMarkupParseContext  *context,
           return;
         }
 
-      gtk_snapshot_push_clip (data->snapshot, &GRAPHENE_RECT_INIT (0, 0, data->width, data->height));
       data->has_clip = TRUE;
     }
   else if (strcmp (element_name, "g") == 0)
@@ -1250,7 +1356,7 @@ start_element_cb (GMarkupParseContext  *context,
           n_dash = g_strv_length (str);
           if (n_dash > 0)
             {
-              float *dash = g_newa (float, n_dash);
+              float *dash = g_new (float, n_dash);
 
               for (int i = 0; i < n_dash; i++)
                 {
@@ -1258,12 +1364,14 @@ start_element_cb (GMarkupParseContext  *context,
                   if (end && *end != '\0')
                     {
                       set_attribute_error (error, "stroke-dasharray", stroke_dasharray_attr);
+                      g_free (dash);
                       g_strfreev (str);
                       goto cleanup;
                     }
                 }
 
               gsk_stroke_set_dash (stroke, dash, n_dash);
+              g_free (dash);
             }
 
           g_strfreev (str);
@@ -1281,23 +1389,14 @@ start_element_cb (GMarkupParseContext  *context,
           gsk_stroke_set_dash_offset (stroke, offset);
         }
 
-      if (opacity != 1)
-        gtk_snapshot_push_opacity (data->snapshot, opacity);
-
-      if (do_fill)
-        {
-          data->n_paths++;
-          gtk_snapshot_append_fill (data->snapshot, path, fill_rule, &fill_color);
-        }
-
-      if (do_stroke)
-        {
-          data->n_paths++;
-          gtk_snapshot_append_stroke (data->snapshot, path, stroke, &stroke_color);
-        }
-
-      if (opacity != 1)
-        gtk_snapshot_pop (data->snapshot);
+      if (do_fill || do_stroke)
+        symbolic_icon_add_path (data,
+                                path,
+                                opacity,
+                                fill_rule,
+                                do_fill ? &fill_color : NULL,
+                                do_stroke ? stroke : NULL,
+                                &stroke_color);
 
 cleanup:
       g_clear_pointer (&path, gsk_path_unref);
@@ -1310,25 +1409,57 @@ cleanup:
     }
 }
 
-static void
-end_element_cb (GMarkupParseContext *context,
-                const gchar         *element_name,
-                gpointer             user_data,
-                GError             **error)
+static gboolean
+symbolic_icon_parse (SymbolicIcon  *icon,
+                     GBytes        *bytes,
+                     GError       **error)
 {
-  ParserData *data = user_data;
+  GMarkupParseContext *context;
+  GMarkupParser parser = {
+    start_element_cb,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+  };
+  const char *text;
+  gsize len;
+  gboolean ret;
 
-  if (strcmp (element_name, "svg") == 0)
-    {
-      if (data->has_clip)
-        {
-          gtk_snapshot_pop (data->snapshot);
-          data->has_clip = FALSE;
-        }
-    }
+  text = g_bytes_get_data (bytes, &len);
+
+  context = g_markup_parse_context_new (&parser, G_MARKUP_PREFIX_ERROR_POSITION, icon, NULL);
+  ret = g_markup_parse_context_parse (context, text, len, error);
+  g_markup_parse_context_free (context);
+
+  return ret;
 }
 
 static GskRenderNode *
+symbolic_icon_free_to_node (SymbolicIcon *icon,
+                            gboolean     *only_fg,
+                            gboolean     *single_path,
+                            double       *width,
+                            double       *height)
+{
+  GskRenderNode *node;
+
+  if (only_fg)
+    *only_fg = icon->only_fg;
+
+  if (single_path)
+    *single_path = icon->n_paths == 1;
+
+  *width = icon->width;
+  *height = icon->height;
+
+  node = symbolic_icon_to_node (icon);
+  symbolic_icon_clear (icon);
+
+  return node;
+}
+
+GskRenderNode *
 gsk_render_node_new_from_bytes_symbolic (GBytes    *bytes,
                                          gboolean  *only_fg,
                                          gboolean  *single_path,
@@ -1336,56 +1467,618 @@ gsk_render_node_new_from_bytes_symbolic (GBytes    *bytes,
                                          double    *height,
                                          GError   **error)
 {
-  GMarkupParseContext *context;
-  GMarkupParser parser = {
-    start_element_cb,
-    end_element_cb,
-    NULL,
-    NULL,
-    NULL,
-  };
-  ParserData data;
-  const char *text;
-  gsize len;
-
-  data.width = data.height = 0;
-  data.only_fg = TRUE;
-  data.snapshot = gtk_snapshot_new ();
-  data.has_clip = FALSE;
-  data.n_paths = 0;
+  SymbolicIcon icon;
 
-  text = g_bytes_get_data (bytes, &len);
+  symbolic_icon_init (&icon);
 
-  context = g_markup_parse_context_new (&parser, G_MARKUP_PREFIX_ERROR_POSITION, &data, NULL);
-  if (!g_markup_parse_context_parse (context, text, len, error))
+  if (!symbolic_icon_parse (&icon, bytes, error))
     {
-      GskRenderNode *node;
+      symbolic_icon_clear (&icon);
+      return NULL;
+    }
 
-      g_markup_parse_context_free (context);
+  return symbolic_icon_free_to_node (&icon, only_fg, single_path, width, height);
+}
 
-      if (data.has_clip)
-        gtk_snapshot_pop (data.snapshot);
+/* }}} */
+/* {{{ Symbolic icon cache */
 
-      node = gtk_snapshot_free_to_node (data.snapshot);
-      g_clear_pointer (&node, gsk_render_node_unref);
+/* The symbolic icon cache keeps the parsed contents of symbolic
+ * svg files on disk, so that other processes (and later runs) can
+ * skip the svg parsing. There is one file per icon, named after a
+ * checksum of the icon filename. Entries are validated against the
+ * filename, mtime and size of the icon.
+ *
+ * The data is written in host byte order, and we refuse to load
+ * caches written by a machine with a different byte order.
+ */
+
+#define SYMBOLIC_CACHE_MAGIC "GtkSymbolicCache"
+#define SYMBOLIC_CACHE_VERSION 1
+#define SYMBOLIC_CACHE_BYTE_ORDER 0x01020304
+
+enum {
+  SYMBOLIC_PATH_FILL     = 1 << 0,
+  SYMBOLIC_PATH_STROKE   = 1 << 1,
+  SYMBOLIC_PATH_EVEN_ODD = 1 << 2,
+};
+
+enum {
+  SYMBOLIC_ICON_ONLY_FG  = 1 << 0,
+  SYMBOLIC_ICON_HAS_CLIP = 1 << 1,
+};
 
+static char *
+symbolic_cache_get_path (const char *filename,
+                         gboolean    create)
+{
+  char *checksum;
+  char *basename;
+  char *dir;
+  char *path;
+
+  dir = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "symbolic-icons", NULL);
+  if (create && g_mkdir_with_parents (dir, 0755) != 0)
+    {
+      g_free (dir);
       return NULL;
     }
 
-  g_markup_parse_context_free (context);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, filename, -1);
+  basename = g_strconcat (checksum, ".cache", NULL);
+  path = g_build_filename (dir, basename, NULL);
 
-  if (only_fg)
-    *only_fg = data.only_fg;
+  g_free (basename);
+  g_free (checksum);
+  g_free (dir);
 
-  if (single_path)
-    *single_path = data.n_paths == 1;
+  return path;
+}
+
+static void
+append_data (GByteArray    *array,
+             gconstpointer  data,
+             gsize          size)
+{
+  g_byte_array_append (array, data, size);
+}
+
+static void
+append_uint32 (GByteArray *array,
+               guint32     value)
+{
+  append_data (array, &value, sizeof (guint32));
+}
 
-  *width = data.width;
-  *height = data.height;
+static void
+append_float (GByteArray *array,
+              float       value)
+{
+  append_data (array, &value, sizeof (float));
+}
 
-  return gtk_snapshot_free_to_node (data.snapshot);
+static void
+append_rgba (GByteArray    *array,
+             const GdkRGBA *rgba)
+{
+  append_float (array, rgba->red);
+  append_float (array, rgba->green);
+  append_float (array, rgba->blue);
+  append_float (array, rgba->alpha);
+}
+
+typedef struct
+{
+  GByteArray *ops;
+  GArray *floats;
+} PathData;
+
+static inline void
+append_point (GArray                 *floats,
+              const graphene_point_t *pt)
+{
+  g_array_append_val (floats, pt->x);
+  g_array_append_val (floats, pt->y);
 }
 
+static gboolean
+collect_path_op (GskPathOperation        op,
+                 const graphene_point_t *pts,
+                 gsize                   n_pts,
+                 float                   weight,
+                 gpointer                user_data)
+{
+  PathData *data = user_data;
+  guint8 byte = op;
+
+  g_byte_array_append (data->ops, &byte, 1);
+
+  switch (op)
+    {
+    case GSK_PATH_MOVE:
+      append_point (data->floats, &pts[0]);
+      break;
+
+    case GSK_PATH_CLOSE:
+      break;
+
+    case GSK_PATH_LINE:
+      append_point (data->floats, &pts[1]);
+      break;
+
+    case GSK_PATH_QUAD:
+      append_point (data->floats, &pts[1]);
+      append_point (data->floats, &pts[2]);
+      break;
+
+    case GSK_PATH_CUBIC:
+      append_point (data->floats, &pts[1]);
+      append_point (data->floats, &pts[2]);
+      append_point (data->floats, &pts[3]);
+      break;
+
+    case GSK_PATH_CONIC:
+      append_point (data->floats, &pts[1]);
+      append_point (data->floats, &pts[2]);
+      g_array_append_val (data->floats, weight);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return TRUE;
+}
+
+static void
+append_path (GByteArray *array,
+             GskPath    *path)
+{
+  PathData data;
+
+  data.ops = g_byte_array_new ();
+  data.floats = g_array_new (FALSE, FALSE, sizeof (float));
+
+  gsk_path_foreach (path,
+                    GSK_PATH_FOREACH_ALLOW_QUAD |
+                    GSK_PATH_FOREACH_ALLOW_CUBIC |
+                    GSK_PATH_FOREACH_ALLOW_CONIC,
+                    collect_path_op,
+                    &data);
+
+  append_uint32 (array, data.ops->len);
+  append_uint32 (array, data.floats->len);
+  append_data (array, data.ops->data, data.ops->len);
+  append_data (array, data.floats->data, data.floats->len * sizeof (float));
+
+  g_byte_array_unref (data.ops);
+  g_array_unref (data.floats);
+}
+
+static void
+append_stroke (GByteArray      *array,
+               const GskStroke *stroke)
+{
+  const float *dash;
+  gsize n_dash;
+
+  append_float (array, gsk_stroke_get_line_width (stroke));
+  append_uint32 (array, gsk_stroke_get_line_cap (stroke));
+  append_uint32 (array, gsk_stroke_get_line_join (stroke));
+  append_float (array, gsk_stroke_get_miter_limit (stroke));
+  append_float (array, gsk_stroke_get_dash_offset (stroke));
+
+  dash = gsk_stroke_get_dash (stroke, &n_dash);
+  append_uint32 (array, n_dash);
+  append_data (array, dash, n_dash * sizeof (float));
+}
+
+static void
+symbolic_icon_save_cache (const SymbolicIcon *icon,
+                          const char         *filename,
+                          const GStatBuf     *st)
+{
+  GByteArray *array;
+  char *path;
+  guint32 flags;
+  gint64 mtime;
+  guint64 size;
+  double d;
+  GError *error = NULL;
+
+  path = symbolic_cache_get_path (filename, TRUE);
+  if (path == NULL)
+    return;
+
+  array = g_byte_array_new ();
+
+  append_data (array, SYMBOLIC_CACHE_MAGIC, strlen (SYMBOLIC_CACHE_MAGIC));
+  append_uint32 (array, SYMBOLIC_CACHE_VERSION);
+  append_uint32 (array, SYMBOLIC_CACHE_BYTE_ORDER);
+
+  mtime = st->st_mtime;
+  size = st->st_size;
+  append_data (array, &mtime, sizeof (gint64));
+  append_data (array, &size, sizeof (guint64));
+  append_uint32 (array, strlen (filename));
+  append_data (array, filename, strlen (filename));
+
+  d = icon->width;
+  append_data (array, &d, sizeof (double));
+  d = icon->height;
+  append_data (array, &d, sizeof (double));
+
+  flags = 0;
+  if (icon->only_fg)
+    flags |= SYMBOLIC_ICON_ONLY_FG;
+  if (icon->has_clip)
+    flags |= SYMBOLIC_ICON_HAS_CLIP;
+  append_uint32 (array, flags);
+  append_uint32 (array, icon->paths->len);
+
+  for (guint i = 0; i < icon->paths->len; i++)
+    {
+      const SymbolicPath *sp = &g_array_index (icon->paths, SymbolicPath, i);
+
+      flags = 0;
+      if (sp->do_fill)
+        flags |= SYMBOLIC_PATH_FILL;
+      if (sp->stroke)
+        flags |= SYMBOLIC_PATH_STROKE;
+      if (sp->fill_rule == GSK_FILL_RULE_EVEN_ODD)
+        flags |= SYMBOLIC_PATH_EVEN_ODD;
+
+      append_uint32 (array, flags);
+      append_float (array, sp->opacity);
+
+      if (sp->do_fill)
+        append_rgba (array, &sp->fill_color);
+
+      if (sp->stroke)
+        {
+          append_rgba (array, &sp->stroke_color);
+          append_stroke (array, sp->stroke);
+        }
+
+      append_path (array, sp->path);
+    }
+
+  if (!g_file_set_contents (path, (const char *) array->data, array->len, &error))
+    {
+      if (GTK_DEBUG_CHECK (ICONTHEME))
+        gdk_debug_message ("Failed to write symbolic icon cache %s: %s", path, error->message);
+      g_error_free (error);
+    }
+
+  g_byte_array_unref (array);
+  g_free (path);
+}
+
+typedef struct
+{
+  const guchar *data;
+  const guchar *end;
+} CacheReader;
+
+static gconstpointer
+read_data (CacheReader *reader,
+           gsize        size)
+{
+  gconstpointer result;
+
+  if ((gsize) (reader->end - reader->data) < size)
+    return NULL;
+
+  result = reader->data;
+  reader->data += size;
+
+  return result;
+}
+
+static gboolean
+read_uint32 (CacheReader *reader,
+             guint32     *value)
+{
+  gconstpointer data = read_data (reader, sizeof (guint32));
+
+  if (data == NULL)
+    return FALSE;
+
+  memcpy (value, data, sizeof (guint32));
+  return TRUE;
+}
+
+static gboolean
+read_float (CacheReader *reader,
+            float       *value)
+{
+  gconstpointer data = read_data (reader, sizeof (float));
+
+  if (data == NULL)
+    return FALSE;
+
+  memcpy (value, data, sizeof (float));
+  return TRUE;
+}
+
+static gboolean
+read_rgba (CacheReader *reader,
+           GdkRGBA     *rgba)
+{
+  return read_float (reader, &rgba->red) &&
+         read_float (reader, &rgba->green) &&
+         read_float (reader, &rgba->blue) &&
+         read_float (reader, &rgba->alpha);
+}
+
+static GskStroke *
+read_stroke (CacheReader *reader)
+{
+  GskStroke *stroke;
+  float line_width, miter_limit, dash_offset;
+  guint32 line_cap, line_join, n_dash;
+  gconstpointer dash_data;
+
+  if (!read_float (reader, &line_width) ||
+      !read_uint32 (reader, &line_cap) ||
+      !read_uint32 (reader, &line_join) ||
+      !read_float (reader, &miter_limit) ||
+      !read_float (reader, &dash_offset) ||
+      !read_uint32 (reader, &n_dash))
+    return NULL;
+
+  if (line_cap > GSK_LINE_CAP_SQUARE || line_join > GSK_LINE_JOIN_BEVEL)
+    return NULL;
+
+  if (n_dash > G_MAXUINT32 / sizeof (float))
+    return NULL;
+
+  dash_data = read_data (reader, n_dash * sizeof (float));
+  if (dash_data == NULL)
+    return NULL;
+
+  stroke = gsk_stroke_new (line_width);
+  gsk_stroke_set_line_cap (stroke, line_cap);
+  gsk_stroke_set_line_join (stroke, line_join);
+  gsk_stroke_set_miter_limit (stroke, miter_limit);
+  gsk_stroke_set_dash_offset (stroke, dash_offset);
+  if (n_dash > 0)
+    {
+      /* dash_data may not be aligned */
+      float *dash = g_memdup2 (dash_data, n_dash * sizeof (float));
+
+      gsk_stroke_set_dash (stroke, dash, n_dash);
+      g_free (dash);
+    }
+
+  return stroke;
+}
+
+static GskPath *
+read_path (CacheReader *reader)
+{
+  GskPathBuilder *builder;
+  const guint8 *ops;
+  const guchar *float_data;
+  guint32 n_ops, n_floats;
+  float f[5];
+  gsize pos;
+
+  if (!read_uint32 (reader, &n_ops) ||
+      !read_uint32 (reader, &n_floats) ||
+      n_floats > G_MAXUINT32 / sizeof (float))
+    return NULL;
+
+  ops = read_data (reader, n_ops);
+  float_data = read_data (reader, n_floats * sizeof (float));
+  if (ops == NULL || float_data == NULL)
+    return NULL;
+
+#define GET_FLOATS(n) \
+  G_STMT_START { \
+    if (pos + (n) > n_floats) \
+      goto fail; \
+    memcpy (f, float_data + pos * sizeof (float), (n) * sizeof (float)); \
+    pos += (n); \
+  } G_STMT_END
+
+  builder = gsk_path_builder_new ();
+  pos = 0;
+
+  for (guint32 i = 0; i < n_ops; i++)
+    {
+      switch (ops[i])
+        {
+        case GSK_PATH_MOVE:
+          GET_FLOATS (2);
+          gsk_path_builder_move_to (builder, f[0], f[1]);
+          break;
+
+        case GSK_PATH_CLOSE:
+          gsk_path_builder_close (builder);
+          break;
+
+        case GSK_PATH_LINE:
+          GET_FLOATS (2);
+          gsk_path_builder_line_to (builder, f[0], f[1]);
+          break;
+
+        case GSK_PATH_QUAD:
+          GET_FLOATS (4);
+          gsk_path_builder_quad_to (builder, f[0], f[1], f[2], f[3]);
+          break;
+
+        case GSK_PATH_CUBIC:
+          GET_FLOATS (6);
+          gsk_path_builder_cubic_to (builder, f[0], f[1], f[2], f[3], f[4], f[5]);
+          break;
+
+        case GSK_PATH_CONIC:
+          GET_FLOATS (5);
+          gsk_path_builder_conic_to (builder, f[0], f[1], f[2], f[3], f[4]);
+          break;
+
+        default:
+          goto fail;
+        }
+    }
+
+#undef GET_FLOATS
+
+  if (pos != n_floats)
+    goto fail;
+
+  return gsk_path_builder_free_to_path (builder);
+
+fail:
+  gsk_path_builder_unref (builder);
+  return NULL;
+}
+
+static gboolean
+symbolic_icon_read (SymbolicIcon   *icon,
+                    CacheReader    *reader,
+                    const char     *filename,
+                    const GStatBuf *st)
+{
+  gconstpointer data;
+  guint32 version, byte_order, filename_len, flags, n_records;
+  gint64 mtime;
+  guint64 size;
+  double width, height;
+
+  data = read_data (reader, strlen (SYMBOLIC_CACHE_MAGIC));
+  if (data == NULL || memcmp (data, SYMBOLIC_CACHE_MAGIC, strlen (SYMBOLIC_CACHE_MAGIC)) != 0)
+    return FALSE;
+
+  if (!read_uint32 (reader, &version) || version != SYMBOLIC_CACHE_VERSION ||
+      !read_uint32 (reader, &byte_order) || byte_order != SYMBOLIC_CACHE_BYTE_ORDER)
+    return FALSE;
+
+  data = read_data (reader, sizeof (gint64));
+  if (data == NULL)
+    return FALSE;
+  memcpy (&mtime, data, sizeof (gint64));
+
+  data = read_data (reader, sizeof (guint64));
+  if (data == NULL)
+    return FALSE;
+  memcpy (&size, data, sizeof (guint64));
+
+  if (mtime != (gint64) st->st_mtime || size != (guint64) st->st_size)
+    return FALSE;
+
+  if (!read_uint32 (reader, &filename_len) ||
+      filename_len != strlen (filename))
+    return FALSE;
+
+  data = read_data (reader, filename_len);
+  if (data == NULL || memcmp (data, filename, filename_len) != 0)
+    return FALSE;
+
+  data = read_data (reader, sizeof (double));
+  if (data == NULL)
+    return FALSE;
+  memcpy (&width, data, sizeof (double));
+
+  data = read_data (reader, sizeof (double));
+  if (data == NULL)
+    return FALSE;
+  memcpy (&height, data, sizeof (double));
+
+  if (!read_uint32 (reader, &flags) ||
+      !read_uint32 (reader, &n_records))
+    return FALSE;
+
+  icon->width = width;
+  icon->height = height;
+  icon->only_fg = (flags & SYMBOLIC_ICON_ONLY_FG) != 0;
+  icon->has_clip = (flags & SYMBOLIC_ICON_HAS_CLIP) != 0;
+
+  for (guint32 i = 0; i < n_records; i++)
+    {
+      GdkRGBA fill_color, stroke_color;
+      GskStroke *stroke = NULL;
+      GskPath *path;
+      float opacity;
+
+      if (!read_uint32 (reader, &flags) ||
+          !read_float (reader, &opacity))
+        return FALSE;
+
+      if ((flags & SYMBOLIC_PATH_FILL) && !read_rgba (reader, &fill_color))
+        return FALSE;
+
+      if (flags & SYMBOLIC_PATH_STROKE)
+        {
+          if (!read_rgba (reader, &stroke_color))
+            return FALSE;
+
+          stroke = read_stroke (reader);
+          if (stroke == NULL)
+            return FALSE;
+        }
+
+      path = read_path (reader);
+      if (path == NULL)
+        {
+          g_clear_pointer (&stroke, gsk_stroke_free);
+          return FALSE;
+        }
+
+      symbolic_icon_add_path (icon,
+                              path,
+                              opacity,
+                              flags & SYMBOLIC_PATH_EVEN_ODD ? GSK_FILL_RULE_EVEN_ODD
+                                                             : GSK_FILL_RULE_WINDING,
+                              flags & SYMBOLIC_PATH_FILL ? &fill_color : NULL,
+                              stroke,
+                              &stroke_color);
+
+      gsk_path_unref (path);
+      g_clear_pointer (&stroke, gsk_stroke_free);
+    }
+
+  return reader->data == reader->end;
+}
+
+static gboolean
+symbolic_icon_load_cache (SymbolicIcon   *icon,
+                          const char     *filename,
+                          const GStatBuf *st)
+{
+  GMappedFile *file;
+  CacheReader reader;
+  char *path;
+  gboolean ret;
+
+  path = symbolic_cache_get_path (filename, FALSE);
+  file = g_mapped_file_new (path, FALSE, NULL);
+  g_free (path);
+
+  if (file == NULL)
+    return FALSE;
+
+  reader.data = (const guchar *) g_mapped_file_get_contents (file);
+  reader.end = reader.data + g_mapped_file_get_length (file);
+
+  ret = symbolic_icon_read (icon, &reader, filename, st);
+  if (!ret)
+    {
+      /* Drop whatever we read before noticing the entry is stale
+       * or broken, the icon gets parsed from the svg next */
+      symbolic_icon_clear (icon);
+      symbolic_icon_init (icon);
+    }
+
+  g_mapped_file_unref (file);
+
+  return ret;
+}
+
+/* }}} */
+/* {{{ Symbolic render node API */
+
 GskRenderNode *
 gsk_render_node_new_from_resource_symbolic (const char *path,
                                             gboolean   *only_fg,
@@ -1426,26 +2119,43 @@ gsk_render_node_new_from_filename_symbolic (const char *filename,
   char *text;
   gsize len;
   GBytes *bytes;
-  GskRenderNode *node;
+  SymbolicIcon icon;
+  GStatBuf st;
+  gboolean have_stat;
   GError *error = NULL;
 
   if (!gdk_has_feature (GDK_FEATURE_ICON_NODES))
     return NULL;
 
+  have_stat = g_stat (filename, &st) == 0;
+
+  symbolic_icon_init (&icon);
+
+  if (have_stat && symbolic_icon_load_cache (&icon, filename, &st))
+    return symbolic_icon_free_to_node (&icon, only_fg, single_path, width, height);
+
   if (!g_file_get_contents (filename, &text, &len, NULL))
-    return NULL;
+    {
+      symbolic_icon_clear (&icon);
+      return NULL;
+    }
 
   bytes = g_bytes_new_take (text, len);
-  node = gsk_render_node_new_from_bytes_symbolic (bytes, only_fg, single_path, width, height, &error);
-  g_bytes_unref (bytes);
-  if (error)
+  if (!symbolic_icon_parse (&icon, bytes, &error))
     {
       if (GTK_DEBUG_CHECK (ICONTHEME))
         gdk_debug_message ("Failed to convert file %s to node: %s", filename, error->message);
       g_error_free (error);
+      g_bytes_unref (bytes);
+      symbolic_icon_clear (&icon);
+      return NULL;
     }
+  g_bytes_unref (bytes);
 
-  return node;
+  if (have_stat)
+    symbolic_icon_save_cache (&icon, filename, &st);
+
+  return symbolic_icon_free_to_node (&icon, only_fg, single_path, width, height);
 }
 
 /* }}} */
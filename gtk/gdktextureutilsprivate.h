@@ -71,6 +71,12 @@ GdkPaintable *gdk_paintable_new_from_resource_scaled (const char    *path,
 GdkPaintable *gdk_paintable_new_from_file_scaled     (GFile         *file,
                                                       double         scale);
 
+GskRenderNode *gsk_render_node_new_from_bytes_symbolic    (GBytes     *bytes,
+                                                           gboolean   *only_fg,
+                                                           gboolean   *single_path,
+                                                           double     *width,
+                                                           double     *height,
+                                                           GError    **error);
 GskRenderNode *gsk_render_node_new_from_resource_symbolic (const char *path,
                                                            gboolean   *only_fg,
                                                            gboolean   *single_path,
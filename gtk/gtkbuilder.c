@@ -444,6 +444,7 @@ typedef struct
   gboolean allow_template_parents;
   GObject *current_object;
   GtkBuilderScope *scope;
+  GtkBuilderTemplateCache *template_cache;
 } GtkBuilderPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkBuilder, gtk_builder, G_TYPE_OBJECT)
@@ -777,6 +778,14 @@ gtk_builder_get_parameters (GtkBuilder         *builder,
               continue;
             }
         }
+      else if (priv->template_cache &&
+               gtk_builder_template_cache_lookup_value (priv->template_cache,
+                                                        prop->pspec,
+                                                        prop->text->str,
+                                                        &property_value))
+        {
+          /* Parsed when an earlier instance of the template was built */
+        }
       else if (!gtk_builder_value_from_string (builder, prop->pspec,
                                                prop->text->str,
                                                &property_value,
@@ -790,6 +799,13 @@ gtk_builder_get_parameters (GtkBuilder         *builder,
           g_clear_error (&error);
           continue;
         }
+      else if (priv->template_cache)
+        {
+          gtk_builder_template_cache_add_value (priv->template_cache,
+                                                prop->pspec,
+                                                prop->text->str,
+                                                &property_value);
+        }
 
       /* At this point, property_value has been set, and we need to either
        * copy it to one of the two arrays, or unset it.
@@ -3047,6 +3063,13 @@ gtk_builder_get_type_from_name (GtkBuilder  *builder,
   g_return_val_if_fail (GTK_IS_BUILDER (builder), G_TYPE_INVALID);
   g_return_val_if_fail (type_name != NULL, G_TYPE_INVALID);
 
+  if (priv->template_cache)
+    {
+      type = gtk_builder_template_cache_lookup_type (priv->template_cache, type_name);
+      if (type != G_TYPE_INVALID)
+        return type;
+    }
+
   type = gtk_builder_scope_get_type_from_name (priv->scope, builder, type_name);
   if (type == G_TYPE_INVALID)
     return G_TYPE_INVALID;
@@ -3054,6 +3077,9 @@ gtk_builder_get_type_from_name (GtkBuilder  *builder,
   if (G_TYPE_IS_CLASSED (type))
     g_type_class_unref (g_type_class_ref (type));
 
+  if (priv->template_cache)
+    gtk_builder_template_cache_add_type (priv->template_cache, type_name, type);
+
   return type;
 }
 
@@ -3127,6 +3153,34 @@ gtk_builder_get_template_type (GtkBuilder *builder,
   return priv->template_type;
 }
 
+/*
+ * gtk_builder_set_template_cache:
+ * @builder: a `GtkBuilder`
+ * @cache: (nullable): the cache of the template being built
+ *
+ * Makes @builder reuse type, signal and property value lookups
+ * from previous instantiations of the same template.
+ *
+ * The cache must be used with the same scope every time and
+ * must outlive @builder.
+ */
+void
+gtk_builder_set_template_cache (GtkBuilder              *builder,
+                                GtkBuilderTemplateCache *cache)
+{
+  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
+
+  priv->template_cache = cache;
+}
+
+GtkBuilderTemplateCache *
+gtk_builder_get_template_cache (GtkBuilder *builder)
+{
+  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
+
+  return priv->template_cache;
+}
+
 /**
  * gtk_builder_create_closure:
  * @builder: a `GtkBuilder`
@@ -1507,6 +1507,7 @@ parse_signal (ParserData   *data,
   gboolean after = FALSE;
   gboolean swapped = -1;
   ObjectInfo *object_info;
+  GtkBuilderTemplateCache *template_cache;
   guint id = 0;
   GQuark detail = 0;
 
@@ -1532,15 +1533,23 @@ parse_signal (ParserData   *data,
       return;
     }
 
-  if (!g_signal_parse_name (name, object_info->type, &id, &detail, TRUE))
+  template_cache = gtk_builder_get_template_cache (data->builder);
+  if (template_cache == NULL ||
+      !gtk_builder_template_cache_lookup_signal (template_cache, object_info->type, name, &id, &detail))
     {
-      g_set_error (error,
-                   GTK_BUILDER_ERROR,
-                   GTK_BUILDER_ERROR_INVALID_SIGNAL,
-                   "Invalid signal '%s' for type '%s'",
-                   name, g_type_name (object_info->type));
-      _gtk_builder_prefix_error (data->builder, &data->ctx, error);
-      return;
+      if (!g_signal_parse_name (name, object_info->type, &id, &detail, TRUE))
+        {
+          g_set_error (error,
+                       GTK_BUILDER_ERROR,
+                       GTK_BUILDER_ERROR_INVALID_SIGNAL,
+                       "Invalid signal '%s' for type '%s'",
+                       name, g_type_name (object_info->type));
+          _gtk_builder_prefix_error (data->builder, &data->ctx, error);
+          return;
+        }
+
+      if (template_cache)
+        gtk_builder_template_cache_add_signal (template_cache, object_info->type, name, id, detail);
     }
 
   /* Swapped defaults to FALSE except when object is set */
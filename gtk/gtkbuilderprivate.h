@@ -276,6 +276,40 @@ GType     gtk_builder_get_template_type (GtkBuilder *builder,
 void      gtk_builder_set_allow_template_parents (GtkBuilder *builder,
                                                   gboolean    allow_parents);
 
+typedef struct _GtkBuilderTemplateCache GtkBuilderTemplateCache;
+
+GtkBuilderTemplateCache *
+          gtk_builder_template_cache_new           (void);
+void      gtk_builder_template_cache_free          (GtkBuilderTemplateCache *cache);
+GType     gtk_builder_template_cache_lookup_type   (GtkBuilderTemplateCache *cache,
+                                                    const char              *type_name);
+void      gtk_builder_template_cache_add_type      (GtkBuilderTemplateCache *cache,
+                                                    const char              *type_name,
+                                                    GType                    type);
+gboolean  gtk_builder_template_cache_lookup_signal (GtkBuilderTemplateCache *cache,
+                                                    GType                    type,
+                                                    const char              *signal_name,
+                                                    guint                   *signal_id,
+                                                    GQuark                  *detail);
+void      gtk_builder_template_cache_add_signal    (GtkBuilderTemplateCache *cache,
+                                                    GType                    type,
+                                                    const char              *signal_name,
+                                                    guint                    signal_id,
+                                                    GQuark                   detail);
+gboolean  gtk_builder_template_cache_lookup_value  (GtkBuilderTemplateCache *cache,
+                                                    GParamSpec              *pspec,
+                                                    const char              *string,
+                                                    GValue                  *value);
+void      gtk_builder_template_cache_add_value     (GtkBuilderTemplateCache *cache,
+                                                    GParamSpec              *pspec,
+                                                    const char              *string,
+                                                    const GValue            *value);
+
+void      gtk_builder_set_template_cache (GtkBuilder              *builder,
+                                          GtkBuilderTemplateCache *cache);
+GtkBuilderTemplateCache *
+          gtk_builder_get_template_cache (GtkBuilder              *builder);
+
 void     _gtk_builder_prefix_error        (GtkBuilder                *builder,
                                            GtkBuildableParseContext  *context,
                                            GError                   **error);
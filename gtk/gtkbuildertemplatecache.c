@@ -0,0 +1,284 @@
+/* gtkbuildertemplatecache.c
+ * Copyright (C) 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkbuilderprivate.h"
+
+#include <string.h>
+
+/* A GtkBuilderTemplateCache is attached to a widget class template and
+ * shared by all the builders that instantiate that template.
+ *
+ * The template is replayed from precompiled data for every instance, so
+ * the parser sees the same type names, signal names and property strings
+ * over and over. Everything here is the result of resolving one of those
+ * strings in a way that does not depend on the instance being built:
+ *
+ *  - type names resolved through the builder scope (which may involve
+ *    dlsym() lookups for lazily registered types)
+ *  - signal names parsed into signal ids and details
+ *  - constant property values parsed into GValues
+ *
+ * Objects, expressions, strings (which would just be copied again) and
+ * anything that is resolved relative to the builder are not cached.
+ */
+
+struct _GtkBuilderTemplateCache
+{
+  GHashTable *types;   /* char * -> GType */
+  GHashTable *signals; /* SignalKey -> SignalValue */
+  GHashTable *values;  /* ValueKey -> GValue */
+};
+
+typedef struct
+{
+  GType type;
+  char *name;
+} SignalKey;
+
+typedef struct
+{
+  guint id;
+  GQuark detail;
+} SignalValue;
+
+typedef struct
+{
+  GParamSpec *pspec;
+  char *string;
+} ValueKey;
+
+static guint
+signal_key_hash (gconstpointer data)
+{
+  const SignalKey *key = data;
+
+  return g_str_hash (key->name) ^ (guint) key->type;
+}
+
+static gboolean
+signal_key_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const SignalKey *ka = a;
+  const SignalKey *kb = b;
+
+  return ka->type == kb->type && strcmp (ka->name, kb->name) == 0;
+}
+
+static void
+signal_key_free (gpointer data)
+{
+  SignalKey *key = data;
+
+  g_free (key->name);
+  g_free (key);
+}
+
+static guint
+value_key_hash (gconstpointer data)
+{
+  const ValueKey *key = data;
+
+  return g_str_hash (key->string) ^ g_direct_hash (key->pspec);
+}
+
+static gboolean
+value_key_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  const ValueKey *ka = a;
+  const ValueKey *kb = b;
+
+  return ka->pspec == kb->pspec && strcmp (ka->string, kb->string) == 0;
+}
+
+static void
+value_key_free (gpointer data)
+{
+  ValueKey *key = data;
+
+  g_param_spec_unref (key->pspec);
+  g_free (key->string);
+  g_free (key);
+}
+
+static void
+cached_value_free (gpointer data)
+{
+  GValue *value = data;
+
+  g_value_unset (value);
+  g_free (value);
+}
+
+GtkBuilderTemplateCache *
+gtk_builder_template_cache_new (void)
+{
+  GtkBuilderTemplateCache *cache;
+
+  cache = g_new0 (GtkBuilderTemplateCache, 1);
+  cache->types = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  cache->signals = g_hash_table_new_full (signal_key_hash, signal_key_equal, signal_key_free, g_free);
+  cache->values = g_hash_table_new_full (value_key_hash, value_key_equal, value_key_free, cached_value_free);
+
+  return cache;
+}
+
+void
+gtk_builder_template_cache_free (GtkBuilderTemplateCache *cache)
+{
+  if (cache == NULL)
+    return;
+
+  g_hash_table_unref (cache->types);
+  g_hash_table_unref (cache->signals);
+  g_hash_table_unref (cache->values);
+  g_free (cache);
+}
+
+GType
+gtk_builder_template_cache_lookup_type (GtkBuilderTemplateCache *cache,
+                                        const char              *type_name)
+{
+  return (GType) GPOINTER_TO_SIZE (g_hash_table_lookup (cache->types, type_name));
+}
+
+void
+gtk_builder_template_cache_add_type (GtkBuilderTemplateCache *cache,
+                                     const char              *type_name,
+                                     GType                    type)
+{
+  g_hash_table_insert (cache->types, g_strdup (type_name), GSIZE_TO_POINTER (type));
+}
+
+gboolean
+gtk_builder_template_cache_lookup_signal (GtkBuilderTemplateCache *cache,
+                                          GType                    type,
+                                          const char              *signal_name,
+                                          guint                   *signal_id,
+                                          GQuark                  *detail)
+{
+  SignalKey key = { type, (char *) signal_name };
+  SignalValue *value;
+
+  value = g_hash_table_lookup (cache->signals, &key);
+  if (value == NULL)
+    return FALSE;
+
+  *signal_id = value->id;
+  *detail = value->detail;
+
+  return TRUE;
+}
+
+void
+gtk_builder_template_cache_add_signal (GtkBuilderTemplateCache *cache,
+                                       GType                    type,
+                                       const char              *signal_name,
+                                       guint                    signal_id,
+                                       GQuark                   detail)
+{
+  SignalKey *key;
+  SignalValue *value;
+
+  key = g_new (SignalKey, 1);
+  key->type = type;
+  key->name = g_strdup (signal_name);
+
+  value = g_new (SignalValue, 1);
+  value->id = signal_id;
+  value->detail = detail;
+
+  g_hash_table_insert (cache->signals, key, value);
+}
+
+static gboolean
+value_is_cacheable (GParamSpec *pspec)
+{
+  switch (G_TYPE_FUNDAMENTAL (G_PARAM_SPEC_VALUE_TYPE (pspec)))
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT:
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_VARIANT:
+    case G_TYPE_BOXED:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/* Returns TRUE and initializes @value with a copy of the cached value
+ * if @string has been parsed for @pspec before.
+ */
+gboolean
+gtk_builder_template_cache_lookup_value (GtkBuilderTemplateCache *cache,
+                                         GParamSpec              *pspec,
+                                         const char              *string,
+                                         GValue                  *value)
+{
+  ValueKey key = { pspec, (char *) string };
+  const GValue *cached;
+
+  if (!value_is_cacheable (pspec))
+    return FALSE;
+
+  cached = g_hash_table_lookup (cache->values, &key);
+  if (cached == NULL)
+    return FALSE;
+
+  g_value_init (value, G_VALUE_TYPE (cached));
+  g_value_copy (cached, value);
+
+  return TRUE;
+}
+
+void
+gtk_builder_template_cache_add_value (GtkBuilderTemplateCache *cache,
+                                      GParamSpec              *pspec,
+                                      const char              *string,
+                                      const GValue            *value)
+{
+  ValueKey *key;
+  GValue *cached;
+
+  if (!value_is_cacheable (pspec))
+    return;
+
+  key = g_new (ValueKey, 1);
+  key->pspec = g_param_spec_ref (pspec);
+  key->string = g_strdup (string);
+
+  cached = g_new0 (GValue, 1);
+  g_value_init (cached, G_VALUE_TYPE (value));
+  g_value_copy (value, cached);
+
+  g_hash_table_insert (cache->values, key, cached);
+}
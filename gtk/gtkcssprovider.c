@@ -99,6 +99,7 @@ struct _GtkCssProviderClass
 };
 
 typedef struct GtkCssRuleset GtkCssRuleset;
+typedef struct _GtkCssStylesheet GtkCssStylesheet;
 typedef struct _GtkCssScanner GtkCssScanner;
 typedef struct _PropertyValue PropertyValue;
 typedef enum ParserScope ParserScope;
@@ -120,6 +121,24 @@ struct GtkCssRuleset
   GHashTable *custom_properties;
 };
 
+/* Everything that is the result of parsing the CSS.
+ *
+ * A stylesheet is only modified while it is being loaded. After that,
+ * it is immutable, and providers that load the same theme can share it.
+ */
+struct _GtkCssStylesheet
+{
+  int ref_count;
+  char *key; /* set if the stylesheet is in the cache */
+
+  GHashTable *symbolic_colors;
+  GHashTable *keyframes;
+
+  GArray *rulesets;
+  GtkCssSelectorTree *tree;
+  GBytes *bytes; /* *no* reference */
+};
+
 struct _GtkCssScanner
 {
   GtkCssProvider *provider;
@@ -131,14 +150,10 @@ struct _GtkCssProviderPrivate
 {
   GScanner *scanner;
 
-  GHashTable *symbolic_colors;
-  GHashTable *keyframes;
-
-  GArray *rulesets;
-  GtkCssSelectorTree *tree;
+  GtkCssStylesheet *stylesheet;
   GResource *resource;
   char *path;
-  GBytes *bytes; /* *no* reference */
+  guint cacheable : 1;
 };
 
 enum {
@@ -293,6 +308,138 @@ gtk_css_ruleset_clear (GtkCssRuleset *ruleset)
   memset (ruleset, 0, sizeof (GtkCssRuleset));
 }
 
+static GtkCssStylesheet *
+gtk_css_stylesheet_new (void)
+{
+  GtkCssStylesheet *stylesheet;
+
+  stylesheet = g_new0 (GtkCssStylesheet, 1);
+  stylesheet->ref_count = 1;
+
+  stylesheet->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
+
+  stylesheet->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                       (GDestroyNotify) g_free,
+                                                       (GDestroyNotify) gtk_css_value_unref);
+  stylesheet->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 (GDestroyNotify) g_free,
+                                                 (GDestroyNotify) _gtk_css_keyframes_unref);
+
+  return stylesheet;
+}
+
+static GtkCssStylesheet *
+gtk_css_stylesheet_ref (GtkCssStylesheet *stylesheet)
+{
+  stylesheet->ref_count++;
+
+  return stylesheet;
+}
+
+static void
+gtk_css_stylesheet_unref (GtkCssStylesheet *stylesheet)
+{
+  guint i;
+
+  stylesheet->ref_count--;
+  if (stylesheet->ref_count > 0)
+    return;
+
+  for (i = 0; i < stylesheet->rulesets->len; i++)
+    gtk_css_ruleset_clear (&g_array_index (stylesheet->rulesets, GtkCssRuleset, i));
+
+  g_array_free (stylesheet->rulesets, TRUE);
+  _gtk_css_selector_tree_free (stylesheet->tree);
+
+  g_hash_table_destroy (stylesheet->symbolic_colors);
+  g_hash_table_destroy (stylesheet->keyframes);
+
+  g_free (stylesheet->key);
+  g_free (stylesheet);
+}
+
+/* Themes get loaded again and again: by every display, when switching
+ * between the light and dark variants and by the inspector. Parsing
+ * the Default theme and building its selector tree is expensive, so
+ * we keep the last few theme stylesheets around and hand them out
+ * to providers loading the same data.
+ *
+ * The cache only lives in memory and is not shared between processes,
+ * so it only helps with loading a theme again. The first load in every
+ * process still parses the theme in full.
+ *
+ * Entries are keyed by a checksum of the CSS and the file it was
+ * loaded from, since relative urls are resolved against that file.
+ */
+#define MAX_CACHED_STYLESHEETS 4
+
+static GQueue stylesheet_cache = G_QUEUE_INIT; /* most recently used first */
+static guint n_cache_hits;
+
+static char *
+gtk_css_stylesheet_compute_key (GFile  *file,
+                                GBytes *bytes)
+{
+  char *checksum, *uri, *key;
+
+  checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+  uri = g_file_get_uri (file);
+  key = g_strconcat (checksum, " ", uri, NULL);
+  g_free (checksum);
+  g_free (uri);
+
+  return key;
+}
+
+static GtkCssStylesheet *
+gtk_css_stylesheet_cache_lookup (const char *key)
+{
+  GList *l;
+
+  for (l = stylesheet_cache.head; l; l = l->next)
+    {
+      GtkCssStylesheet *stylesheet = l->data;
+
+      if (strcmp (stylesheet->key, key) == 0)
+        {
+          g_queue_unlink (&stylesheet_cache, l);
+          g_queue_push_head_link (&stylesheet_cache, l);
+          n_cache_hits++;
+
+          return gtk_css_stylesheet_ref (stylesheet);
+        }
+    }
+
+  return NULL;
+}
+
+/*<private>
+ * gtk_css_provider_get_n_cache_hits:
+ *
+ * Returns how often a provider reused a cached stylesheet
+ * instead of parsing its data. This is meant for tests.
+ *
+ * Returns: the number of cache hits
+ */
+guint
+gtk_css_provider_get_n_cache_hits (void)
+{
+  return n_cache_hits;
+}
+
+static void
+gtk_css_stylesheet_cache_insert (GtkCssStylesheet *stylesheet,
+                                 char             *key)
+{
+  g_assert (stylesheet->key == NULL);
+
+  stylesheet->key = key;
+  g_queue_push_head (&stylesheet_cache, gtk_css_stylesheet_ref (stylesheet));
+
+  while (stylesheet_cache.length > MAX_CACHED_STYLESHEETS)
+    gtk_css_stylesheet_unref (g_queue_pop_tail (&stylesheet_cache));
+}
+
 static void
 gtk_css_ruleset_add (GtkCssRuleset       *ruleset,
                      GtkCssStyleProperty *property,
@@ -378,6 +525,12 @@ gtk_css_style_provider_emit_error (GtkStyleProvider *provider,
                                    GtkCssSection    *section,
                                    const GError     *error)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (GTK_CSS_PROVIDER (provider));
+
+  /* Don't cache stylesheets with errors, or loading them
+   * again would not emit the errors */
+  priv->cacheable = FALSE;
+
   g_signal_emit (provider, css_provider_signals[PARSING_ERROR], 0, section, error);
 }
 
@@ -445,14 +598,7 @@ gtk_css_provider_init (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  priv->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
-
-  priv->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                 (GDestroyNotify) g_free,
-                                                 (GDestroyNotify) gtk_css_value_unref);
-  priv->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                           (GDestroyNotify) g_free,
-                                           (GDestroyNotify) _gtk_css_keyframes_unref);
+  priv->stylesheet = gtk_css_stylesheet_new ();
 }
 
 static void
@@ -466,11 +612,11 @@ verify_tree_match_results (GtkCssProvider        *provider,
   gboolean should_match;
   int i, j;
 
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       gboolean found = FALSE;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i);
 
       for (j = 0; j < gtk_css_selector_matches_get_size (tree_rules); j++)
 	{
@@ -499,7 +645,7 @@ gtk_css_style_provider_get_color (GtkStyleProvider *provider,
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  return g_hash_table_lookup (priv->symbolic_colors, name);
+  return g_hash_table_lookup (priv->stylesheet->symbolic_colors, name);
 }
 
 static GtkCssKeyframes *
@@ -509,7 +655,7 @@ gtk_css_style_provider_get_keyframes (GtkStyleProvider *provider,
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  return g_hash_table_lookup (priv->keyframes, name);
+  return g_hash_table_lookup (priv->stylesheet->keyframes, name);
 }
 
 static void
@@ -526,11 +672,11 @@ gtk_css_style_provider_lookup (GtkStyleProvider             *provider,
   int i;
   GtkCssSelectorMatches tree_rules;
 
-  if (_gtk_css_selector_tree_is_empty (priv->tree))
+  if (_gtk_css_selector_tree_is_empty (priv->stylesheet->tree))
     return;
 
   gtk_css_selector_matches_init (&tree_rules);
-  _gtk_css_selector_tree_match_all (priv->tree, filter, node, &tree_rules);
+  _gtk_css_selector_tree_match_all (priv->stylesheet->tree, filter, node, &tree_rules);
 
   if (!gtk_css_selector_matches_is_empty (&tree_rules))
     {
@@ -573,7 +719,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider             *provider,
   gtk_css_selector_matches_clear (&tree_rules);
 
   if (change)
-    *change = gtk_css_selector_tree_get_change_all (priv->tree, filter, node);
+    *change = gtk_css_selector_tree_get_change_all (priv->stylesheet->tree, filter, node);
 }
 
 static gboolean
@@ -583,7 +729,7 @@ gtk_css_style_provider_has_section (GtkStyleProvider *provider,
   GtkCssProvider *self = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
 
-  return priv->bytes == gtk_css_section_get_bytes (section);
+  return priv->stylesheet->bytes == gtk_css_section_get_bytes (section);
 }
 
 static void
@@ -601,16 +747,8 @@ gtk_css_provider_finalize (GObject *object)
 {
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (object);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
-  guint i;
-
-  for (i = 0; i < priv->rulesets->len; i++)
-    gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
 
-  g_array_free (priv->rulesets, TRUE);
-  _gtk_css_selector_tree_free (priv->tree);
-
-  g_hash_table_destroy (priv->symbolic_colors);
-  g_hash_table_destroy (priv->keyframes);
+  gtk_css_stylesheet_unref (priv->stylesheet);
 
   if (priv->resource)
     {
@@ -656,9 +794,9 @@ css_provider_commit (GtkCssProvider  *css_provider,
     {
       GtkCssRuleset *new;
 
-      g_array_set_size (priv->rulesets, priv->rulesets->len + 1);
+      g_array_set_size (priv->stylesheet->rulesets, priv->stylesheet->rulesets->len + 1);
 
-      new = &g_array_index (priv->rulesets, GtkCssRuleset, priv->rulesets->len - 1);
+      new = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, priv->stylesheet->rulesets->len - 1);
       gtk_css_ruleset_init_copy (new, ruleset, gtk_css_selectors_get (selectors, i));
     }
 }
@@ -667,7 +805,6 @@ static void
 gtk_css_provider_reset (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
-  guint i;
 
   if (priv->resource)
     {
@@ -682,14 +819,9 @@ gtk_css_provider_reset (GtkCssProvider *css_provider)
       priv->path = NULL;
     }
 
-  g_hash_table_remove_all (priv->symbolic_colors);
-  g_hash_table_remove_all (priv->keyframes);
-
-  for (i = 0; i < priv->rulesets->len; i++)
-    gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
-  g_array_set_size (priv->rulesets, 0);
-  _gtk_css_selector_tree_free (priv->tree);
-  priv->tree = NULL;
+  /* The stylesheet may be shared, so don't clear it, replace it */
+  gtk_css_stylesheet_unref (priv->stylesheet);
+  priv->stylesheet = gtk_css_stylesheet_new ();
 }
 
 static gboolean
@@ -793,7 +925,7 @@ parse_color_definition (GtkCssScanner *scanner)
       return TRUE;
     }
 
-  g_hash_table_insert (priv->symbolic_colors, name, color);
+  g_hash_table_insert (priv->stylesheet->symbolic_colors, name, color);
 
   return TRUE;
 }
@@ -822,7 +954,7 @@ parse_keyframes (GtkCssScanner *scanner)
 
   keyframes = _gtk_css_keyframes_parse (scanner->parser);
   if (keyframes != NULL)
-    g_hash_table_insert (priv->keyframes, name, keyframes);
+    g_hash_table_insert (priv->stylesheet->keyframes, name, keyframes);
 
   if (!gtk_css_parser_has_token (scanner->parser, GTK_CSS_TOKEN_EOF))
     gtk_css_parser_error_syntax (scanner->parser, "Expected '}' after declarations");
@@ -1168,14 +1300,14 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
 
   before = GDK_PROFILER_CURRENT_TIME;
 
-  g_array_sort (priv->rulesets, gtk_css_provider_compare_rule);
+  g_array_sort (priv->stylesheet->rulesets, gtk_css_provider_compare_rule);
 
   builder = _gtk_css_selector_tree_builder_new ();
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       GtkCssRuleset *ruleset;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i);
 
       _gtk_css_selector_tree_builder_add (builder,
 					  ruleset->selector,
@@ -1183,15 +1315,15 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
 					  ruleset);
     }
 
-  priv->tree = _gtk_css_selector_tree_builder_build (builder);
+  priv->stylesheet->tree = _gtk_css_selector_tree_builder_build (builder);
   _gtk_css_selector_tree_builder_free (builder);
 
 #ifndef VERIFY_TREE
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       GtkCssRuleset *ruleset;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i);
 
       _gtk_css_selector_free (ruleset->selector);
       ruleset->selector = NULL;
@@ -1208,10 +1340,20 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
                                 GBytes         *bytes)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
+  char *key = NULL;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
 
+  /* Resources don't change while we're running, but anything
+   * else we import might, and we only check the toplevel data */
+  if (parent == NULL)
+    priv->cacheable = file != NULL &&
+                      !gtk_keep_css_sections &&
+                      !GTK_DEBUG_CHECK (NO_CSS_CACHE);
+  else if (!g_file_has_uri_scheme (file, "resource"))
+    priv->cacheable = FALSE;
+
   if (bytes == NULL)
     {
       GError *load_error = NULL;
@@ -1242,12 +1384,28 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
         }
     }
 
-  priv->bytes = bytes;
+  if (bytes && parent == NULL && priv->cacheable)
+    {
+      GtkCssStylesheet *cached;
+
+      key = gtk_css_stylesheet_compute_key (file, bytes);
+      cached = gtk_css_stylesheet_cache_lookup (key);
+      if (cached)
+        {
+          gtk_css_stylesheet_unref (priv->stylesheet);
+          priv->stylesheet = cached;
+
+          g_clear_pointer (&key, g_free);
+          g_clear_pointer (&bytes, g_bytes_unref);
+        }
+    }
 
   if (bytes)
     {
       GtkCssScanner *scanner;
 
+      priv->stylesheet->bytes = bytes;
+
       scanner = gtk_css_scanner_new (self,
                                      parent,
                                      file,
@@ -1258,11 +1416,18 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
       gtk_css_scanner_destroy (scanner);
 
       if (parent == NULL)
-        gtk_css_provider_postprocess (self);
+        {
+          gtk_css_provider_postprocess (self);
+
+          if (key && priv->cacheable)
+            gtk_css_stylesheet_cache_insert (priv->stylesheet, g_steal_pointer (&key));
+        }
 
       g_bytes_unref (bytes);
     }
 
+  g_free (key);
+
   if (GDK_PROFILER_IS_RUNNING)
     {
       const char *uri G_GNUC_UNUSED;
@@ -1819,14 +1984,14 @@ gtk_css_provider_to_string (GtkCssProvider *provider)
 
   str = g_string_new ("");
 
-  gtk_css_provider_print_colors (priv->symbolic_colors, str);
-  gtk_css_provider_print_keyframes (priv->keyframes, str);
+  gtk_css_provider_print_colors (priv->stylesheet->symbolic_colors, str);
+  gtk_css_provider_print_keyframes (priv->stylesheet->keyframes, str);
 
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       if (str->len != 0)
         g_string_append (str, "\n");
-      gtk_css_ruleset_print (&g_array_index (priv->rulesets, GtkCssRuleset, i), str);
+      gtk_css_ruleset_print (&g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i), str);
     }
 
   return g_string_free (str, FALSE);
@@ -27,5 +27,7 @@ const char *_gtk_css_provider_get_theme_dir (GtkCssProvider *provider);
 
 void   gtk_css_provider_set_keep_css_sections (void);
 
+guint  gtk_css_provider_get_n_cache_hits      (void);
+
 G_END_DECLS
 
@@ -48,11 +48,30 @@
  * This means you do not need access to the `GtkDirectoryList`, but can access
  * the `GFile` directly from the `GFileInfo` when operating with a `GtkListView`
  * or similar.
+ *
+ * Querying expensive attributes like thumbnails or content types for every
+ * file can make large directories slow to appear. If
+ * [property@Gtk.DirectoryList:lazy] is set, the enumeration only queries
+ * the name and type of files, and the requested attributes are queried later,
+ * for the items that are actually retrieved from the model. Items are replaced
+ * with a new `GFileInfo` once their attributes have been loaded.
  */
 
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
 
+/* Attributes queried in lazy mode while enumerating */
+#define LAZY_ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE
+
+/* Number of attribute queries we run in parallel in lazy mode */
+#define MAX_ATTRIBUTE_QUERIES 8
+
+/* Number of items waiting for their attributes in lazy mode.
+ * When more items are requested, we forget the oldest ones,
+ * they have most likely been scrolled out of view already.
+ */
+#define MAX_QUEUED_ITEMS 256
+
 enum {
   PROP_0,
   PROP_ATTRIBUTES,
@@ -60,6 +79,7 @@ enum {
   PROP_FILE,
   PROP_IO_PRIORITY,
   PROP_ITEM_TYPE,
+  PROP_LAZY,
   PROP_LOADING,
   PROP_MONITORED,
   PROP_N_ITEMS,
@@ -86,6 +106,24 @@ free_queued_event (gpointer data)
   g_free (event);
 }
 
+/* An item in lazy mode whose attributes have not been loaded yet */
+typedef struct _LazyItem LazyItem;
+struct _LazyItem
+{
+  GSequenceIter *iter;
+  GQueue *queue; /* the list's lazy_queue */
+  GList queue_link;
+  gboolean queued;
+  gboolean in_flight; /* a query for this item is running */
+};
+
+typedef struct _AttributeQuery AttributeQuery;
+struct _AttributeQuery
+{
+  GtkDirectoryList *list;
+  GFileInfo *info;
+};
+
 struct _GtkDirectoryList
 {
   GObject parent_instance;
@@ -95,11 +133,19 @@ struct _GtkDirectoryList
   GFileMonitor *monitor;
   gboolean monitored;
   int io_priority;
+  gboolean lazy;
 
   GCancellable *cancellable;
   GError *error; /* Error while loading */
   GSequence *items; /* Use GPtrArray or GListStore here? */
   GQueue events;
+
+  /* lazy mode */
+  GHashTable *lazy_items; /* GFileInfo => LazyItem */
+  GQueue lazy_queue; /* of GFileInfo, most recently requested first */
+  char *lazy_attributes; /* attributes queried for each item */
+  GCancellable *attributes_cancellable;
+  guint n_attribute_queries;
 };
 
 struct _GtkDirectoryListClass
@@ -109,6 +155,9 @@ struct _GtkDirectoryListClass
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+static void gtk_directory_list_queue_attributes (GtkDirectoryList *self,
+                                                 GFileInfo        *info);
+
 static GType
 gtk_directory_list_get_item_type (GListModel *list)
 {
@@ -130,12 +179,18 @@ gtk_directory_list_get_item (GListModel *list,
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (list);
   GSequenceIter *iter;
 
+  GFileInfo *info;
+
   iter = g_sequence_get_iter_at_pos (self->items, position);
 
   if (g_sequence_iter_is_end (iter))
     return NULL;
-  else
-    return g_object_ref (g_sequence_get (iter));
+
+  info = g_sequence_get (iter);
+  if (self->lazy_items)
+    gtk_directory_list_queue_attributes (self, info);
+
+  return g_object_ref (info);
 }
 
 static void
@@ -170,6 +225,10 @@ gtk_directory_list_set_property (GObject      *object,
       gtk_directory_list_set_io_priority (self, g_value_get_int (value));
       break;
 
+    case PROP_LAZY:
+      gtk_directory_list_set_lazy (self, g_value_get_boolean (value));
+      break;
+
     case PROP_MONITORED:
       gtk_directory_list_set_monitored (self, g_value_get_boolean (value));
       break;
@@ -210,6 +269,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_gtype (value, G_TYPE_FILE_INFO);
       break;
 
+    case PROP_LAZY:
+      g_value_set_boolean (value, self->lazy);
+      break;
+
     case PROP_LOADING:
       g_value_set_boolean (value, gtk_directory_list_is_loading (self));
       break;
@@ -239,6 +302,22 @@ gtk_directory_list_stop_loading (GtkDirectoryList *self)
   return TRUE;
 }
 
+static void
+gtk_directory_list_stop_loading_attributes (GtkDirectoryList *self)
+{
+  if (self->attributes_cancellable)
+    {
+      g_cancellable_cancel (self->attributes_cancellable);
+      g_clear_object (&self->attributes_cancellable);
+    }
+
+  self->n_attribute_queries = 0;
+  /* Freeing the items unlinks them from the queue */
+  g_clear_pointer (&self->lazy_items, g_hash_table_unref);
+  g_queue_init (&self->lazy_queue);
+  g_clear_pointer (&self->lazy_attributes, g_free);
+}
+
 static void directory_changed (GFileMonitor       *monitor,
                                GFile              *file,
                                GFile              *other_file,
@@ -259,6 +338,7 @@ gtk_directory_list_dispose (GObject *object)
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (object);
 
   gtk_directory_list_stop_loading (self);
+  gtk_directory_list_stop_loading_attributes (self);
   gtk_directory_list_stop_monitoring (self);
 
   g_clear_object (&self->file);
@@ -334,6 +414,20 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                         G_TYPE_FILE_INFO,
                         G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkDirectoryList:lazy:
+   *
+   * Whether to query attributes lazily.
+   *
+   * See [method@Gtk.DirectoryList.set_lazy].
+   *
+   * Since: 4.20
+   */
+  properties[PROP_LAZY] =
+      g_param_spec_boolean ("lazy", NULL, NULL,
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkDirectoryList:loading: (getter is_loading)
    *
@@ -402,11 +496,168 @@ gtk_directory_list_new (const char *attributes,
                        NULL);
 }
 
+static void
+lazy_item_free (gpointer data)
+{
+  LazyItem *item = data;
+
+  if (item->queued)
+    g_queue_unlink (item->queue, &item->queue_link);
+
+  g_free (item);
+}
+
+static void
+gtk_directory_list_add_lazy_item (GtkDirectoryList *self,
+                                  GSequenceIter    *iter)
+{
+  LazyItem *item;
+
+  item = g_new0 (LazyItem, 1);
+  item->iter = iter;
+  item->queue = &self->lazy_queue;
+  item->queue_link.data = g_sequence_get (iter);
+
+  g_hash_table_insert (self->lazy_items, g_sequence_get (iter), item);
+}
+
+/* Must be called before the info is removed from self->items */
+static void
+gtk_directory_list_remove_lazy_item (GtkDirectoryList *self,
+                                     GFileInfo        *info)
+{
+  if (self->lazy_items == NULL)
+    return;
+
+  g_hash_table_remove (self->lazy_items, info);
+}
+
+static void gtk_directory_list_run_attribute_queries (GtkDirectoryList *self);
+
+static void
+gtk_directory_list_got_attributes_cb (GObject      *source,
+                                      GAsyncResult *res,
+                                      gpointer      data)
+{
+  AttributeQuery *query = data;
+  GtkDirectoryList *self = query->list; /* invalid if cancelled */
+  GFile *file = G_FILE (source);
+  GFileInfo *info;
+  GError *error = NULL;
+  LazyItem *item;
+
+  info = g_file_query_info_finish (file, res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_clear_error (&error);
+      goto out;
+    }
+
+  self->n_attribute_queries--;
+
+  /* The item may have been removed or replaced while we were waiting */
+  item = g_hash_table_lookup (self->lazy_items, query->info);
+  if (item != NULL)
+    {
+      GSequenceIter *iter = item->iter;
+
+      g_hash_table_remove (self->lazy_items, query->info);
+
+      /* If the query failed, we keep the item with only name and type */
+      if (info)
+        {
+          unsigned int position;
+
+          g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
+
+          position = g_sequence_iter_get_position (iter);
+          g_sequence_set (iter, g_object_ref (info));
+          g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
+        }
+    }
+
+  g_clear_error (&error);
+
+  gtk_directory_list_run_attribute_queries (self);
+
+out:
+  g_clear_object (&info);
+  g_object_unref (query->info);
+  g_free (query);
+}
+
+static void
+gtk_directory_list_run_attribute_queries (GtkDirectoryList *self)
+{
+  while (self->n_attribute_queries < MAX_ATTRIBUTE_QUERIES &&
+         !g_queue_is_empty (&self->lazy_queue))
+    {
+      AttributeQuery *query;
+      GFileInfo *info;
+      LazyItem *item;
+      GFile *file;
+
+      info = g_queue_peek_head (&self->lazy_queue);
+      item = g_hash_table_lookup (self->lazy_items, info);
+      g_queue_unlink (&self->lazy_queue, &item->queue_link);
+      item->queued = FALSE;
+      item->in_flight = TRUE;
+
+      query = g_new (AttributeQuery, 1);
+      query->list = self;
+      query->info = g_object_ref (info);
+
+      file = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+
+      g_file_query_info_async (file,
+                               self->lazy_attributes,
+                               G_FILE_QUERY_INFO_NONE,
+                               self->io_priority,
+                               self->attributes_cancellable,
+                               gtk_directory_list_got_attributes_cb,
+                               query);
+      self->n_attribute_queries++;
+    }
+}
+
+/* Called when an item is retrieved from the model. We load
+ * attributes for the most recently requested items first, as
+ * those are the ones most likely to be visible.
+ */
+static void
+gtk_directory_list_queue_attributes (GtkDirectoryList *self,
+                                     GFileInfo        *info)
+{
+  LazyItem *item;
+
+  item = g_hash_table_lookup (self->lazy_items, info);
+  if (item == NULL || item->in_flight)
+    return;
+
+  if (item->queued)
+    g_queue_unlink (&self->lazy_queue, &item->queue_link);
+
+  g_queue_push_head_link (&self->lazy_queue, &item->queue_link);
+  item->queued = TRUE;
+
+  if (g_queue_get_length (&self->lazy_queue) > MAX_QUEUED_ITEMS)
+    {
+      GList *oldest = g_queue_pop_tail_link (&self->lazy_queue);
+
+      item = g_hash_table_lookup (self->lazy_items, oldest->data);
+      item->queued = FALSE;
+    }
+
+  gtk_directory_list_run_attribute_queries (self);
+}
+
 static void
 gtk_directory_list_clear_items (GtkDirectoryList *self)
 {
   guint n_items;
 
+  gtk_directory_list_stop_loading_attributes (self);
+
   n_items = g_sequence_get_length (self->items);
   if (n_items > 0)
     {
@@ -479,12 +730,15 @@ gtk_directory_list_got_files_cb (GObject      *source,
     {
       GFileInfo *info;
       GFile *file;
+      GSequenceIter *iter;
 
       info = l->data;
       file = g_file_enumerator_get_child (enumerator, info);
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
       g_object_unref (file);
-      g_sequence_append (self->items, info);
+      iter = g_sequence_append (self->items, info);
+      if (self->lazy_items)
+        gtk_directory_list_add_lazy_item (self, iter);
       n++;
     }
   g_list_free (files);
@@ -556,7 +810,20 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
       return;
     }
 
-  glib_apis_suck = g_strconcat ("standard::name,", self->attributes, NULL);
+  /* In lazy mode, we only get names and types now and query
+   * everything else when items are requested
+   */
+  if (self->lazy && self->attributes)
+    {
+      glib_apis_suck = g_strdup (LAZY_ATTRIBUTES);
+      self->lazy_items = g_hash_table_new_full (NULL, NULL, NULL, lazy_item_free);
+      /* The new info replaces the item, so it needs name and type too */
+      self->lazy_attributes = g_strconcat (LAZY_ATTRIBUTES ",", self->attributes, NULL);
+      self->attributes_cancellable = g_cancellable_new ();
+    }
+  else
+    glib_apis_suck = g_strconcat ("standard::name,", self->attributes, NULL);
+
   self->cancellable = g_cancellable_new ();
   g_file_enumerate_children_async (self->file,
                                    glib_apis_suck,
@@ -613,6 +880,7 @@ handle_event (QueuedEvent *event)
       if (iter)
         {
           position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_remove_lazy_item (self, g_sequence_get (iter));
           g_sequence_set (iter, g_object_ref (info));
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
         }
@@ -631,6 +899,7 @@ handle_event (QueuedEvent *event)
       if (iter)
         {
           position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_remove_lazy_item (self, g_sequence_get (iter));
           g_sequence_remove (iter);
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
           g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
@@ -647,6 +916,7 @@ handle_event (QueuedEvent *event)
       if (iter)
         {
           position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_remove_lazy_item (self, g_sequence_get (iter));
           g_sequence_set (iter, g_object_ref (info));
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
         }
@@ -950,6 +1220,70 @@ gtk_directory_list_get_io_priority (GtkDirectoryList *self)
   return self->io_priority;
 }
 
+/**
+ * gtk_directory_list_set_lazy:
+ * @self: a `GtkDirectoryList`
+ * @lazy: %TRUE to query attributes lazily
+ *
+ * Sets whether attributes are queried lazily.
+ *
+ * By default, all [property@Gtk.DirectoryList:attributes] are queried
+ * for every file while the directory is enumerated, and files are only
+ * added once that is done.
+ *
+ * If @lazy is %TRUE, only the name and the type of files are queried
+ * during enumeration, so that files appear quickly. The other attributes
+ * are queried in the background for the items that are retrieved from
+ * the list, with the most recently retrieved items being loaded first.
+ * Once the attributes of an item have been loaded, it is replaced with
+ * a new `GFileInfo` containing them, and the ::items-changed signal is
+ * emitted.
+ *
+ * This is useful for large directories shown in a `GtkListView` or
+ * `GtkGridView`, which only retrieve the items they display.
+ *
+ * Changing this property restarts the enumeration.
+ *
+ * Since: 4.20
+ */
+void
+gtk_directory_list_set_lazy (GtkDirectoryList *self,
+                             gboolean          lazy)
+{
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (self->lazy == lazy)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  self->lazy = lazy;
+
+  gtk_directory_list_start_loading (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LAZY]);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * gtk_directory_list_get_lazy:
+ * @self: a `GtkDirectoryList`
+ *
+ * Returns whether attributes are queried lazily.
+ *
+ * Returns: %TRUE if attributes are queried lazily
+ *
+ * Since: 4.20
+ */
+gboolean
+gtk_directory_list_get_lazy (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), FALSE);
+
+  return self->lazy;
+}
+
 /**
  * gtk_directory_list_is_loading: (get-property loading)
  * @self: a `GtkDirectoryList`
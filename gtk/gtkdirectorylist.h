@@ -56,6 +56,12 @@ void                    gtk_directory_list_set_io_priority      (GtkDirectoryLis
 GDK_AVAILABLE_IN_ALL
 int                     gtk_directory_list_get_io_priority      (GtkDirectoryList       *self);
 
+GDK_AVAILABLE_IN_4_20
+void                    gtk_directory_list_set_lazy             (GtkDirectoryList       *self,
+                                                                 gboolean                lazy);
+GDK_AVAILABLE_IN_4_20
+gboolean                gtk_directory_list_get_lazy             (GtkDirectoryList       *self);
+
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_directory_list_is_loading           (GtkDirectoryList       *self);
 GDK_AVAILABLE_IN_ALL
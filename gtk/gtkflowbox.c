@@ -150,6 +150,8 @@ static void gtk_flow_box_set_accept_unpaired_release (GtkFlowBox *box,
 
 static void gtk_flow_box_check_model_compat  (GtkFlowBox *box);
 
+static void gtk_flow_box_child_invalidate_lines (GtkFlowBoxChild *child);
+
 static void
 path_from_horizontal_line_rects (cairo_t      *cr,
                                  GdkRectangle *lines,
@@ -515,6 +517,22 @@ gtk_flow_box_child_root (GtkWidget *widget)
 
 /* GObject implementation {{{2 */
 
+static void
+gtk_flow_box_child_show (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (gtk_flow_box_child_parent_class)->show (widget);
+
+  gtk_flow_box_child_invalidate_lines (GTK_FLOW_BOX_CHILD (widget));
+}
+
+static void
+gtk_flow_box_child_hide (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (gtk_flow_box_child_parent_class)->hide (widget);
+
+  gtk_flow_box_child_invalidate_lines (GTK_FLOW_BOX_CHILD (widget));
+}
+
 static void
 gtk_flow_box_child_class_init (GtkFlowBoxChildClass *class)
 {
@@ -528,6 +546,8 @@ gtk_flow_box_child_class_init (GtkFlowBoxChildClass *class)
   widget_class->root = gtk_flow_box_child_root;
   widget_class->compute_expand = gtk_flow_box_child_compute_expand;
   widget_class->focus = gtk_flow_box_child_focus;
+  widget_class->show = gtk_flow_box_child_show;
+  widget_class->hide = gtk_flow_box_child_hide;
 
   class->activate = gtk_flow_box_child_activate;
 
@@ -571,10 +591,17 @@ gtk_flow_box_child_class_init (GtkFlowBoxChildClass *class)
   gtk_widget_class_set_activate_signal (widget_class, child_signals[CHILD_ACTIVATE]);
 }
 
+static void
+gtk_flow_box_child_resize_func (GtkWidget *widget)
+{
+  gtk_flow_box_child_invalidate_lines (GTK_FLOW_BOX_CHILD (widget));
+}
+
 static void
 gtk_flow_box_child_init (GtkFlowBoxChild *child)
 {
   gtk_widget_set_focusable (GTK_WIDGET (child), TRUE);
+  GTK_WIDGET (child)->priv->resize_func = gtk_flow_box_child_resize_func;
 }
 
 /* Public API {{{2 */
@@ -786,6 +813,28 @@ struct _GtkFlowBoxClass
   void (*unselect_all)               (GtkFlowBox        *box);
 };
 
+/* Line sizes of earlier layouts, see gtk_flow_box_get_line_sizes() */
+#define N_LINE_CACHES 2
+
+typedef struct
+{
+  GtkRequestedSize size;
+  int end;        /* position after the last child of the line */
+  int n_children; /* visible children on the line */
+} LineInfo;
+
+typedef struct
+{
+  GtkOrientation orientation;
+  GtkAlign align;
+  int line_length;
+  int extra_pixels;
+  int *item_sizes;
+  GArray *lines;   /* LineInfo */
+  int first_dirty; /* position of the first child that changed since */
+  guint64 last_used;
+} LineCache;
+
 typedef struct _GtkFlowBoxPrivate GtkFlowBoxPrivate;
 struct _GtkFlowBoxPrivate {
   GtkOrientation    orientation;
@@ -838,6 +887,9 @@ struct _GtkFlowBoxPrivate {
   GDestroyNotify              create_widget_func_data_destroy;
 
   gboolean           disable_move_cursor;
+
+  LineCache          line_caches[N_LINE_CACHES];
+  guint64            line_cache_stamp;
 };
 
 #define BOX_PRIV(box) ((GtkFlowBoxPrivate*)gtk_flow_box_get_instance_private ((GtkFlowBox*)(box)))
@@ -903,6 +955,9 @@ gtk_flow_box_apply_filter (GtkFlowBox      *box,
   if (priv->filter_func != NULL)
     do_show = priv->filter_func (child, priv->filter_data);
 
+  if (do_show != gtk_widget_get_child_visible (GTK_WIDGET (child)))
+    gtk_flow_box_child_invalidate_lines (child);
+
   gtk_widget_set_child_visible (GTK_WIDGET (child), do_show);
 }
 
@@ -929,8 +984,10 @@ gtk_flow_box_apply_sort (GtkFlowBox      *box,
 {
   if (BOX_PRIV (box)->sort_func != NULL)
     {
+      gtk_flow_box_child_invalidate_lines (child);
       g_sequence_sort_changed (CHILD_PRIV (child)->iter,
                                (GCompareDataFunc)gtk_flow_box_sort, box);
+      gtk_flow_box_child_invalidate_lines (child);
       gtk_widget_queue_resize (GTK_WIDGET (box));
     }
 }
@@ -1346,65 +1403,234 @@ get_largest_size_for_opposing_orientation (GtkFlowBox     *box,
     *nat_item_size = max_nat_size;
 }
 
-/* Gets the largest minimum/natural size on a single line for a given size
- * (used to get the largest line heights for a fixed item width and the opposite
- * while iterating over a list of children, note the new index is returned)
+/* Lines are measured by asking every child on them for its size for
+ * the item size, which is what makes layout expensive for boxes with
+ * many children. So we keep the line sizes of earlier layouts, with
+ * the position where each line ends, and only measure the lines from
+ * the first child that changed since.
+ *
+ * Measuring and allocating usually use different item sizes, so the
+ * sizes for a few item sizes are kept.
  */
-static GSequenceIter *
-get_largest_size_for_line_in_opposing_orientation (GtkFlowBox       *box,
-                                                   GtkOrientation    orientation,
-                                                   GSequenceIter    *cursor,
-                                                   int               line_length,
-                                                   GtkRequestedSize *item_sizes,
-                                                   int               extra_pixels,
-                                                   int              *min_item_size,
-                                                   int              *nat_item_size)
+
+static void
+line_cache_clear (LineCache *cache)
 {
-  GSequenceIter *iter;
-  int max_min_size = 0;
-  int max_nat_size = 0;
+  g_clear_pointer (&cache->lines, g_array_unref);
+  g_clear_pointer (&cache->item_sizes, g_free);
+}
+
+static void
+gtk_flow_box_clear_line_caches (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
   int i;
 
-  i = 0;
-  for (iter = cursor;
-       !g_sequence_iter_is_end (iter) && i < line_length;
-       iter = g_sequence_iter_next (iter))
+  for (i = 0; i < N_LINE_CACHES; i++)
+    line_cache_clear (&priv->line_caches[i]);
+}
+
+/* Call this when the child at @position changed in a way that
+ * can change the size of its line, including being added, removed
+ * or moved there. All lines from that child on are measured again.
+ */
+static void
+gtk_flow_box_invalidate_lines (GtkFlowBox *box,
+                               int         position)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  int i;
+
+  for (i = 0; i < N_LINE_CACHES; i++)
+    priv->line_caches[i].first_dirty = MIN (priv->line_caches[i].first_dirty, position);
+}
+
+static void
+gtk_flow_box_child_invalidate_lines (GtkFlowBoxChild *child)
+{
+  GSequenceIter *iter = CHILD_PRIV (child)->iter;
+  GtkFlowBox *box;
+
+  box = gtk_flow_box_child_get_box (child);
+  if (box == NULL || iter == NULL)
+    return;
+
+  gtk_flow_box_invalidate_lines (box, g_sequence_iter_get_position (iter));
+}
+
+static gboolean
+line_cache_matches (LineCache        *cache,
+                    GtkOrientation    orientation,
+                    GtkAlign          align,
+                    int               line_length,
+                    GtkRequestedSize *item_sizes,
+                    int               extra_pixels)
+{
+  int i;
+
+  if (cache->lines == NULL ||
+      cache->orientation != orientation ||
+      cache->align != align ||
+      cache->line_length != line_length ||
+      cache->extra_pixels != extra_pixels)
+    return FALSE;
+
+  for (i = 0; i < line_length; i++)
     {
-      GtkWidget *child;
-      int child_min, child_nat, this_item_size;
+      if (cache->item_sizes[i] != item_sizes[i].minimum_size)
+        return FALSE;
+    }
 
-      child = g_sequence_get (iter);
+  return TRUE;
+}
 
-      if (!child_is_visible (child))
-        continue;
+static LineCache *
+gtk_flow_box_lookup_line_cache (GtkFlowBox       *box,
+                                GtkOrientation    orientation,
+                                int               line_length,
+                                GtkRequestedSize *item_sizes,
+                                int               extra_pixels)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkAlign align = ORIENTATION_ALIGN (box);
+  LineCache *cache = NULL;
+  int i;
 
-      /* Distribute the extra pixels to the first children in the line
-       * (could be fancier and spread them out more evenly) */
-      this_item_size = item_sizes[i].minimum_size;
-      if (extra_pixels > 0 && ORIENTATION_ALIGN (box) == GTK_ALIGN_FILL)
+  for (i = 0; i < N_LINE_CACHES; i++)
+    {
+      if (line_cache_matches (&priv->line_caches[i], orientation, align, line_length, item_sizes, extra_pixels))
         {
-          this_item_size++;
-          extra_pixels--;
+          cache = &priv->line_caches[i];
+          break;
         }
+    }
 
-      gtk_widget_measure (child, 1 - orientation, this_item_size,
-                          &child_min, &child_nat,
-                          NULL, NULL);
+  if (cache == NULL)
+    {
+      /* Replace the one that was used least recently */
+      cache = &priv->line_caches[0];
+      for (i = 1; i < N_LINE_CACHES; i++)
+        {
+          if (priv->line_caches[i].last_used < cache->last_used)
+            cache = &priv->line_caches[i];
+        }
 
-      max_min_size = MAX (max_min_size, child_min);
-      max_nat_size = MAX (max_nat_size, child_nat);
+      line_cache_clear (cache);
+      cache->orientation = orientation;
+      cache->align = align;
+      cache->line_length = line_length;
+      cache->extra_pixels = extra_pixels;
+      cache->item_sizes = g_new (int, line_length);
+      for (i = 0; i < line_length; i++)
+        cache->item_sizes[i] = item_sizes[i].minimum_size;
+      cache->lines = g_array_new (FALSE, FALSE, sizeof (LineInfo));
+      cache->first_dirty = 0;
+    }
 
-      i++;
+  cache->last_used = ++priv->line_cache_stamp;
+
+  return cache;
+}
+
+/* Returns the number of lines at the start of @cache that
+ * don't contain a child that changed
+ */
+static guint
+line_cache_get_n_valid (LineCache *cache)
+{
+  guint lo, hi;
+
+  /* Find the first line that ends after the first change */
+  lo = 0;
+  hi = cache->lines->len;
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+
+      if (g_array_index (cache->lines, LineInfo, mid).end <= cache->first_dirty)
+        lo = mid + 1;
+      else
+        hi = mid;
     }
 
-  if (min_item_size)
-    *min_item_size = max_min_size;
+  /* A line that isn't full gains the children after it */
+  if (lo > 0 &&
+      cache->first_dirty != G_MAXINT &&
+      g_array_index (cache->lines, LineInfo, lo - 1).n_children < cache->line_length)
+    lo--;
 
-  if (nat_item_size)
-    *nat_item_size = max_nat_size;
+  return lo;
+}
 
-  /* Return next item in the list */
-  return iter;
+/* Gets the largest minimum/natural size of each line for the given item
+ * sizes (used to get the line heights for fixed item widths and the opposite).
+ */
+static void
+gtk_flow_box_get_line_sizes (GtkFlowBox       *box,
+                             GtkOrientation    orientation,
+                             int               line_length,
+                             GtkRequestedSize *item_sizes,
+                             int               extra_pixels,
+                             GtkRequestedSize *line_sizes,
+                             int               n_lines)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  LineCache *cache;
+  GSequenceIter *iter;
+  guint n_valid, line;
+  int position;
+
+  cache = gtk_flow_box_lookup_line_cache (box, orientation, line_length, item_sizes, extra_pixels);
+
+  n_valid = MIN (line_cache_get_n_valid (cache), (guint) n_lines);
+  g_array_set_size (cache->lines, n_valid);
+
+  for (line = 0; line < n_valid; line++)
+    line_sizes[line] = g_array_index (cache->lines, LineInfo, line).size;
+
+  position = n_valid > 0 ? g_array_index (cache->lines, LineInfo, n_valid - 1).end : 0;
+  iter = g_sequence_get_iter_at_pos (priv->children, position);
+
+  for (line = n_valid; line < (guint) n_lines; line++)
+    {
+      LineInfo info = { { 0, }, 0, 0 };
+      int line_extra_pixels = extra_pixels;
+
+      while (!g_sequence_iter_is_end (iter) && info.n_children < line_length)
+        {
+          GtkWidget *child = g_sequence_get (iter);
+          int child_min, child_nat, this_item_size;
+
+          iter = g_sequence_iter_next (iter);
+          position++;
+
+          if (!child_is_visible (child))
+            continue;
+
+          /* Distribute the extra pixels to the first children in the line
+           * (could be fancier and spread them out more evenly) */
+          this_item_size = item_sizes[info.n_children].minimum_size;
+          if (line_extra_pixels > 0 && ORIENTATION_ALIGN (box) == GTK_ALIGN_FILL)
+            {
+              this_item_size++;
+              line_extra_pixels--;
+            }
+
+          gtk_widget_measure (child, 1 - orientation, this_item_size,
+                              &child_min, &child_nat,
+                              NULL, NULL);
+
+          info.size.minimum_size = MAX (info.size.minimum_size, child_min);
+          info.size.natural_size = MAX (info.size.natural_size, child_nat);
+          info.n_children++;
+        }
+
+      info.end = position;
+      line_sizes[line] = info.size;
+      g_array_append_val (cache->lines, info);
+    }
+
+  cache->first_dirty = G_MAXINT;
 }
 
 /* fit_aligned_item_requests() helper */
@@ -1709,20 +1935,16 @@ gtk_flow_box_size_allocate (GtkWidget *widget,
        * line based on the aligned item sizes.
        */
 
-      for (i = 0, iter = g_sequence_get_begin_iter (priv->children);
-           !g_sequence_iter_is_end (iter) && i < n_lines;
-           i++)
-        {
-          iter = get_largest_size_for_line_in_opposing_orientation (box,
-                                                                    priv->orientation,
-                                                                    iter,
-                                                                    line_length,
-                                                                    item_sizes,
-                                                                    extra_pixels,
-                                                                    &line_sizes[i].minimum_size,
-                                                                    &line_sizes[i].natural_size);
-
+      gtk_flow_box_get_line_sizes (box,
+                                   priv->orientation,
+                                   line_length,
+                                   item_sizes,
+                                   extra_pixels,
+                                   line_sizes,
+                                   n_lines);
 
+      for (i = 0; i < n_lines; i++)
+        {
           /* Its possible a line is made of completely invisible children */
           if (line_sizes[i].natural_size > 0)
             {
@@ -2232,10 +2454,9 @@ gtk_flow_box_measure (GtkWidget      *widget,
                 }
               else
                 {
-                  int min_line_width, nat_line_width, i;
+                  int min_line_width, nat_line_width, n_lines, i;
                   gboolean first_line = TRUE;
-                  GtkRequestedSize *item_sizes;
-                  GSequenceIter *iter;
+                  GtkRequestedSize *item_sizes, *line_sizes;
 
                   /* First get the size each set of items take to span the line
                    * when aligning the items above and below after flowping.
@@ -2256,17 +2477,23 @@ gtk_flow_box_measure (GtkWidget      *widget,
                   if (avail_size > 0)
                     extra_pixels = gtk_distribute_natural_allocation (avail_size, line_length, item_sizes);
 
-                  for (iter = g_sequence_get_begin_iter (priv->children);
-                       !g_sequence_iter_is_end (iter);)
+                  n_lines = n_children / line_length;
+                  if ((n_children % line_length) > 0)
+                    n_lines++;
+
+                  line_sizes = g_new0 (GtkRequestedSize, n_lines);
+                  gtk_flow_box_get_line_sizes (box,
+                                               GTK_ORIENTATION_VERTICAL,
+                                               line_length,
+                                               item_sizes,
+                                               extra_pixels,
+                                               line_sizes,
+                                               n_lines);
+
+                  for (i = 0; i < n_lines; i++)
                     {
-                      iter = get_largest_size_for_line_in_opposing_orientation (box,
-                                                                                GTK_ORIENTATION_VERTICAL,
-                                                                                iter,
-                                                                                line_length,
-                                                                                item_sizes,
-                                                                                extra_pixels,
-                                                                                &min_line_width,
-                                                                                &nat_line_width);
+                      min_line_width = line_sizes[i].minimum_size;
+                      nat_line_width = line_sizes[i].natural_size;
 
                       /* Its possible the last line only had invisible widgets */
                       if (nat_line_width > 0)
@@ -2283,6 +2510,7 @@ gtk_flow_box_measure (GtkWidget      *widget,
                           nat_width += nat_line_width;
                         }
                     }
+                  g_free (line_sizes);
                   g_free (item_sizes);
                 }
             }
@@ -2470,10 +2698,9 @@ gtk_flow_box_measure (GtkWidget      *widget,
                 }
               else
                 {
-                  int min_line_height, nat_line_height, i;
+                  int min_line_height, nat_line_height, n_lines, i;
                   gboolean first_line = TRUE;
-                  GtkRequestedSize *item_sizes;
-                  GSequenceIter *iter;
+                  GtkRequestedSize *item_sizes, *line_sizes;
 
                   /* First get the size each set of items take to span the line
                    * when aligning the items above and below after flowping.
@@ -2494,17 +2721,24 @@ gtk_flow_box_measure (GtkWidget      *widget,
                   if (avail_size > 0)
                     extra_pixels = gtk_distribute_natural_allocation (avail_size, line_length, item_sizes);
 
-                  for (iter = g_sequence_get_begin_iter (priv->children);
-                       !g_sequence_iter_is_end (iter);)
+                  n_lines = n_children / line_length;
+                  if ((n_children % line_length) > 0)
+                    n_lines++;
+
+                  line_sizes = g_new0 (GtkRequestedSize, n_lines);
+                  gtk_flow_box_get_line_sizes (box,
+                                               GTK_ORIENTATION_HORIZONTAL,
+                                               line_length,
+                                               item_sizes,
+                                               extra_pixels,
+                                               line_sizes,
+                                               n_lines);
+
+                  for (i = 0; i < n_lines; i++)
                     {
-                      iter = get_largest_size_for_line_in_opposing_orientation (box,
-                                                                                GTK_ORIENTATION_HORIZONTAL,
-                                                                                iter,
-                                                                                line_length,
-                                                                                item_sizes,
-                                                                                extra_pixels,
-                                                                                &min_line_height,
-                                                                                &nat_line_height);
+                      min_line_height = line_sizes[i].minimum_size;
+                      nat_line_height = line_sizes[i].natural_size;
+
                       /* Its possible the line only had invisible widgets */
                       if (nat_line_height > 0)
                         {
@@ -2521,6 +2755,7 @@ gtk_flow_box_measure (GtkWidget      *widget,
                         }
                     }
 
+                  g_free (line_sizes);
                   g_free (item_sizes);
                 }
             }
@@ -3136,7 +3371,9 @@ gtk_flow_box_remove (GtkFlowBox *box,
   if (child == priv->selected_child)
     priv->selected_child = NULL;
 
+  gtk_flow_box_child_invalidate_lines (child);
   g_sequence_remove (CHILD_PRIV (child)->iter);
+  CHILD_PRIV (child)->iter = NULL;
   gtk_widget_unparent (GTK_WIDGET (child));
 
   if (was_visible && gtk_widget_get_visible (GTK_WIDGET (box)))
@@ -3573,6 +3810,8 @@ gtk_flow_box_set_property (GObject      *object,
 
             gtk_widget_update_orientation (GTK_WIDGET (box), priv->orientation);
 
+            gtk_flow_box_clear_line_caches (box);
+
             /* Re-box the children in the new orientation */
             gtk_widget_queue_resize (GTK_WIDGET (box));
             g_object_notify_by_pspec (object, pspec);
@@ -3646,6 +3885,8 @@ gtk_flow_box_dispose (GObject *obj)
       g_clear_object (&priv->bound_model);
     }
 
+  gtk_flow_box_clear_line_caches (GTK_FLOW_BOX (obj));
+
   G_OBJECT_CLASS (gtk_flow_box_parent_class)->dispose (obj);
 }
 
@@ -4249,6 +4490,7 @@ gtk_flow_box_insert (GtkFlowBox *box,
 
   CHILD_PRIV (child)->iter = iter;
   gtk_flow_box_insert_widget (box, GTK_WIDGET (child), iter);
+  gtk_flow_box_invalidate_lines (box, g_sequence_iter_get_position (iter));
   gtk_flow_box_apply_filter (box, child);
 }
 
@@ -5099,6 +5341,7 @@ gtk_flow_box_invalidate_sort (GtkFlowBox *box)
     {
       g_sequence_sort (priv->children, (GCompareDataFunc)gtk_flow_box_sort, box);
       g_sequence_foreach (priv->children, gtk_flow_box_reorder_foreach, &previous);
+      gtk_flow_box_invalidate_lines (box, 0);
       gtk_widget_queue_resize (GTK_WIDGET (box));
     }
 }
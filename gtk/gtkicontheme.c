@@ -378,13 +378,22 @@ typedef struct
 
   GArray *dir_sizes;     /* IconThemeDirSize */
   GArray *dirs;          /* IconThemeDir */
+
+  /* All the files of an icon are kept in a list sorted by dir size,
+   * so a lookup only looks at the dir sizes that have the icon */
+  GArray *files;         /* IconThemeFile */
+  GHashTable *icon_index; /* name (interned) -> index of first file */
 } IconTheme;
 
+#define NO_FILE G_MAXUINT32
+
 typedef struct
 {
   guint16 dir_index;    /* index in dirs */
+  guint16 dir_size_index; /* index in dir_sizes */
   guint8 best_suffix;
   guint8 best_suffix_no_svg;
+  guint32 next;         /* next file with the same name, or NO_FILE */
 } IconThemeFile;
 
 typedef struct
@@ -395,9 +404,6 @@ typedef struct
   int max_size;
   int threshold;
   int scale;
-
-  GArray *icon_files;
-  GHashTable *icon_hash; /* name (interned) -> file index */
 } IconThemeDirSize;
 
 typedef struct
@@ -421,11 +427,17 @@ typedef struct
   gboolean exists;
 } IconThemeDirMtime;
 
+static inline IconThemeFile *
+theme_get_file (IconTheme *theme,
+                guint32    index)
+{
+  return &g_array_index (theme->files, IconThemeFile, index);
+}
+
 static void              gtk_icon_theme_finalize          (GObject          *object);
 static void              gtk_icon_theme_dispose           (GObject          *object);
 static IconTheme *       theme_new                        (const char       *theme_name,
                                                            GKeyFile         *theme_file);
-static void              theme_dir_size_destroy           (IconThemeDirSize *dir_size);
 static void              theme_dir_destroy                (IconThemeDir     *dir);
 static void              theme_destroy                    (IconTheme        *theme);
 static GtkIconPaintable *theme_lookup_icon                (IconTheme        *theme,
@@ -2558,7 +2570,7 @@ gtk_icon_theme_get_icon_sizes (GtkIconTheme *self,
                                const char   *icon_name)
 {
   GList *l;
-  int i;
+  guint32 i;
   GHashTable *sizes;
   int *result, *r;
   const char *interned_icon_name;
@@ -2576,17 +2588,19 @@ gtk_icon_theme_get_icon_sizes (GtkIconTheme *self,
   for (l = self->themes; l; l = l->next)
     {
       IconTheme *theme = l->data;
+      gpointer first;
 
-      for (i = 0; i < theme->dir_sizes->len; i++)
+      if (interned_icon_name == NULL ||
+          !g_hash_table_lookup_extended (theme->icon_index, interned_icon_name, NULL, &first))
+        continue;
+
+      for (i = GPOINTER_TO_UINT (first); i != NO_FILE; i = theme_get_file (theme, i)->next)
         {
-          IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, i);
+          IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, theme_get_file (theme, i)->dir_size_index);
 
           if (dir_size->type != ICON_THEME_DIR_SCALABLE && g_hash_table_lookup_extended (sizes, GINT_TO_POINTER (dir_size->size), NULL, NULL))
             continue;
 
-          if (!g_hash_table_contains (dir_size->icon_hash, interned_icon_name))
-            continue;
-
           if (dir_size->type == ICON_THEME_DIR_SCALABLE)
             g_hash_table_insert (sizes, GINT_TO_POINTER (-1), NULL);
           else
@@ -2699,6 +2713,9 @@ theme_new (const char *theme_name,
   theme->name = g_strdup (theme_name);
   theme->dir_sizes = g_array_new (FALSE, FALSE, sizeof (IconThemeDirSize));
   theme->dirs = g_array_new (FALSE, FALSE, sizeof (IconThemeDir));
+  theme->files = g_array_new (FALSE, FALSE, sizeof (IconThemeFile));
+  /* The keys are interned strings, so use direct hash/equal */
+  theme->icon_index = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   theme->display_name =
     g_key_file_get_locale_string (theme_file, "Icon Theme", "Name", NULL, NULL);
@@ -2721,24 +2738,16 @@ theme_destroy (IconTheme *theme)
   g_free (theme->display_name);
   g_free (theme->comment);
 
-  for (i = 0; i < theme->dir_sizes->len; i++)
-    theme_dir_size_destroy (&g_array_index (theme->dir_sizes, IconThemeDirSize, i));
   g_array_free (theme->dir_sizes, TRUE);
 
   for (i = 0; i < theme->dirs->len; i++)
     theme_dir_destroy (&g_array_index (theme->dirs, IconThemeDir, i));
   g_array_free (theme->dirs, TRUE);
 
-  g_free (theme);
-}
+  g_array_free (theme->files, TRUE);
+  g_hash_table_destroy (theme->icon_index);
 
-static void
-theme_dir_size_destroy (IconThemeDirSize *dir)
-{
-  if (dir->icon_hash)
-    g_hash_table_destroy (dir->icon_hash);
-  if (dir->icon_files)
-    g_array_free (dir->icon_files, TRUE);
+  g_free (theme);
 }
 
 static void
@@ -2914,25 +2923,22 @@ theme_lookup_icon (IconTheme  *theme,
   IconThemeFile *min_file;
   int min_difference;
   IconCacheFlag min_suffix = ICON_CACHE_FLAG_PNG_SUFFIX;
-  int i;
+  gpointer first;
+  guint32 i;
 
   min_difference = G_MAXINT;
   min_dir_size = NULL;
   min_file = NULL;
 
-  for (i = 0; i < theme->dir_sizes->len; i++)
+  if (!g_hash_table_lookup_extended (theme->icon_index, icon_name, NULL, &first))
+    return NULL;
+
+  for (i = GPOINTER_TO_UINT (first); i != NO_FILE; i = theme_get_file (theme, i)->next)
     {
-      IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, i);
-      IconThemeFile *file;
+      IconThemeFile *file = theme_get_file (theme, i);
+      IconThemeDirSize *dir_size = &g_array_index (theme->dir_sizes, IconThemeDirSize, file->dir_size_index);
       guint best_suffix;
       int difference;
-      gpointer file_index;
-
-      if (!g_hash_table_lookup_extended (dir_size->icon_hash, icon_name, NULL, &file_index))
-        continue;
-
-      file = &g_array_index (dir_size->icon_files, IconThemeFile, GPOINTER_TO_INT(file_index));
-
 
       if (allow_svg)
         best_suffix = file->best_suffix;
@@ -3095,10 +3101,6 @@ theme_ensure_dir_size (IconTheme *theme,
         return index;
     }
 
-  new.icon_files = g_array_new (FALSE, FALSE, sizeof (IconThemeFile));
-  /* The keys are interned strings, so use direct hash/equal */
-  new.icon_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, NULL);
-
   index = theme->dir_sizes->len;
   g_array_append_val (theme->dir_sizes, new);
 
@@ -3129,20 +3131,47 @@ theme_add_icon_file (IconTheme *theme,
                      guint dir_index)
 {
   IconThemeFile new_file = { 0 };
-  guint index;
-
-  if (g_hash_table_contains (dir_size->icon_hash, icon_name))
-    return;
+  gpointer first;
+  guint32 index, prev;
 
   new_file.dir_index = dir_index;
+  new_file.dir_size_index = dir_size - &g_array_index (theme->dir_sizes, IconThemeDirSize, 0);
   new_file.best_suffix = best_suffix (suffixes, TRUE);
   new_file.best_suffix_no_svg = best_suffix (suffixes, FALSE);
+  new_file.next = NO_FILE;
 
-  index = dir_size->icon_files->len;
-  g_array_append_val (dir_size->icon_files, new_file);
+  if (!g_hash_table_lookup_extended (theme->icon_index, icon_name, NULL, &first))
+    {
+      index = theme->files->len;
+      g_array_append_val (theme->files, new_file);
+      g_hash_table_insert (theme->icon_index, (char *) icon_name, GUINT_TO_POINTER (index));
+      return;
+    }
 
-  g_hash_table_insert (dir_size->icon_hash, (char *)icon_name, GINT_TO_POINTER(index));
+  /* Keep the list sorted by dir size, so lookups
+   * look at the dir sizes in the order they were defined */
+  index = GPOINTER_TO_UINT (first);
+  prev = NO_FILE;
+  while (index != NO_FILE &&
+         theme_get_file (theme, index)->dir_size_index < new_file.dir_size_index)
+    {
+      prev = index;
+      index = theme_get_file (theme, index)->next;
+    }
 
+  /* The first directory with the icon wins */
+  if (index != NO_FILE &&
+      theme_get_file (theme, index)->dir_size_index == new_file.dir_size_index)
+    return;
+
+  new_file.next = index;
+  index = theme->files->len;
+  g_array_append_val (theme->files, new_file);
+
+  if (prev == NO_FILE)
+    g_hash_table_insert (theme->icon_index, (char *) icon_name, GUINT_TO_POINTER (index));
+  else
+    theme_get_file (theme, prev)->next = index;
 }
 
 /* Icon names are are already interned */
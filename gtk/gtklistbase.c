@@ -62,6 +62,11 @@ struct _RubberbandData
 
 typedef struct _GtkListBasePrivate GtkListBasePrivate;
 
+/* Scrolling is considered over when the adjustment hasn't changed for this long */
+#define SCROLL_TIMEOUT (G_USEC_PER_SEC / 10)
+/* Items that will scroll into view this far in the future are created ahead of time */
+#define SCROLL_LOOKAHEAD (G_USEC_PER_SEC / 4)
+
 struct _GtkListBasePrivate
 {
   GtkListItemManager *item_manager;
@@ -78,6 +83,14 @@ struct _GtkListBasePrivate
   GtkPackType anchor_side_across;
   guint center_widgets;
   guint above_below_widgets;
+  /* number of items on screen at the last allocation */
+  guint n_visible;
+
+  /* scrolling along the list, to predict which items are needed next */
+  gint64 scroll_time;
+  int scroll_value;
+  int scroll_direction;
+  double scroll_velocity;                       /* in pixels per second */
   /* the last item that was selected - basically the location to extend selections from */
   GtkListItemTracker *selected;
   /* the item that has input focus */
@@ -179,6 +192,50 @@ gtk_list_base_get_adjustment_values (GtkListBase    *self,
     *page_size = ps;
 }
 
+static gint64
+gtk_list_base_get_scroll_time (GtkListBase *self)
+{
+  GdkFrameClock *frame_clock;
+
+  frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (self));
+  if (frame_clock)
+    return gdk_frame_clock_get_frame_time (frame_clock);
+
+  return g_get_monotonic_time ();
+}
+
+static void
+gtk_list_base_update_scroll_velocity (GtkListBase *self)
+{
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+  gint64 now;
+  int value;
+
+  now = gtk_list_base_get_scroll_time (self);
+  gtk_list_base_get_adjustment_values (self, priv->orientation, &value, NULL, NULL);
+
+  if (value == priv->scroll_value)
+    return;
+
+  priv->scroll_direction = value > priv->scroll_value ? 1 : -1;
+
+  /* Multiple changes in the same frame add up */
+  if (now == priv->scroll_time)
+    return;
+
+  if (now - priv->scroll_time < SCROLL_TIMEOUT)
+    {
+      double velocity = (double) (value - priv->scroll_value) * G_USEC_PER_SEC / (now - priv->scroll_time);
+
+      priv->scroll_velocity = (priv->scroll_velocity + velocity) / 2;
+    }
+  else
+    priv->scroll_velocity = 0;
+
+  priv->scroll_time = now;
+  priv->scroll_value = value;
+}
+
 static void
 gtk_list_base_adjustment_value_changed_cb (GtkAdjustment *adjustment,
                                            GtkListBase   *self)
@@ -190,6 +247,9 @@ gtk_list_base_adjustment_value_changed_cb (GtkAdjustment *adjustment,
   GtkPackType side_across, side_along;
   guint pos;
 
+  if (adjustment == priv->adjustment[priv->orientation])
+    gtk_list_base_update_scroll_velocity (self);
+
   gtk_list_base_get_adjustment_values (self, OPPOSITE_ORIENTATION (priv->orientation), &area.x, &total_size, &area.width);
   if (total_size == area.width)
     align_across = 0.5;
@@ -2171,6 +2231,38 @@ gtk_list_base_update_adjustments (GtkListBase *self)
                                        value_along,
                                        bounds.height,
                                        page_along);
+  gtk_list_base_get_adjustment_values (self, priv->orientation, &priv->scroll_value, NULL, NULL);
+}
+
+static void
+gtk_list_base_update_n_visible (GtkListBase *self)
+{
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+  int value_along, size_along, page_along;
+  int value_across, size_across, page_across;
+  guint first, last;
+
+  gtk_list_base_get_adjustment_values (self, priv->orientation, &value_along, &size_along, &page_along);
+  gtk_list_base_get_adjustment_values (self, OPPOSITE_ORIENTATION (priv->orientation), &value_across, &size_across, &page_across);
+
+  if (size_along <= 0 || size_across <= 0 ||
+      !gtk_list_base_get_position_from_allocation (self,
+                                                   value_across,
+                                                   value_along,
+                                                   &first,
+                                                   NULL) ||
+      !gtk_list_base_get_position_from_allocation (self,
+                                                   MIN (value_across + page_across, size_across) - 1,
+                                                   MIN (value_along + page_along, size_along) - 1,
+                                                   &last,
+                                                   NULL) ||
+      last < first)
+    {
+      priv->n_visible = 0;
+      return;
+    }
+
+  priv->n_visible = last - first + 1;
 }
 
 void
@@ -2181,6 +2273,7 @@ gtk_list_base_allocate (GtkListBase *self)
   gtk_css_boxes_init (&boxes, GTK_WIDGET (self));
 
   gtk_list_base_update_adjustments (self);
+  gtk_list_base_update_n_visible (self);
 
   gtk_list_base_allocate_children (self, &boxes);
   gtk_list_base_allocate_rubberband (self, &boxes);
@@ -2277,6 +2370,11 @@ gtk_list_base_get_anchor (GtkListBase *self)
  *
  * The anchor will also ensure that enough widgets are created according
  * to gtk_list_base_set_anchor_max_widgets().
+ *
+ * While scrolling, only the widgets for the items that are on screen
+ * are created right away, the others are created over the next frames.
+ * More widgets are created in the direction of scrolling, depending on
+ * how fast the list scrolls.
  **/
 void
 gtk_list_base_set_anchor (GtkListBase *self,
@@ -2287,14 +2385,48 @@ gtk_list_base_set_anchor (GtkListBase *self,
                           GtkPackType  anchor_side_along)
 {
   GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
-  guint items_before;
+  guint items_before, items_after, visible_before, lookahead;
+  int direction;
+
+  items_before = round (priv->center_widgets * CLAMP (anchor_align_along, 0, 1)) + priv->above_below_widgets;
+  items_after = priv->center_widgets + 2 * priv->above_below_widgets - items_before;
+
+  if (priv->n_visible > 0 &&
+      gtk_list_base_get_scroll_time (self) - priv->scroll_time < SCROLL_TIMEOUT)
+    direction = priv->scroll_direction;
+  else
+    direction = 0;
+
+  if (direction != 0)
+    {
+      int page_size;
+
+      visible_before = ceil (priv->n_visible * CLAMP (anchor_align_along, 0, 1));
+      gtk_list_item_tracker_set_required (priv->item_manager,
+                                          priv->anchor,
+                                          visible_before + priv->above_below_widgets,
+                                          priv->n_visible - visible_before + priv->above_below_widgets);
+
+      gtk_list_base_get_adjustment_values (self, priv->orientation, NULL, NULL, &page_size);
+      lookahead = fabs (priv->scroll_velocity) * SCROLL_LOOKAHEAD / G_USEC_PER_SEC
+                  * priv->n_visible / MAX (page_size, 1);
+      lookahead = MIN (lookahead, priv->center_widgets);
+      if (direction < 0)
+        items_before += lookahead;
+      else
+        items_after += lookahead;
+    }
+  else
+    {
+      gtk_list_item_tracker_set_required (priv->item_manager, priv->anchor, G_MAXUINT, G_MAXUINT);
+    }
 
-  items_before = round (priv->center_widgets * CLAMP (anchor_align_along, 0, 1));
+  gtk_list_item_manager_set_scroll_direction (priv->item_manager, direction);
   gtk_list_item_tracker_set_position (priv->item_manager,
                                       priv->anchor,
                                       anchor_pos,
-                                      items_before + priv->above_below_widgets,
-                                      priv->center_widgets - items_before + priv->above_below_widgets);
+                                      items_before,
+                                      items_after);
 
   priv->anchor_align_across = anchor_align_across;
   priv->anchor_side_across = anchor_side_across;
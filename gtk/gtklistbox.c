@@ -166,6 +166,10 @@ struct _GtkListBox
   GDestroyNotify create_widget_func_data_destroy;
 
   GtkListTabBehavior tab_behavior;
+
+  gboolean virtualized;
+  int estimated_row_height;
+  guint resize_tick_id;
 };
 
 struct _GtkListBoxClass
@@ -200,6 +204,7 @@ typedef struct
   guint selected    :1;
   guint activatable :1;
   guint selectable  :1;
+  guint pending     :1;
 } GtkListBoxRowPrivate;
 
 enum {
@@ -226,6 +231,7 @@ enum {
   PROP_ACCEPT_UNPAIRED_RELEASE,
   PROP_SHOW_SEPARATORS,
   PROP_TAB_BEHAVIOR,
+  PROP_VIRTUALIZED,
   LAST_PROPERTY
 };
 
@@ -336,6 +342,8 @@ static void gtk_list_box_update_row        (GtkListBox    *box,
                                             GtkListBoxRow *row);
 static void gtk_list_box_update_rows       (GtkListBox    *box);
 
+static void                 gtk_list_box_adjustment_value_changed       (GtkAdjustment       *adjustment,
+                                                                         GtkListBox          *box);
 static void                 gtk_list_box_bound_model_changed            (GListModel          *list,
                                                                          guint                position,
                                                                          guint                removed,
@@ -420,6 +428,9 @@ gtk_list_box_get_property (GObject    *obj,
     case PROP_TAB_BEHAVIOR:
       g_value_set_enum (value, box->tab_behavior);
       break;
+    case PROP_VIRTUALIZED:
+      g_value_set_boolean (value, box->virtualized);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, property_id, pspec);
       break;
@@ -451,6 +462,9 @@ gtk_list_box_set_property (GObject      *obj,
     case PROP_TAB_BEHAVIOR:
       gtk_list_box_set_tab_behavior (box, g_value_get_enum (value));
       break;
+    case PROP_VIRTUALIZED:
+      gtk_list_box_set_virtualized (box, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, property_id, pspec);
       break;
@@ -488,7 +502,7 @@ gtk_list_box_finalize (GObject *obj)
   if (box->update_header_func_target_destroy_notify != NULL)
     box->update_header_func_target_destroy_notify (box->update_header_func_target);
 
-  g_clear_object (&box->adjustment);
+  gtk_list_box_set_adjustment (box, NULL);
   g_clear_object (&box->drag_highlighted_row);
 
   g_sequence_free (box->children);
@@ -578,6 +592,19 @@ gtk_list_box_class_init (GtkListBoxClass *klass)
                                                GTK_LIST_TAB_ALL,
                                                G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkListBox:virtualized:
+   *
+   * Whether rows for items of a bound model are only created
+   * when they get close to the visible area.
+   *
+   * Since: 4.20
+   */
+  properties[PROP_VIRTUALIZED] =
+    g_param_spec_boolean ("virtualized", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROPERTY, properties);
 
   /**
@@ -1145,9 +1172,17 @@ gtk_list_box_set_adjustment (GtkListBox    *box,
   g_return_if_fail (adjustment == NULL || GTK_IS_ADJUSTMENT (adjustment));
 
   if (adjustment)
-    g_object_ref_sink (adjustment);
+    {
+      g_object_ref_sink (adjustment);
+      g_signal_connect (adjustment, "value-changed",
+                        G_CALLBACK (gtk_list_box_adjustment_value_changed), box);
+    }
   if (box->adjustment)
-    g_object_unref (box->adjustment);
+    {
+      g_signal_handlers_disconnect_by_func (box->adjustment,
+                                            gtk_list_box_adjustment_value_changed, box);
+      g_object_unref (box->adjustment);
+    }
   box->adjustment = adjustment;
 }
 
@@ -2199,7 +2234,7 @@ gtk_list_box_apply_filter (GtkListBox    *box,
   gboolean do_show;
 
   do_show = TRUE;
-  if (box->filter_func != NULL)
+  if (box->filter_func != NULL && !ROW_PRIV (row)->pending)
     do_show = box->filter_func (row, box->filter_func_target);
 
   gtk_widget_set_child_visible (GTK_WIDGET (row), do_show);
@@ -2349,7 +2384,8 @@ gtk_list_box_update_header (GtkListBox    *box,
     }
 
   if (box->update_header_func != NULL &&
-      row_is_visible (row))
+      row_is_visible (row) &&
+      !ROW_PRIV (row)->pending)
     {
       old_header = ROW_PRIV (row)->header;
       if (old_header)
@@ -2591,6 +2627,26 @@ gtk_list_box_get_request_mode (GtkWidget *widget)
   return GTK_SIZE_REQUEST_CONSTANT_SIZE;
 }
 
+/* Rows that have not been created yet use the average height of
+ * the rows that have, so the scrollbar is roughly right.
+ */
+static void
+gtk_list_box_measure_row_height (GtkListBox    *box,
+                                 GtkListBoxRow *row,
+                                 int            for_width,
+                                 int           *minimum,
+                                 int           *natural)
+{
+  gtk_widget_measure (GTK_WIDGET (row), GTK_ORIENTATION_VERTICAL,
+                      for_width, minimum, natural, NULL, NULL);
+
+  if (ROW_PRIV (row)->pending)
+    {
+      *minimum = MAX (*minimum, box->estimated_row_height);
+      *natural = MAX (*natural, box->estimated_row_height);
+    }
+}
+
 static void
 gtk_list_box_measure_height_for_width (GtkListBox       *box,
                                        int               for_width,
@@ -2636,8 +2692,7 @@ gtk_list_box_measure_height_for_width (GtkListBox       *box,
               i++;
             }
         }
-      gtk_widget_measure (GTK_WIDGET (row), GTK_ORIENTATION_VERTICAL,
-                          for_width, &row_min, &row_nat, NULL, NULL);
+      gtk_list_box_measure_row_height (box, row, for_width, &row_min, &row_nat);
       *minimum += row_min;
       *natural += row_nat;
 
@@ -2820,6 +2875,221 @@ gtk_list_box_measure (GtkWidget     *widget,
                                            minimum, natural, NULL);
 }
 
+/* Swaps @old_row for @new_row at the same position, moving over
+ * everything the box keeps track of about the row.
+ */
+static void
+gtk_list_box_replace_row (GtkListBox    *box,
+                          GtkListBoxRow *old_row,
+                          GtkListBoxRow *new_row)
+{
+  GtkListBoxRowPrivate *old_priv = ROW_PRIV (old_row);
+  GtkListBoxRowPrivate *new_priv = ROW_PRIV (new_row);
+  gboolean had_focus;
+
+  g_object_ref (old_row);
+  had_focus = gtk_widget_has_focus (GTK_WIDGET (old_row));
+
+  g_sequence_set (old_priv->iter, new_row);
+  new_priv->iter = g_steal_pointer (&old_priv->iter);
+  new_priv->y = old_priv->y;
+  new_priv->height = old_priv->height;
+
+  gtk_widget_insert_after (GTK_WIDGET (new_row), GTK_WIDGET (box), GTK_WIDGET (old_row));
+  gtk_widget_set_child_visible (GTK_WIDGET (new_row), TRUE);
+
+  if (old_priv->visible)
+    list_box_add_visible_rows (box, -1);
+  new_priv->visible = gtk_widget_get_visible (GTK_WIDGET (new_row));
+  if (new_priv->visible)
+    list_box_add_visible_rows (box, 1);
+
+  if (old_priv->header)
+    {
+      g_hash_table_insert (box->header_hash, old_priv->header, new_row);
+      g_set_object (&new_priv->header, old_priv->header);
+      g_clear_object (&old_priv->header);
+    }
+
+  if (old_priv->selected)
+    gtk_list_box_row_set_selected (new_row, TRUE);
+  if (box->selected_row == old_row)
+    box->selected_row = new_row;
+  if (box->cursor_row == old_row)
+    box->cursor_row = new_row;
+  if (box->active_row == old_row)
+    box->active_row = NULL;
+  if (box->drag_highlighted_row == old_row)
+    gtk_list_box_drag_unhighlight_row (box);
+
+  gtk_widget_unparent (GTK_WIDGET (old_row));
+  g_object_unref (old_row);
+
+  gtk_list_box_apply_filter (box, new_row);
+  gtk_list_box_update_row (box, new_row);
+
+  if (had_focus)
+    gtk_widget_grab_focus (GTK_WIDGET (new_row));
+}
+
+static GtkWidget *
+gtk_list_box_create_pending_row (void)
+{
+  GtkWidget *row;
+
+  row = gtk_list_box_row_new ();
+  ROW_PRIV (row)->pending = TRUE;
+
+  return row;
+}
+
+static void
+gtk_list_box_materialize_row (GtkListBox    *box,
+                              GtkListBoxRow *row)
+{
+  GSequenceIter *iter = ROW_PRIV (row)->iter;
+  GObject *item;
+  GtkWidget *widget;
+
+  item = g_list_model_get_item (box->bound_model, g_sequence_iter_get_position (iter));
+  widget = box->create_widget_func (item, box->create_widget_func_data);
+  if (g_object_is_floating (widget))
+    g_object_ref_sink (widget);
+
+  if (GTK_IS_LIST_BOX_ROW (widget))
+    {
+      gtk_list_box_replace_row (box, row, GTK_LIST_BOX_ROW (widget));
+    }
+  else
+    {
+      ROW_PRIV (row)->pending = FALSE;
+      gtk_list_box_row_set_child (row, widget);
+    }
+
+  gtk_list_box_update_header (box, iter);
+  gtk_list_box_update_header (box, gtk_list_box_get_next_visible (box, iter));
+
+  g_object_unref (widget);
+  g_object_unref (item);
+}
+
+static void
+gtk_list_box_release_row (GtkListBox    *box,
+                          GtkListBoxRow *row)
+{
+  GSequenceIter *iter = ROW_PRIV (row)->iter;
+
+  gtk_list_box_replace_row (box, row, GTK_LIST_BOX_ROW (gtk_list_box_create_pending_row ()));
+
+  gtk_list_box_update_header (box, iter);
+  gtk_list_box_update_header (box, gtk_list_box_get_next_visible (box, iter));
+}
+
+static gboolean
+gtk_list_box_resize_tick_cb (GtkWidget     *widget,
+                             GdkFrameClock *frame_clock,
+                             gpointer       user_data)
+{
+  GtkListBox *box = GTK_LIST_BOX (widget);
+
+  box->resize_tick_id = 0;
+  gtk_widget_queue_resize (widget);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Resizes queued from size_allocate() are ignored, so the size
+ * we reported with the old estimate gets fixed up in the next frame.
+ */
+static void
+gtk_list_box_queue_resize_later (GtkListBox *box)
+{
+  if (box->resize_tick_id == 0)
+    box->resize_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (box),
+                                                        gtk_list_box_resize_tick_cb,
+                                                        NULL, NULL);
+}
+
+/* Without an estimate, all pending rows are at the same position,
+ * so only create a few to get one.
+ */
+#define VIRTUAL_ROWS_WITHOUT_ESTIMATE 32
+
+/*<private>
+ * gtk_list_box_update_virtual_rows:
+ * @box: a virtualized list box
+ *
+ * Creates the rows that are within a page of the visible area and
+ * releases the ones that are more than two pages away, unless they
+ * are selected or focused.
+ *
+ * Positions come from the last allocation, with the estimated
+ * height for rows that do not exist yet.
+ */
+static void
+gtk_list_box_update_virtual_rows (GtkListBox *box)
+{
+  GSequenceIter *iter;
+  double value, page_size;
+  int y, n_created;
+
+  if (box->adjustment == NULL)
+    {
+      value = 0;
+      page_size = G_MAXINT / 4;
+    }
+  else
+    {
+      value = gtk_adjustment_get_value (box->adjustment);
+      page_size = gtk_adjustment_get_page_size (box->adjustment);
+    }
+
+  y = 0;
+  n_created = 0;
+  for (iter = g_sequence_get_begin_iter (box->children);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    {
+      GtkListBoxRow *row = g_sequence_get (iter);
+      int height;
+
+      if (!gtk_widget_get_visible (GTK_WIDGET (row)))
+        continue;
+
+      height = ROW_PRIV (row)->pending ? box->estimated_row_height : ROW_PRIV (row)->height;
+
+      if (ROW_PRIV (row)->pending)
+        {
+          if (y + height >= value - page_size && y <= value + 2 * page_size &&
+              (box->estimated_row_height > 0 || n_created < VIRTUAL_ROWS_WITHOUT_ESTIMATE))
+            {
+              gtk_list_box_materialize_row (box, row);
+              n_created++;
+            }
+        }
+      else if (y + height < value - 2 * page_size || y > value + 3 * page_size)
+        {
+          if (!ROW_PRIV (row)->selected &&
+              row != box->cursor_row &&
+              gtk_widget_get_focus_child (GTK_WIDGET (box)) != GTK_WIDGET (row))
+            gtk_list_box_release_row (box, row);
+        }
+
+      y += height;
+    }
+
+  if (n_created > 0)
+    gtk_list_box_queue_resize_later (box);
+}
+
+static void
+gtk_list_box_adjustment_value_changed (GtkAdjustment *adjustment,
+                                       GtkListBox    *box)
+{
+  if (box->virtualized && box->bound_model)
+    gtk_widget_queue_allocate (GTK_WIDGET (box));
+}
+
 static void
 gtk_list_box_size_allocate (GtkWidget *widget,
                             int        width,
@@ -2838,7 +3108,11 @@ gtk_list_box_size_allocate (GtkWidget *widget,
   int i = 0;
   int n_vexpand_children = 0;
   int extra_height = height;
+  gint64 known_height = 0;
+  guint n_known = 0;
 
+  if (box->virtualized && box->bound_model)
+    gtk_list_box_update_virtual_rows (box);
 
   child_allocation.x = 0;
   child_allocation.y = 0;
@@ -2881,16 +3155,33 @@ gtk_list_box_size_allocate (GtkWidget *widget,
             n_vexpand_children++;
         }
 
-      gtk_widget_measure (GTK_WIDGET (row), GTK_ORIENTATION_VERTICAL,
-                          width, &child_min, &child_nat, NULL, NULL);
+      gtk_list_box_measure_row_height (box, row, width, &child_min, &child_nat);
       total_min += child_min;
       total_nat += child_nat;
       i++;
 
+      if (!ROW_PRIV (row)->pending)
+        {
+          known_height += child_nat;
+          n_known++;
+        }
+
       if (gtk_widget_compute_expand (GTK_WIDGET (row), GTK_ORIENTATION_VERTICAL))
         n_vexpand_children++;
     }
 
+  if (box->virtualized && n_known > 0)
+    {
+      int estimate = (known_height + n_known / 2) / n_known;
+
+      /* Pending rows got measured with the old estimate */
+      if (estimate != box->estimated_row_height)
+        {
+          box->estimated_row_height = estimate;
+          gtk_list_box_queue_resize_later (box);
+        }
+    }
+
   /* We're most likely to be allocated either our minimum or natural
    * height, even more so when we're placed inside a GtkScrolledWindow &
    * GtkViewport. Detect these cases and skip the logic for distributing
@@ -2931,11 +3222,9 @@ gtk_list_box_size_allocate (GtkWidget *widget,
           i++;
         }
 
-      gtk_widget_measure (GTK_WIDGET (row),
-                          GTK_ORIENTATION_VERTICAL, width,
-                          &sizes[i].minimum_size,
-                          &sizes[i].natural_size,
-                          NULL, NULL);
+      gtk_list_box_measure_row_height (box, row, width,
+                                       &sizes[i].minimum_size,
+                                       &sizes[i].natural_size);
       i++;
     }
 
@@ -2983,10 +3272,7 @@ do_allocate:
 
       if (allocate_min || allocate_nat)
         {
-          gtk_widget_measure (GTK_WIDGET (row),
-                              GTK_ORIENTATION_VERTICAL, width,
-                              &child_min, &child_nat,
-                              NULL, NULL);
+          gtk_list_box_measure_row_height (box, row, width, &child_min, &child_nat);
           if (allocate_min)
             child_allocation.height = child_min;
           else
@@ -4022,6 +4308,14 @@ gtk_list_box_bound_model_changed (GListModel *list,
       gtk_list_box_remove (box, GTK_WIDGET (row));
     }
 
+  if (box->virtualized)
+    {
+      for (i = 0; i < added; i++)
+        gtk_list_box_insert (box, gtk_list_box_create_pending_row (), position + i);
+
+      return;
+    }
+
   for (i = 0; i < added; i++)
     {
       GObject *item;
@@ -4079,6 +4373,8 @@ gtk_list_box_check_model_compat (GtkListBox *box)
  * Note that using a model is incompatible with the filtering and sorting
  * functionality in `GtkListBox`. When using a model, filtering and sorting
  * should be implemented by the model.
+ *
+ * For big models, see [property@Gtk.ListBox:virtualized].
  */
 void
 gtk_list_box_bind_model (GtkListBox                 *box,
@@ -4209,3 +4505,83 @@ gtk_list_box_get_tab_behavior (GtkListBox *box)
 
   return box->tab_behavior;
 }
+
+/**
+ * gtk_list_box_set_virtualized:
+ * @box: a `GtkListBox`
+ * @virtualized: whether to only create rows close to the visible area
+ *
+ * Sets whether rows for items of a bound model are created lazily.
+ *
+ * Normally, [method@Gtk.ListBox.bind_model] creates a row for every
+ * item of the model up front. When the list box is virtualized, the
+ * create function is only called for items that get close to the
+ * visible area of the scrollable it is in, and rows that are far
+ * away are destroyed again, unless they are selected or focused.
+ * Until then, items are represented by empty rows that get the
+ * average height of the existing rows.
+ *
+ * This keeps lists with thousands of items fast to set up and to
+ * scroll, but code that looks at the children of rows must be
+ * prepared to find empty rows, and must not keep references to rows
+ * or their children around, since they may be recreated. The header
+ * function is only called for rows that have been created.
+ *
+ * Virtualization needs the list box to be the child of a
+ * [iface@Gtk.Scrollable], such as a [class@Gtk.Viewport], or to
+ * have an adjustment set with [method@Gtk.ListBox.set_adjustment].
+ * Otherwise, all rows are created when the list box is allocated.
+ *
+ * This setting has no effect on rows that are added with
+ * [method@Gtk.ListBox.insert].
+ *
+ * Since: 4.20
+ */
+void
+gtk_list_box_set_virtualized (GtkListBox *box,
+                              gboolean    virtualized)
+{
+  g_return_if_fail (GTK_IS_LIST_BOX (box));
+
+  if (box->virtualized == virtualized)
+    return;
+
+  box->virtualized = virtualized;
+
+  if (!virtualized)
+    {
+      GSequenceIter *iter;
+
+      for (iter = g_sequence_get_begin_iter (box->children);
+           !g_sequence_iter_is_end (iter);
+           iter = g_sequence_iter_next (iter))
+        {
+          GtkListBoxRow *row = g_sequence_get (iter);
+
+          if (ROW_PRIV (row)->pending)
+            gtk_list_box_materialize_row (box, row);
+        }
+    }
+
+  gtk_widget_queue_resize (GTK_WIDGET (box));
+
+  g_object_notify_by_pspec (G_OBJECT (box), properties[PROP_VIRTUALIZED]);
+}
+
+/**
+ * gtk_list_box_get_virtualized:
+ * @box: a `GtkListBox`
+ *
+ * Returns whether rows for items of a bound model are created lazily.
+ *
+ * Returns: %TRUE if the list box is virtualized
+ *
+ * Since: 4.20
+ */
+gboolean
+gtk_list_box_get_virtualized (GtkListBox *box)
+{
+  g_return_val_if_fail (GTK_IS_LIST_BOX (box), FALSE);
+
+  return box->virtualized;
+}
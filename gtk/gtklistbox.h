@@ -280,6 +280,12 @@ void               gtk_list_box_set_tab_behavior (GtkListBox         *box,
 GDK_AVAILABLE_IN_4_18
 GtkListTabBehavior gtk_list_box_get_tab_behavior (GtkListBox         *box);
 
+GDK_AVAILABLE_IN_4_20
+void           gtk_list_box_set_virtualized              (GtkListBox                   *box,
+                                                          gboolean                      virtualized);
+GDK_AVAILABLE_IN_4_20
+gboolean       gtk_list_box_get_virtualized              (GtkListBox                   *box);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListBox, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListBoxRow, g_object_unref)
 
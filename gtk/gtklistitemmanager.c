@@ -26,6 +26,15 @@
 #include "gtksectionmodel.h"
 #include "gtkwidgetprivate.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
+/* While scrolling, binding items that are not on screen stops after
+ * this many microseconds and continues in the next frames. That's a
+ * quarter of a frame at 60Hz, so there's room left for layout and
+ * rendering.
+ */
+#define GTK_LIST_ITEM_MANAGER_BIND_BUDGET 4000
+
 typedef struct _GtkListItemChange GtkListItemChange;
 
 struct _GtkListItemManager
@@ -43,6 +52,9 @@ struct _GtkListItemManager
   GtkListItemBase * (* create_widget) (GtkWidget *);
   void (* prepare_section) (GtkWidget *, GtkListTile *, guint);
   GtkListHeaderBase * (* create_header_widget) (GtkWidget *);
+
+  int scroll_direction;
+  guint materialize_id;
 };
 
 struct _GtkListItemManagerClass
@@ -56,6 +68,8 @@ struct _GtkListItemTracker
   GtkListItemBase *widget;
   guint n_before;
   guint n_after;
+  guint n_required_before;
+  guint n_required_after;
 };
 
 struct _GtkListItemChange
@@ -67,6 +81,9 @@ struct _GtkListItemChange
 
 G_DEFINE_TYPE (GtkListItemManager, gtk_list_item_manager, G_TYPE_OBJECT)
 
+static guint profiler_bound_counter;
+static guint profiler_deferred_counter;
+
 static void
 gtk_list_item_change_init (GtkListItemChange *change)
 {
@@ -1279,6 +1296,160 @@ gtk_list_tile_find_widget_before (GtkListTile *tile)
   return NULL;
 }
 
+/* Items close to a tracker's position - the ones on screen for the
+ * anchor - must always get a widget. The others may be left for
+ * gtk_list_item_manager_materialize_cb() while scrolling.
+ *
+ * The required range never extends past the tracked range, so
+ * trackers like the focus, which only track a single item, don't
+ * make the items around them required.
+ */
+static gboolean
+gtk_list_item_manager_is_required (GtkListItemManager *self,
+                                   guint               position)
+{
+  GSList *l;
+
+  for (l = self->trackers; l; l = l->next)
+    {
+      GtkListItemTracker *tracker = l->data;
+
+      if (tracker->position == GTK_INVALID_LIST_POSITION)
+        continue;
+
+      if (position < tracker->position)
+        {
+          if (tracker->position - position <= MIN (tracker->n_required_before, tracker->n_before))
+            return TRUE;
+        }
+      else
+        {
+          if (position - tracker->position <= MIN (tracker->n_required_after, tracker->n_after))
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_list_item_manager_bind_tile (GtkListItemManager *self,
+                                 GtkListItemChange  *change,
+                                 GtkListTile        *tile,
+                                 guint               position,
+                                 GtkWidget          *insert_after)
+{
+  gpointer item;
+
+  g_assert (tile->type == GTK_LIST_TILE_ITEM);
+  g_assert (tile->n_items == 1);
+  g_assert (tile->widget == NULL);
+
+  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+  tile->widget = GTK_WIDGET (gtk_list_item_change_get (change, item));
+  if (tile->widget == NULL)
+    tile->widget = GTK_WIDGET (self->create_widget (self->widget));
+  gtk_list_item_base_update (GTK_LIST_ITEM_BASE (tile->widget),
+                             position,
+                             item,
+                             gtk_selection_model_is_selected (self->model, position));
+  g_object_unref (item);
+  gtk_widget_insert_after (tile->widget, self->widget, insert_after);
+}
+
+/* Binds the tracked items that gtk_list_item_manager_ensure_items()
+ * skipped, a frame's budget at a time, starting at the end that is
+ * scrolled towards. Until then, the views treat them like any other
+ * item without a widget and estimate their size.
+ */
+static gboolean
+gtk_list_item_manager_materialize_cb (GtkWidget     *widget,
+                                      GdkFrameClock *frame_clock,
+                                      gpointer       data)
+{
+  GtkListItemManager *self = data;
+  GtkListItemChange change;
+  GArray *positions;
+  guint position, i, n_items, query_n_items, n_bound;
+  gboolean tracked, done;
+  gint64 deadline;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  deadline = g_get_monotonic_time () + GTK_LIST_ITEM_MANAGER_BIND_BUDGET;
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
+
+  positions = g_array_new (FALSE, FALSE, sizeof (guint));
+  for (position = 0; position < n_items; position += query_n_items)
+    {
+      gtk_list_item_query_tracked_range (self, n_items, position, &query_n_items, &tracked);
+      if (!tracked)
+        continue;
+
+      for (i = 0; i < query_n_items; i++)
+        {
+          guint pos = position + i;
+          g_array_append_val (positions, pos);
+        }
+    }
+
+  gtk_list_item_change_init (&change);
+  done = TRUE;
+  n_bound = 0;
+
+  for (i = 0; i < positions->len; i++)
+    {
+      GtkListTile *tile;
+      guint offset;
+
+      if (self->scroll_direction < 0)
+        position = g_array_index (positions, guint, positions->len - 1 - i);
+      else
+        position = g_array_index (positions, guint, i);
+
+      tile = gtk_list_item_manager_get_nth (self, position, &offset);
+      if (tile->widget)
+        continue;
+
+      if (g_get_monotonic_time () >= deadline)
+        {
+          done = FALSE;
+          break;
+        }
+
+      if (offset > 0)
+        tile = gtk_list_item_manager_ensure_split (self, tile, offset);
+      if (tile->n_items > 1)
+        gtk_list_item_manager_ensure_split (self, tile, 1);
+
+      gtk_list_item_manager_bind_tile (self,
+                                       &change,
+                                       tile,
+                                       position,
+                                       gtk_list_tile_find_widget_before (tile));
+      n_bound++;
+    }
+
+  gtk_list_item_change_finish (&change);
+  g_array_free (positions, TRUE);
+
+  if (n_bound > 0)
+    gtk_widget_queue_resize (self->widget);
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      gdk_profiler_end_markf (before, "Bind deferred list items", "%u items", n_bound);
+      gdk_profiler_set_int_counter (profiler_bound_counter, n_bound);
+    }
+
+  if (done)
+    {
+      self->materialize_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
 static void
 gtk_list_item_manager_ensure_items (GtkListItemManager *self,
                                     GtkListItemChange  *change,
@@ -1287,8 +1458,10 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
 {
   GtkListTile *tile, *header;
   GtkWidget *insert_after;
-  guint position, i, n_items, query_n_items, offset;
+  guint position, i, n_items, query_n_items, offset, n_bound, n_deferred;
   gboolean tracked, has_sections;
+  gint64 start_time, deadline;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
 
   if (self->model == NULL)
     return;
@@ -1296,6 +1469,14 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
   position = 0;
   has_sections = gtk_list_item_manager_has_sections (self);
+  n_bound = 0;
+  n_deferred = 0;
+
+  start_time = g_get_monotonic_time ();
+  if (self->scroll_direction != 0)
+    deadline = start_time + GTK_LIST_ITEM_MANAGER_BIND_BUDGET;
+  else
+    deadline = G_MAXINT64;
 
   gtk_list_item_manager_release_items (self, change);
 
@@ -1368,16 +1549,17 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
 
               if (tile->widget == NULL)
                 {
-                  gpointer item = g_list_model_get_item (G_LIST_MODEL (self->model), position + i);
-                  tile->widget = GTK_WIDGET (gtk_list_item_change_get (change, item));
-                  if (tile->widget == NULL)
-                    tile->widget = GTK_WIDGET (self->create_widget (self->widget));
-                  gtk_list_item_base_update (GTK_LIST_ITEM_BASE (tile->widget),
-                                             position + i,
-                                             item,
-                                             gtk_selection_model_is_selected (self->model, position + i));
-                  g_object_unref (item);
-                  gtk_widget_insert_after (tile->widget, self->widget, insert_after);
+                  if (deadline != G_MAXINT64 &&
+                      g_get_monotonic_time () >= deadline &&
+                      !gtk_list_item_manager_is_required (self, position + i))
+                    {
+                      n_deferred++;
+                      i++;
+                      break;
+                    }
+
+                  gtk_list_item_manager_bind_tile (self, change, tile, position + i, insert_after);
+                  n_bound++;
                 }
               else
                 {
@@ -1436,6 +1618,30 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
 
       position += query_n_items;
     }
+
+  if (n_deferred > 0 && self->materialize_id == 0)
+    {
+      self->materialize_id = gtk_widget_add_tick_callback (self->widget,
+                                                           gtk_list_item_manager_materialize_cb,
+                                                           self,
+                                                           NULL);
+    }
+  else if (n_deferred == 0 && self->materialize_id != 0)
+    {
+      gtk_widget_remove_tick_callback (self->widget, self->materialize_id);
+      self->materialize_id = 0;
+    }
+
+  if (GDK_PROFILER_IS_RUNNING && n_bound + n_deferred > 0)
+    {
+      /* Binding the items that had to be shown took longer than a frame */
+      if (g_get_monotonic_time () - start_time > G_USEC_PER_SEC / 60)
+        gdk_profiler_end_markf (before, "List item binding dropped a frame", "%u items", n_bound);
+      else
+        gdk_profiler_end_markf (before, "Bind list items", "%u items, %u deferred", n_bound, n_deferred);
+      gdk_profiler_set_int_counter (profiler_bound_counter, n_bound);
+      gdk_profiler_set_int_counter (profiler_deferred_counter, n_deferred);
+    }
 }
 
 static void
@@ -1711,6 +1917,12 @@ gtk_list_item_manager_clear_model (GtkListItemManager *self)
   if (self->model == NULL)
     return;
 
+  if (self->materialize_id)
+    {
+      gtk_widget_remove_tick_callback (self->widget, self->materialize_id);
+      self->materialize_id = 0;
+    }
+
   gtk_list_item_change_init (&change);
   gtk_list_item_manager_remove_items (self, &change, 0, g_list_model_get_n_items (G_LIST_MODEL (self->model)));
   gtk_list_item_change_finish (&change);
@@ -1753,6 +1965,12 @@ gtk_list_item_manager_class_init (GtkListItemManagerClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gtk_list_item_manager_dispose;
+
+  if (profiler_bound_counter == 0)
+    {
+      profiler_bound_counter = gdk_profiler_define_int_counter ("list-items-bound", "List items bound per update");
+      profiler_deferred_counter = gdk_profiler_define_int_counter ("list-items-deferred", "List items deferred to later frames");
+    }
 }
 
 static void
@@ -1885,6 +2103,8 @@ gtk_list_item_tracker_new (GtkListItemManager *self)
   tracker = g_new0 (GtkListItemTracker, 1);
 
   tracker->position = GTK_INVALID_LIST_POSITION;
+  tracker->n_required_before = G_MAXUINT;
+  tracker->n_required_after = G_MAXUINT;
 
   self->trackers = g_slist_prepend (self->trackers, tracker);
 
@@ -1951,3 +2171,45 @@ gtk_list_item_tracker_get_position (GtkListItemManager *self,
 {
   return tracker->position;
 }
+
+/*
+ * gtk_list_item_tracker_set_required:
+ * @self: the listitemmanager
+ * @tracker: the tracker
+ * @n_before: number of items before the position that need a widget
+ * @n_after: number of items after the position that need a widget
+ *
+ * Limits the items around the tracker that must get a widget right
+ * away while scrolling. Binding the other items of the tracked range
+ * is spread over the next frames.
+ *
+ * By default, all tracked items are required. The required items
+ * are limited to the tracked range. The new values take effect the
+ * next time the tracker's position is set.
+ */
+void
+gtk_list_item_tracker_set_required (GtkListItemManager *self,
+                                    GtkListItemTracker *tracker,
+                                    guint               n_before,
+                                    guint               n_after)
+{
+  tracker->n_required_before = n_before;
+  tracker->n_required_after = n_after;
+}
+
+/*
+ * gtk_list_item_manager_set_scroll_direction:
+ * @self: the listitemmanager
+ * @direction: -1 if scrolling towards the start, 1 if scrolling
+ *   towards the end, 0 if not scrolling
+ *
+ * While scrolling, binding items that are not required is limited
+ * to a part of each frame and continues at the end of the tracked
+ * ranges that is scrolled towards.
+ */
+void
+gtk_list_item_manager_set_scroll_direction (GtkListItemManager *self,
+                                            int                 direction)
+{
+  self->scroll_direction = direction;
+}
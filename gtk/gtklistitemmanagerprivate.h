@@ -145,6 +145,12 @@ void                    gtk_list_item_tracker_set_position      (GtkListItemMana
                                                                  guint                   n_after);
 guint                   gtk_list_item_tracker_get_position      (GtkListItemManager     *self,
                                                                  GtkListItemTracker     *tracker);
+void                    gtk_list_item_tracker_set_required      (GtkListItemManager     *self,
+                                                                 GtkListItemTracker     *tracker,
+                                                                 guint                   n_before,
+                                                                 guint                   n_after);
+void                    gtk_list_item_manager_set_scroll_direction (GtkListItemManager  *self,
+                                                                 int                     direction);
 
 
 G_END_DECLS
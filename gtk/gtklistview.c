@@ -154,6 +154,7 @@ enum
   PROP_ENABLE_RUBBERBAND,
   PROP_FACTORY,
   PROP_HEADER_FACTORY,
+  PROP_HOMOGENEOUS,
   PROP_MODEL,
   PROP_SHOW_SEPARATORS,
   PROP_SINGLE_CLICK_ACTIVATE,
@@ -478,12 +479,45 @@ gtk_list_view_get_unknown_row_height (GtkListView *self,
 {
   g_return_val_if_fail (heights->len > 0, 0);
 
+  /* all rows get the size of the first one we measured */
+  if (self->homogeneous)
+    return self->homogeneous_height >= 0 ? self->homogeneous_height
+                                         : g_array_index (heights, int, 0);
+
   /* return the median and hope rows are generally uniform with few outliers */
   g_array_sort (heights, compare_ints);
 
   return g_array_index (heights, int, heights->len / 2);
 }
 
+/* Running totals of the rows we measured in one section. Sections
+ * often contain rows of a different kind than the rest of the list,
+ * so their unknown rows are estimated from their own rows first.
+ */
+typedef struct
+{
+  gint64 sum;
+  guint count;
+} SectionHeights;
+
+static int
+gtk_list_view_get_section_row_height (GtkListView *self,
+                                      GArray      *sections,
+                                      guint        section,
+                                      int          fallback)
+{
+  const SectionHeights *heights;
+
+  if (self->homogeneous)
+    return fallback;
+
+  heights = &g_array_index (sections, SectionHeights, section);
+  if (heights->count == 0)
+    return fallback;
+
+  return (heights->sum + heights->count / 2) / heights->count;
+}
+
 static void
 gtk_list_view_measure_across (GtkWidget      *widget,
                               GtkOrientation  orientation,
@@ -557,6 +591,11 @@ gtk_list_view_measure_list (GtkWidget      *widget,
             {
               g_array_append_val (min_heights, child_min);
               g_array_append_val (nat_heights, child_nat);
+              if (self->homogeneous)
+                {
+                  n_unknown += tile->n_items;
+                  continue;
+                }
             }
           min += child_min;
           nat += child_nat;
@@ -604,8 +643,9 @@ gtk_list_view_size_allocate (GtkWidget *widget,
 {
   GtkListView *self = GTK_LIST_VIEW (widget);
   GtkListTile *tile;
-  GArray *heights;
+  GArray *heights, *sections;
   int min, nat, row_height, y, list_width, spacing;
+  guint section;
   GtkOrientation orientation, opposite_orientation;
   GtkScrollablePolicy scroll_policy, opposite_scroll_policy;
 
@@ -637,11 +677,16 @@ gtk_list_view_size_allocate (GtkWidget *widget,
 
   /* step 2: determine height of known list items and gc the list */
   heights = g_array_new (FALSE, FALSE, sizeof (int));
+  sections = g_array_new (FALSE, TRUE, sizeof (SectionHeights));
+  g_array_set_size (sections, 1);
 
   for (;
        tile != NULL;
        tile = gtk_rb_tree_node_get_next (tile))
     {
+      if (gtk_list_tile_is_header (tile))
+        g_array_set_size (sections, sections->len + 1);
+
       if (tile->widget == NULL)
         continue;
 
@@ -654,30 +699,61 @@ gtk_list_view_size_allocate (GtkWidget *widget,
         row_height = nat;
       gtk_list_tile_set_area_size (self->item_manager, tile, list_width, row_height);
       if (tile->type == GTK_LIST_TILE_ITEM)
-        g_array_append_val (heights, row_height);
+        {
+          SectionHeights *section = &g_array_index (sections, SectionHeights, sections->len - 1);
+
+          /* Remember the first row, so the height of the
+           * rows doesn't depend on which ones are visible */
+          if (self->homogeneous &&
+              (self->homogeneous_height < 0 || self->homogeneous_width != list_width))
+            {
+              self->homogeneous_height = row_height;
+              self->homogeneous_width = list_width;
+            }
+
+          g_array_append_val (heights, row_height);
+          section->sum += row_height;
+          section->count++;
+        }
     }
 
-  /* step 3: determine height of unknown items and set the positions */
+  /* step 3: determine height of unknown items and set the positions.
+   * In homogeneous mode, known items get that height, too, unless
+   * they need more. */
   row_height = gtk_list_view_get_unknown_row_height (self, heights);
   g_array_free (heights, TRUE);
 
   y = 0;
+  section = 0;
   for (tile = gtk_list_item_manager_get_first (self->item_manager);
        tile != NULL;
        tile = gtk_rb_tree_node_get_next (tile))
     {
+      if (gtk_list_tile_is_header (tile))
+        section++;
+
       gtk_list_tile_set_area_position (self->item_manager, tile, 0, y);
-      if (tile->widget == NULL)
+      if (self->homogeneous && tile->widget != NULL && tile->type == GTK_LIST_TILE_ITEM)
+        {
+          gtk_list_tile_set_area_size (self->item_manager,
+                                       tile,
+                                       list_width,
+                                       MAX (tile->area.height, row_height));
+        }
+      else if (tile->widget == NULL)
         {
+          int tile_row_height = gtk_list_view_get_section_row_height (self, sections, section, row_height);
+
           gtk_list_tile_set_area_size (self->item_manager,
                                        tile,
                                        list_width,
-                                       row_height * tile->n_items
+                                       tile_row_height * tile->n_items
                                        + spacing * (tile->n_items - 1));
         }
 
       y += tile->area.height + spacing;
     }
+  g_array_free (sections, TRUE);
 
   /* step 4: allocate the rest */
   gtk_list_base_allocate (GTK_LIST_BASE (self));
@@ -762,6 +838,10 @@ gtk_list_view_get_property (GObject    *object,
       g_value_set_object (value, self->header_factory);
       break;
 
+    case PROP_HOMOGENEOUS:
+      g_value_set_boolean (value, self->homogeneous);
+      break;
+
     case PROP_MODEL:
       g_value_set_object (value, gtk_list_base_get_model (GTK_LIST_BASE (self)));
       break;
@@ -806,6 +886,10 @@ gtk_list_view_set_property (GObject      *object,
       gtk_list_view_set_header_factory (self, g_value_get_object (value));
       break;
 
+    case PROP_HOMOGENEOUS:
+      gtk_list_view_set_homogeneous (self, g_value_get_boolean (value));
+      break;
+
     case PROP_MODEL:
       gtk_list_view_set_model (self, g_value_get_object (value));
       break;
@@ -910,6 +994,18 @@ gtk_list_view_class_init (GtkListViewClass *klass)
                          GTK_TYPE_LIST_ITEM_FACTORY,
                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkListView:homogeneous:
+   *
+   * Whether all rows have the same height.
+   *
+   * Since: 4.20
+   */
+  properties[PROP_HOMOGENEOUS] =
+    g_param_spec_boolean ("homogeneous", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   /**
    * GtkListView:model:
    *
@@ -1007,6 +1103,8 @@ gtk_list_view_init (GtkListView *self)
                                         GTK_LIST_VIEW_MAX_LIST_ITEMS,
                                         GTK_LIST_VIEW_EXTRA_ITEMS);
 
+  self->homogeneous_height = -1;
+
   gtk_widget_add_css_class (GTK_WIDGET (self), "view");
 }
 
@@ -1083,6 +1181,8 @@ gtk_list_view_set_model (GtkListView       *self,
   if (!gtk_list_base_set_model (GTK_LIST_BASE (self), model))
     return;
 
+  self->homogeneous_height = -1;
+
   gtk_accessible_update_property (GTK_ACCESSIBLE (self),
                                   GTK_ACCESSIBLE_PROPERTY_MULTI_SELECTABLE, GTK_IS_MULTI_SELECTION (model),
                                   -1);
@@ -1123,6 +1223,7 @@ gtk_list_view_set_factory (GtkListView        *self,
   if (!g_set_object (&self->factory, factory))
     return;
 
+  self->homogeneous_height = -1;
   gtk_list_view_update_factories (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
@@ -1367,6 +1468,67 @@ gtk_list_view_get_tab_behavior (GtkListView *self)
   return gtk_list_base_get_tab_behavior (GTK_LIST_BASE (self));
 }
 
+/**
+ * gtk_list_view_set_homogeneous:
+ * @self: a listview
+ * @homogeneous: whether all rows have the same height
+ *
+ * Sets whether all rows should be given the same height.
+ *
+ * The listview only ever creates widgets for the rows close to
+ * the visible area and has to guess the height of all the others.
+ * When rows have different heights, that guess changes while
+ * scrolling, which can make the scrollbar jump around.
+ *
+ * When rows are homogeneous, the first row that gets a widget is
+ * measured once and every row gets its height, so the position of
+ * every row is known without creating it. This makes scrolling to
+ * arbitrary positions in big models exact and fast.
+ *
+ * The row is measured again when the width of the listview, its
+ * model or its factory change. Rows that need more space than the
+ * measured row still get it, but that moves the rows after them,
+ * so this should only be used when all rows have the same height.
+ *
+ * Headers are not affected by this setting.
+ *
+ * Since: 4.20
+ */
+void
+gtk_list_view_set_homogeneous (GtkListView *self,
+                               gboolean     homogeneous)
+{
+  g_return_if_fail (GTK_IS_LIST_VIEW (self));
+
+  if (self->homogeneous == homogeneous)
+    return;
+
+  self->homogeneous = homogeneous;
+  self->homogeneous_height = -1;
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_HOMOGENEOUS]);
+}
+
+/**
+ * gtk_list_view_get_homogeneous:
+ * @self: a listview
+ *
+ * Returns whether all rows are given the same height.
+ *
+ * Returns: true if the rows are homogeneous
+ *
+ * Since: 4.20
+ */
+gboolean
+gtk_list_view_get_homogeneous (GtkListView *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_VIEW (self), FALSE);
+
+  return self->homogeneous;
+}
+
 /**
  * gtk_list_view_scroll_to:
  * @self: a listview
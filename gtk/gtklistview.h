@@ -89,6 +89,12 @@ GDK_AVAILABLE_IN_4_12
 GtkListTabBehavior
                 gtk_list_view_get_tab_behavior                  (GtkListView            *self);
 
+GDK_AVAILABLE_IN_4_20
+void            gtk_list_view_set_homogeneous                   (GtkListView            *self,
+                                                                 gboolean                homogeneous);
+GDK_AVAILABLE_IN_4_20
+gboolean        gtk_list_view_get_homogeneous                   (GtkListView            *self);
+
 GDK_AVAILABLE_IN_4_12
 void            gtk_list_view_scroll_to                         (GtkListView            *self,
                                                                  guint                   pos,
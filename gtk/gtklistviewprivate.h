@@ -33,6 +33,10 @@ struct _GtkListView
   GtkListItemFactory *header_factory;
   gboolean show_separators;
   gboolean single_click_activate;
+  gboolean homogeneous;
+  /* height of the row that stands in for all rows, or -1 */
+  int homogeneous_height;
+  int homogeneous_width;
 };
 
 struct _GtkListViewClass
@@ -192,7 +192,7 @@ static const GdkDebugKey gtk_debug_keys[] = {
   { "layout", GTK_DEBUG_LAYOUT, "Information from layout managers" },
   { "builder-trace", GTK_DEBUG_BUILDER_TRACE, "Trace GtkBuilder operation" },
   { "builder-objects", GTK_DEBUG_BUILDER_OBJECTS, "Log unused GtkBuilder objects" },
-  { "no-css-cache", GTK_DEBUG_NO_CSS_CACHE, "Disable style property cache" },
+  { "no-css-cache", GTK_DEBUG_NO_CSS_CACHE, "Disable style property and theme caches" },
   { "interactive", GTK_DEBUG_INTERACTIVE, "Enable the GTK inspector" },
   { "touch-ui", GTK_DEBUG_TOUCHSCREEN, "Show touch ui elements for pointer events" },
   { "snapshot", GTK_DEBUG_SNAPSHOT, "Generate debug render nodes" },
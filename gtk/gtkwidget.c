@@ -1981,6 +1981,7 @@ gtk_widget_base_class_finalize (GtkWidgetClass *klass)
       g_slist_free_full (template_data->children, (GDestroyNotify)template_child_class_free);
 
       g_object_unref (template_data->scope);
+      gtk_builder_template_cache_free (template_data->cache);
 
       g_free (template_data);
     }
@@ -11303,6 +11304,10 @@ gtk_widget_init_template (GtkWidget *widget)
   if (template->scope)
     gtk_builder_set_scope (builder, template->scope);
 
+  if (template->cache == NULL)
+    template->cache = gtk_builder_template_cache_new ();
+  gtk_builder_set_template_cache (builder, template->cache);
+
   gtk_builder_set_current_object (builder, object);
 
   /* This will build the template XML as children to the widget instance, also it
@@ -11595,6 +11600,7 @@ gtk_widget_class_set_template_scope (GtkWidgetClass  *widget_class,
 
   /* Defensive, destroy any previously set data */
   g_set_object (&widget_class->priv->template->scope, scope);
+  g_clear_pointer (&widget_class->priv->template->cache, gtk_builder_template_cache_free);
 }
 
 /**
@@ -206,6 +206,7 @@ typedef struct
   GBytes *data;
   GSList *children;
   GtkBuilderScope *scope;
+  struct _GtkBuilderTemplateCache *cache;
 } GtkWidgetTemplate;
 
 struct _GtkWidgetClassPrivate
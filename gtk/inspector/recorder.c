@@ -225,6 +225,12 @@ struct _GtkInspectorRecorder
   gboolean record_events;
   gboolean stop_after_next_frame;
   gboolean dark;
+  gboolean limit_size;
+  guint max_size; /* in MB */
+
+  GHashTable *retained; /* render node or texture => Retained */
+  GQueue retained_frames;
+  gsize retained_size;
 
   GdkEventSequence *selected_sequence;
 
@@ -248,6 +254,8 @@ enum
   PROP_SELECTED_SEQUENCE,
   PROP_RECORD_EVENTS,
   PROP_DARK,
+  PROP_LIMIT_SIZE,
+  PROP_MAX_SIZE,
   LAST_PROP
 };
 
@@ -415,11 +423,356 @@ create_list_model_for_render_node_paintable (gpointer paintable,
   return create_list_model_for_render_node (node);
 }
 
+/* {{{ Size limit */
+
+/* Long recordings keep the render nodes of every frame alive,
+ * which quickly adds up. So we estimate how much memory the nodes
+ * use and, if the size of the recording is limited, discard the
+ * nodes of the oldest frames. The frames themselves stay in the
+ * list, so their timestamps can still be looked at.
+ *
+ * Consecutive frames share all the subtrees that did not change,
+ * so every node and texture is only counted once. The retained
+ * table counts how many frames or retained parent nodes refer to
+ * a node or texture.
+ */
+
+typedef struct
+{
+  gsize refs;
+  gsize size;
+} Retained;
+
+typedef void (* RenderNodeFunc) (GtkInspectorRecorder *recorder,
+                                 GskRenderNode        *node);
+
+static void
+foreach_render_node_child (GskRenderNode        *node,
+                           RenderNodeFunc        func,
+                           GtkInspectorRecorder *recorder)
+{
+  guint i;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    default:
+    case GSK_NOT_A_RENDER_NODE:
+      g_assert_not_reached ();
+      return;
+
+    case GSK_CAIRO_NODE:
+    case GSK_TEXT_NODE:
+    case GSK_TEXTURE_NODE:
+    case GSK_TEXTURE_SCALE_NODE:
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      func (recorder, gsk_transform_node_get_child (node));
+      break;
+
+    case GSK_OPACITY_NODE:
+      func (recorder, gsk_opacity_node_get_child (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      func (recorder, gsk_color_matrix_node_get_child (node));
+      break;
+
+    case GSK_BLUR_NODE:
+      func (recorder, gsk_blur_node_get_child (node));
+      break;
+
+    case GSK_REPEAT_NODE:
+      func (recorder, gsk_repeat_node_get_child (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      func (recorder, gsk_clip_node_get_child (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      func (recorder, gsk_rounded_clip_node_get_child (node));
+      break;
+
+    case GSK_FILL_NODE:
+      func (recorder, gsk_fill_node_get_child (node));
+      break;
+
+    case GSK_STROKE_NODE:
+      func (recorder, gsk_stroke_node_get_child (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      func (recorder, gsk_shadow_node_get_child (node));
+      break;
+
+    case GSK_BLEND_NODE:
+      func (recorder, gsk_blend_node_get_bottom_child (node));
+      func (recorder, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_MASK_NODE:
+      func (recorder, gsk_mask_node_get_source (node));
+      func (recorder, gsk_mask_node_get_mask (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      func (recorder, gsk_cross_fade_node_get_start_child (node));
+      func (recorder, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+    case GSK_GL_SHADER_NODE:
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+      for (i = 0; i < gsk_gl_shader_node_get_n_children (node); i++)
+        func (recorder, gsk_gl_shader_node_get_child (node, i));
+G_GNUC_END_IGNORE_DEPRECATIONS
+      break;
+
+    case GSK_CONTAINER_NODE:
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        func (recorder, gsk_container_node_get_child (node, i));
+      break;
+
+    case GSK_DEBUG_NODE:
+      func (recorder, gsk_debug_node_get_child (node));
+      break;
+
+    case GSK_SUBSURFACE_NODE:
+      func (recorder, gsk_subsurface_node_get_child (node));
+      break;
+    }
+}
+
+static GdkTexture *
+get_render_node_texture (GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_TEXTURE_NODE:
+      return gsk_texture_node_get_texture (node);
+
+    case GSK_TEXTURE_SCALE_NODE:
+      return gsk_texture_scale_node_get_texture (node);
+
+    default:
+      return NULL;
+    }
+}
+
+/* Estimates the memory used by the node itself, without
+ * its children and textures */
+static gsize
+estimate_render_node_size (GskRenderNode *node)
+{
+  static gsize instance_sizes[GSK_RENDER_NODE_TYPE_N_TYPES];
+  GskRenderNodeType type;
+  gsize size;
+
+  type = gsk_render_node_get_node_type (node);
+
+  if (instance_sizes[type] == 0)
+    {
+      GTypeQuery query;
+
+      g_type_query (G_TYPE_FROM_INSTANCE (node), &query);
+      instance_sizes[type] = query.instance_size;
+    }
+
+  size = instance_sizes[type];
+
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      size += gsk_container_node_get_n_children (node) * sizeof (GskRenderNode *);
+      break;
+
+    case GSK_TEXT_NODE:
+      size += gsk_text_node_get_num_glyphs (node) * sizeof (PangoGlyphInfo);
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      size += gsk_linear_gradient_node_get_n_color_stops (node) * sizeof (GskColorStop);
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      size += gsk_radial_gradient_node_get_n_color_stops (node) * sizeof (GskColorStop);
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      size += gsk_conic_gradient_node_get_n_color_stops (node) * sizeof (GskColorStop);
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = gsk_cairo_node_get_surface (node);
+
+        if (surface && cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE)
+          size += cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface);
+      }
+      break;
+
+    default:
+      break;
+    }
+
+  return size;
+}
+
+/* Returns TRUE if @object was not retained before */
+static gboolean
+retain_object (GtkInspectorRecorder *recorder,
+               gpointer              object)
+{
+  Retained *retained;
+
+  retained = g_hash_table_lookup (recorder->retained, object);
+  if (retained)
+    {
+      retained->refs++;
+      return FALSE;
+    }
+
+  retained = g_new (Retained, 1);
+  retained->refs = 1;
+  retained->size = 0;
+  g_hash_table_insert (recorder->retained, object, retained);
+
+  return TRUE;
+}
+
+static void
+set_retained_size (GtkInspectorRecorder *recorder,
+                   gpointer              object,
+                   gsize                 size)
+{
+  Retained *retained = g_hash_table_lookup (recorder->retained, object);
+
+  retained->size = size;
+  recorder->retained_size += size;
+}
+
+/* Returns TRUE if @object is no longer retained */
+static gboolean
+release_object (GtkInspectorRecorder *recorder,
+                gpointer              object)
+{
+  Retained *retained;
+
+  retained = g_hash_table_lookup (recorder->retained, object);
+  g_assert (retained != NULL);
+
+  retained->refs--;
+  if (retained->refs > 0)
+    return FALSE;
+
+  recorder->retained_size -= retained->size;
+  g_hash_table_remove (recorder->retained, object);
+
+  return TRUE;
+}
+
+static void
+retain_render_node (GtkInspectorRecorder *recorder,
+                    GskRenderNode        *node)
+{
+  GdkTexture *texture;
+
+  if (!retain_object (recorder, node))
+    return;
+
+  set_retained_size (recorder, node, estimate_render_node_size (node));
+
+  texture = get_render_node_texture (node);
+  if (texture && retain_object (recorder, texture))
+    set_retained_size (recorder, texture,
+                       (gsize) gdk_texture_get_width (texture) * gdk_texture_get_height (texture) * 4);
+
+  foreach_render_node_child (node, retain_render_node, recorder);
+}
+
+static void
+release_render_node (GtkInspectorRecorder *recorder,
+                     GskRenderNode        *node)
+{
+  GdkTexture *texture;
+
+  if (!release_object (recorder, node))
+    return;
+
+  texture = get_render_node_texture (node);
+  if (texture)
+    release_object (recorder, texture);
+
+  foreach_render_node_child (node, release_render_node, recorder);
+}
+
+static void
+gtk_inspector_recorder_retain_frame (GtkInspectorRecorder        *recorder,
+                                     GtkInspectorRenderRecording *recording)
+{
+  gsize size_before = recorder->retained_size;
+
+  retain_render_node (recorder, gtk_inspector_render_recording_get_node (recording));
+  gtk_inspector_render_recording_set_size (recording, recorder->retained_size - size_before);
+
+  g_queue_push_tail (&recorder->retained_frames, g_object_ref (recording));
+}
+
+static void
+gtk_inspector_recorder_discard_old_frames (GtkInspectorRecorder *recorder)
+{
+  gsize max_size = (gsize) recorder->max_size * 1024 * 1024;
+
+  if (!recorder->limit_size)
+    return;
+
+  /* Always keep the latest frame */
+  while (recorder->retained_size > max_size &&
+         g_queue_get_length (&recorder->retained_frames) > 1)
+    {
+      GtkInspectorRenderRecording *recording;
+      guint position;
+
+      recording = g_queue_pop_head (&recorder->retained_frames);
+
+      release_render_node (recorder, gtk_inspector_render_recording_get_node (recording));
+      gtk_inspector_render_recording_discard_node (recording);
+
+      /* Update the row */
+      if (g_list_store_find (G_LIST_STORE (recorder->recordings), recording, &position))
+        g_list_store_splice (G_LIST_STORE (recorder->recordings), position, 1, (gpointer[1]) { recording }, 1);
+
+      g_object_unref (recording);
+    }
+}
+
+static void
+gtk_inspector_recorder_clear_retained (GtkInspectorRecorder *recorder)
+{
+  g_queue_clear_full (&recorder->retained_frames, g_object_unref);
+  g_hash_table_remove_all (recorder->retained);
+  recorder->retained_size = 0;
+}
+
+/* }}} */
+
 static void
 recordings_clear_all (GtkButton            *button,
                       GtkInspectorRecorder *recorder)
 {
   g_list_store_remove_all (G_LIST_STORE (recorder->recordings));
+  gtk_inspector_recorder_clear_retained (recorder);
 }
 
 static const char *
@@ -813,7 +1166,15 @@ recording_selected (GtkSingleSelection   *selection,
       gtk_stack_set_visible_child_name (GTK_STACK (recorder->recording_data_stack), "frame_data");
 
       node = gtk_inspector_render_recording_get_node (GTK_INSPECTOR_RENDER_RECORDING (recording));
-      show_render_node (recorder, node);
+      if (node)
+        {
+          show_render_node (recorder, node);
+        }
+      else
+        {
+          gtk_picture_set_paintable (GTK_PICTURE (recorder->render_node_view), NULL);
+          g_list_store_remove_all (recorder->render_node_root_model);
+        }
     }
   else if (GTK_INSPECTOR_IS_EVENT_RECORDING (recording))
     {
@@ -2365,11 +2726,25 @@ bind_widget_for_recording (GtkListItemFactory *factory,
 
   gtk_label_set_use_markup (GTK_LABEL (label), FALSE);
 
+  gtk_widget_set_tooltip_text (row, NULL);
+
   if (GTK_INSPECTOR_IS_RENDER_RECORDING (recording))
     {
-      gtk_label_set_label (GTK_LABEL (label), "Frame");
+      GtkInspectorRenderRecording *render_recording = GTK_INSPECTOR_RENDER_RECORDING (recording);
+      char *size;
+
+      if (gtk_inspector_render_recording_get_node (render_recording))
+        gtk_label_set_label (GTK_LABEL (label), "Frame");
+      else
+        gtk_label_set_label (GTK_LABEL (label), "Frame (discarded)");
       gtk_label_set_use_markup (GTK_LABEL (label), FALSE);
 
+      size = g_format_size (gtk_inspector_render_recording_get_size (render_recording));
+      text = g_strdup_printf ("New render nodes: %s", size);
+      gtk_widget_set_tooltip_text (row, text);
+      g_free (text);
+      g_free (size);
+
       text = g_strdup_printf ("%.3f", gtk_inspector_recording_get_timestamp (recording) / 1000.0);
       gtk_label_set_label (GTK_LABEL (label2), text);
       g_free (text);
@@ -2455,6 +2830,14 @@ gtk_inspector_recorder_get_property (GObject    *object,
       g_value_set_boolean (value, recorder->dark);
       break;
 
+    case PROP_LIMIT_SIZE:
+      g_value_set_boolean (value, recorder->limit_size);
+      break;
+
+    case PROP_MAX_SIZE:
+      g_value_set_uint (value, recorder->max_size);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -2495,6 +2878,16 @@ gtk_inspector_recorder_set_property (GObject      *object,
       recorder_set_dark (recorder, g_value_get_boolean (value));
       break;
 
+    case PROP_LIMIT_SIZE:
+      recorder->limit_size = g_value_get_boolean (value);
+      gtk_inspector_recorder_discard_old_frames (recorder);
+      break;
+
+    case PROP_MAX_SIZE:
+      recorder->max_size = g_value_get_uint (value);
+      gtk_inspector_recorder_discard_old_frames (recorder);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -2515,6 +2908,9 @@ gtk_inspector_recorder_dispose (GObject *object)
 
   g_clear_object (&recorder->settings);
 
+  g_queue_clear_full (&recorder->retained_frames, g_object_unref);
+  g_clear_pointer (&recorder->retained, g_hash_table_unref);
+
   G_OBJECT_CLASS (gtk_inspector_recorder_parent_class)->dispose (object);
 }
 
@@ -2534,6 +2930,8 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
   props[PROP_HIGHLIGHT_SEQUENCES] = g_param_spec_boolean ("highlight-sequences", NULL, NULL, FALSE, G_PARAM_READWRITE);
   props[PROP_SELECTED_SEQUENCE] = g_param_spec_pointer ("selected-sequence", NULL, NULL, G_PARAM_READWRITE);
   props[PROP_DARK] = g_param_spec_boolean ("dark", NULL, NULL, FALSE, G_PARAM_READWRITE);
+  props[PROP_LIMIT_SIZE] = g_param_spec_boolean ("limit-size", NULL, NULL, FALSE, G_PARAM_READWRITE);
+  props[PROP_MAX_SIZE] = g_param_spec_uint ("max-size", NULL, NULL, 1, G_MAXUINT, 256, G_PARAM_READWRITE);
 
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
@@ -2541,6 +2939,7 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
   gtk_widget_class_install_property_action (widget_class, "record.debug-nodes", "debug-nodes");
   gtk_widget_class_install_property_action (widget_class, "record.highlight-sequences", "highlight-sequences");
   gtk_widget_class_install_property_action (widget_class, "record.toggle-dark", "dark");
+  gtk_widget_class_install_property_action (widget_class, "record.limit-size", "limit-size");
 
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/recorder.ui");
 
@@ -2574,6 +2973,8 @@ gtk_inspector_recorder_init (GtkInspectorRecorder *recorder)
   GSettingsSchema *schema;
 
   recorder->record_events = TRUE;
+  recorder->max_size = 256;
+  recorder->retained = g_hash_table_new_full (NULL, NULL, NULL, g_free);
 
   gtk_widget_init_template (GTK_WIDGET (recorder));
 
@@ -2662,6 +3063,8 @@ gtk_inspector_recorder_init (GtkInspectorRecorder *recorder)
       g_settings_bind (recorder->settings, "record-events", recorder, "record-events", G_SETTINGS_BIND_DEFAULT);
      g_settings_bind (recorder->settings, "highlight-sequences", recorder, "highlight-sequences", G_SETTINGS_BIND_DEFAULT);
      g_settings_bind (recorder->settings, "dark", recorder, "dark", G_SETTINGS_BIND_DEFAULT);
+     g_settings_bind (recorder->settings, "limit-size", recorder, "limit-size", G_SETTINGS_BIND_DEFAULT);
+     g_settings_bind (recorder->settings, "max-size", recorder, "max-size", G_SETTINGS_BIND_DEFAULT);
 
      g_settings_schema_unref (schema);
    }
@@ -2756,6 +3159,8 @@ gtk_inspector_recorder_record_render (GtkInspectorRecorder *recorder,
                                                   node,
                                                   surface);
   gtk_inspector_recorder_add_recording (recorder, recording);
+  gtk_inspector_recorder_retain_frame (recorder, GTK_INSPECTOR_RENDER_RECORDING (recording));
+  gtk_inspector_recorder_discard_old_frames (recorder);
   g_object_unref (recording);
 
   if (recorder->stop_after_next_frame)
@@ -91,4 +91,26 @@ gtk_inspector_render_recording_get_surface (GtkInspectorRenderRecording *recordi
   return recording->surface;
 }
 
+/* The estimated size of the render nodes that were
+ * first used in this frame */
+gsize
+gtk_inspector_render_recording_get_size (GtkInspectorRenderRecording *recording)
+{
+  return recording->size;
+}
+
+void
+gtk_inspector_render_recording_set_size (GtkInspectorRenderRecording *recording,
+                                         gsize                        size)
+{
+  recording->size = size;
+}
+
+/* Frees the render nodes, but keeps the recording around */
+void
+gtk_inspector_render_recording_discard_node (GtkInspectorRenderRecording *recording)
+{
+  g_clear_pointer (&recording->node, gsk_render_node_unref);
+}
+
 // vim: set et sw=2 ts=2:
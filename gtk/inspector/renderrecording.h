@@ -42,6 +42,7 @@ typedef struct _GtkInspectorRenderRecording
   cairo_region_t *clip_region;
   GskRenderNode *node;
   gpointer surface;
+  gsize size;
 } GtkInspectorRenderRecording;
 
 typedef struct _GtkInspectorRenderRecordingClass
@@ -67,6 +68,11 @@ const cairo_rectangle_int_t *
 gpointer
                 gtk_inspector_render_recording_get_surface   (GtkInspectorRenderRecording       *recording);
 
+gsize           gtk_inspector_render_recording_get_size      (GtkInspectorRenderRecording       *recording);
+void            gtk_inspector_render_recording_set_size      (GtkInspectorRenderRecording       *recording,
+                                                              gsize                              size);
+void            gtk_inspector_render_recording_discard_node  (GtkInspectorRenderRecording       *recording);
+
 G_END_DECLS
 
 
@@ -0,0 +1,204 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Changes a small part of a big image every frame, either as a
+ * texture that is built as an update of the previous one, or by
+ * redrawing a drawing area.
+ *
+ * Run with GDK_BACKEND=broadway under a profiler to see how many
+ * bytes are sent per frame ("broadway texture bytes" counter) and
+ * how long encoding takes ("Upload texture" marks).
+ */
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "frame-stats.h"
+
+#define SIZE 1024
+#define SPOT 32
+
+static gboolean use_cairo = FALSE;
+
+static GOptionEntry options[] = {
+  { "cairo", 'c', 0, G_OPTION_ARG_NONE, &use_cairo, "Redraw a drawing area instead of updating a texture", NULL },
+  { NULL }
+};
+
+static guchar *pixels;
+static GdkTexture *texture;
+static guint frame;
+
+static void
+get_spot (guint                  n,
+          cairo_rectangle_int_t *spot)
+{
+  spot->x = (n * 7 * SPOT) % (SIZE - SPOT);
+  spot->y = (n * 3 * SPOT) % (SIZE - SPOT);
+  spot->width = SPOT;
+  spot->height = SPOT;
+}
+
+static void
+fill_background (void)
+{
+  int x, y;
+
+  pixels = g_malloc (SIZE * SIZE * 4);
+  for (y = 0; y < SIZE; y++)
+    for (x = 0; x < SIZE; x++)
+      {
+        guchar *p = pixels + (y * SIZE + x) * 4;
+
+        p[0] = x / 4;
+        p[1] = y / 4;
+        p[2] = (x ^ y) & 0xff;
+        p[3] = 0xff;
+      }
+}
+
+static void
+update_texture (GtkPicture *picture)
+{
+  GdkMemoryTextureBuilder *builder;
+  cairo_rectangle_int_t spot;
+  cairo_region_t *region;
+  GdkTexture *updated;
+  GBytes *bytes;
+  int y;
+
+  get_spot (frame, &spot);
+  for (y = spot.y; y < spot.y + spot.height; y++)
+    memset (pixels + (y * SIZE + spot.x) * 4, (frame * 37) & 0xff, spot.width * 4);
+
+  bytes = g_bytes_new (pixels, SIZE * SIZE * 4);
+  region = cairo_region_create_rectangle (&spot);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_width (builder, SIZE);
+  gdk_memory_texture_builder_set_height (builder, SIZE);
+  gdk_memory_texture_builder_set_stride (builder, SIZE * 4);
+  gdk_memory_texture_builder_set_format (builder, GDK_MEMORY_R8G8B8A8);
+  gdk_memory_texture_builder_set_update_texture (builder, texture);
+  gdk_memory_texture_builder_set_update_region (builder, region);
+  updated = gdk_memory_texture_builder_build (builder);
+
+  gtk_picture_set_paintable (picture, GDK_PAINTABLE (updated));
+  g_set_object (&texture, updated);
+
+  g_object_unref (updated);
+  g_object_unref (builder);
+  cairo_region_destroy (region);
+  g_bytes_unref (bytes);
+}
+
+static void
+draw_func (GtkDrawingArea *area,
+           cairo_t        *cr,
+           int             width,
+           int             height,
+           gpointer        data)
+{
+  cairo_rectangle_int_t spot;
+  cairo_pattern_t *pattern;
+  guint i;
+
+  pattern = cairo_pattern_create_linear (0, 0, width, height);
+  cairo_pattern_add_color_stop_rgb (pattern, 0, 0, 0.5, 1);
+  cairo_pattern_add_color_stop_rgb (pattern, 1, 1, 0.5, 0);
+  cairo_set_source (cr, pattern);
+  cairo_paint (cr);
+  cairo_pattern_destroy (pattern);
+
+  for (i = frame > 64 ? frame - 64 : 0; i <= frame; i++)
+    {
+      get_spot (i, &spot);
+      cairo_set_source_rgb (cr, ((i * 37) & 0xff) / 255., 0, 0);
+      cairo_rectangle (cr, spot.x, spot.y, spot.width, spot.height);
+      cairo_fill (cr);
+    }
+}
+
+static gboolean
+tick_cb (GtkWidget     *widget,
+         GdkFrameClock *frame_clock,
+         gpointer       user_data)
+{
+  frame++;
+
+  if (GTK_IS_PICTURE (widget))
+    update_texture (GTK_PICTURE (widget));
+  else
+    gtk_widget_queue_draw (widget);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+quit_cb (GtkWidget *widget,
+         gpointer   data)
+{
+  gboolean *done = data;
+
+  *done = TRUE;
+
+  g_main_context_wakeup (NULL);
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window, *widget;
+  GError *error = NULL;
+  gboolean done = FALSE;
+  GBytes *bytes;
+
+  GOptionContext *context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  frame_stats_add_options (g_option_context_get_main_group (context));
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+
+  gtk_init ();
+
+  fill_background ();
+  bytes = g_bytes_new (pixels, SIZE * SIZE * 4);
+  texture = gdk_memory_texture_new (SIZE, SIZE, GDK_MEMORY_R8G8B8A8, bytes, SIZE * 4);
+  g_bytes_unref (bytes);
+
+  window = gtk_window_new ();
+  frame_stats_ensure (GTK_WINDOW (window));
+  gtk_window_set_default_size (GTK_WINDOW (window), SIZE, SIZE);
+
+  if (use_cairo)
+    {
+      widget = gtk_drawing_area_new ();
+      gtk_drawing_area_set_content_width (GTK_DRAWING_AREA (widget), SIZE);
+      gtk_drawing_area_set_content_height (GTK_DRAWING_AREA (widget), SIZE);
+      gtk_drawing_area_set_draw_func (GTK_DRAWING_AREA (widget), draw_func, NULL, NULL);
+    }
+  else
+    {
+      widget = gtk_picture_new_for_paintable (GDK_PAINTABLE (texture));
+      gtk_picture_set_content_fit (GTK_PICTURE (widget), GTK_CONTENT_FIT_FILL);
+    }
+
+  gtk_window_set_child (GTK_WINDOW (window), widget);
+  gtk_widget_add_tick_callback (widget, tick_cb, NULL, NULL);
+
+  gtk_window_present (GTK_WINDOW (window));
+  g_signal_connect (window, "destroy",
+                    G_CALLBACK (quit_cb), &done);
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_object_unref (texture);
+  g_free (pixels);
+
+  return 0;
+}
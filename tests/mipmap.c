@@ -0,0 +1,72 @@
+#include <gtk/gtk.h>
+#include "gdk/gdkmemoryformatprivate.h"
+
+static void
+fill_with_random_data (guchar *data, gsize size)
+{
+  for (gsize i = 0; i < size; i++)
+    data[i] = g_random_int_range (0, 256);
+}
+
+int
+main (int argc, char *argv[])
+{
+  const GdkMemoryFormat formats[] = {
+    GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
+    GDK_MEMORY_R8G8B8A8,
+    GDK_MEMORY_R8G8B8,
+    GDK_MEMORY_R16G16B16A16_FLOAT_PREMULTIPLIED,
+  };
+  GEnumClass *enum_class;
+  int rounds = 10;
+
+  gtk_init ();
+
+  enum_class = g_type_class_ref (GDK_TYPE_MEMORY_FORMAT);
+
+  for (gsize f = 0; f < G_N_ELEMENTS (formats); f++)
+    {
+      for (guint lod_level = 1; lod_level <= 4; lod_level++)
+        {
+          for (gsize size = 256; size <= 4096; size *= 2)
+            {
+              guchar *src_data;
+              guchar *dst_data;
+              GdkMemoryLayout src_layout;
+              GdkMemoryLayout dst_layout;
+              guint64 elapsed;
+
+              gdk_memory_layout_init (&src_layout, formats[f], size, size, 1);
+              src_data = g_malloc (src_layout.size);
+              fill_with_random_data (src_data, src_layout.size);
+              gdk_memory_layout_init (&dst_layout, formats[f], size >> lod_level, size >> lod_level, 1);
+              dst_data = g_malloc (dst_layout.size);
+
+              elapsed = 0;
+              for (int k = 0; k < rounds; k++)
+                {
+                  guint64 before = g_get_monotonic_time ();
+                  gdk_memory_mipmap (dst_data,
+                                     &dst_layout,
+                                     src_data,
+                                     &src_layout,
+                                     lod_level,
+                                     TRUE);
+                  elapsed += g_get_monotonic_time () - before;
+                }
+
+              g_print ("%s, %u, %zu, %zu, %f\n",
+                       g_enum_get_value (enum_class, formats[f])->value_nick,
+                       lod_level, size, size,
+                       ((double)(elapsed / rounds)) / 1000.0);
+
+              g_free (src_data);
+              g_free (dst_data);
+            }
+        }
+    }
+
+  g_type_class_unref (enum_class);
+
+  return 0;
+}
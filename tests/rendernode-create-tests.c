@@ -520,6 +520,102 @@ box_shadows (guint n)
   return container;
 }
 
+static GskPath *
+random_path (graphene_rect_t *bounds)
+{
+  GskPathBuilder *builder;
+  float x, y, w, h;
+  guint i;
+
+  w = g_random_int_range (20, 100);
+  h = g_random_int_range (20, 100);
+  x = g_random_int_range (0, 1000 - w);
+  y = g_random_int_range (0, 1000 - h);
+  *bounds = GRAPHENE_RECT_INIT (x, y, w, h);
+
+  builder = gsk_path_builder_new ();
+  gsk_path_builder_move_to (builder, x + g_random_double () * w, y + g_random_double () * h);
+  for (i = 0; i < 3; i++)
+    {
+      if (g_random_boolean ())
+        gsk_path_builder_cubic_to (builder,
+                                   x + g_random_double () * w, y + g_random_double () * h,
+                                   x + g_random_double () * w, y + g_random_double () * h,
+                                   x + g_random_double () * w, y + g_random_double () * h);
+      else
+        gsk_path_builder_line_to (builder, x + g_random_double () * w, y + g_random_double () * h);
+    }
+  gsk_path_builder_close (builder);
+
+  return gsk_path_builder_free_to_path (builder);
+}
+
+static GskRenderNode *
+fills (guint n)
+{
+  GskRenderNode **nodes = g_new (GskRenderNode *, n);
+  GskRenderNode *container, *color_node;
+  graphene_rect_t bounds;
+  GskPath *path;
+  GdkRGBA color;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    {
+      path = random_path (&bounds);
+      hsv_to_rgb (&color, g_random_double (), g_random_double_range (0.15, 0.4), g_random_double_range (0.6, 0.85));
+      color_node = gsk_color_node_new (&color, &bounds);
+      nodes[i] = gsk_fill_node_new (color_node,
+                                    path,
+                                    g_random_boolean () ? GSK_FILL_RULE_WINDING : GSK_FILL_RULE_EVEN_ODD);
+      gsk_render_node_unref (color_node);
+      gsk_path_unref (path);
+    }
+
+  container = gsk_container_node_new (nodes, n);
+
+  for (i = 0; i < n; i++)
+    gsk_render_node_unref (nodes[i]);
+  g_free (nodes);
+
+  return container;
+}
+
+static GskRenderNode *
+strokes (guint n)
+{
+  GskRenderNode **nodes = g_new (GskRenderNode *, n);
+  GskRenderNode *container, *color_node;
+  graphene_rect_t bounds;
+  GskStroke *stroke;
+  GskPath *path;
+  GdkRGBA color;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    {
+      path = random_path (&bounds);
+      stroke = gsk_stroke_new (g_random_double_range (1.0, 8.0));
+      gsk_stroke_set_line_join (stroke, g_random_int_range (GSK_LINE_JOIN_MITER, GSK_LINE_JOIN_BEVEL + 1));
+      gsk_stroke_set_line_cap (stroke, g_random_int_range (GSK_LINE_CAP_BUTT, GSK_LINE_CAP_SQUARE + 1));
+      graphene_rect_inset (&bounds, -8, -8);
+      hsv_to_rgb (&color, g_random_double (), g_random_double_range (0.15, 0.4), g_random_double_range (0.6, 0.85));
+      color_node = gsk_color_node_new (&color, &bounds);
+      nodes[i] = gsk_stroke_node_new (color_node, path, stroke);
+      gsk_render_node_unref (color_node);
+      gsk_stroke_free (stroke);
+      gsk_path_unref (path);
+    }
+
+  container = gsk_container_node_new (nodes, n);
+
+  for (i = 0; i < n; i++)
+    gsk_render_node_unref (nodes[i]);
+  g_free (nodes);
+
+  return container;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -536,6 +632,8 @@ main (int argc, char **argv)
     { "borders.node", borders },
     { "text.node", text },
     { "box-shadows.node", box_shadows },
+    { "fills.node", fills },
+    { "strokes.node", strokes },
   };
   GError *error = NULL;
   GskRenderNode *node;
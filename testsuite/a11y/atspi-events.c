@@ -0,0 +1,328 @@
+#include <gtk/gtk.h>
+#include "gtk/a11y/gtkatspirootprivate.h"
+#include "gtk/a11y/gtkatspiutilsprivate.h"
+
+/* Checks the events that GtkAtSpiRoot emits for its event queue,
+ * using a private bus.
+ */
+
+#define PATH_A "/org/gtk/test/a11y/a"
+#define PATH_B "/org/gtk/test/a11y/b"
+
+typedef struct
+{
+  GTestDBus *bus;
+  GtkAtSpiRoot *root;
+  GDBusConnection *listener;
+  guint subscription;
+  GPtrArray *received;
+  gboolean done;
+} Fixture;
+
+static void
+on_signal (GDBusConnection *connection,
+           const char      *sender_name,
+           const char      *object_path,
+           const char      *interface_name,
+           const char      *signal_name,
+           GVariant        *parameters,
+           gpointer         data)
+{
+  Fixture *fixture = data;
+  const char *detail;
+  int detail1;
+
+  if (strcmp (signal_name, "Done") == 0)
+    {
+      fixture->done = TRUE;
+      return;
+    }
+
+  g_variant_get (parameters, "(&siiva{sv})", &detail, &detail1, NULL, NULL, NULL);
+  g_ptr_array_add (fixture->received,
+                   g_strdup_printf ("%s %s %s %d",
+                                    strrchr (object_path, '/') + 1,
+                                    signal_name,
+                                    detail,
+                                    detail1));
+}
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+  GError *error = NULL;
+  char *dbus_daemon;
+  GVariant *result;
+
+  dbus_daemon = g_find_program_in_path ("dbus-daemon");
+  if (dbus_daemon == NULL)
+    return;
+  g_free (dbus_daemon);
+
+  fixture->bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (fixture->bus);
+
+  fixture->root = gtk_at_spi_root_new (g_test_dbus_get_bus_address (fixture->bus));
+
+  fixture->listener = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (fixture->bus),
+                                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                              G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                              NULL, NULL,
+                                                              &error);
+  g_assert_no_error (error);
+
+  fixture->received = g_ptr_array_new_with_free_func (g_free);
+  fixture->subscription = g_dbus_connection_signal_subscribe (fixture->listener,
+                                                              NULL,
+                                                              "org.a11y.atspi.Event.Object",
+                                                              NULL,
+                                                              NULL,
+                                                              NULL,
+                                                              G_DBUS_SIGNAL_FLAGS_NONE,
+                                                              on_signal,
+                                                              fixture,
+                                                              NULL);
+
+  /* Make sure the match rule is in place before anything is emitted */
+  result = g_dbus_connection_call_sync (fixture->listener,
+                                        "org.freedesktop.DBus",
+                                        "/org/freedesktop/DBus",
+                                        "org.freedesktop.DBus",
+                                        "GetId",
+                                        NULL, NULL,
+                                        G_DBUS_CALL_FLAGS_NONE,
+                                        -1, NULL,
+                                        &error);
+  g_assert_no_error (error);
+  g_variant_unref (result);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+  if (fixture->bus == NULL)
+    return;
+
+  g_dbus_connection_signal_unsubscribe (fixture->listener, fixture->subscription);
+  g_ptr_array_unref (fixture->received);
+  g_dbus_connection_close_sync (fixture->listener, NULL, NULL);
+  g_object_unref (fixture->listener);
+  g_object_unref (fixture->root);
+  g_test_dbus_down (fixture->bus);
+  g_object_unref (fixture->bus);
+}
+
+static void
+queue_value (Fixture    *fixture,
+             const char *path,
+             const char *member,
+             const char *detail,
+             int         value)
+{
+  gtk_at_spi_root_queue_event (fixture->root, NULL, path,
+                               "org.a11y.atspi.Event.Object",
+                               member,
+                               detail,
+                               g_variant_new ("(siiva{sv})",
+                                              detail, value, 0,
+                                              g_variant_new_int32 (value),
+                                              NULL));
+}
+
+static void
+queue_children_changed (Fixture                 *fixture,
+                        GtkAccessibleChildState  state,
+                        int                      idx)
+{
+  gtk_at_spi_root_queue_children_changed (fixture->root, NULL, PATH_A,
+                                          state, idx,
+                                          gtk_at_spi_null_ref ());
+}
+
+/* Returns everything that was received from @connection */
+static char *
+collect (Fixture         *fixture,
+         GDBusConnection *connection)
+{
+  char *result;
+
+  /* Signals from one connection arrive in order, so once
+   * this one is here, we have seen everything before it
+   */
+  g_dbus_connection_emit_signal (connection,
+                                 NULL,
+                                 "/org/gtk/test/a11y",
+                                 "org.a11y.atspi.Event.Object",
+                                 "Done",
+                                 NULL,
+                                 NULL);
+
+  fixture->done = FALSE;
+  while (!fixture->done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_ptr_array_add (fixture->received, NULL);
+  result = g_strjoinv (", ", (char **) fixture->received->pdata);
+  g_ptr_array_set_size (fixture->received, 0);
+
+  return result;
+}
+
+/* Flushes the queue and returns everything that was received */
+static char *
+flush (Fixture *fixture)
+{
+  gtk_at_spi_root_flush_events (fixture->root);
+
+  return collect (fixture, gtk_at_spi_root_get_connection (fixture->root));
+}
+
+static void
+test_coalesce (Fixture       *fixture,
+               gconstpointer  data)
+{
+  char *result;
+
+  if (fixture->bus == NULL)
+    {
+      g_test_skip ("dbus-daemon not available");
+      return;
+    }
+
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 1);
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 2);
+  queue_value (fixture, PATH_B, "StateChanged", "focused", 1);
+  queue_value (fixture, PATH_B, "StateChanged", "focused", 0);
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 3);
+
+  result = flush (fixture);
+  g_assert_cmpstr (result, ==, "b StateChanged focused 0, "
+                               "a PropertyChange accessible-name 3");
+  g_free (result);
+}
+
+static void
+test_keep_order (Fixture       *fixture,
+                 gconstpointer  data)
+{
+  char *result;
+
+  if (fixture->bus == NULL)
+    {
+      g_test_skip ("dbus-daemon not available");
+      return;
+    }
+
+  /* The second name change can't replace the first one,
+   * because the state change happened in between
+   */
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 1);
+  queue_value (fixture, PATH_A, "StateChanged", "checked", 1);
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 2);
+
+  result = flush (fixture);
+  g_assert_cmpstr (result, ==, "a PropertyChange accessible-name 1, "
+                               "a StateChanged checked 1, "
+                               "a PropertyChange accessible-name 2");
+  g_free (result);
+}
+
+static void
+test_children_changed (Fixture       *fixture,
+                       gconstpointer  data)
+{
+  char *result;
+
+  if (fixture->bus == NULL)
+    {
+      g_test_skip ("dbus-daemon not available");
+      return;
+    }
+
+  /* A few changes are emitted as they are */
+  queue_children_changed (fixture, GTK_ACCESSIBLE_CHILD_STATE_ADDED, 0);
+  queue_children_changed (fixture, GTK_ACCESSIBLE_CHILD_STATE_REMOVED, 1);
+
+  result = flush (fixture);
+  g_assert_cmpstr (result, ==, "a ChildrenChanged add 0, "
+                               "a ChildrenChanged remove 1");
+  g_free (result);
+}
+
+static void
+test_children_changed_collapse (Fixture       *fixture,
+                                gconstpointer  data)
+{
+  char *result;
+
+  if (fixture->bus == NULL)
+    {
+      g_test_skip ("dbus-daemon not available");
+      return;
+    }
+
+  /* Many changes are collapsed, but keep their kind. They are
+   * emitted where the last one was queued, after the name change
+   * that happened while the children changed
+   */
+  for (int i = 0; i < 20; i++)
+    queue_children_changed (fixture, GTK_ACCESSIBLE_CHILD_STATE_REMOVED, 0);
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 1);
+  for (int i = 0; i < 20; i++)
+    queue_children_changed (fixture, GTK_ACCESSIBLE_CHILD_STATE_ADDED, i);
+
+  result = flush (fixture);
+  g_assert_cmpstr (result, ==, "a PropertyChange accessible-name 1, "
+                               "a ChildrenChanged remove -1, "
+                               "a ChildrenChanged add -1");
+  g_free (result);
+
+  for (int i = 0; i < 40; i++)
+    queue_children_changed (fixture, GTK_ACCESSIBLE_CHILD_STATE_ADDED, i);
+
+  result = flush (fixture);
+  g_assert_cmpstr (result, ==, "a ChildrenChanged add -1");
+  g_free (result);
+}
+
+static void
+test_dispose (Fixture       *fixture,
+              gconstpointer  data)
+{
+  GDBusConnection *connection;
+  char *result;
+
+  if (fixture->bus == NULL)
+    {
+      g_test_skip ("dbus-daemon not available");
+      return;
+    }
+
+  connection = g_object_ref (gtk_at_spi_root_get_connection (fixture->root));
+
+  /* Queued events are sent, not dropped */
+  queue_value (fixture, PATH_A, "PropertyChange", "accessible-name", 1);
+  g_object_run_dispose (G_OBJECT (fixture->root));
+
+  result = collect (fixture, connection);
+  g_assert_cmpstr (result, ==, "a PropertyChange accessible-name 1");
+  g_free (result);
+
+  g_object_unref (connection);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/atspi/events/coalesce", Fixture, NULL, fixture_setup, test_coalesce, fixture_teardown);
+  g_test_add ("/atspi/events/keep-order", Fixture, NULL, fixture_setup, test_keep_order, fixture_teardown);
+  g_test_add ("/atspi/events/children-changed", Fixture, NULL, fixture_setup, test_children_changed, fixture_teardown);
+  g_test_add ("/atspi/events/children-changed-collapse", Fixture, NULL, fixture_setup, test_children_changed_collapse, fixture_teardown);
+  g_test_add ("/atspi/events/dispose", Fixture, NULL, fixture_setup, test_dispose, fixture_teardown);
+
+  return g_test_run ();
+}
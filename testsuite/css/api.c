@@ -19,6 +19,9 @@
  */
 
 #include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#include "gtk/gtkcssproviderprivate.h"
 
 static void
 gtk_css_provider_load_data_not_null_terminated (void)
@@ -36,6 +39,88 @@ gtk_css_provider_load_data_not_null_terminated (void)
   g_object_unref (p);
 }
 
+static void
+count_errors (GtkCssProvider *provider,
+              GtkCssSection  *section,
+              const GError   *error,
+              gpointer        data)
+{
+  int *n_errors = data;
+
+  (*n_errors)++;
+}
+
+static void
+gtk_css_provider_load_shared_theme (void)
+{
+  GtkCssProvider *p1, *p2, *p3;
+  GtkDebugFlags flags;
+  guint hits;
+  char *s1, *s2, *s3;
+
+  p1 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_resource (p1, "/org/gtk/libgtk/theme/Default/gtk.css");
+
+  /* The theme may have been loaded before, so only the
+   * second load is known to hit the cache */
+  hits = gtk_css_provider_get_n_cache_hits ();
+  p2 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_resource (p2, "/org/gtk/libgtk/theme/Default/gtk.css");
+  g_assert_cmpuint (gtk_css_provider_get_n_cache_hits (), ==, hits + 1);
+
+  /* With the cache disabled, the data is parsed again */
+  flags = gtk_get_debug_flags ();
+  gtk_set_debug_flags (flags | GTK_DEBUG_NO_CSS_CACHE);
+  p3 = gtk_css_provider_new ();
+  gtk_css_provider_load_from_resource (p3, "/org/gtk/libgtk/theme/Default/gtk.css");
+  g_assert_cmpuint (gtk_css_provider_get_n_cache_hits (), ==, hits + 1);
+  gtk_set_debug_flags (flags);
+
+  s1 = gtk_css_provider_to_string (p1);
+  s2 = gtk_css_provider_to_string (p2);
+  s3 = gtk_css_provider_to_string (p3);
+  g_assert_cmpstr (s1, !=, "");
+  g_assert_cmpstr (s1, ==, s2);
+  g_assert_cmpstr (s1, ==, s3);
+  g_free (s1);
+  g_free (s2);
+  g_free (s3);
+  g_object_unref (p3);
+
+  /* The second provider must keep working after the first is gone */
+  g_object_unref (p1);
+  gtk_css_provider_load_from_resource (p2, "/org/gtk/libgtk/theme/Default/gtk-dark.css");
+  g_object_unref (p2);
+}
+
+static void
+gtk_css_provider_load_errors_twice (void)
+{
+  GtkCssProvider *p;
+  GFile *file;
+  char *path;
+  int n_errors = 0;
+  GError *error = NULL;
+
+  path = g_build_filename (g_get_tmp_dir (), "gtk-css-errors-XXXXXX.css", NULL);
+  g_close (g_mkstemp (path), NULL);
+  g_file_set_contents (path, "* { color: nonsense; }", -1, &error);
+  g_assert_no_error (error);
+  file = g_file_new_for_path (path);
+
+  p = gtk_css_provider_new ();
+  g_signal_connect (p, "parsing-error", G_CALLBACK (count_errors), &n_errors);
+
+  gtk_css_provider_load_from_file (p, file);
+  g_assert_cmpint (n_errors, ==, 1);
+  gtk_css_provider_load_from_file (p, file);
+  g_assert_cmpint (n_errors, ==, 2);
+
+  g_object_unref (p);
+  g_object_unref (file);
+  g_unlink (path);
+  g_free (path);
+}
 
 int
 main (int argc, char *argv[])
@@ -44,6 +129,10 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/gtk_css_provider_load_data/not_null_terminated",
       gtk_css_provider_load_data_not_null_terminated);
+  g_test_add_func ("/gtk_css_provider_load/shared_theme",
+      gtk_css_provider_load_shared_theme);
+  g_test_add_func ("/gtk_css_provider_load/errors_twice",
+      gtk_css_provider_load_errors_twice);
 
   return g_test_run ();
 }
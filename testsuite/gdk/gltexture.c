@@ -4,6 +4,7 @@
 #include <windows.h>
 #endif
 #include <epoxy/gl.h>
+#include "gdk/gdkdisplayprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdkglcontextprivate.h"
 #include "gdk/gdkgltextureprivate.h"
@@ -238,6 +239,202 @@ G_GNUC_END_IGNORE_DEPRECATIONS
   g_object_unref (context);
 }
 
+typedef struct
+{
+  GdkTextureDownloader *downloader;
+  GBytes *bytes;
+} AsyncDownload;
+
+static void
+downloaded (GObject      *source,
+            GAsyncResult *result,
+            gpointer      data)
+{
+  AsyncDownload *download = data;
+  GError *error = NULL;
+  gsize stride;
+
+  download->bytes = gdk_texture_downloader_download_bytes_finish (download->downloader, result, &stride, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (stride, ==, 64 * 4);
+}
+
+static void
+test_gltexture_download_async (void)
+{
+  GdkDisplay *display;
+  GdkGLContext *context;
+  GdkGLTextureBuilder *builder;
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  GError *error = NULL;
+  AsyncDownload download = { NULL, NULL };
+  unsigned int id;
+
+  display = gdk_display_get_default ();
+  if (!gdk_display_prepare_gl (display, &error))
+    {
+      g_test_message ("no GL support: %s", error->message);
+      g_test_skip ("no GL support");
+      g_clear_error (&error);
+      return;
+    }
+
+  context = gdk_display_create_gl_context (display, &error);
+  g_assert_nonnull (context);
+  g_assert_no_error (error);
+
+  gdk_gl_context_realize (context, &error);
+  g_assert_no_error (error);
+
+  surface = make_surface ();
+
+  gdk_gl_context_make_current (context);
+
+  id = make_gl_texture (context, surface);
+
+  builder = gdk_gl_texture_builder_new ();
+  gdk_gl_texture_builder_set_id (builder, id);
+  gdk_gl_texture_builder_set_context (builder, context);
+  gdk_gl_texture_builder_set_width (builder, 64);
+  gdk_gl_texture_builder_set_height (builder, 64);
+  texture = gdk_gl_texture_builder_build (builder, NULL, NULL);
+
+  download.downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_download_bytes_async (download.downloader, NULL, downloaded, &download);
+  /* changing the downloader must not affect the running download */
+  gdk_texture_downloader_set_format (download.downloader, GDK_MEMORY_R16G16B16A16);
+
+  while (download.bytes == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpmem (g_bytes_get_data (download.bytes, NULL), g_bytes_get_size (download.bytes),
+                   cairo_image_surface_get_data (surface), 64 * 64 * 4);
+
+  g_bytes_unref (download.bytes);
+  gdk_texture_downloader_free (download.downloader);
+  g_object_unref (texture);
+  g_object_unref (builder);
+
+  cairo_surface_destroy (surface);
+
+  g_object_unref (context);
+}
+
+typedef struct
+{
+  GdkGLTexture *texture;
+  GdkTexture *result;
+  GError *error;
+  gboolean done;
+} Readback;
+
+static void
+readback_done (GObject      *source,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  Readback *readback = data;
+
+  readback->result = gdk_gl_texture_download_finish (GDK_GL_TEXTURE (source), result, &readback->error);
+  readback->done = TRUE;
+}
+
+static gpointer
+readback_thread (gpointer data)
+{
+  Readback *readback = data;
+
+  gdk_gl_texture_download_async (readback->texture, NULL, readback_done, readback);
+
+  return NULL;
+}
+
+static void
+test_gltexture_readback (gconstpointer data)
+{
+  gboolean in_thread = GPOINTER_TO_INT (data);
+  GdkDisplay *display;
+  GdkGLContext *context;
+  GdkGLTextureBuilder *builder;
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  GError *error = NULL;
+  Readback readback = { NULL, };
+  unsigned int id;
+  guchar *pixels;
+
+  display = gdk_display_get_default ();
+  if (!gdk_display_prepare_gl (display, &error))
+    {
+      g_test_message ("no GL support: %s", error->message);
+      g_test_skip ("no GL support");
+      g_clear_error (&error);
+      return;
+    }
+
+  context = gdk_display_create_gl_context (display, &error);
+  g_assert_nonnull (context);
+  g_assert_no_error (error);
+
+  gdk_gl_context_realize (context, &error);
+  g_assert_no_error (error);
+
+  surface = make_surface ();
+
+  gdk_gl_context_make_current (context);
+
+  id = make_gl_texture (context, surface);
+
+  builder = gdk_gl_texture_builder_new ();
+  gdk_gl_texture_builder_set_id (builder, id);
+  gdk_gl_texture_builder_set_context (builder, context);
+  gdk_gl_texture_builder_set_width (builder, 64);
+  gdk_gl_texture_builder_set_height (builder, 64);
+  texture = gdk_gl_texture_builder_build (builder, NULL, NULL);
+
+  readback.texture = GDK_GL_TEXTURE (texture);
+  if (in_thread)
+    g_thread_join (g_thread_new ("readback", readback_thread, &readback));
+  else
+    gdk_gl_texture_download_async (readback.texture, NULL, readback_done, &readback);
+
+  while (!readback.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Even when started from another thread while the main
+   * thread was busy, GL was only used on the main thread */
+  g_assert_true (gdk_gl_texture_get_last_readback_thread () == g_thread_self ());
+
+  if (!gdk_gl_context_check_version (gdk_display_get_gl_context (display), "3.2", NULL))
+    {
+      g_assert_error (readback.error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+      g_clear_error (&readback.error);
+      g_test_skip ("no pixel buffer support");
+    }
+  else
+    {
+      /* The pixel buffer was read, not the texture downloaded */
+      g_assert_no_error (readback.error);
+      g_assert_true (GDK_IS_MEMORY_TEXTURE (readback.result));
+      g_assert_cmpint (gdk_texture_get_format (readback.result), ==, gdk_texture_get_format (texture));
+
+      pixels = g_malloc0 (64 * 64 * 4);
+      gdk_texture_download (readback.result, pixels, 64 * 4);
+      g_assert_cmpmem (pixels, 64 * 64 * 4, cairo_image_surface_get_data (surface), 64 * 64 * 4);
+      g_free (pixels);
+
+      g_object_unref (readback.result);
+    }
+
+  g_object_unref (texture);
+  g_object_unref (builder);
+
+  cairo_surface_destroy (surface);
+
+  g_object_unref (context);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -247,6 +444,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/gltexture/no-context", test_gltexture_no_context);
   g_test_add_func ("/gltexture/shared-context", test_gltexture_shared_context);
   g_test_add_func ("/gltexture/updates", test_gltexture_updates);
+  g_test_add_func ("/gltexture/download-async", test_gltexture_download_async);
+  g_test_add_data_func ("/gltexture/readback", GINT_TO_POINTER (FALSE), test_gltexture_readback);
+  g_test_add_data_func ("/gltexture/readback-thread", GINT_TO_POINTER (TRUE), test_gltexture_readback);
 
   return g_test_run ();
 }
@@ -117,6 +117,85 @@ test_save_image (gconstpointer test_data)
   g_free (path);
 }
 
+static GdkTexture *
+make_noisy_texture (GdkMemoryFormat format,
+                    gsize           width,
+                    gsize           height,
+                    gsize           bpp)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  gsize x, y, stride;
+
+  stride = width * bpp;
+  data = g_malloc (stride * height);
+
+  /* Smooth areas and noise, so that different rows
+   * end up with different filters */
+  for (y = 0; y < height; y++)
+    for (x = 0; x < stride; x++)
+      data[y * stride + x] = (y / 16) % 2 ? g_test_rand_int_range (0, 256) : (x + y) / 3;
+
+  bytes = g_bytes_new_take (data, stride * height);
+  texture = gdk_memory_texture_new (width, height, format, bytes, stride);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static void
+test_save_png_compression (void)
+{
+  struct {
+    GdkMemoryFormat format;
+    gsize bpp;
+  } formats[] = {
+    { GDK_MEMORY_R8G8B8A8, 4 },
+    { GDK_MEMORY_R16G16B16, 6 },
+    { GDK_MEMORY_G8, 1 },
+  };
+  GdkPngCompression compression;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      /* large enough to be split into many bands */
+      GdkTexture *texture = make_noisy_texture (formats[i].format, 601, 1031, formats[i].bpp);
+
+      for (compression = GDK_PNG_COMPRESSION_FAST; compression <= GDK_PNG_COMPRESSION_BEST; compression++)
+        {
+          GdkTextureDownloader *downloader;
+          GdkTexture *texture2;
+          GBytes *bytes, *data1, *data2;
+          GError *error = NULL;
+          gsize stride1, stride2;
+
+          bytes = gdk_save_png_full (texture, NULL, compression);
+          g_assert_nonnull (bytes);
+
+          texture2 = gdk_load_png (bytes, NULL, &error);
+          g_assert_no_error (error);
+
+          downloader = gdk_texture_downloader_new (texture);
+          gdk_texture_downloader_set_format (downloader, formats[i].format);
+          data1 = gdk_texture_downloader_download_bytes (downloader, &stride1);
+          gdk_texture_downloader_set_texture (downloader, texture2);
+          data2 = gdk_texture_downloader_download_bytes (downloader, &stride2);
+          g_assert_cmpuint (stride1, ==, stride2);
+          g_assert_true (g_bytes_equal (data1, data2));
+
+          g_bytes_unref (data2);
+          g_bytes_unref (data1);
+          gdk_texture_downloader_free (downloader);
+          g_object_unref (texture2);
+          g_bytes_unref (bytes);
+        }
+
+      g_object_unref (texture);
+    }
+}
+
 static void
 test_load_image_fail (gconstpointer data)
 {
@@ -176,6 +255,7 @@ main (int argc, char *argv[])
   g_test_add_data_func ("/image/save/image.png", "image.png", test_save_image);
   g_test_add_data_func ("/image/save/image.tiff", "image.tiff", test_save_image);
   g_test_add_data_func ("/image/save/image.jpeg", "image.jpeg", test_save_image);
+  g_test_add_func ("/image/save/png-compression", test_save_png_compression);
 
   return g_test_run ();
 }
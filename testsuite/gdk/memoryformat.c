@@ -1,5 +1,6 @@
 #include <gdk/gdk.h>
 #include <gdk/gdkmemoryformatprivate.h>
+#include <gdk/gdkcolorstateprivate.h>
 
 static void
 test_depth_merge (void)
@@ -14,12 +15,82 @@ test_depth_merge (void)
     }
 }
 
+/* Compares the YCbCr to 8-bit RGB fast path with the generic
+ * float conversion
+ */
+static void
+test_convert_yuv (void)
+{
+  const GdkMemoryFormat formats[] = {
+    GDK_MEMORY_G8_B8R8_420,
+    GDK_MEMORY_G8_R8B8_422,
+    GDK_MEMORY_G10X6_B10X6R10X6_420,
+    GDK_MEMORY_G8_B8_R8_420,
+    GDK_MEMORY_G8_R8_B8_444,
+  };
+  const GdkCicp cicps[] = {
+    { 1, 13, 1, GDK_CICP_RANGE_NARROW },
+    { 1, 13, 5, GDK_CICP_RANGE_FULL },
+    { 1, 13, 9, GDK_CICP_RANGE_NARROW },
+    { 1, 1, 1, GDK_CICP_RANGE_NARROW },
+  };
+  const gsize width = 32, height = 16;
+
+  for (gsize f = 0; f < G_N_ELEMENTS (formats); f++)
+    {
+      GdkMemoryLayout src_layout, fast_layout, float_layout;
+      guchar *src, *fast, *ref;
+
+      gdk_memory_layout_init (&src_layout, formats[f], width, height, 1);
+      gdk_memory_layout_init (&fast_layout, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, width, height, 1);
+      gdk_memory_layout_init (&float_layout, GDK_MEMORY_R32G32B32A32_FLOAT, width, height, 1);
+
+      src = g_malloc (src_layout.size);
+      for (gsize i = 0; i < src_layout.size; i++)
+        src[i] = g_test_rand_int_range (0, 256);
+
+      fast = g_malloc (fast_layout.size);
+      ref = g_malloc (float_layout.size);
+
+      for (gsize c = 0; c < G_N_ELEMENTS (cicps); c++)
+        {
+          GdkColorState *cs;
+
+          cs = gdk_color_state_new_for_cicp (&cicps[c], NULL);
+          g_assert_nonnull (cs);
+
+          gdk_memory_convert (fast, &fast_layout, GDK_COLOR_STATE_SRGB,
+                              src, &src_layout, cs);
+          gdk_memory_convert (ref, &float_layout, GDK_COLOR_STATE_SRGB,
+                              src, &src_layout, cs);
+
+          for (gsize y = 0; y < height; y++)
+            {
+              const guchar *fast_row = fast + gdk_memory_layout_offset (&fast_layout, 0, 0, y);
+              const float *ref_row = (const float *) (ref + gdk_memory_layout_offset (&float_layout, 0, 0, y));
+
+              for (gsize x = 0; x < width * 4; x++)
+                g_assert_cmpfloat_with_epsilon (fast_row[x] / 255.f,
+                                                CLAMP (ref_row[x], 0.f, 1.f),
+                                                2.5f / 255.f);
+            }
+
+          gdk_color_state_unref (cs);
+        }
+
+      g_free (src);
+      g_free (fast);
+      g_free (ref);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
   (g_test_init) (&argc, &argv, NULL);
 
   g_test_add_func ("/depth/merge", test_depth_merge);
+  g_test_add_func ("/convert/yuv", test_convert_yuv);
 
   return g_test_run ();
 }
@@ -276,6 +276,87 @@ test_mipmap_simple (gconstpointer data_)
   g_object_unref (ref);
 }
 
+static void
+test_mipmap_straight_alpha (void)
+{
+  /* an opaque red pixel and 3 transparent green ones */
+  const guchar pixels[] = { 255,   0, 0, 255,    0, 255, 0, 0,
+                              0, 255, 0,   0,    0, 255, 0, 0 };
+  GdkMemoryLayout layout = GDK_MEMORY_LAYOUT_SIMPLE (GDK_MEMORY_R8G8B8A8, 2, 2, 8);
+  GdkMemoryLayout dest_layout = GDK_MEMORY_LAYOUT_SIMPLE (GDK_MEMORY_R8G8B8A8, 1, 1, 4);
+  guchar result[4];
+
+  gdk_memory_mipmap (result, &dest_layout, pixels, &layout, 1, TRUE);
+
+  /* green must not bleed into the result */
+  g_assert_cmpuint (result[0], ==, 255);
+  g_assert_cmpuint (result[1], ==, 0);
+  g_assert_cmpuint (result[2], ==, 0);
+  g_assert_cmpuint (result[3], ==, 63);
+}
+
+/* Compare odd sizes against a straightforward box filter, so
+ * the edges and the chunking of the fast paths get tested */
+static void
+test_mipmap_box (void)
+{
+  const GdkMemoryFormat formats[] = { GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, GDK_MEMORY_R8G8B8, GDK_MEMORY_G8 };
+  const gsize width = 601, height = 7;
+  gsize f, lod_level;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++)
+    {
+      gsize bpp = gdk_memory_format_get_plane_block_bytes (formats[f], 0);
+      GdkMemoryLayout layout;
+      guchar *data;
+      gsize i;
+
+      gdk_memory_layout_init (&layout, formats[f], width, height, 1);
+      data = g_malloc (layout.size);
+      for (i = 0; i < layout.size; i++)
+        data[i] = g_test_rand_int_range (0, 256);
+
+      for (lod_level = 1; lod_level <= 3; lod_level++)
+        {
+          gsize n = 1 << lod_level;
+          GdkMemoryLayout dest_layout;
+          guchar *result, *expected;
+          gsize x, y, dx, dy, c;
+
+          gdk_memory_layout_init (&dest_layout, formats[f], (width + n - 1) / n, (height + n - 1) / n, 1);
+          result = g_malloc (dest_layout.size);
+          expected = g_malloc (dest_layout.size);
+
+          for (y = 0; y < dest_layout.height; y++)
+            for (x = 0; x < dest_layout.width; x++)
+              for (c = 0; c < bpp; c++)
+                {
+                  guint sum = 0, count = 0;
+
+                  for (dy = y * n; dy < MIN ((y + 1) * n, height); dy++)
+                    for (dx = x * n; dx < MIN ((x + 1) * n, width); dx++)
+                      {
+                        sum += data[dy * layout.planes[0].stride + dx * bpp + c];
+                        count++;
+                      }
+
+                  expected[y * dest_layout.planes[0].stride + x * bpp + c] = sum / count;
+                }
+
+          gdk_memory_mipmap (result, &dest_layout, data, &layout, lod_level, TRUE);
+
+          for (y = 0; y < dest_layout.height; y++)
+            g_assert_cmpmem (result + y * dest_layout.planes[0].stride, dest_layout.width * bpp,
+                             expected + y * dest_layout.planes[0].stride, dest_layout.width * bpp);
+
+          g_free (expected);
+          g_free (result);
+        }
+
+      g_free (data);
+    }
+}
+
 static void
 add_test (const char    *name,
           GTestDataFunc  func,
@@ -315,6 +396,8 @@ main (int argc, char *argv[])
 
   add_test ("simple", test_mipmap_simple, 1);
   add_test ("pixels", test_mipmap_pixels, 3);
+  g_test_add_func ("/mipmap/straight-alpha", test_mipmap_straight_alpha);
+  g_test_add_func ("/mipmap/box", test_mipmap_box);
 
   return g_test_run ();
 }
@@ -0,0 +1,741 @@
+#include "config.h"
+
+#include <locale.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include <gdk/gdk.h>
+#include "gdk/gdkprofilerprivate.h"
+
+/* Records a few marks and counters with the built-in trace
+ * recorder and checks that the written traces are valid.
+ *
+ * All times are in nanoseconds, and far apart from real
+ * times, so marks from GDK itself don't get in the way.
+ */
+
+#define T0 G_GINT64_CONSTANT (1000000000000)
+
+typedef struct
+{
+  const char *name;
+  gint64 time;
+  gint64 duration;
+  const char *message;
+} Mark;
+
+/* "overlap" starts inside "outer" and ends after it,
+ * so it can't be nested into it */
+static const Mark marks[] = {
+  { "outer",   T0,        5000, "outer \"message\"\\\n" },
+  { "inner",   T0 + 1000, 1000, NULL },
+  { "overlap", T0 + 2000, 6000, "overlap" },
+  { "nested",  T0 + 3000, 1000, NULL },
+  { "later",   T0 + 9000, 1000, NULL },
+};
+
+static guint double_counter;
+static guint int_counter;
+
+static gpointer
+thread_func (gpointer data)
+{
+  gdk_profiler_add_mark (T0, 2000, "thread", NULL);
+
+  return NULL;
+}
+
+static void
+record_events (void)
+{
+  static gboolean recorded;
+  guint i;
+
+  if (recorded)
+    return;
+
+  recorded = TRUE;
+
+  for (i = 0; i < G_N_ELEMENTS (marks); i++)
+    gdk_profiler_add_mark (marks[i].time, marks[i].duration, marks[i].name, marks[i].message);
+
+  g_thread_join (g_thread_new ("profiler", thread_func, NULL));
+
+  double_counter = gdk_profiler_define_counter ("test double", "A double counter");
+  int_counter = gdk_profiler_define_int_counter ("test int", "An int counter");
+  gdk_profiler_set_counter (double_counter, 0.5);
+  gdk_profiler_set_int_counter (int_counter, 42);
+}
+
+static char *
+save_trace (const char *basename)
+{
+  GError *error = NULL;
+  char *dir, *filename;
+
+  record_events ();
+
+  dir = g_dir_make_tmp ("gdk-profiler-XXXXXX", &error);
+  g_assert_no_error (error);
+  filename = g_build_filename (dir, basename, NULL);
+  g_free (dir);
+
+  gdk_profiler_save_trace (filename, &error);
+  g_assert_no_error (error);
+
+  return filename;
+}
+
+static void
+remove_trace (char *filename)
+{
+  char *dir = g_path_get_dirname (filename);
+
+  g_unlink (filename);
+  g_rmdir (dir);
+
+  g_free (dir);
+  g_free (filename);
+}
+
+/* {{{ JSON */
+
+/* A minimal JSON parser that turns objects into a{sv}, arrays
+ * into av, and strings and numbers into s and d. Fails the test
+ * on any syntax error.
+ */
+
+static void
+skip_whitespace (const char **p)
+{
+  while (g_ascii_isspace (**p))
+    (*p)++;
+}
+
+static void
+expect_char (const char **p,
+             char         c)
+{
+  skip_whitespace (p);
+  if (**p != c)
+    g_error ("Expected '%c' in JSON, got '%.20s'", c, *p);
+  (*p)++;
+}
+
+static char *
+parse_json_string (const char **p)
+{
+  GString *s = g_string_new (NULL);
+
+  expect_char (p, '"');
+
+  while (**p != '"')
+    {
+      if (**p == '\0' || (guchar) **p < 0x20)
+        g_error ("Invalid character in JSON string");
+
+      if (**p == '\\')
+        {
+          (*p)++;
+          switch (**p)
+            {
+            case '"': g_string_append_c (s, '"'); break;
+            case '\\': g_string_append_c (s, '\\'); break;
+            case '/': g_string_append_c (s, '/'); break;
+            case 'n': g_string_append_c (s, '\n'); break;
+            case 't': g_string_append_c (s, '\t'); break;
+            case 'u':
+              {
+                char hex[5] = { 0, };
+
+                memcpy (hex, *p + 1, 4);
+                g_string_append_unichar (s, g_ascii_strtoull (hex, NULL, 16));
+                *p += 4;
+              }
+              break;
+            default:
+              g_error ("Invalid escape in JSON string");
+            }
+          (*p)++;
+        }
+      else
+        {
+          g_string_append_c (s, **p);
+          (*p)++;
+        }
+    }
+  (*p)++;
+
+  return g_string_free (s, FALSE);
+}
+
+static GVariant *
+parse_json_value (const char **p)
+{
+  skip_whitespace (p);
+
+  if (**p == '{')
+    {
+      GVariantBuilder builder;
+
+      g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+      (*p)++;
+      skip_whitespace (p);
+      if (**p == '}')
+        (*p)++;
+      else
+        {
+          for (;;)
+            {
+              char *key = parse_json_string (p);
+
+              expect_char (p, ':');
+              g_variant_builder_add (&builder, "{sv}", key, parse_json_value (p));
+              g_free (key);
+
+              skip_whitespace (p);
+              if (**p == '}')
+                break;
+              expect_char (p, ',');
+            }
+          (*p)++;
+        }
+
+      return g_variant_builder_end (&builder);
+    }
+  else if (**p == '[')
+    {
+      GVariantBuilder builder;
+
+      g_variant_builder_init (&builder, G_VARIANT_TYPE ("av"));
+      (*p)++;
+      skip_whitespace (p);
+      if (**p == ']')
+        (*p)++;
+      else
+        {
+          for (;;)
+            {
+              g_variant_builder_add (&builder, "v", parse_json_value (p));
+
+              skip_whitespace (p);
+              if (**p == ']')
+                break;
+              expect_char (p, ',');
+            }
+          (*p)++;
+        }
+
+      return g_variant_builder_end (&builder);
+    }
+  else if (**p == '"')
+    {
+      return g_variant_new_take_string (parse_json_string (p));
+    }
+  else
+    {
+      char *end;
+      double d;
+
+      d = g_ascii_strtod (*p, &end);
+      if (end == *p)
+        g_error ("Invalid JSON value '%.20s'", *p);
+      *p = end;
+
+      return g_variant_new_double (d);
+    }
+}
+
+static GVariant *
+find_json_event (GVariant   *events,
+                 const char *name,
+                 const char *ph)
+{
+  GVariant *result = NULL;
+  gsize i;
+
+  for (i = 0; i < g_variant_n_children (events); i++)
+    {
+      GVariant *event = g_variant_get_child_value (events, i);
+      GVariant *inner = g_variant_get_variant (event);
+      const char *event_name, *event_ph;
+
+      g_variant_unref (event);
+
+      if (g_variant_lookup (inner, "name", "&s", &event_name) &&
+          g_variant_lookup (inner, "ph", "&s", &event_ph) &&
+          strcmp (event_name, name) == 0 &&
+          strcmp (event_ph, ph) == 0)
+        {
+          g_assert_null (result);
+          result = g_variant_ref (inner);
+        }
+
+      g_variant_unref (inner);
+    }
+
+  g_assert_nonnull (result);
+
+  return result;
+}
+
+static void
+test_trace_json (void)
+{
+  GError *error = NULL;
+  GVariant *trace, *events, *event, *args;
+  char *filename, *contents;
+  const char *p, *message;
+  double ts, dur, value, tid;
+  guint i;
+
+  filename = save_trace ("trace.json");
+
+  g_file_get_contents (filename, &contents, NULL, &error);
+  g_assert_no_error (error);
+
+  p = contents;
+  trace = g_variant_ref_sink (parse_json_value (&p));
+  skip_whitespace (&p);
+  g_assert_cmpint (*p, ==, '\0');
+
+  events = g_variant_lookup_value (trace, "traceEvents", G_VARIANT_TYPE ("av"));
+  g_assert_nonnull (events);
+
+  for (i = 0; i < G_N_ELEMENTS (marks); i++)
+    {
+      event = find_json_event (events, marks[i].name, "X");
+
+      g_assert_true (g_variant_lookup (event, "ts", "d", &ts));
+      g_assert_true (g_variant_lookup (event, "dur", "d", &dur));
+      g_assert_true (g_variant_lookup (event, "tid", "d", &tid));
+      g_assert_cmpfloat_with_epsilon (ts, marks[i].time / 1000.0, 0.001);
+      g_assert_cmpfloat_with_epsilon (dur, marks[i].duration / 1000.0, 0.001);
+      g_assert_cmpfloat (tid, ==, 1);
+
+      args = g_variant_lookup_value (event, "args", G_VARIANT_TYPE_VARDICT);
+      if (marks[i].message)
+        {
+          g_assert_nonnull (args);
+          g_assert_true (g_variant_lookup (args, "message", "&s", &message));
+          g_assert_cmpstr (message, ==, marks[i].message);
+          g_variant_unref (args);
+        }
+      else
+        g_assert_null (args);
+
+      g_variant_unref (event);
+    }
+
+  event = find_json_event (events, "thread", "X");
+  g_assert_true (g_variant_lookup (event, "tid", "d", &tid));
+  g_assert_cmpfloat (tid, ==, 2);
+  g_variant_unref (event);
+
+  event = find_json_event (events, "test double", "C");
+  args = g_variant_lookup_value (event, "args", G_VARIANT_TYPE_VARDICT);
+  g_assert_true (g_variant_lookup (args, "value", "d", &value));
+  g_assert_cmpfloat (value, ==, 0.5);
+  g_variant_unref (args);
+  g_variant_unref (event);
+
+  event = find_json_event (events, "test int", "C");
+  args = g_variant_lookup_value (event, "args", G_VARIANT_TYPE_VARDICT);
+  g_assert_true (g_variant_lookup (args, "value", "d", &value));
+  g_assert_cmpfloat (value, ==, 42);
+  g_variant_unref (args);
+  g_variant_unref (event);
+
+  g_variant_unref (events);
+  g_variant_unref (trace);
+  g_free (contents);
+  remove_trace (filename);
+}
+
+/* }}} */
+/* {{{ Perfetto */
+
+/* Just enough of the protobuf wire format and the field
+ * numbers of the Perfetto trace to read our own traces.
+ */
+
+typedef struct
+{
+  const guint8 *data;
+  const guint8 *end;
+} PbReader;
+
+typedef struct
+{
+  guint field;
+  guint wire_type;
+  guint64 value;
+  const guint8 *data;
+  gsize size;
+} PbField;
+
+static guint64
+pb_read_varint (PbReader *reader)
+{
+  guint64 value = 0;
+  guint shift = 0;
+  guint8 byte;
+
+  do
+    {
+      g_assert_true (reader->data < reader->end);
+      g_assert_cmpuint (shift, <, 64);
+      byte = *reader->data++;
+      value |= (guint64) (byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
+
+  return value;
+}
+
+static gboolean
+pb_read_field (PbReader *reader,
+               PbField  *field)
+{
+  guint64 key;
+
+  if (reader->data == reader->end)
+    return FALSE;
+
+  key = pb_read_varint (reader);
+  field->field = key >> 3;
+  field->wire_type = key & 7;
+
+  switch (field->wire_type)
+    {
+    case 0:
+      field->value = pb_read_varint (reader);
+      break;
+
+    case 1:
+      g_assert_cmpint (reader->end - reader->data, >=, 8);
+      memcpy (&field->value, reader->data, 8);
+      field->value = GUINT64_FROM_LE (field->value);
+      reader->data += 8;
+      break;
+
+    case 2:
+      field->size = pb_read_varint (reader);
+      g_assert_cmpuint (field->size, <=, reader->end - reader->data);
+      field->data = reader->data;
+      reader->data += field->size;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return TRUE;
+}
+
+static PbReader
+pb_reader (const PbField *field)
+{
+  g_assert_cmpuint (field->wire_type, ==, 2);
+
+  return (PbReader) { field->data, field->data + field->size };
+}
+
+static char *
+pb_string (const PbField *field)
+{
+  g_assert_cmpuint (field->wire_type, ==, 2);
+
+  return g_strndup ((const char *) field->data, field->size);
+}
+
+typedef struct
+{
+  guint64 time;
+  guint type;
+  guint64 track;
+  char *name;
+  gboolean has_double;
+  double v_double;
+  gint64 v_int;
+  guint order;
+} PfEvent;
+
+typedef struct
+{
+  guint64 uuid;
+  guint64 parent;
+  char *name;
+  gboolean is_counter;
+} PfTrack;
+
+static void
+pf_event_clear (gpointer data)
+{
+  PfEvent *event = data;
+
+  g_free (event->name);
+}
+
+static void
+pf_track_clear (gpointer data)
+{
+  PfTrack *track = data;
+
+  g_free (track->name);
+}
+
+static void
+parse_perfetto (GBytes *bytes,
+                GArray *tracks,
+                GArray *events)
+{
+  PbReader trace = { g_bytes_get_data (bytes, NULL), NULL };
+  PbField field;
+
+  trace.end = trace.data + g_bytes_get_size (bytes);
+
+  while (pb_read_field (&trace, &field))
+    {
+      PbReader packet;
+      PbField pf;
+      PfEvent event = { 0, };
+      gboolean is_event = FALSE;
+
+      g_assert_cmpuint (field.field, ==, 1);
+
+      packet = pb_reader (&field);
+      while (pb_read_field (&packet, &pf))
+        {
+          if (pf.field == 8)
+            event.time = pf.value;
+          else if (pf.field == 10)
+            g_assert_cmpuint (pf.value, ==, 1);
+          else if (pf.field == 60)
+            {
+              PbReader r = pb_reader (&pf);
+              PfTrack track = { 0, };
+              PbField tf;
+
+              while (pb_read_field (&r, &tf))
+                {
+                  if (tf.field == 1)
+                    track.uuid = tf.value;
+                  else if (tf.field == 2)
+                    track.name = pb_string (&tf);
+                  else if (tf.field == 5)
+                    track.parent = tf.value;
+                  else if (tf.field == 8)
+                    track.is_counter = TRUE;
+                }
+
+              g_array_append_val (tracks, track);
+            }
+          else if (pf.field == 11)
+            {
+              PbReader r = pb_reader (&pf);
+              PbField ef;
+
+              is_event = TRUE;
+              while (pb_read_field (&r, &ef))
+                {
+                  if (ef.field == 9)
+                    event.type = ef.value;
+                  else if (ef.field == 11)
+                    event.track = ef.value;
+                  else if (ef.field == 23)
+                    event.name = pb_string (&ef);
+                  else if (ef.field == 30)
+                    event.v_int = ef.value;
+                  else if (ef.field == 44)
+                    {
+                      memcpy (&event.v_double, &ef.value, sizeof (double));
+                      event.has_double = TRUE;
+                    }
+                }
+            }
+        }
+
+      if (is_event)
+        {
+          event.order = events->len;
+          g_array_append_val (events, event);
+        }
+    }
+}
+
+static int
+compare_pf_events (gconstpointer a,
+                   gconstpointer b)
+{
+  const PfEvent *ea = a;
+  const PfEvent *eb = b;
+
+  if (ea->time != eb->time)
+    return ea->time < eb->time ? -1 : 1;
+
+  return (int) ea->order - (int) eb->order;
+}
+
+static const PfTrack *
+find_track (GArray  *tracks,
+            guint64  uuid)
+{
+  guint i;
+
+  for (i = 0; i < tracks->len; i++)
+    {
+      const PfTrack *track = &g_array_index (tracks, PfTrack, i);
+
+      if (track->uuid == uuid)
+        return track;
+    }
+
+  return NULL;
+}
+
+static const Mark *
+find_mark (const char *name)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (marks); i++)
+    {
+      if (strcmp (marks[i].name, name) == 0)
+        return &marks[i];
+    }
+
+  return NULL;
+}
+
+static void
+test_trace_perfetto (void)
+{
+  GError *error = NULL;
+  GArray *tracks, *events;
+  GHashTable *stacks;
+  GBytes *bytes;
+  char *filename, *contents;
+  gsize length;
+  guint i, n_marks, n_counters;
+
+  filename = save_trace ("trace.pftrace");
+
+  g_file_get_contents (filename, &contents, &length, &error);
+  g_assert_no_error (error);
+  bytes = g_bytes_new_take (contents, length);
+
+  tracks = g_array_new (FALSE, TRUE, sizeof (PfTrack));
+  g_array_set_clear_func (tracks, pf_track_clear);
+  events = g_array_new (FALSE, TRUE, sizeof (PfEvent));
+  g_array_set_clear_func (events, pf_event_clear);
+
+  parse_perfetto (bytes, tracks, events);
+
+  /* Perfetto orders events by time, and keeps the order of
+   * the packets for equal times */
+  g_array_sort (events, compare_pf_events);
+
+  /* Every end must close the slice that was opened last on
+   * its track, and at the time the mark ends */
+  stacks = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+  n_marks = 0;
+  n_counters = 0;
+
+  for (i = 0; i < events->len; i++)
+    {
+      const PfEvent *event = &g_array_index (events, PfEvent, i);
+      const PfTrack *track;
+      GPtrArray *stack;
+
+      track = find_track (tracks, event->track);
+      g_assert_nonnull (track);
+
+      if (event->type == 4)
+        {
+          g_assert_true (track->is_counter);
+          if (strcmp (track->name, "test double") == 0)
+            {
+              g_assert_true (event->has_double);
+              g_assert_cmpfloat (event->v_double, ==, 0.5);
+              n_counters++;
+            }
+          else if (strcmp (track->name, "test int") == 0)
+            {
+              g_assert_false (event->has_double);
+              g_assert_cmpint (event->v_int, ==, 42);
+              n_counters++;
+            }
+          continue;
+        }
+
+      g_assert_false (track->is_counter);
+
+      /* The lanes of a thread are children of its track */
+      if (track->parent != 0)
+        g_assert_nonnull (find_track (tracks, track->parent));
+
+      stack = g_hash_table_lookup (stacks, &event->track);
+      if (stack == NULL)
+        {
+          stack = g_ptr_array_new ();
+          g_hash_table_insert (stacks, g_memdup2 (&event->track, sizeof (guint64)), stack);
+        }
+
+      if (event->type == 1)
+        {
+          g_assert_nonnull (event->name);
+          g_ptr_array_add (stack, (gpointer) event);
+        }
+      else
+        {
+          const PfEvent *begin;
+          const Mark *mark;
+
+          g_assert_cmpuint (event->type, ==, 2);
+          g_assert_cmpuint (stack->len, >, 0);
+
+          begin = g_ptr_array_steal_index (stack, stack->len - 1);
+          mark = find_mark (begin->name);
+          if (mark == NULL)
+            continue;
+
+          g_assert_cmpuint (begin->time, ==, mark->time);
+          g_assert_cmpuint (event->time, ==, mark->time + mark->duration);
+          n_marks++;
+        }
+    }
+
+  g_assert_cmpuint (n_marks, ==, G_N_ELEMENTS (marks));
+  g_assert_cmpuint (n_counters, ==, 2);
+
+  g_hash_table_unref (stacks);
+  g_array_unref (events);
+  g_array_unref (tracks);
+  g_bytes_unref (bytes);
+  remove_trace (filename);
+}
+
+/* }}} */
+
+int
+main (int argc, char *argv[])
+{
+  char *exit_trace;
+
+  (g_test_init) (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  /* The recorder also writes a trace when the process exits */
+  exit_trace = g_test_build_filename (G_TEST_BUILT, "profiler-exit.json", NULL);
+  g_setenv ("GDK_TRACE", exit_trace, TRUE);
+  g_free (exit_trace);
+
+  gdk_profiler_init ();
+
+  g_test_add_func ("/profiler/trace/json", test_trace_json);
+  g_test_add_func ("/profiler/trace/perfetto", test_trace_perfetto);
+
+  return g_test_run ();
+}
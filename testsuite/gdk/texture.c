@@ -456,6 +456,53 @@ test_texture_downloader (void)
   g_object_unref (texture);
 }
 
+typedef struct
+{
+  GdkTextureDownloader *downloader;
+  GBytes *bytes;
+} AsyncDownload;
+
+static void
+texture_downloaded (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      data)
+{
+  AsyncDownload *download = data;
+  GError *error = NULL;
+  gsize stride;
+
+  download->bytes = gdk_texture_downloader_download_bytes_finish (download->downloader, result, &stride, &error);
+  g_assert_no_error (error);
+  g_assert_true (stride == 4 * 2 * 16);
+}
+
+static void
+test_texture_downloader_async (void)
+{
+  GdkTexture *texture;
+  AsyncDownload download = { NULL, NULL };
+  GBytes *bytes;
+  gsize stride;
+
+  texture = gdk_texture_new_from_resource ("/org/gtk/libgtk/icons/16x16/places/user-trash.png");
+
+  download.downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (download.downloader, GDK_MEMORY_R16G16B16A16);
+
+  gdk_texture_downloader_download_bytes_async (download.downloader, NULL, texture_downloaded, &download);
+
+  while (download.bytes == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  bytes = gdk_texture_downloader_download_bytes (download.downloader, &stride);
+  g_assert_true (g_bytes_equal (bytes, download.bytes));
+
+  g_bytes_unref (download.bytes);
+  g_bytes_unref (bytes);
+  gdk_texture_downloader_free (download.downloader);
+  g_object_unref (texture);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -472,6 +519,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/texture/icon/serialize", test_texture_icon_serialize);
   g_test_add_func ("/texture/diff", test_texture_diff);
   g_test_add_func ("/texture/downloader", test_texture_downloader);
+  g_test_add_func ("/texture/downloader-async", test_texture_downloader_async);
 
   return g_test_run ();
 }
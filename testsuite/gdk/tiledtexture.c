@@ -0,0 +1,220 @@
+#include <gtk/gtk.h>
+
+#include "gdk/gdkmemoryformatprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
+#include "gdk/gdktiledtextureprivate.h"
+#include "gdk/loaders/gdkjpegprivate.h"
+
+#include "testsuite/gdk/gdktestutils.h"
+
+/* Just big enough to be loaded as a tiled texture */
+#define WIDTH 8192
+#define HEIGHT (GDK_TILED_TEXTURE_MIN_PIXELS / WIDTH)
+
+static GdkTexture *
+create_texture (void)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  gsize x, y;
+
+  data = g_malloc (WIDTH * HEIGHT);
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH; x++)
+      data[y * WIDTH + x] = (x * 7) ^ (y * 3);
+
+  bytes = g_bytes_new_take (data, WIDTH * HEIGHT);
+  texture = gdk_memory_texture_new (WIDTH, HEIGHT, GDK_MEMORY_G8, bytes, WIDTH);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static GdkTexture *
+mipmap_area (GdkTexture                  *texture,
+             const cairo_rectangle_int_t *area,
+             guint                        lod_level,
+             gboolean                     linear)
+{
+  GdkMemoryTexture *memtex;
+  GdkTexture *subtex, *result;
+  GdkMemoryLayout src_layout, dest_layout;
+  GBytes *src_bytes, *dest_bytes;
+  guchar *data;
+
+  memtex = gdk_memory_texture_from_texture (texture);
+  subtex = gdk_memory_texture_new_subtexture (memtex, area->x, area->y, area->width, area->height);
+  if (lod_level == 0)
+    {
+      g_object_unref (memtex);
+      return subtex;
+    }
+
+  src_bytes = gdk_texture_download_bytes (subtex, &src_layout);
+  gdk_memory_layout_init (&dest_layout,
+                          gdk_memory_format_get_mipmap_format (src_layout.format),
+                          (area->width + (1 << lod_level) - 1) >> lod_level,
+                          (area->height + (1 << lod_level) - 1) >> lod_level,
+                          1);
+  data = g_malloc (dest_layout.size);
+  gdk_memory_mipmap (data, &dest_layout, g_bytes_get_data (src_bytes, NULL), &src_layout, lod_level, linear);
+  dest_bytes = g_bytes_new_take (data, dest_layout.size);
+  result = gdk_memory_texture_new_from_layout (dest_bytes,
+                                               &dest_layout,
+                                               GDK_COLOR_STATE_SRGB,
+                                               NULL, NULL);
+
+  g_bytes_unref (dest_bytes);
+  g_bytes_unref (src_bytes);
+  g_object_unref (subtex);
+  g_object_unref (memtex);
+
+  return result;
+}
+
+static void
+check_area (GdkTexture                  *tiled,
+            GdkTexture                  *reference,
+            const cairo_rectangle_int_t *area,
+            guint                        lod_level,
+            gboolean                     linear)
+{
+  GdkTexture *decoded, *expected;
+  GError *error = NULL;
+
+  decoded = gdk_tiled_texture_decode (GDK_TILED_TEXTURE (tiled), area, lod_level, linear, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (decoded);
+
+  expected = mipmap_area (reference, area, lod_level, linear);
+  compare_textures (expected, decoded, TRUE);
+
+  g_object_unref (expected);
+  g_object_unref (decoded);
+}
+
+static void
+test_tiled_lossless (gconstpointer data)
+{
+  GBytes * (* save_func) (GdkTexture *) = data;
+  GdkTexture *texture, *tiled;
+  GError *error = NULL;
+  GBytes *bytes;
+
+  texture = create_texture ();
+  bytes = save_func (texture);
+  tiled = gdk_texture_new_from_bytes (bytes, &error);
+  g_assert_no_error (error);
+  g_assert_true (GDK_IS_TILED_TEXTURE (tiled));
+  g_assert_cmpint (gdk_texture_get_width (tiled), ==, WIDTH);
+  g_assert_cmpint (gdk_texture_get_height (tiled), ==, HEIGHT);
+
+  /* two tiles in the same row, then going back up */
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { 1024, 2048, 512, 300 }, 0, FALSE);
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { 1536, 2048, 512, 300 }, 0, FALSE);
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { 0, 0, 100, 100 }, 0, FALSE);
+
+  /* lower levels of detail, including the image edges */
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { 4096, 1024, 1024, 1024 }, 2, FALSE);
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { 4096, 1024, 1024, 1024 }, 2, TRUE);
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { WIDTH - 999, HEIGHT - 333, 999, 333 }, 3, TRUE);
+
+  /* and everything at once */
+  compare_textures (texture, tiled, TRUE);
+  /* and again, which uses the kept result */
+  compare_textures (texture, tiled, TRUE);
+  check_area (tiled, texture, &(cairo_rectangle_int_t) { 512, 512, 256, 256 }, 1, TRUE);
+
+  g_object_unref (tiled);
+  g_bytes_unref (bytes);
+  g_object_unref (texture);
+}
+
+static void
+test_tiled_jpeg (void)
+{
+  GdkTexture *texture, *tiled, *decoded;
+  GError *error = NULL;
+  GBytes *bytes;
+
+  texture = create_texture ();
+  bytes = gdk_save_jpeg (texture);
+  tiled = gdk_texture_new_from_bytes (bytes, &error);
+  g_assert_no_error (error);
+  g_assert_true (GDK_IS_TILED_TEXTURE (tiled));
+
+  /* jpeg is lossy, so only check that the sizes work out */
+  decoded = gdk_tiled_texture_decode (GDK_TILED_TEXTURE (tiled),
+                                      &(cairo_rectangle_int_t) { 2048, 1024, 1000, 999 },
+                                      5,
+                                      TRUE,
+                                      &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (decoded), ==, 32);
+  g_assert_cmpint (gdk_texture_get_height (decoded), ==, 32);
+
+  g_object_unref (decoded);
+  g_object_unref (tiled);
+  g_bytes_unref (bytes);
+  g_object_unref (texture);
+}
+
+static void
+test_small_not_tiled (void)
+{
+  GdkTexture *texture, *loaded;
+  GError *error = NULL;
+  GBytes *bytes, *data;
+
+  data = g_bytes_new_take (g_malloc0 (64 * 64), 64 * 64);
+  texture = gdk_memory_texture_new (64, 64, GDK_MEMORY_G8, data, 64);
+  bytes = gdk_texture_save_to_png_bytes (texture);
+  loaded = gdk_texture_new_from_bytes (bytes, &error);
+  g_assert_no_error (error);
+  g_assert_false (GDK_IS_TILED_TEXTURE (loaded));
+
+  g_object_unref (loaded);
+  g_bytes_unref (bytes);
+  g_object_unref (texture);
+  g_bytes_unref (data);
+}
+
+static void
+test_tiled_truncated (gconstpointer data)
+{
+  GBytes * (* save_func) (GdkTexture *) = data;
+  GdkTexture *texture, *loaded;
+  GError *error = NULL;
+  GBytes *bytes, *truncated;
+
+  texture = create_texture ();
+  bytes = save_func (texture);
+  truncated = g_bytes_new_from_bytes (bytes, 0, g_bytes_get_size (bytes) / 2);
+
+  /* Only the header is needed for a tiled texture, but the
+   * broken file must still fail to load */
+  loaded = gdk_texture_new_from_bytes (truncated, &error);
+  g_assert_null (loaded);
+  g_assert_nonnull (error);
+
+  g_error_free (error);
+  g_bytes_unref (truncated);
+  g_bytes_unref (bytes);
+  g_object_unref (texture);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_data_func ("/tiledtexture/png", gdk_texture_save_to_png_bytes, test_tiled_lossless);
+  g_test_add_data_func ("/tiledtexture/tiff", gdk_texture_save_to_tiff_bytes, test_tiled_lossless);
+  g_test_add_func ("/tiledtexture/jpeg", test_tiled_jpeg);
+  g_test_add_func ("/tiledtexture/small", test_small_not_tiled);
+  g_test_add_data_func ("/tiledtexture/truncated/png", gdk_texture_save_to_png_bytes, test_tiled_truncated);
+  g_test_add_data_func ("/tiledtexture/truncated/tiff", gdk_texture_save_to_tiff_bytes, test_tiled_truncated);
+
+  return g_test_run ();
+}
@@ -197,6 +197,67 @@ test_renderer (GskRenderer *renderer)
 
 }
 
+#define N_POOL_NODES 1000
+
+static gpointer
+create_nodes_thread (gpointer data)
+{
+  GskRenderNode **nodes = g_new (GskRenderNode *, N_POOL_NODES);
+  GskRenderNode *container, *child;
+  GskTransform *transform;
+  int i;
+
+  for (i = 0; i < N_POOL_NODES; i++)
+    {
+      transform = gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (i, i));
+      transform = gsk_transform_scale (transform, 2, 2);
+      child = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+      nodes[i] = gsk_transform_node_new (child, transform);
+      gsk_render_node_unref (child);
+      gsk_transform_unref (transform);
+    }
+
+  container = gsk_container_node_new (nodes, N_POOL_NODES);
+
+  for (i = 0; i < N_POOL_NODES; i++)
+    gsk_render_node_unref (nodes[i]);
+  g_free (nodes);
+
+  return container;
+}
+
+static void
+test_rendernode_pool_threads (void)
+{
+  GThread *threads[4];
+  GskRenderNode *nodes[G_N_ELEMENTS (threads)];
+  guint i;
+
+  /* Nodes come from a pool with thread-safe free lists, so create
+   * and free them from different threads at the same time */
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("create nodes", create_nodes_thread, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    {
+      nodes[i] = g_thread_join (threads[i]);
+      g_assert_true (GSK_IS_RENDER_NODE (nodes[i]));
+      g_assert_cmpint (gsk_render_node_get_node_type (nodes[i]), ==, GSK_CONTAINER_NODE);
+      g_assert_cmpint (gsk_container_node_get_n_children (nodes[i]), ==, N_POOL_NODES);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("free nodes", (GThreadFunc) gsk_render_node_unref, nodes[i]);
+
+  nodes[0] = create_nodes_thread (NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_assert_true (G_TYPE_CHECK_INSTANCE_TYPE (nodes[0], GSK_TYPE_CONTAINER_NODE));
+  gsk_render_node_unref (nodes[0]);
+}
+
 static void
 test_cairo_renderer (void)
 {
@@ -246,6 +307,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/rendernode/border/uniform", test_bordernode_uniform);
   g_test_add_func ("/rendernode/conic-gradient/angle", test_conic_gradient_angle);
   g_test_add_func ("/rendernode/container/disjoint", test_container_disjoint);
+  g_test_add_func ("/rendernode/pool/threads", test_rendernode_pool_threads);
   g_test_add_func ("/renderer/cairo", test_cairo_renderer);
   g_test_add_func ("/renderer/gl", test_gl_renderer);
   g_test_add_func ("/renderer/vulkan", test_vulkan_renderer);
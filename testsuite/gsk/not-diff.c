@@ -95,6 +95,149 @@ test_can_diff_transform (void)
   gsk_transform_unref (t2);
 }
 
+static GskRenderNode *
+scrolled_node_new (GskRenderNode *content,
+                   float          offset,
+                   GskRenderNode *overlay)
+{
+  GskTransform *t;
+  GskRenderNode *transform, *clip, *container;
+
+  t = gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (0, offset));
+  transform = gsk_transform_node_new (content, t);
+  clip = gsk_clip_node_new (transform, &GRAPHENE_RECT_INIT (0, 0, 100, 100));
+  gsk_render_node_unref (transform);
+  gsk_transform_unref (t);
+
+  if (overlay == NULL)
+    return clip;
+
+  container = gsk_container_node_new ((GskRenderNode *[]) { clip, overlay }, 2);
+  gsk_render_node_unref (clip);
+
+  return container;
+}
+
+static void
+test_diff_scroll (void)
+{
+  GskRenderNode *content, *node1, *node2;
+  cairo_region_t *region;
+  GArray *scrolls;
+  GskDiffScroll *scroll;
+
+  content = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 100, 200));
+  node1 = scrolled_node_new (content, -10, NULL);
+  node2 = scrolled_node_new (content, -20, NULL);
+
+  region = cairo_region_create ();
+  scrolls = g_array_new (FALSE, FALSE, sizeof (GskDiffScroll));
+  gsk_render_node_diff (node1, node2, &(GskDiffData) { region, NULL, scrolls });
+
+  /* Everything moves up, and only the bottom needs to be drawn */
+  g_assert_cmpuint (scrolls->len, ==, 1);
+  scroll = &g_array_index (scrolls, GskDiffScroll, 0);
+  g_assert_cmpint (scroll->dx, ==, 0);
+  g_assert_cmpint (scroll->dy, ==, -10);
+  g_assert_true (gdk_rectangle_equal (&scroll->rect, &(cairo_rectangle_int_t) { 0, 0, 100, 90 }));
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 0, 90, 100, 10 }) == CAIRO_REGION_OVERLAP_IN);
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 0, 0, 100, 90 }) == CAIRO_REGION_OVERLAP_OUT);
+
+  /* Without scrolls, we need to redraw everything */
+  cairo_region_destroy (region);
+  region = cairo_region_create ();
+  gsk_render_node_diff (node1, node2, &(GskDiffData) { region, NULL, NULL });
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 0, 0, 100, 100 }) == CAIRO_REGION_OVERLAP_IN);
+
+  gsk_render_node_unref (node1);
+  gsk_render_node_unref (node2);
+  gsk_render_node_unref (content);
+  cairo_region_destroy (region);
+  g_array_unref (scrolls);
+}
+
+static void
+test_diff_scroll_overlay (void)
+{
+  GskRenderNode *content, *overlay, *node1, *node2;
+  cairo_region_t *region;
+  GArray *scrolls;
+
+  content = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 100, 200));
+  overlay = gsk_color_node_new (&(GdkRGBA){1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (90, 40, 10, 20));
+  node1 = scrolled_node_new (content, -10, overlay);
+  node2 = scrolled_node_new (content, -20, overlay);
+
+  region = cairo_region_create ();
+  scrolls = g_array_new (FALSE, FALSE, sizeof (GskDiffScroll));
+  gsk_render_node_diff (node1, node2, &(GskDiffData) { region, NULL, scrolls });
+
+  g_assert_cmpuint (scrolls->len, ==, 1);
+  /* The overlay got moved with the content, so it needs to be
+   * drawn where it was moved to and where it is */
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 90, 30, 10, 20 }) == CAIRO_REGION_OVERLAP_IN);
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 90, 40, 10, 20 }) == CAIRO_REGION_OVERLAP_IN);
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 0, 0, 90, 90 }) == CAIRO_REGION_OVERLAP_OUT);
+
+  gsk_render_node_unref (node1);
+  gsk_render_node_unref (node2);
+  gsk_render_node_unref (overlay);
+  gsk_render_node_unref (content);
+  cairo_region_destroy (region);
+  g_array_unref (scrolls);
+}
+
+typedef GskRenderNode * (* WrapFunc) (GskRenderNode *node);
+
+static GskRenderNode *
+wrap_in_opacity (GskRenderNode *node)
+{
+  return gsk_opacity_node_new (node, 0.5);
+}
+
+static GskRenderNode *
+wrap_in_mask (GskRenderNode *node)
+{
+  GskRenderNode *mask, *result;
+
+  mask = gsk_color_node_new (&(GdkRGBA){0, 0, 0, 0.5 }, &GRAPHENE_RECT_INIT (0, 0, 100, 100));
+  result = gsk_mask_node_new (node, mask, GSK_MASK_MODE_ALPHA);
+  gsk_render_node_unref (mask);
+
+  return result;
+}
+
+static void
+test_diff_scroll_wrapped (gconstpointer data)
+{
+  WrapFunc wrap = (WrapFunc) data;
+  GskRenderNode *content, *scrolled1, *scrolled2, *node1, *node2;
+  cairo_region_t *region;
+  GArray *scrolls;
+
+  content = gsk_color_node_new (&(GdkRGBA){0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 100, 200));
+  scrolled1 = scrolled_node_new (content, -10, NULL);
+  scrolled2 = scrolled_node_new (content, -20, NULL);
+  node1 = wrap (scrolled1);
+  node2 = wrap (scrolled2);
+
+  region = cairo_region_create ();
+  scrolls = g_array_new (FALSE, FALSE, sizeof (GskDiffScroll));
+  gsk_render_node_diff (node1, node2, &(GskDiffData) { region, NULL, scrolls });
+
+  /* The drawn pixels are not the scrolled pixels, so we can't move them */
+  g_assert_cmpuint (scrolls->len, ==, 0);
+  g_assert_true (cairo_region_contains_rectangle (region, &(cairo_rectangle_int_t) { 0, 0, 100, 100 }) == CAIRO_REGION_OVERLAP_IN);
+
+  gsk_render_node_unref (node1);
+  gsk_render_node_unref (node2);
+  gsk_render_node_unref (scrolled1);
+  gsk_render_node_unref (scrolled2);
+  gsk_render_node_unref (content);
+  cairo_region_destroy (region);
+  g_array_unref (scrolls);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -103,6 +246,10 @@ main (int   argc,
 
   g_test_add_func ("/node/can-diff/basic", test_can_diff_basic);
   g_test_add_func ("/node/can-diff/transform", test_can_diff_transform);
+  g_test_add_func ("/node/diff/scroll", test_diff_scroll);
+  g_test_add_func ("/node/diff/scroll-overlay", test_diff_scroll_overlay);
+  g_test_add_data_func ("/node/diff/scroll-opacity", wrap_in_opacity, test_diff_scroll_wrapped);
+  g_test_add_data_func ("/node/diff/scroll-mask", wrap_in_mask, test_diff_scroll_wrapped);
 
   return g_test_run ();
 }
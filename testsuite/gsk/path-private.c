@@ -263,6 +263,186 @@ test_rect_winding (void)
   gsk_path_unref (path1);
 }
 
+static GskPath *
+create_large_path (void)
+{
+  GskPathBuilder *builder;
+  int i, j;
+
+  builder = gsk_path_builder_new ();
+
+  for (i = 0; i < 100; i++)
+    {
+      gsk_path_builder_move_to (builder, g_test_rand_double_range (0, 1000), g_test_rand_double_range (0, 1000));
+      for (j = 0; j < 50; j++)
+        {
+          float x = g_test_rand_double_range (0, 1000);
+          float y = g_test_rand_double_range (0, 1000);
+
+          switch (g_test_rand_int_range (0, 3))
+            {
+            case 0:
+              gsk_path_builder_line_to (builder, x, y);
+              break;
+            case 1:
+              gsk_path_builder_rel_quad_to (builder, 10, 10, x / 50, y / 50);
+              break;
+            case 2:
+              gsk_path_builder_rel_cubic_to (builder, 10, 0, 0, 10, x / 50, y / 50);
+              break;
+            default:
+              g_assert_not_reached ();
+            }
+        }
+
+      if (g_test_rand_bit ())
+        gsk_path_builder_close (builder);
+    }
+
+  for (i = 0; i < 20; i++)
+    {
+      gsk_path_builder_add_circle (builder,
+                                   &GRAPHENE_POINT_INIT (g_test_rand_double_range (0, 1000),
+                                                         g_test_rand_double_range (0, 1000)),
+                                   g_test_rand_double_range (1, 100));
+      gsk_path_builder_add_rect (builder,
+                                 &GRAPHENE_RECT_INIT (g_test_rand_double_range (0, 1000),
+                                                      g_test_rand_double_range (0, 1000),
+                                                      g_test_rand_double_range (1, 100),
+                                                      g_test_rand_double_range (1, 100)));
+    }
+
+  return gsk_path_builder_free_to_path (builder);
+}
+
+/* What the path does without an index */
+static int
+get_winding_slow (GskPath                *path,
+                  const graphene_point_t *point)
+{
+  int winding = 0;
+
+  for (gsize i = 0; i < gsk_path_get_n_contours (path); i++)
+    winding += gsk_contour_get_winding (gsk_path_get_contour (path, i), point);
+
+  return winding;
+}
+
+static gboolean
+get_closest_point_slow (GskPath                *path,
+                        const graphene_point_t *point,
+                        float                   threshold,
+                        GskPathPoint           *result,
+                        float                  *distance)
+{
+  gboolean found = FALSE;
+
+  for (gsize i = 0; i < gsk_path_get_n_contours (path); i++)
+    {
+      if (gsk_contour_get_closest_point (gsk_path_get_contour (path, i), point, threshold, result, distance))
+        {
+          found = TRUE;
+          result->contour = i;
+          threshold = *distance;
+        }
+    }
+
+  return found;
+}
+
+static void
+test_index_queries (void)
+{
+  GskPath *path;
+  int i;
+
+  path = create_large_path ();
+
+  for (i = 0; i < 1000; i++)
+    {
+      graphene_point_t p = GRAPHENE_POINT_INIT (g_test_rand_double_range (-100, 1100),
+                                                g_test_rand_double_range (-100, 1100));
+      float threshold = g_test_rand_double_range (1, 200);
+      GskPathPoint point1, point2;
+      float distance1, distance2;
+      gboolean found1, found2;
+
+      g_assert_cmpint (gsk_path_in_fill (path, &p, GSK_FILL_RULE_WINDING), ==, get_winding_slow (path, &p) != 0);
+      g_assert_cmpint (gsk_path_in_fill (path, &p, GSK_FILL_RULE_EVEN_ODD), ==, get_winding_slow (path, &p) & 1);
+
+      /* The closest point is searched with a different threshold
+       * for each curve, so allow for some imprecision */
+      found1 = gsk_path_get_closest_point (path, &p, threshold, &point1, &distance1);
+      found2 = get_closest_point_slow (path, &p, threshold, &point2, &distance2);
+      if (found1 && found2)
+        {
+          graphene_point_t pos1, pos2;
+
+          g_assert_cmpfloat_with_epsilon (distance1, distance2, 0.01);
+          gsk_path_point_get_position (&point1, path, &pos1);
+          gsk_path_point_get_position (&point2, path, &pos2);
+          if (point1.contour != point2.contour || point1.idx != point2.idx)
+            g_assert_cmpfloat_with_epsilon (graphene_point_distance (&pos1, &p, NULL, NULL),
+                                            graphene_point_distance (&pos2, &p, NULL, NULL),
+                                            0.01);
+          else
+            g_assert_cmpfloat_with_epsilon (graphene_point_distance (&pos1, &pos2, NULL, NULL), 0, 0.1);
+        }
+      else if (found1)
+        g_assert_cmpfloat_with_epsilon (distance1, threshold, 0.01);
+      else if (found2)
+        g_assert_cmpfloat_with_epsilon (distance2, threshold, 0.01);
+    }
+
+  gsk_path_unref (path);
+}
+
+static void
+test_index_perf (void)
+{
+  GskPath *path;
+  double indexed, slow;
+  int i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("only run in perf mode");
+      return;
+    }
+
+  path = create_large_path ();
+
+  g_test_timer_start ();
+  for (i = 0; i < 10000; i++)
+    {
+      graphene_point_t p = GRAPHENE_POINT_INIT (g_test_rand_double_range (0, 1000),
+                                                g_test_rand_double_range (0, 1000));
+      GskPathPoint point;
+
+      gsk_path_in_fill (path, &p, GSK_FILL_RULE_WINDING);
+      gsk_path_get_closest_point (path, &p, 10, &point, NULL);
+    }
+  indexed = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (i = 0; i < 10000; i++)
+    {
+      graphene_point_t p = GRAPHENE_POINT_INIT (g_test_rand_double_range (0, 1000),
+                                                g_test_rand_double_range (0, 1000));
+      GskPathPoint point;
+      float distance;
+
+      get_winding_slow (path, &p);
+      get_closest_point_slow (path, &p, 10, &point, &distance);
+    }
+  slow = g_test_timer_elapsed ();
+
+  g_test_minimized_result (indexed, "10000 queries with index: %gs", indexed);
+  g_test_message ("10000 queries without index: %gs", slow);
+
+  gsk_path_unref (path);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -274,6 +454,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/path/rounded-rect/winding", test_rounded_rect_winding);
   g_test_add_func ("/path/rect/roundtrip", test_rect_roundtrip);
   g_test_add_func ("/path/rect/winding", test_rect_winding);
+  g_test_add_func ("/path/index/queries", test_index_queries);
+  g_test_add_func ("/path/index/perf", test_index_perf);
 
   return g_test_run ();
 }
@@ -0,0 +1,241 @@
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "gsk/gpu/gskgpucacheprivate.h"
+#include "gsk/gpu/gskgpudeviceprivate.h"
+#include "gsk/gpu/gskgpurendererprivate.h"
+
+#include "testsuite/gdk/gdktestutils.h"
+
+#define SIZE 64
+
+struct {
+  const char *name;
+  GskRenderer * (*create_func) (void);
+  GskRenderer *renderer;
+} renderers[] = {
+  {
+    "cairo",
+    gsk_cairo_renderer_new,
+  },
+  {
+    "vulkan",
+    gsk_vulkan_renderer_new,
+  },
+  {
+    "gl",
+    gsk_gl_renderer_new,
+  },
+};
+
+static void
+fill_rect (guchar                      *data,
+           const cairo_rectangle_int_t *rect,
+           guint32                      color)
+{
+  int x, y;
+
+  for (y = rect->y; y < rect->y + rect->height; y++)
+    for (x = rect->x; x < rect->x + rect->width; x++)
+      memcpy (data + (y * SIZE + x) * 4, &color, 4);
+}
+
+static gsize
+get_n_stolen_images (GskRenderer *renderer)
+{
+  GskGpuDevice *device;
+
+  if (!GSK_IS_GPU_RENDERER (renderer))
+    return 0;
+
+  device = gsk_gpu_renderer_get_device (GSK_GPU_RENDERER (renderer));
+
+  return gsk_gpu_cache_get_n_stolen_images (gsk_gpu_device_get_cache (device));
+}
+
+static GdkTexture *
+build_texture (const guchar   *data,
+               GdkMemoryFormat format,
+               GdkTexture     *update_texture,
+               cairo_region_t *update_region)
+{
+  GdkMemoryTextureBuilder *builder;
+  GdkTexture *texture;
+  GBytes *bytes;
+
+  bytes = g_bytes_new (data, SIZE * SIZE * 4);
+
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_width (builder, SIZE);
+  gdk_memory_texture_builder_set_height (builder, SIZE);
+  gdk_memory_texture_builder_set_stride (builder, SIZE * 4);
+  gdk_memory_texture_builder_set_format (builder, format);
+  gdk_memory_texture_builder_set_update_texture (builder, update_texture);
+  gdk_memory_texture_builder_set_update_region (builder, update_region);
+
+  texture = gdk_memory_texture_builder_build (builder);
+
+  g_object_unref (builder);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static GdkTexture *
+render_texture (GskRenderer *renderer,
+                GdkTexture  *texture)
+{
+  GskRenderNode *node;
+  GdkTexture *result;
+
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, SIZE, SIZE));
+  result = gsk_renderer_render_texture (renderer, node, NULL);
+  gsk_render_node_unref (node);
+
+  return result;
+}
+
+/* Renders a texture, then a texture that was built as an update
+ * of it, and checks that the result matches a texture with the
+ * same data that has no relation to the first one.
+ */
+static void
+test_update (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  cairo_rectangle_int_t change = { 13, 7, 5, 20 };
+  GdkTexture *texture, *updated, *reference, *output, *expected;
+  cairo_region_t *region;
+  guchar *pixels;
+  gsize n_stolen;
+
+  pixels = g_malloc (SIZE * SIZE * 4);
+  fill_rect (pixels, &(cairo_rectangle_int_t) { 0, 0, SIZE, SIZE }, GUINT32_TO_BE (0xff0000ff));
+
+  texture = build_texture (pixels, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, NULL, NULL);
+  output = render_texture (renderer, texture);
+  g_object_unref (output);
+
+  fill_rect (pixels, &change, GUINT32_TO_BE (0x0000ffff));
+  region = cairo_region_create_rectangle (&change);
+  updated = build_texture (pixels, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, texture, region);
+  reference = build_texture (pixels, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, NULL, NULL);
+
+  n_stolen = get_n_stolen_images (renderer);
+  output = render_texture (renderer, updated);
+  /* Make sure we did only upload the changes */
+  if (GSK_IS_GPU_RENDERER (renderer))
+    g_assert_cmpuint (get_n_stolen_images (renderer), ==, n_stolen + 1);
+  expected = render_texture (renderer, reference);
+  compare_textures (expected, output, TRUE);
+  g_object_unref (output);
+  g_object_unref (expected);
+
+  /* The original texture must not have been changed */
+  fill_rect (pixels, &change, GUINT32_TO_BE (0xff0000ff));
+  g_object_unref (reference);
+  reference = build_texture (pixels, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, NULL, NULL);
+
+  output = render_texture (renderer, texture);
+  expected = render_texture (renderer, reference);
+  compare_textures (expected, output, TRUE);
+  g_object_unref (output);
+  g_object_unref (expected);
+
+  g_object_unref (reference);
+  g_object_unref (updated);
+  g_object_unref (texture);
+  cairo_region_destroy (region);
+  g_free (pixels);
+}
+
+/* An update that changes the format can't reuse the old image,
+ * even though the size is the same.
+ */
+static void
+test_update_format (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  cairo_rectangle_int_t change = { 13, 7, 5, 20 };
+  GdkTexture *texture, *updated, *reference, *output, *expected;
+  cairo_region_t *region;
+  guchar *pixels;
+  gsize n_stolen;
+
+  pixels = g_malloc (SIZE * SIZE * 4);
+  fill_rect (pixels, &(cairo_rectangle_int_t) { 0, 0, SIZE, SIZE }, GUINT32_TO_BE (0xff0000ff));
+
+  texture = build_texture (pixels, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, NULL, NULL);
+  output = render_texture (renderer, texture);
+  g_object_unref (output);
+
+  fill_rect (pixels, &change, GUINT32_TO_BE (0x0000ffff));
+  region = cairo_region_create_rectangle (&change);
+  updated = build_texture (pixels, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED, texture, region);
+  reference = build_texture (pixels, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED, NULL, NULL);
+
+  n_stolen = get_n_stolen_images (renderer);
+  output = render_texture (renderer, updated);
+  g_assert_cmpuint (get_n_stolen_images (renderer), ==, n_stolen);
+  expected = render_texture (renderer, reference);
+  compare_textures (expected, output, TRUE);
+  g_object_unref (output);
+  g_object_unref (expected);
+
+  g_object_unref (reference);
+  g_object_unref (updated);
+  g_object_unref (texture);
+  cairo_region_destroy (region);
+  g_free (pixels);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+  int result;
+  gsize i;
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      renderers[i].renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize_for_display (renderers[i].renderer, gdk_display_get_default (), &error))
+        {
+          g_test_message ("Could not realize %s renderer: %s", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_clear_object (&renderers[i].renderer);
+          continue;
+        }
+
+      test_name = g_strdup_printf ("/texture-update/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_update);
+      g_free (test_name);
+
+      test_name = g_strdup_printf ("/texture-update/%s/format", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_update_format);
+      g_free (test_name);
+    }
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+    }
+
+  return result;
+}
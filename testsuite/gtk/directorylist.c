@@ -0,0 +1,201 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+#include <glib/gstdio.h>
+
+#include <gtk/gtk.h>
+
+#define N_FILES 20
+
+static GFile *
+create_test_dir (void)
+{
+  char *path;
+  GFile *dir;
+  guint i;
+
+  path = g_dir_make_tmp ("gtk-directorylist-XXXXXX", NULL);
+  g_assert_nonnull (path);
+
+  for (i = 0; i < N_FILES; i++)
+    {
+      char *name = g_strdup_printf ("file%02u", i);
+      char *file = g_build_filename (path, name, NULL);
+
+      g_assert_true (g_file_set_contents (file, name, -1, NULL));
+
+      g_free (file);
+      g_free (name);
+    }
+
+  dir = g_file_new_for_path (path);
+  g_free (path);
+
+  return dir;
+}
+
+static void
+remove_test_dir (GFile *dir)
+{
+  char *path = g_file_get_path (dir);
+  guint i;
+
+  for (i = 0; i < N_FILES; i++)
+    {
+      char *name = g_strdup_printf ("file%02u", i);
+      char *file = g_build_filename (path, name, NULL);
+
+      g_unlink (file);
+
+      g_free (file);
+      g_free (name);
+    }
+
+  g_rmdir (path);
+  g_free (path);
+}
+
+static void
+wait_for_loading (GtkDirectoryList *list)
+{
+  while (gtk_directory_list_is_loading (list))
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+items_changed (GListModel *model,
+               guint       position,
+               guint       removed,
+               guint       added,
+               guint      *counter)
+{
+  g_assert_cmpuint (removed, ==, 1);
+  g_assert_cmpuint (added, ==, 1);
+
+  (*counter)++;
+}
+
+static void
+test_lazy (void)
+{
+  GtkDirectoryList *list;
+  GListModel *model;
+  GFile *dir;
+  guint changes = 0;
+  guint i;
+
+  dir = create_test_dir ();
+
+  list = gtk_directory_list_new (G_FILE_ATTRIBUTE_STANDARD_SIZE, NULL);
+  gtk_directory_list_set_lazy (list, TRUE);
+  gtk_directory_list_set_file (list, dir);
+  model = G_LIST_MODEL (list);
+
+  wait_for_loading (list);
+  g_assert_no_error (gtk_directory_list_get_error (list));
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, N_FILES);
+
+  g_signal_connect (list, "items-changed", G_CALLBACK (items_changed), &changes);
+
+  /* Request every item twice, so the second request comes
+   * in while the query for the first one is still running
+   */
+  for (i = 0; i < N_FILES; i++)
+    {
+      GFileInfo *info;
+
+      info = g_list_model_get_item (model, i);
+      g_assert_nonnull (g_file_info_get_name (info));
+      g_object_unref (info);
+
+      info = g_list_model_get_item (model, i);
+      g_object_unref (info);
+    }
+
+  while (changes < N_FILES)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Every item is updated exactly once */
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  g_assert_cmpuint (changes, ==, N_FILES);
+
+  for (i = 0; i < N_FILES; i++)
+    {
+      GFileInfo *info;
+
+      info = g_list_model_get_item (model, i);
+      g_assert_true (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE));
+      g_assert_nonnull (g_file_info_get_name (info));
+      g_assert_cmpint (g_file_info_get_file_type (info), ==, G_FILE_TYPE_REGULAR);
+      g_assert_true (G_IS_FILE (g_file_info_get_attribute_object (info, "standard::file")));
+      g_object_unref (info);
+    }
+
+  g_signal_handlers_disconnect_by_func (list, items_changed, &changes);
+  g_object_unref (list);
+
+  remove_test_dir (dir);
+  g_object_unref (dir);
+}
+
+static void
+test_lazy_restart (void)
+{
+  GtkDirectoryList *list;
+  GListModel *model;
+  GFile *dir;
+  guint i;
+
+  dir = create_test_dir ();
+
+  list = gtk_directory_list_new (G_FILE_ATTRIBUTE_STANDARD_SIZE, NULL);
+  gtk_directory_list_set_lazy (list, TRUE);
+  gtk_directory_list_set_file (list, dir);
+  model = G_LIST_MODEL (list);
+
+  wait_for_loading (list);
+
+  for (i = 0; i < N_FILES; i++)
+    g_object_unref (g_list_model_get_item (model, i));
+
+  /* Drop all pending queries while they are queued or running */
+  gtk_directory_list_set_attributes (list, G_FILE_ATTRIBUTE_STANDARD_SIZE "," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
+  wait_for_loading (list);
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, N_FILES);
+
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  g_object_unref (list);
+
+  remove_test_dir (dir);
+  g_object_unref (dir);
+}
+
+int
+main (int argc, char *argv[])
+{
+  (g_test_init) (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/directorylist/lazy", test_lazy);
+  g_test_add_func ("/directorylist/lazy-restart", test_lazy_restart);
+
+  return g_test_run ();
+}
@@ -48,12 +48,59 @@ test_measure_crash (void)
   gtk_window_destroy (GTK_WINDOW (window));
 }
 
+static int
+measure_height (GtkWidget *box,
+                int        width)
+{
+  int min, nat;
+
+  gtk_widget_measure (box, GTK_ORIENTATION_VERTICAL, width, &min, &nat, NULL, NULL);
+
+  return min;
+}
+
+/* Line sizes are kept between layouts, check that they
+ * are updated when a child changes size or goes away
+ */
+static void
+test_relayout (void)
+{
+  GtkWidget *box, *labels[10];
+  int height;
+  guint i;
+
+  box = g_object_ref_sink (gtk_flow_box_new ());
+  for (i = 0; i < G_N_ELEMENTS (labels); i++)
+    {
+      labels[i] = gtk_label_new ("label");
+      gtk_flow_box_insert (GTK_FLOW_BOX (box), labels[i], -1);
+    }
+
+  height = measure_height (box, 200);
+  g_assert_cmpint (height, >, 0);
+  g_assert_cmpint (measure_height (box, 200), ==, height);
+
+  gtk_label_set_text (GTK_LABEL (labels[7]), "a\nlabel\nwith\nmany\nlines");
+  g_assert_cmpint (measure_height (box, 200), >, height);
+
+  gtk_label_set_text (GTK_LABEL (labels[7]), "label");
+  g_assert_cmpint (measure_height (box, 200), ==, height);
+
+  gtk_label_set_text (GTK_LABEL (labels[7]), "a\nlabel\nwith\nmany\nlines");
+  gtk_flow_box_remove (GTK_FLOW_BOX (box), gtk_widget_get_parent (labels[7]));
+  gtk_flow_box_insert (GTK_FLOW_BOX (box), gtk_label_new ("label"), 7);
+  g_assert_cmpint (measure_height (box, 200), ==, height);
+
+  g_object_unref (box);
+}
+
 int
 main (int argc, char *argv[])
 {
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/flowbox/measure-crash", test_measure_crash);
+  g_test_add_func ("/flowbox/relayout", test_relayout);
 
   return g_test_run ();
 }
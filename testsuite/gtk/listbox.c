@@ -437,6 +437,105 @@ test_header (void)
   g_object_unref (list);
 }
 
+static GtkWidget *
+create_label (gpointer item,
+              gpointer data)
+{
+  int *count = data;
+
+  (*count)++;
+
+  return gtk_label_new (gtk_string_object_get_string (item));
+}
+
+static void
+allocate (GtkWidget *widget)
+{
+  int width, height;
+
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, &width, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, width, NULL, &height, NULL, NULL);
+  gtk_widget_size_allocate (widget, &(GtkAllocation) { 0, 0, width, height }, -1);
+}
+
+static int
+count_created_rows (GtkListBox *list)
+{
+  GtkListBoxRow *row;
+  int i, count;
+
+  count = 0;
+  for (i = 0; (row = gtk_list_box_get_row_at_index (list, i)) != NULL; i++)
+    {
+      if (gtk_list_box_row_get_child (row) != NULL)
+        count++;
+    }
+
+  return count;
+}
+
+static void
+test_virtualized (void)
+{
+  GtkListBox *list;
+  GtkStringList *model;
+  GtkAdjustment *adjustment;
+  GtkListBoxRow *row;
+  int i, count, created, height;
+  char *s;
+
+  model = gtk_string_list_new (NULL);
+  for (i = 0; i < 1000; i++)
+    {
+      s = g_strdup_printf ("%d", i);
+      gtk_string_list_append (model, s);
+      g_free (s);
+    }
+
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  g_object_ref_sink (list);
+  adjustment = gtk_adjustment_new (0, 0, 0, 10, 100, 100);
+  gtk_list_box_set_adjustment (list, adjustment);
+  gtk_list_box_set_virtualized (list, TRUE);
+
+  count = 0;
+  gtk_list_box_bind_model (list, G_LIST_MODEL (model), create_label, &count, NULL);
+  g_assert_cmpint (count, ==, 0);
+  g_assert_nonnull (gtk_list_box_get_row_at_index (list, 999));
+
+  /* once to get an estimate, once more to create the visible rows */
+  allocate (GTK_WIDGET (list));
+  allocate (GTK_WIDGET (list));
+  created = count_created_rows (list);
+  g_assert_cmpint (created, >, 0);
+  g_assert_cmpint (created, <, 1000);
+  g_assert_cmpint (count, <, 1000);
+
+  gtk_list_box_select_row (list, gtk_list_box_get_row_at_index (list, 0));
+
+  height = gtk_widget_get_height (GTK_WIDGET (list));
+  gtk_adjustment_configure (adjustment, height - 100, 0, height, 10, 100, 100);
+  allocate (GTK_WIDGET (list));
+  row = gtk_list_box_get_row_at_index (list, 999);
+  g_assert_nonnull (gtk_list_box_row_get_child (row));
+
+  /* the selected row stays around */
+  row = gtk_list_box_get_row_at_index (list, 0);
+  g_assert_nonnull (gtk_list_box_row_get_child (row));
+  g_assert_true (gtk_list_box_row_is_selected (row));
+  g_assert_true (gtk_list_box_get_selected_row (list) == row);
+
+  /* but rows next to it don't */
+  row = gtk_list_box_get_row_at_index (list, 1);
+  g_assert_null (gtk_list_box_row_get_child (row));
+
+  gtk_list_box_set_virtualized (list, FALSE);
+  g_assert_cmpint (count_created_rows (list), ==, 1000);
+
+  g_object_unref (list);
+  g_object_unref (model);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -447,6 +546,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/listbox/multi-selection", test_multi_selection);
   g_test_add_func ("/listbox/filter", test_filter);
   g_test_add_func ("/listbox/header", test_header);
+  g_test_add_func ("/listbox/virtualized", test_virtualized);
 
   return g_test_run ();
 }
@@ -378,6 +378,104 @@ test_create_with_items (void)
   gtk_window_destroy (GTK_WINDOW (widget));
 }
 
+static GtkListItemBase *
+create_slow_item (GtkWidget *widget)
+{
+  g_usleep (G_USEC_PER_SEC / 1000);
+
+  return g_object_new (GTK_TYPE_LIST_ITEM_BASE, NULL);
+}
+
+static void
+test_bind_budget (void)
+{
+  GtkListItemTracker *tracker;
+  GListModel *source;
+  GtkNoSelection *selection;
+  GtkListItemManager *items;
+  GtkWidget *widget;
+
+  widget = gtk_window_new ();
+  items = gtk_list_item_manager_new (widget,
+                                     split_simple,
+                                     create_slow_item,
+                                     prepare_simple,
+                                     create_simple_header);
+  g_object_set_data_full (G_OBJECT (widget), "the-items", items, g_object_unref);
+  tracker = gtk_list_item_tracker_new (items);
+
+  source = create_source_model (100, 100);
+  selection = gtk_no_selection_new (G_LIST_MODEL (source));
+  gtk_list_item_manager_set_model (items, GTK_SELECTION_MODEL (selection));
+
+  /* While scrolling, only the required items are bound right away */
+  gtk_list_item_manager_set_scroll_direction (items, 1);
+  gtk_list_item_tracker_set_required (items, tracker, 2, 2);
+  gtk_list_item_tracker_set_position (items, tracker, 50, 40, 40);
+  check_list_item_manager (items, widget, &tracker, 1);
+  g_assert_cmpint (widget_count_children (widget), >=, 5);
+  g_assert_cmpint (widget_count_children (widget), <, 81);
+
+  /* and everything once scrolling stops */
+  gtk_list_item_manager_set_scroll_direction (items, 0);
+  gtk_list_item_tracker_set_position (items, tracker, 50, 40, 40);
+  check_list_item_manager (items, widget, &tracker, 1);
+  g_assert_cmpint (widget_count_children (widget), ==, 81);
+
+  gtk_list_item_tracker_free (items, tracker);
+  g_object_unref (selection);
+  gtk_window_destroy (GTK_WINDOW (widget));
+}
+
+static void
+test_bind_budget_focus (void)
+{
+  GtkListItemTracker *trackers[2];
+  GListModel *source;
+  GtkNoSelection *selection;
+  GtkListItemManager *items;
+  GtkWidget *widget;
+
+  widget = gtk_window_new ();
+  items = gtk_list_item_manager_new (widget,
+                                     split_simple,
+                                     create_slow_item,
+                                     prepare_simple,
+                                     create_simple_header);
+  g_object_set_data_full (G_OBJECT (widget), "the-items", items, g_object_unref);
+  trackers[0] = gtk_list_item_tracker_new (items);
+  trackers[1] = gtk_list_item_tracker_new (items);
+
+  source = create_source_model (200, 200);
+  selection = gtk_no_selection_new (G_LIST_MODEL (source));
+  gtk_list_item_manager_set_model (items, GTK_SELECTION_MODEL (selection));
+
+  /* Focus an item, like GtkListBase does */
+  gtk_list_item_tracker_set_position (items, trackers[1], 50, 0, 0);
+
+  /* Scrolling away from it still defers binding, the focus
+   * only requires its own item */
+  gtk_list_item_manager_set_scroll_direction (items, 1);
+  gtk_list_item_tracker_set_required (items, trackers[0], 2, 2);
+  gtk_list_item_tracker_set_position (items, trackers[0], 50, 40, 40);
+  check_list_item_manager (items, widget, trackers, 2);
+  g_assert_cmpint (widget_count_children (widget), <, 81);
+
+  gtk_list_item_tracker_set_position (items, trackers[0], 150, 40, 40);
+  check_list_item_manager (items, widget, trackers, 2);
+  g_assert_cmpint (widget_count_children (widget), <, 82);
+
+  gtk_list_item_manager_set_scroll_direction (items, 0);
+  gtk_list_item_tracker_set_position (items, trackers[0], 150, 40, 40);
+  check_list_item_manager (items, widget, trackers, 2);
+  g_assert_cmpint (widget_count_children (widget), ==, 82);
+
+  gtk_list_item_tracker_free (items, trackers[0]);
+  gtk_list_item_tracker_free (items, trackers[1]);
+  g_object_unref (selection);
+  gtk_window_destroy (GTK_WINDOW (widget));
+}
+
 #define N_TRACKERS 3
 #define N_WIDGETS_PER_TRACKER 10
 #define N_RUNS 500
@@ -561,6 +659,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/listitemmanager/create", test_create);
   g_test_add_func ("/listitemmanager/create_with_items", test_create_with_items);
   g_test_add_func ("/listitemmanager/exhaustive", test_exhaustive);
+  g_test_add_func ("/listitemmanager/bind-budget", test_bind_budget);
+  g_test_add_func ("/listitemmanager/bind-budget-focus", test_bind_budget_focus);
 
   return g_test_run ();
 }
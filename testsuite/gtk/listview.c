@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2026 the GTK team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+
+#include <gtk/gtk.h>
+
+#define N_ITEMS 1000
+#define ROW_HEIGHT 20
+
+static void
+setup_item (GtkSignalListItemFactory *factory,
+            GtkListItem              *item)
+{
+  GtkWidget *child;
+
+  child = gtk_label_new (NULL);
+  gtk_widget_set_size_request (child, -1, ROW_HEIGHT);
+  g_object_set_data (G_OBJECT (child), "list-item", item);
+  gtk_list_item_set_child (item, child);
+}
+
+static void
+bind_item (GtkSignalListItemFactory *factory,
+           GtkListItem              *item)
+{
+  GtkWidget *child = gtk_list_item_get_child (item);
+
+  gtk_label_set_label (GTK_LABEL (child),
+                       gtk_string_object_get_string (gtk_list_item_get_item (item)));
+}
+
+static GtkListView *
+create_list_view (GtkWidget **window)
+{
+  GtkStringList *strings;
+  GtkListItemFactory *factory;
+  GtkWidget *sw, *list;
+  guint i;
+
+  strings = gtk_string_list_new (NULL);
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      char *s = g_strdup_printf ("%u", i);
+      gtk_string_list_take (strings, s);
+    }
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_item), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_item), NULL);
+
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))),
+                            factory);
+
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), list);
+
+  *window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (*window), 200, 200);
+  gtk_window_set_child (GTK_WINDOW (*window), sw);
+
+  return GTK_LIST_VIEW (list);
+}
+
+static void
+wait_for_allocation (GtkWidget *widget)
+{
+  while (gtk_widget_get_height (widget) == 0 ||
+         gtk_widget_needs_allocate (widget))
+    g_main_context_iteration (NULL, TRUE);
+
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+}
+
+/* Returns the widget of the row at position, or NULL */
+static GtkWidget *
+find_row (GtkListView *list,
+          guint        position)
+{
+  GtkWidget *row;
+
+  for (row = gtk_widget_get_first_child (GTK_WIDGET (list));
+       row != NULL;
+       row = gtk_widget_get_next_sibling (row))
+    {
+      GtkWidget *child = gtk_widget_get_first_child (row);
+      GtkListItem *item;
+
+      if (child == NULL || !gtk_widget_get_visible (row))
+        continue;
+
+      item = g_object_get_data (G_OBJECT (child), "list-item");
+      if (item != NULL && gtk_list_item_get_position (item) == position)
+        return row;
+    }
+
+  return NULL;
+}
+
+/* Returns the offset of the row at position from the start of the list */
+static double
+get_row_offset (GtkListView *list,
+                guint        position)
+{
+  GtkAdjustment *vadjustment;
+  GtkWidget *row;
+  graphene_point_t p;
+
+  row = find_row (list, position);
+  g_assert_nonnull (row);
+
+  g_assert_true (gtk_widget_compute_point (row, GTK_WIDGET (list), &GRAPHENE_POINT_INIT (0, 0), &p));
+  vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (list));
+
+  return p.y + gtk_adjustment_get_value (vadjustment);
+}
+
+static void
+notify_cb (GObject    *object,
+           GParamSpec *pspec,
+           guint      *counter)
+{
+  (*counter)++;
+}
+
+static void
+test_homogeneous_property (void)
+{
+  GtkWidget *list;
+  guint notified = 0;
+
+  list = gtk_list_view_new (NULL, NULL);
+  g_object_ref_sink (list);
+
+  g_assert_false (gtk_list_view_get_homogeneous (GTK_LIST_VIEW (list)));
+
+  g_signal_connect (list, "notify::homogeneous", G_CALLBACK (notify_cb), &notified);
+
+  gtk_list_view_set_homogeneous (GTK_LIST_VIEW (list), TRUE);
+  g_assert_true (gtk_list_view_get_homogeneous (GTK_LIST_VIEW (list)));
+  g_assert_cmpuint (notified, ==, 1);
+
+  gtk_list_view_set_homogeneous (GTK_LIST_VIEW (list), TRUE);
+  g_assert_cmpuint (notified, ==, 1);
+
+  g_object_set (list, "homogeneous", FALSE, NULL);
+  g_assert_false (gtk_list_view_get_homogeneous (GTK_LIST_VIEW (list)));
+  g_assert_cmpuint (notified, ==, 2);
+
+  g_object_unref (list);
+}
+
+static void
+test_homogeneous_scroll_to (void)
+{
+  GtkWidget *window;
+  GtkListView *list;
+  GtkAdjustment *vadjustment;
+  double row_stride, upper;
+  int row_height;
+  guint positions[] = { 500, N_ITEMS - 1, 250, 0 };
+  guint i;
+
+  list = create_list_view (&window);
+  gtk_list_view_set_homogeneous (list, TRUE);
+  vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (list));
+
+  gtk_window_present (GTK_WINDOW (window));
+  wait_for_allocation (GTK_WIDGET (list));
+
+  row_height = gtk_widget_get_height (find_row (list, 0));
+  g_assert_cmpint (row_height, >=, ROW_HEIGHT);
+  row_stride = get_row_offset (list, 1) - get_row_offset (list, 0);
+  g_assert_cmpfloat (row_stride, >=, row_height);
+
+  /* Only the first rows have been measured, but the size of the
+   * list is already exact */
+  upper = gtk_adjustment_get_upper (vadjustment);
+  g_assert_cmpfloat (upper, ==, row_stride * (N_ITEMS - 1) + row_height);
+
+  for (i = 0; i < G_N_ELEMENTS (positions); i++)
+    {
+      GtkWidget *row;
+
+      gtk_list_view_scroll_to (list, positions[i], GTK_LIST_SCROLL_NONE, NULL);
+      wait_for_allocation (GTK_WIDGET (list));
+
+      row = find_row (list, positions[i]);
+      g_assert_nonnull (row);
+      g_assert_cmpfloat (get_row_offset (list, positions[i]), ==, row_stride * positions[i]);
+      g_assert_cmpint (gtk_widget_get_height (row), ==, row_height);
+
+      /* The row is visible */
+      g_assert_cmpfloat (get_row_offset (list, positions[i]), >=, gtk_adjustment_get_value (vadjustment));
+      g_assert_cmpfloat (get_row_offset (list, positions[i]) + gtk_widget_get_height (row), <=,
+                         gtk_adjustment_get_value (vadjustment) + gtk_adjustment_get_page_size (vadjustment));
+
+      /* Nothing moved while scrolling */
+      g_assert_cmpfloat (gtk_adjustment_get_upper (vadjustment), ==, upper);
+    }
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/listview/homogeneous/property", test_homogeneous_property);
+  g_test_add_func ("/listview/homogeneous/scroll-to", test_homogeneous_scroll_to);
+
+  return g_test_run ();
+}
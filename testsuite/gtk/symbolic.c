@@ -1,4 +1,5 @@
 #include <gtk/gtk.h>
+#include "gdktextureutilsprivate.h"
 #include "../reftests/reftest-compare.h"
 
 static char *arg_output_dir = NULL;
@@ -200,6 +201,174 @@ test_symbolic (gconstpointer data)
   g_object_unref (texture);
 }
 
+static void
+test_symbolic_cache (gconstpointer data)
+{
+  GFile *file = (GFile *) data;
+  const char *filename;
+  GskRenderNode *node[3];
+  gboolean only_fg[3], single_path[3];
+  double width[3], height[3];
+  GBytes *bytes[3];
+  GBytes *contents;
+
+  filename = g_file_peek_path (file);
+
+  /* The reference is parsed from the svg directly, without
+   * looking at the cache
+   */
+  contents = g_file_load_bytes (file, NULL, NULL, NULL);
+  g_assert_nonnull (contents);
+  node[0] = gsk_render_node_new_from_bytes_symbolic (contents,
+                                                     &only_fg[0],
+                                                     &single_path[0],
+                                                     &width[0],
+                                                     &height[0],
+                                                     NULL);
+  g_bytes_unref (contents);
+
+  /* The first load writes the cache, if an earlier test
+   * didn't already, the second load is served from the cache.
+   */
+  for (int i = 1; i < 3; i++)
+    node[i] = gsk_render_node_new_from_filename_symbolic (filename,
+                                                          &only_fg[i],
+                                                          &single_path[i],
+                                                          &width[i],
+                                                          &height[i]);
+
+  if (node[1] == NULL)
+    {
+      g_assert_null (node[2]);
+      g_clear_pointer (&node[0], gsk_render_node_unref);
+      return;
+    }
+
+  g_assert_nonnull (node[0]);
+  g_assert_nonnull (node[2]);
+
+  for (int i = 0; i < 3; i++)
+    bytes[i] = gsk_render_node_serialize (node[i]);
+
+  for (int i = 1; i < 3; i++)
+    {
+      g_assert_cmpint (only_fg[0], ==, only_fg[i]);
+      g_assert_cmpint (single_path[0], ==, single_path[i]);
+      g_assert_cmpfloat (width[0], ==, width[i]);
+      g_assert_cmpfloat (height[0], ==, height[i]);
+      g_assert_true (g_bytes_equal (bytes[0], bytes[i]));
+    }
+
+  for (int i = 0; i < 3; i++)
+    {
+      g_bytes_unref (bytes[i]);
+      gsk_render_node_unref (node[i]);
+    }
+}
+
+static void
+test_symbolic_cache_truncated (gconstpointer data)
+{
+  GFile *file = (GFile *) data;
+  const char *filename;
+  GskRenderNode *node[2];
+  gboolean only_fg[2], single_path[2];
+  double width[2], height[2];
+  GBytes *bytes[2];
+  GBytes *contents;
+  char *checksum, *basename, *cache_path;
+  char *cache;
+  gsize cache_len;
+
+  filename = g_file_peek_path (file);
+
+  contents = g_file_load_bytes (file, NULL, NULL, NULL);
+  g_assert_nonnull (contents);
+  node[0] = gsk_render_node_new_from_bytes_symbolic (contents,
+                                                     &only_fg[0],
+                                                     &single_path[0],
+                                                     &width[0],
+                                                     &height[0],
+                                                     NULL);
+  g_bytes_unref (contents);
+
+  /* Make sure the cache is written */
+  node[1] = gsk_render_node_new_from_filename_symbolic (filename, NULL, NULL, &width[1], &height[1]);
+  if (node[1] == NULL)
+    {
+      g_clear_pointer (&node[0], gsk_render_node_unref);
+      return;
+    }
+  gsk_render_node_unref (node[1]);
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, filename, -1);
+  basename = g_strconcat (checksum, ".cache", NULL);
+  cache_path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "symbolic-icons", basename, NULL);
+  if (!g_file_get_contents (cache_path, &cache, &cache_len, NULL))
+    {
+      g_test_skip ("No cache was written");
+      goto out;
+    }
+
+  /* Cut off the end of the last path, so that the header and
+   * the other paths are read before the cache is rejected
+   */
+  g_assert_true (g_file_set_contents (cache_path, cache, cache_len - 4, NULL));
+  g_free (cache);
+
+  node[1] = gsk_render_node_new_from_filename_symbolic (filename,
+                                                        &only_fg[1],
+                                                        &single_path[1],
+                                                        &width[1],
+                                                        &height[1]);
+  g_assert_nonnull (node[1]);
+
+  for (int i = 0; i < 2; i++)
+    bytes[i] = gsk_render_node_serialize (node[i]);
+
+  g_assert_cmpint (only_fg[0], ==, only_fg[1]);
+  g_assert_cmpint (single_path[0], ==, single_path[1]);
+  g_assert_cmpfloat (width[0], ==, width[1]);
+  g_assert_cmpfloat (height[0], ==, height[1]);
+  g_assert_true (g_bytes_equal (bytes[0], bytes[1]));
+
+  for (int i = 0; i < 2; i++)
+    g_bytes_unref (bytes[i]);
+  gsk_render_node_unref (node[1]);
+
+out:
+  g_clear_pointer (&node[0], gsk_render_node_unref);
+  g_free (cache_path);
+  g_free (basename);
+  g_free (checksum);
+}
+
+static void
+remove_dir_recursively (GFile *dir)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *child;
+
+  enumerator = g_file_enumerate_children (dir,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          NULL, NULL);
+  if (enumerator)
+    {
+      while (g_file_enumerator_iterate (enumerator, &info, &child, NULL, NULL) && info)
+        {
+          if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+            remove_dir_recursively (child);
+          else
+            g_file_delete (child, NULL, NULL);
+        }
+      g_object_unref (enumerator);
+    }
+
+  g_file_delete (dir, NULL, NULL);
+}
+
 static int
 compare_files (gconstpointer a, gconstpointer b)
 {
@@ -233,6 +402,13 @@ main (int argc, char *argv[])
   GFileInfo *info;
   GList *files;
   GError *error = NULL;
+  char *cache_dir;
+  int result;
+
+  /* Don't read or pollute the symbolic icon cache of the user */
+  cache_dir = g_dir_make_tmp ("gtk-symbolic-cache-XXXXXX", NULL);
+  g_assert_nonnull (cache_dir);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
 
   gtk_test_init (&argc, &argv);
 
@@ -262,7 +438,8 @@ main (int argc, char *argv[])
       g_free (out);
       g_object_unref (texture);
 
-      return 0;
+      result = 0;
+      goto out;
     }
 
   dir = g_test_build_filename (G_TEST_DIST, "symbolic-icons", NULL);
@@ -301,9 +478,23 @@ main (int argc, char *argv[])
       testname = g_strconcat ("/symbolic/", basename, NULL);
       g_test_add_data_func_full (testname, g_object_ref (file), test_symbolic, g_object_unref);
       g_free (testname);
+      testname = g_strconcat ("/symbolic-cache/", basename, NULL);
+      g_test_add_data_func_full (testname, g_object_ref (file), test_symbolic_cache, g_object_unref);
+      g_free (testname);
+      testname = g_strconcat ("/symbolic-cache-truncated/", basename, NULL);
+      g_test_add_data_func_full (testname, g_object_ref (file), test_symbolic_cache_truncated, g_object_unref);
+      g_free (testname);
       g_free (basename);
     }
   g_list_free_full (files, g_object_unref);
 
-  return g_test_run ();
+  result = g_test_run ();
+
+out:
+  file = g_file_new_for_path (cache_dir);
+  remove_dir_recursively (file);
+  g_object_unref (file);
+  g_free (cache_dir);
+
+  return result;
 }
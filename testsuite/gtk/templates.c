@@ -170,6 +170,34 @@ test_volume_button_basic (void)
   g_object_unref (g_object_ref_sink (widget));
 }
 
+static void
+test_scale_button_instances (void)
+{
+  GtkWidget *widget[2];
+  guint i;
+
+  /* The second instance is built from the cached template data */
+  for (i = 0; i < G_N_ELEMENTS (widget); i++)
+    {
+      GtkWidget *button, *box;
+
+      widget[i] = gtk_scale_button_new (0, 100, 10, NULL);
+      g_object_ref_sink (widget[i]);
+
+      button = gtk_widget_get_first_child (widget[i]);
+      g_assert_true (GTK_IS_TOGGLE_BUTTON (button));
+      g_assert_false (gtk_widget_get_focus_on_click (button));
+      g_assert_true (gtk_widget_get_receives_default (button));
+
+      box = gtk_popover_get_child (GTK_POPOVER (gtk_scale_button_get_popup (GTK_SCALE_BUTTON (widget[i]))));
+      g_assert_cmpint (gtk_orientable_get_orientation (GTK_ORIENTABLE (box)), ==, GTK_ORIENTATION_VERTICAL);
+      g_assert_cmpint (gtk_box_get_spacing (GTK_BOX (box)), ==, 4);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (widget); i++)
+    g_object_unref (widget[i]);
+}
+
 static void
 test_statusbar_basic (void)
 {
@@ -446,6 +474,7 @@ main (int argc, char **argv)
   g_test_add_func ("/template/GtkAssistant/basic", test_assistant_basic);
   g_test_add_func ("/template/GtkAssistant/show", test_assistant_show);
   g_test_add_func ("/template/GtkScaleButton/basic", test_scale_button_basic);
+  g_test_add_func ("/template/GtkScaleButton/instances", test_scale_button_instances);
   g_test_add_func ("/template/GtkVolumeButton/basic", test_volume_button_basic);
   g_test_add_func ("/template/GtkStatusBar/basic", test_statusbar_basic);
   g_test_add_func ("/template/GtkSearchBar/basic", test_search_bar_basic);